@@ -0,0 +1,237 @@
+#!/usr/bin/env python3
+
+'''
+Coverage -- merge e6809 code coverage maps and map them onto a listing
+
+Version:
+    1.0.0
+
+Copyright:
+    2025, Tony Smith (@smittytone)
+
+License:
+    MIT (terms attached to this repo)
+'''
+
+'''
+IMPORTS
+'''
+import re
+from sys import exit, argv, stdout
+
+
+'''
+GLOBALS
+'''
+# Coverage files, as written by e6809_d32 -c and remote.py coverage,
+# hold the magic then three maps of a bit per address: bytes executed,
+# branches taken and branches not taken -- see source/coverage.h
+FILE_MAGIC = b"e6809cv1"
+MAP_SIZE = 65536 // 8
+EXECUTED = 0
+TAKEN = 1
+NOT_TAKEN = 2
+MAPS = 3
+
+# A listing line starts with its address then, for code, its bytes
+LISTING_LINE = re.compile(r'^([0-9A-Fa-f]{4})\s+((?:[0-9A-Fa-f]{2})+)(?:\s+(.*))?$')
+DATA_DIRECTIVES = {"fcb", "fdb", "fcc", "fcn", "fcs", "fqb", "rmb", "zmb", "fill", ".byte", ".word", ".ascii", ".db", ".dw"}
+
+# Conditional branches, after any 0x10 prefix. BRA and BRN (0x20, 0x21)
+# only ever go one way
+CONDITIONAL_FIRST = 0x22
+CONDITIONAL_LAST = 0x2F
+
+
+'''
+FUNCTIONS
+'''
+
+'''
+Read a coverage file.
+
+Args:
+    file (str): The file's path.
+
+Returns:
+    List: The maps, each a bitmap held as an integer, address 0 in bit 0.
+'''
+def read_coverage(file):
+    with open(file, "rb") as f: data = f.read()
+    if not data.startswith(FILE_MAGIC) or len(data) != len(FILE_MAGIC) + MAPS * MAP_SIZE:
+        raise ValueError(file)
+    data = data[len(FILE_MAGIC):]
+    return [int.from_bytes(data[m * MAP_SIZE:(m + 1) * MAP_SIZE], "little") for m in range(MAPS)]
+
+
+'''
+Merge coverage files: a bitwise OR of each map.
+
+Args:
+    files (List): The files' paths.
+
+Returns:
+    List: The merged maps.
+'''
+def merge_coverage(files):
+    merged = [0] * MAPS
+    for file in files:
+        maps = read_coverage(file)
+        merged = [merged[m] | maps[m] for m in range(MAPS)]
+    return merged
+
+
+'''
+Write maps as a coverage file.
+
+Args:
+    file (str):  The file's path.
+    maps (List): The maps.
+'''
+def write_coverage(file, maps):
+    with open(file, "wb") as f:
+        f.write(FILE_MAGIC + b"".join(m.to_bytes(MAP_SIZE, "little") for m in maps))
+
+
+'''
+Check an address's bit in a map.
+'''
+def is_set(bitmap, address):
+    return (bitmap >> address) & 1 == 1
+
+
+'''
+Mark up an assembler listing. Each code line gets a two-character
+prefix: '+' if its op ran, '-' if not; then, for a conditional branch,
+'B' if it went both ways, 'T' if only taken, 'N' if only not taken,
+'!' if it never ran. Data lines and other lines are left unmarked.
+
+Args:
+    file (str):  The listing's path.
+    maps (List): The coverage maps.
+
+Returns:
+    Tuple: The marked-up lines, and the counts of code lines, code lines
+           run, conditional branches, and branches seen going both ways.
+'''
+def mark_listing(file, maps):
+    marked = []
+    ops = ops_run = branches = both_ways = 0
+    with open(file) as lines:
+        for line in lines:
+            line = line.rstrip("\n")
+            match = LISTING_LINE.match(line.rstrip())
+            source = (match.group(3) or "") if match else ""
+            words = [w.lower() for w in source.split(";")[0].split()]
+            if not match or len(DATA_DIRECTIVES.intersection(words)) > 0:
+                marked.append("   " + line)
+                continue
+
+            address = int(match.group(1), 16)
+            code = bytes.fromhex(match.group(2))
+            is_run = is_set(maps[EXECUTED], address)
+            ops += 1
+            ops_run += 1 if is_run else 0
+
+            branch = " "
+            opcode = code[1] if code[0] == 0x10 and len(code) > 1 else code[0]
+            if CONDITIONAL_FIRST <= opcode <= CONDITIONAL_LAST:
+                branches += 1
+                taken = is_set(maps[TAKEN], address)
+                not_taken = is_set(maps[NOT_TAKEN], address)
+                if taken and not_taken:
+                    branch = "B"
+                    both_ways += 1
+                elif taken or not_taken:
+                    branch = "T" if taken else "N"
+                else:
+                    branch = "!"
+            marked.append(("+" if is_run else "-") + branch + " " + line)
+    return (marked, ops, ops_run, branches, both_ways)
+
+
+'''
+Describe a fraction as a percentage.
+'''
+def percent(part, whole):
+    return "{}/{} ({:.1f}%)".format(part, whole, 100.0 * part / whole if whole > 0 else 0.0)
+
+
+'''
+Show the utility help
+'''
+def show_help():
+    print("Coverage 1.0.0 copyright (c) 2025 Tony Smith (@smittytone)")
+    print("\nMerge e6809 code coverage files and map them onto an assembler listing.\n")
+    print("Usage:\n\n  coverage.py [-l <listing>] [-o <output file>] [-m <merged file>] <coverage file> ...\n")
+    print("Options:\n")
+    print("  -l / --listing  An assembler listing to mark up with the lines run and the branches' outcomes.")
+    print("  -o / --output   Write the marked-up listing to a file rather than stdout.")
+    print("  -m / --merge    Write the merged coverage to a file, eg. to merge again later.")
+    print("  -h / --help     This help page.")
+    print("\nWithout a listing, the totals for the whole address space are shown.\n")
+
+
+'''
+RUNTIME START
+'''
+if __name__ == '__main__':
+
+    listing_file = None
+    out_file = None
+    merged_file = None
+    coverage_files = []
+
+    index = 1
+    while index < len(argv):
+        item = argv[index]
+        if item in ("-h", "--help"):
+            show_help()
+            exit(0)
+        elif item in ("-l", "--listing", "-o", "--output", "-m", "--merge"):
+            if index + 1 >= len(argv):
+                print("[ERROR]", item, "is missing a file")
+                exit(1)
+            if item in ("-l", "--listing"):
+                listing_file = argv[index + 1]
+            elif item in ("-o", "--output"):
+                out_file = argv[index + 1]
+            else:
+                merged_file = argv[index + 1]
+            index += 2
+        else:
+            coverage_files.append(item)
+            index += 1
+
+    if len(coverage_files) == 0:
+        show_help()
+        exit(1)
+
+    try:
+        maps = merge_coverage(coverage_files)
+        if merged_file is not None: write_coverage(merged_file, maps)
+    except OSError as err:
+        print("[ERROR] Cannot access", err.filename)
+        exit(1)
+    except ValueError as err:
+        print("[ERROR]", err, "is not a coverage file")
+        exit(1)
+
+    if listing_file is None:
+        print("Bytes executed:     ", bin(maps[EXECUTED]).count("1"))
+        print("Branches taken:     ", bin(maps[TAKEN]).count("1"))
+        print("Branches not taken: ", bin(maps[NOT_TAKEN]).count("1"))
+        print("Both ways:          ", bin(maps[TAKEN] & maps[NOT_TAKEN]).count("1"))
+        exit(0)
+
+    try:
+        marked, ops, ops_run, branches, both_ways = mark_listing(listing_file, maps)
+    except OSError:
+        print("[ERROR] Cannot read", listing_file)
+        exit(1)
+
+    output = open(out_file, "w") if out_file is not None else stdout
+    for line in marked: output.write(line + "\n")
+    if out_file is not None: output.close()
+    print("Lines run:          ", percent(ops_run, ops))
+    print("Branches both ways: ", percent(both_ways, branches))
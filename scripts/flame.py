@@ -0,0 +1,279 @@
+#!/usr/bin/env python3
+
+'''
+Flame -- fold e6809 PC samples into flame-graph stacks
+
+Version:
+    1.0.0
+
+Copyright:
+    2025, Tony Smith (@smittytone)
+
+License:
+    MIT (terms attached to this repo)
+'''
+
+'''
+IMPORTS
+'''
+import re
+from bisect import bisect_right
+from sys import exit, argv, stdout
+
+
+'''
+GLOBALS
+'''
+# Sample files, as written by e6809_d32 -s and remote.py sample, hold
+# one sample per line: the stacked return addresses, outermost first,
+# then the PC, in hex. A leading '...' marks a truncated stack
+TRUNCATED = "..."
+TRUNCATED_FRAME = "[deeper]"
+
+LABEL = r'[A-Za-z_.@?][\w.@?$]*'
+SYMBOL_EQU = re.compile(r'^\s*(' + LABEL + r')\s*:?\s+(?:equ|set|=)\s+(?:\$|0x)?([0-9A-Fa-f]{1,4})\b', re.IGNORECASE)
+SYMBOL_ADDRESS_FIRST = re.compile(r'^\s*(?:\$|0x)?([0-9A-Fa-f]{4})\s+(' + LABEL + r')\s*$')
+SYMBOL_NAME_FIRST = re.compile(r'^\s*(' + LABEL + r')\s+(?:\$|0x)?([0-9A-Fa-f]{4})\s*$')
+LISTING_LINE = re.compile(r'^([0-9A-Fa-f]{4})\s+((?:[0-9A-Fa-f]{2})+\s+)*(.*)$')
+LISTING_NOISE = re.compile(r'^(?:\(.*\):\d+|\d+)$')
+
+MNEMONICS = {
+    "abx", "adca", "adcb", "adda", "addb", "addd", "anda", "andb", "andcc", "asl", "asla", "aslb",
+    "asr", "asra", "asrb", "bcc", "bcs", "beq", "bge", "bgt", "bhi", "bhs", "bita", "bitb", "ble",
+    "blo", "bls", "blt", "bmi", "bne", "bpl", "bra", "brn", "bsr", "bvc", "bvs", "clr", "clra",
+    "clrb", "cmpa", "cmpb", "cmpd", "cmps", "cmpu", "cmpx", "cmpy", "com", "coma", "comb", "cwai",
+    "daa", "dec", "deca", "decb", "eora", "eorb", "exg", "inc", "inca", "incb", "jmp", "jsr",
+    "lbcc", "lbcs", "lbeq", "lbge", "lbgt", "lbhi", "lbhs", "lble", "lblo", "lbls", "lblt", "lbmi",
+    "lbne", "lbpl", "lbra", "lbrn", "lbsr", "lbvc", "lbvs", "lda", "ldb", "ldd", "lds", "ldu",
+    "ldx", "ldy", "leas", "leau", "leax", "leay", "lsl", "lsla", "lslb", "lsr", "lsra", "lsrb",
+    "mul", "neg", "nega", "negb", "nop", "ora", "orb", "orcc", "pshs", "pshu", "puls", "pulu",
+    "rol", "rola", "rolb", "ror", "rora", "rorb", "rti", "rts", "sbca", "sbcb", "sex", "sta",
+    "stb", "std", "sts", "stu", "stx", "sty", "suba", "subb", "subd", "swi", "swi2", "swi3",
+    "sync", "tfr", "tst", "tsta", "tstb",
+    "org", "equ", "set", "fcb", "fdb", "fcc", "rmb", "fill", "zmb", "setdp", "end", "put", "include"
+}
+
+
+'''
+FUNCTIONS
+'''
+
+'''
+Check for a local label: one starting '.' or '@', or containing '@'
+or '$'. Local labels mark loops within routines, not routines.
+
+Args:
+    name (str): The label.
+
+Returns:
+    Bool: True if the label is local, otherwise False.
+'''
+def is_local(name):
+    return name[0] in ".@" or "@" in name or "$" in name
+
+
+'''
+Add a symbol, keeping the first routine name seen at an address.
+
+Args:
+    symbols (Dict):  Names keyed by address.
+    address (Int):   The symbol's address.
+    name (str):      The symbol's name.
+'''
+def add_symbol(symbols, address, name):
+    if address not in symbols or (is_local(symbols[address]) and not is_local(name)):
+        symbols[address] = name
+
+
+'''
+Read symbols from a symbol file: lines of 'name EQU $addr',
+'name = $addr', 'addr name' or 'name addr', with or without a $ or
+0x prefix.
+
+Args:
+    file (str): The symbol file's path.
+
+Returns:
+    Dict: Names keyed by address.
+'''
+def read_symbol_file(file):
+    symbols = {}
+    with open(file) as lines:
+        for line in lines:
+            match = SYMBOL_EQU.match(line)
+            if match:
+                add_symbol(symbols, int(match.group(2), 16), match.group(1))
+                continue
+            match = SYMBOL_ADDRESS_FIRST.match(line)
+            if match:
+                add_symbol(symbols, int(match.group(1), 16), match.group(2))
+                continue
+            match = SYMBOL_NAME_FIRST.match(line)
+            if match:
+                add_symbol(symbols, int(match.group(2), 16), match.group(1))
+    return symbols
+
+
+'''
+Read code labels from an assembler listing. A listing line starts with
+its address and any code bytes; its label is the first word of the
+source if that ends with ':', or is not a mnemonic but is followed by
+one or stands alone.
+
+Args:
+    file (str): The listing's path.
+
+Returns:
+    Dict: Names keyed by address.
+'''
+def read_listing(file):
+    symbols = {}
+    with open(file) as lines:
+        for line in lines:
+            match = LISTING_LINE.match(line.rstrip())
+            if not match: continue
+            words = [w for w in match.group(3).split(";")[0].split() if not LISTING_NOISE.match(w)]
+            if len(words) == 0 or words[0].startswith("*"): continue
+
+            name = words[0]
+            if name.endswith(":"):
+                name = name[:-1]
+            elif name.lower() in MNEMONICS or (len(words) > 1 and words[1].lower() not in MNEMONICS):
+                continue
+
+            # EQU sets a value, not a code address
+            if len(words) > 1 and words[1].lower() in ("equ", "set", "="): continue
+            if re.fullmatch(LABEL, name): add_symbol(symbols, int(match.group(1), 16), name)
+    return symbols
+
+
+'''
+Build a lookup from address to enclosing routine. Local labels are
+skipped, so that a routine's loops stay within it.
+
+Args:
+    symbols (Dict): Names keyed by address.
+
+Returns:
+    Tuple: The sorted addresses and their names.
+'''
+def make_lookup(symbols):
+    routines = sorted((a, n) for a, n in symbols.items() if not is_local(n))
+    return ([a for a, _ in routines], [n for _, n in routines])
+
+
+'''
+Name the routine holding an address.
+
+Args:
+    lookup (Tuple):  From make_lookup().
+    address (Int):   The address.
+
+Returns:
+    str: The routine's name, or the address in hex if it precedes every symbol.
+'''
+def symbolise(lookup, address):
+    index = bisect_right(lookup[0], address) - 1
+    return lookup[1][index] if index >= 0 else "${:04X}".format(address)
+
+
+'''
+Fold samples into flame-graph stacks: one line per distinct stack,
+routines outermost first and separated by ';', then the sample count.
+
+Args:
+    files (List):    The sample files' paths.
+    lookup (Tuple):  From make_lookup().
+
+Returns:
+    List: The folded lines.
+'''
+def fold_samples(files, lookup):
+    counts = {}
+    for file in files:
+        with open(file) as lines:
+            for line in lines:
+                words = line.split()
+                if len(words) == 0 or words[0].startswith("#"): continue
+
+                frames = []
+                if words[0] == TRUNCATED:
+                    frames.append(TRUNCATED_FRAME)
+                    words = words[1:]
+
+                # A return address follows its call, so look up the call
+                addresses = [int(w, 16) for w in words]
+                frames += [symbolise(lookup, (a - 1) & 0xFFFF) for a in addresses[:-1]]
+                frames.append(symbolise(lookup, addresses[-1]))
+
+                stack = ";".join(frames)
+                counts[stack] = counts.get(stack, 0) + 1
+    return ["{} {}".format(stack, count) for stack, count in sorted(counts.items())]
+
+
+'''
+Show the utility help
+'''
+def show_help():
+    print("Flame 1.0.0 copyright (c) 2025 Tony Smith (@smittytone)")
+    print("\nFold e6809 PC samples into stacks for flamegraph.pl or speedscope.\n")
+    print("Usage:\n\n  flame.py [-s <symbol file>] [-l <listing>] [-o <output file>] <sample file> ...\n")
+    print("Options:\n")
+    print("  -s / --symbols  A symbol file: 'name EQU $addr', 'name = $addr' or 'addr name' lines.")
+    print("  -l / --listing  An assembler listing to take code labels from.")
+    print("  -o / --output   Write the stacks to a file rather than stdout.")
+    print("  -h / --help     This help page.")
+    print("\nWithout symbols, routines are named by address.\n")
+
+
+'''
+RUNTIME START
+'''
+if __name__ == '__main__':
+
+    symbols = {}
+    sample_files = []
+    out_file = None
+
+    index = 1
+    while index < len(argv):
+        item = argv[index]
+        if item in ("-h", "--help"):
+            show_help()
+            exit(0)
+        elif item in ("-s", "--symbols", "-l", "--listing", "-o", "--output"):
+            if index + 1 >= len(argv):
+                print("[ERROR]", item, "is missing a file")
+                exit(1)
+            file = argv[index + 1]
+            try:
+                if item in ("-s", "--symbols"):
+                    symbols.update(read_symbol_file(file))
+                elif item in ("-l", "--listing"):
+                    symbols.update(read_listing(file))
+                else:
+                    out_file = file
+            except OSError:
+                print("[ERROR] Cannot read", file)
+                exit(1)
+            index += 2
+        else:
+            sample_files.append(item)
+            index += 1
+
+    if len(sample_files) == 0:
+        show_help()
+        exit(1)
+
+    try:
+        folded = fold_samples(sample_files, make_lookup(symbols))
+    except OSError as err:
+        print("[ERROR] Cannot read", err.filename)
+        exit(1)
+    except ValueError:
+        print("[ERROR] A sample file is malformed")
+        exit(1)
+
+    output = open(out_file, "w") if out_file is not None else stdout
+    for line in folded: output.write(line + "\n")
+    if out_file is not None: output.close()
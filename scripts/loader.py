@@ -4,7 +4,7 @@
 Loader -- code loader for e6809 on Pico
 
 Version:
-    1.0.0
+    1.3.0
 
 Copyright:
     2021, Tony Smith (@smittytone)
@@ -18,7 +18,8 @@ IMPORTS
 '''
 from os import path
 from sys import exit, argv
-from time import time_ns
+from time import time_ns, sleep
+from zlib import crc32
 
 
 '''
@@ -26,6 +27,28 @@ GLOBALS
 '''
 verbose = True
 
+# Windowed protocol -- see source/upload.h
+FRAME_SYNC = b'\x55\x3D'
+FRAME_SIZE = 4096
+FRAME_START = 0x01
+FRAME_DATA = 0x02
+FRAME_END = 0x03
+FRAME_HASH = 0x04
+FRAME_PATCH = 0x05
+FRAME_DUMP = 0x06
+FLAG_LZ4 = 0x01
+FLAG_DELTA = 0x02
+PAGE_SIZE = 256
+REPLY_HEAD = 0xAA
+REPLY_ACK = ord('A')
+REPLY_NAK = ord('N')
+REPLY_DONE = ord('D')
+REPLY_ERROR = ord('E')
+REPLY_HASHES = ord('H')
+WINDOW_FRAMES = 8
+FRAME_TIMEOUT_MS = 1000
+MAX_RETRIES = 5
+
 
 '''
 FUNCTIONS
@@ -160,6 +183,520 @@ def send_trailer_block(uart):
     r = uart.write(out)
 
 
+'''
+Build a windowed protocol frame.
+
+Args:
+    frame_type (Int): One of the FRAME_* types.
+    seq (Int):        The frame's sequence number.
+    address (Int):    The 16-bit address of the payload.
+    payload (Bytes):  The frame data.
+    flags (Int):      Frame flags. Default: 0.
+
+Returns:
+    Bytes: The frame, ready to send.
+'''
+def make_frame(frame_type, seq, address, payload, flags=0):
+    header = bytes([frame_type, flags, (seq >> 8) & 0xFF, seq & 0xFF,
+                    (address >> 8) & 0xFF, address & 0xFF,
+                    (len(payload) >> 8) & 0xFF, len(payload) & 0xFF])
+    crc = crc32(header + payload)
+    return FRAME_SYNC + header + payload + crc.to_bytes(4, "big")
+
+
+'''
+Compress a block of data in the LZ4 block format. Greedy matching,
+using a hash of the next four bytes to find earlier occurrences.
+
+Args:
+    data (Bytes): The data to compress.
+
+Returns:
+    Bytes: The LZ4 block.
+'''
+def lz4_compress(data):
+    out = bytearray()
+    table = {}
+    length = len(data)
+    anchor = 0
+    i = 0
+
+    def put_length(value):
+        while value >= 255:
+            out.append(255)
+            value -= 255
+        out.append(value)
+
+    # The format requires the last match to start 12 bytes before the end
+    # and the last 5 bytes to be literals
+    limit = length - 12
+    while i < limit:
+        key = data[i:i + 4]
+        candidate = table.get(key)
+        table[key] = i
+        if candidate is None or i - candidate > 0xFFFF:
+            i += 1
+            continue
+
+        match = 4
+        while i + match < length - 5 and data[candidate + match] == data[i + match]:
+            match += 1
+
+        literals = i - anchor
+        token = (min(literals, 15) << 4) | min(match - 4, 15)
+        out.append(token)
+        if literals >= 15: put_length(literals - 15)
+        out += data[anchor:i]
+        out += (i - candidate).to_bytes(2, "little")
+        if match - 4 >= 15: put_length(match - 4 - 15)
+
+        i += match
+        anchor = i
+
+    # Final literals-only sequence
+    literals = length - anchor
+    out.append(min(literals, 15) << 4)
+    if literals >= 15: put_length(literals - 15)
+    out += data[anchor:]
+    return bytes(out)
+
+
+'''
+Hash a memory page the way the device does: FNV-1a applied to
+little-endian 32-bit words, the last zero-padded -- see source/crc.c.
+
+Args:
+    data (Bytes): The page data.
+
+Returns:
+    Int: The 32-bit hash.
+'''
+def page_hash(data):
+    value = 0x811C9DC5
+    for i in range(0, len(data), 4):
+        word = int.from_bytes(data[i:i + 4], "little")
+        value = ((value ^ word) * 0x01000193) & 0xFFFFFFFF
+    return value
+
+
+'''
+Read whatever replies the device has sent within a time limit.
+
+Args:
+    uart (Serial):      The chosen serial port.
+    buffer (Bytearray): Unparsed reply bytes, carried between calls.
+    timeout (Int):      How long to wait for a first reply, in ms.
+
+Returns:
+    List: (code, seq, extra) tuples. extra is the image CRC32 for
+          REPLY_DONE, the list of page hashes for REPLY_HASHES, or None.
+'''
+def read_replies(uart, buffer, timeout):
+    replies = []
+    end = (time_ns() // 1000000) + timeout
+    while True:
+        waiting = uart.in_waiting
+        if waiting > 0:
+            buffer += uart.read(waiting)
+        else:
+            sleep(0.0005)
+
+        # Parse complete replies, skipping any stray bytes
+        while len(buffer) >= 4:
+            if buffer[0] != REPLY_HEAD:
+                del buffer[0]
+                continue
+            seq = (buffer[2] << 8) | buffer[3]
+            extra = None
+            if buffer[1] == REPLY_DONE:
+                size = 8
+            elif buffer[1] == REPLY_HASHES:
+                size = 4 + seq * 4
+            else:
+                size = 4
+            if len(buffer) < size: break
+            if buffer[1] == REPLY_DONE:
+                extra = int.from_bytes(buffer[4:8], "big")
+            elif buffer[1] == REPLY_HASHES:
+                extra = [int.from_bytes(buffer[i:i + 4], "big") for i in range(4, size, 4)]
+            replies.append((buffer[1], seq, extra))
+            del buffer[:size]
+
+        if len(replies) > 0 or (time_ns() // 1000000) >= end:
+            return replies
+
+
+'''
+Send a control frame and wait for its reply, with retries.
+
+Args:
+    uart (Serial):      The chosen serial port.
+    buffer (Bytearray): Unparsed reply bytes.
+    frame (Bytes):      The frame.
+    wanted (Tuple):     The reply codes that end the wait.
+
+Returns:
+    List: The replies received, or None on timeout.
+'''
+def send_control(uart, buffer, frame, wanted):
+    for _ in range(MAX_RETRIES):
+        uart.write(frame)
+        replies = []
+        while True:
+            batch = read_replies(uart, buffer, FRAME_TIMEOUT_MS)
+            if len(batch) == 0: break
+            replies += batch
+            if any(r[0] in wanted for r in batch): return replies
+    return None
+
+
+'''
+Ask the device for the hash of each 256-byte page a range covers.
+
+Args:
+    uart (Serial):      The chosen serial port.
+    buffer (Bytearray): Unparsed reply bytes.
+    address (Int):      The 16-bit start of the range.
+    length (Int):       The range's length in bytes.
+
+Returns:
+    List: The page hashes, or None if the device did not supply them.
+'''
+def request_hashes(uart, buffer, address, length):
+    frame = make_frame(FRAME_HASH, 0, address, length.to_bytes(4, "big"))
+    replies = send_control(uart, buffer, frame, (REPLY_HASHES, REPLY_ERROR))
+    if replies is None: return None
+    hashes = [r[2] for r in replies if r[0] == REPLY_HASHES]
+    return hashes[0] if len(hashes) > 0 else None
+
+
+'''
+Build PATCH frames for the pages of an image whose hashes differ from
+the device's. Runs of adjacent changed pages are merged, up to 4KB
+a frame. Pages are aligned to memory, not to the image, so the first
+and last may be partial.
+
+Args:
+    data (Bytes):    The image.
+    address (Int):   The 16-bit load address.
+    hashes (List):   The device's page hashes.
+
+Returns:
+    Tuple: The PATCH frames, the bytes they carry and the number of changed pages.
+'''
+def make_patches(data, address, hashes):
+    end = address + len(data)
+    runs = []
+    changed = 0
+    page_start = address
+    for device_hash in hashes:
+        page_end = min((page_start // PAGE_SIZE + 1) * PAGE_SIZE, end)
+        page = data[page_start - address:page_end - address]
+        if page_hash(page) != device_hash:
+            changed += 1
+            if len(runs) > 0 and runs[-1][1] == page_start and page_end - runs[-1][0] <= FRAME_SIZE:
+                runs[-1][1] = page_end
+            else:
+                runs.append([page_start, page_end])
+        page_start = page_end
+
+    frames = [make_frame(FRAME_PATCH, seq, run[0], bytes(data[run[0] - address:run[1] - address]))
+              for seq, run in enumerate(runs)]
+    return (frames, sum(run[1] - run[0] for run in runs), changed)
+
+
+'''
+Run a windowed transfer: START, the frames with up to `window` in
+flight and only NAK'd or timed-out frames resent, then END. The device
+NAKs any frames still missing at END, which are resent in turn.
+
+Args:
+    uart (Serial):      The chosen serial port.
+    buffer (Bytearray): Unparsed reply bytes.
+    data (Bytes):       The image, to check the device's CRC32 against.
+    address (Int):      The 16-bit load address.
+    frames (List):      The DATA or PATCH frames; each one's index is its sequence number.
+    window (Int):       The number of unacknowledged frames allowed.
+    flags (Int):        The START frame's flags.
+
+Returns:
+    Int: The number of frames resent, or None on failure.
+'''
+def send_frames(uart, buffer, data, address, frames, window, flags):
+    start_frame = make_frame(FRAME_START, 0, address, len(data).to_bytes(4, "big"), flags)
+    replies = send_control(uart, buffer, start_frame, (REPLY_ACK, REPLY_ERROR))
+    if replies is None or replies[-1][0] != REPLY_ACK:
+        print("[ERROR] Upload not accepted")
+        return None
+
+    acked = set()
+    sent_at = {}
+    resends = 0
+    next_seq = 0
+
+    def send_frame(seq):
+        uart.write(frames[seq])
+        sent_at[seq] = time_ns() // 1000000
+
+    for _ in range(MAX_RETRIES):
+        while len(acked) < len(frames):
+            # Fill the window above the oldest unacknowledged frame
+            base = min([s for s in range(next_seq) if s not in acked], default=next_seq)
+            while next_seq < len(frames) and next_seq - base < window:
+                send_frame(next_seq)
+                next_seq += 1
+
+            for code, seq, _ in read_replies(uart, buffer, 50):
+                if seq >= len(frames): continue
+                if code == REPLY_ACK:
+                    acked.add(seq)
+                elif code == REPLY_NAK:
+                    acked.discard(seq)
+                    send_frame(seq)
+                    resends += 1
+                elif code == REPLY_ERROR:
+                    print("[ERROR] Device rejected frame", seq)
+                    return None
+
+            # Resend frames whose replies are overdue
+            now = time_ns() // 1000000
+            for seq in range(next_seq):
+                if seq not in acked and now - sent_at[seq] > FRAME_TIMEOUT_MS:
+                    send_frame(seq)
+                    resends += 1
+
+        # The device NAKs any frames it is still missing
+        end_frame = make_frame(FRAME_END, 0, address, b'')
+        replies = send_control(uart, buffer, end_frame, (REPLY_DONE, REPLY_NAK, REPLY_ERROR))
+        if replies is None:
+            print("[ERROR] No reply to end of upload")
+            return None
+
+        done = [r for r in replies if r[0] == REPLY_DONE]
+        if len(done) > 0:
+            if done[0][2] != crc32(data):
+                print("[ERROR] Image CRC mismatch")
+                return None
+            return resends
+
+        for code, seq, _ in replies:
+            if code == REPLY_NAK: acked.discard(seq)
+            if code == REPLY_ERROR:
+                print("[ERROR] Upload aborted by device")
+                return None
+
+    print("[ERROR] Upload failed after", MAX_RETRIES, "attempts")
+    return None
+
+
+'''
+Upload an image with the windowed protocol: 4KB frames, each with
+a CRC32, LZ4-compressed where that makes them smaller. If the device's
+memory already holds much of the image, as when re-sending after an
+edit, only the 256-byte pages whose hashes differ are sent.
+
+Args:
+    uart (Serial):    The chosen serial port.
+    data (Bytes):     The image.
+    address (Int):    The 16-bit load address.
+    window (Int):     The number of unacknowledged frames allowed.
+    compress (Bool):  Whether to compress frames. Default: True.
+    delta (Bool):     Whether to send only changed pages. Default: True.
+
+Returns:
+    Bool: True if the device confirmed the image's CRC32, otherwise False.
+'''
+def send_windowed(uart, data, address, window=WINDOW_FRAMES, compress=True, delta=True):
+    buffer = bytearray()
+    start = time_ns()
+
+    # Build every frame up front; each compressed block decompresses on
+    # the device straight into memory at the frame's address
+    frames = []
+    sent_bytes = 0
+    for seq, offset in enumerate(range(0, len(data), FRAME_SIZE)):
+        payload = bytes(data[offset:offset + FRAME_SIZE])
+        flags = 0
+        if compress:
+            packed = lz4_compress(payload)
+            if len(packed) < len(payload):
+                payload = packed
+                flags = FLAG_LZ4
+        frames.append(make_frame(FRAME_DATA, seq, address + offset, payload, flags))
+        sent_bytes += len(payload)
+
+    # Patch the device's copy if that means sending less
+    if delta:
+        hashes = request_hashes(uart, buffer, address, len(data))
+        if hashes is not None:
+            patches, patch_bytes, changed = make_patches(data, address, hashes)
+            if patch_bytes < sent_bytes:
+                resends = send_frames(uart, buffer, data, address, patches, window, FLAG_DELTA)
+                if resends is not None:
+                    elapsed = (time_ns() - start) / 1e9
+                    show_verbose("{} of {} page(s) changed, {} bytes sent in {:.3f}s, {} frame(s) resent".format(changed, len(hashes), patch_bytes, elapsed, resends))
+                    return True
+                show_verbose("Delta upload failed -- sending the whole image")
+
+    resends = send_frames(uart, buffer, data, address, frames, window, 0)
+    if resends is None: return False
+    elapsed = (time_ns() - start) / 1e9
+    show_verbose("{} bytes sent as {} in {:.3f}s ({:.1f} KB/s), {} frame(s) resent".format(len(data), sent_bytes, elapsed, len(data) / 1024 / elapsed, resends))
+    return True
+
+
+'''
+Read the frames and replies that answer a DUMP request, until the
+device's DONE reply or a timeout.
+
+Args:
+    uart (Serial):      The chosen serial port.
+    buffer (Bytearray): Unparsed bytes, carried between calls.
+    timeout (Int):      How long to wait for more data, in ms.
+
+Returns:
+    Tuple: A dict of good frames' payloads keyed by address, and the
+           DONE reply's (frame count, CRC32), or None on timeout.
+'''
+def read_dump(uart, buffer, timeout):
+    frames = {}
+    last_rx = time_ns() // 1000000
+    while (time_ns() // 1000000) - last_rx < timeout:
+        waiting = uart.in_waiting
+        if waiting > 0:
+            buffer += uart.read(waiting)
+            last_rx = time_ns() // 1000000
+        else:
+            sleep(0.0005)
+
+        while len(buffer) >= 4:
+            if buffer[0] == REPLY_HEAD:
+                if buffer[1] == REPLY_ERROR:
+                    del buffer[:4]
+                    return (frames, None)
+                if buffer[1] != REPLY_DONE:
+                    del buffer[0]
+                    continue
+                if len(buffer) < 8: break
+                done = ((buffer[2] << 8) | buffer[3], int.from_bytes(buffer[4:8], "big"))
+                del buffer[:8]
+                return (frames, done)
+
+            if buffer[:2] != FRAME_SYNC:
+                del buffer[0]
+                continue
+
+            # A frame: drop it if it fails its CRC and hunt for the next one
+            if len(buffer) < 10: break
+            size = (buffer[8] << 8) | buffer[9]
+            if buffer[2] != FRAME_DATA or size > FRAME_SIZE:
+                del buffer[0]
+                continue
+            if len(buffer) < size + 14: break
+            if crc32(buffer[2:10 + size]) != int.from_bytes(buffer[10 + size:14 + size], "big"):
+                del buffer[0]
+                continue
+            frames[(buffer[6] << 8) | buffer[7]] = bytes(buffer[10:10 + size])
+            del buffer[:size + 14]
+
+    return (frames, None)
+
+
+'''
+Read a range of the device's memory. Frames that arrive damaged are
+requested again individually, and the result is checked against the
+CRC32 of the whole range the device reports.
+
+Args:
+    uart (Serial):  The chosen serial port.
+    address (Int):  The 16-bit start address.
+    length (Int):   The number of bytes to read.
+
+Returns:
+    Bytes: The memory contents, or None on failure.
+'''
+def dump_memory(uart, address, length):
+    buffer = bytearray()
+    start = time_ns()
+    uart.write(make_frame(FRAME_DUMP, 0, address, length.to_bytes(4, "big")))
+    frames, done = read_dump(uart, buffer, FRAME_TIMEOUT_MS)
+    if done is None:
+        print("[ERROR] No reply to dump request")
+        return None
+
+    # Fetch any missing frames one at a time
+    resends = 0
+    for offset in range(0, length, FRAME_SIZE):
+        frame_address = address + offset
+        size = min(FRAME_SIZE, length - offset)
+        for _ in range(MAX_RETRIES):
+            if frame_address in frames: break
+            uart.write(make_frame(FRAME_DUMP, 0, frame_address, size.to_bytes(4, "big")))
+            frames.update(read_dump(uart, buffer, FRAME_TIMEOUT_MS)[0])
+            resends += 1
+
+    data = b''.join(frames.get(address + offset, b'') for offset in range(0, length, FRAME_SIZE))
+    if len(data) != length or crc32(data) != done[1]:
+        print("[ERROR] Dump CRC mismatch")
+        return None
+
+    elapsed = (time_ns() - start) / 1e9
+    show_verbose("{} bytes read in {:.3f}s ({:.1f} KB/s), {} frame(s) re-read".format(length, elapsed, length / 1024 / elapsed, resends))
+    return data
+
+
+'''
+Save dumped memory in the format the file's extension implies:
+`.rom` or `.bin` raw, `.s19` or `.srec` Motorola S-records, `.hex`
+Intel HEX, or `.txt` a hex dump.
+
+Args:
+    file (String):  The output path and filename.
+    data (Bytes):   The memory contents.
+    address (Int):  The 16-bit address of the first byte.
+
+Returns:
+    Bool: True if the file was written, False if the format is unknown.
+'''
+def save_dump(file, data, address):
+    _, ext = path.splitext(file)
+    ext = ext.lower()
+    if ext in (".rom", ".bin"):
+        with open(file, "wb") as f:
+            f.write(data)
+        return True
+
+    lines = []
+    if ext in (".s19", ".srec"):
+        def s_record(kind, record_address, payload):
+            body = bytes([len(payload) + 3, record_address >> 8, record_address & 0xFF]) + payload
+            return "S{}{}{:02X}".format(kind, body.hex().upper(), ~sum(body) & 0xFF)
+
+        lines.append(s_record(0, 0, b'e6809'))
+        for offset in range(0, len(data), 32):
+            lines.append(s_record(1, address + offset, data[offset:offset + 32]))
+        lines.append(s_record(9, address, b''))
+    elif ext == ".hex":
+        def i_record(kind, record_address, payload):
+            body = bytes([len(payload), record_address >> 8, record_address & 0xFF, kind]) + payload
+            return ":{}{:02X}".format(body.hex().upper(), -sum(body) & 0xFF)
+
+        for offset in range(0, len(data), 16):
+            lines.append(i_record(0, address + offset, data[offset:offset + 16]))
+        lines.append(i_record(1, 0, b''))
+    elif ext == ".txt":
+        for offset in range(0, len(data), 16):
+            row = data[offset:offset + 16]
+            text = "".join(chr(b) if 32 <= b < 127 else "." for b in row)
+            lines.append("{:04X}  {:<47}  {}".format(address + offset, row.hex(" ").upper(), text))
+    else:
+        return False
+
+    with open(file, "w") as f:
+        f.write("\n".join(lines) + "\n")
+    return True
+
+
 '''
 Display a message if verbose mode is enabled.
 
@@ -194,11 +731,18 @@ Show the utility help
 '''
 def show_help():
     show_version()
-    print("\nTransfer binary data to the 6809e Monitor Board.\n")
-    print("Usage:\n\n  loader.py [-s] [-d] [-q] [-h] <rom_file>\n")
+    print("\nTransfer binary data to or from the 6809e Monitor Board.\n")
+    print("Usage:\n\n  loader.py [-s] [-d] [-w] [-n] [-f] [-l] [-x <file> [-c]] [-q] [-h] <rom_file>\n")
     print("Options:\n")
     print("  -s / --start    Code 16-bit start address. Default: 0x0000.")
     print("  -d / --device   The Monitor Board USB-serial device file.")
+    print("  -w / --window   Frames in flight, 1-16. Default: 8.")
+    print("  -n / --raw      Send frames uncompressed.")
+    print("  -f / --full     Always send the whole image, never just changed pages.")
+    print("  -l / --legacy   Use the original stop-and-wait protocol.")
+    print("  -x / --dump     Save the board's memory from the start address to a")
+    print("                  .rom, .bin, .s19, .srec, .hex or .txt file.")
+    print("  -c / --count    The number of bytes to dump. Default: to the end of memory.")
     print("  -q / --quiet    Quiet output -- no messages other than errors.")
     print("  -h / --help     This help information.")
     print()
@@ -208,7 +752,7 @@ def show_help():
 Show the utility version info
 '''
 def show_version():
-    print("Loader 1.0.0 copyright (c) 2021 Tony Smith (@smittytone)")
+    print("Loader 1.3.0 copyright (c) 2021 Tony Smith (@smittytone)")
 
 
 '''
@@ -220,6 +764,12 @@ if __name__ == '__main__':
     start_address = 0x0000
     rom_file = None
     device = None
+    window = WINDOW_FRAMES
+    use_legacy = False
+    use_compression = True
+    use_delta = True
+    dump_file = None
+    dump_count = None
 
     if len(argv) > 1:
         for index, item in enumerate(argv):
@@ -231,6 +781,39 @@ if __name__ == '__main__':
                 exit(0)
             elif item in ("-q", "--quiet"):
                 verbose = False
+            elif item in ("-l", "--legacy"):
+                use_legacy = True
+            elif item in ("-n", "--raw"):
+                use_compression = False
+            elif item in ("-f", "--full"):
+                use_delta = False
+            elif item in ("-w", "--window"):
+                if index + 1 >= len(argv):
+                    print("[ERROR] -w / --window must be followed by a frame count")
+                    exit(1)
+                window = str_to_int(argv[index + 1])
+                if window is False or window < 1 or window > 16:
+                    print("[ERROR] -w / --window must be followed by a value between 1 and 16")
+                    exit(1)
+                arg_flag = True
+            elif item in ("-x", "--dump"):
+                if index + 1 >= len(argv):
+                    print("[ERROR] -x / --dump must be followed by a file")
+                    exit(1)
+                dump_file = argv[index + 1]
+                if path.splitext(dump_file)[1].lower() not in (".rom", ".bin", ".s19", ".srec", ".hex", ".txt"):
+                    print("[ERROR] -x / --dump must be followed by a .rom, .bin, .s19, .srec, .hex or .txt file")
+                    exit(1)
+                arg_flag = True
+            elif item in ("-c", "--count"):
+                if index + 1 >= len(argv):
+                    print("[ERROR] -c / --count must be followed by a byte count")
+                    exit(1)
+                dump_count = str_to_int(argv[index + 1])
+                if dump_count is False or dump_count < 1 or dump_count > 0x10000:
+                    print("[ERROR] -c / --count must be followed by a value between 1 and 65536")
+                    exit(1)
+                arg_flag = True
             elif item in ("-s", "--startaddress"):
                 if index + 1 >= len(argv):
                     print("[ERROR] -s / --startaddress must be followed by an address")
@@ -262,7 +845,7 @@ if __name__ == '__main__':
                     else:
                         print("[ERROR] File " + item + " is not a .rom file")
 
-    if rom_file is None:
+    if rom_file is None and dump_file is None:
         print("[ERROR] No .rom file specified")
         exit(1)
 
@@ -279,12 +862,33 @@ if __name__ == '__main__':
         print("[ERROR] An invalid e6809 device file was specified:",device)
         exit(1)
 
+    if dump_file is not None:
+        if dump_count is None: dump_count = 0x10000 - start_address
+        if start_address + dump_count > 0x10000:
+            print("[ERROR] Dump runs past the end of memory")
+            exit(1)
+        data_bytes = dump_memory(port, start_address, dump_count)
+        port.close()
+        if data_bytes is None: exit(1)
+        save_dump(dump_file, data_bytes, start_address)
+        show_verbose("Memory saved to " + dump_file)
+        exit(0)
+
     # Load the data
     data_bytes = get_file(rom_file)
     length = len(data_bytes)
     show_verbose("Code start adddress set to 0x{:04X}".format(start_address))
     show_verbose(str(length) + " bytes to send")
 
+    if start_address + length > 0x10000:
+        print("[ERROR] Code does not fit in memory at 0x{:04X}".format(start_address))
+        exit(1)
+
+    if not use_legacy:
+        result = send_windowed(port, data_bytes, start_address, window, use_compression, use_delta)
+        port.close()
+        exit(0 if result else 1)
+
     # Send the header
     send_addr_block(port, start_address)
     await_ack_or_exit(port)
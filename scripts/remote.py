@@ -0,0 +1,753 @@
+#!/usr/bin/env python3
+
+'''
+Remote -- remote control for e6809 on Pico
+
+Version:
+    1.0.0
+
+Copyright:
+    2025, Tony Smith (@smittytone)
+
+License:
+    MIT (terms attached to this repo)
+'''
+
+'''
+IMPORTS
+'''
+from sys import exit, argv
+from time import time_ns, sleep
+from zlib import crc32
+
+
+'''
+GLOBALS
+'''
+# Remote-control protocol -- see source/remote.h
+FRAME_SYNC = b'\x55\x3E'
+RESPONSE_BIT = 0x80
+MAX_PAYLOAD = 1024
+CMD_PING = 0x01
+CMD_PEEK = 0x02
+CMD_POKE = 0x03
+CMD_GET_REGS = 0x04
+CMD_SET_REGS = 0x05
+CMD_RUN = 0x06
+CMD_STEP = 0x07
+CMD_STOP = 0x08
+CMD_BREAK_SET = 0x09
+CMD_BREAK_CLEAR = 0x0A
+CMD_BREAK_CLEAR_ALL = 0x0B
+CMD_STATUS = 0x0C
+CMD_PROFILE = 0x0D
+CMD_PROFILE_RESET = 0x0E
+CMD_SAMPLE_START = 0x0F
+CMD_SAMPLE_READ = 0x10
+CMD_HEATMAP = 0x11
+CMD_HEATMAP_READ = 0x12
+CMD_TRACE = 0x13
+CMD_TRACE_READ = 0x14
+CMD_BREAK_ADD = 0x15
+CMD_BREAK_REMOVE = 0x16
+CMD_SNAPSHOTS = 0x17
+CMD_COVERAGE = 0x18
+CMD_COVERAGE_READ = 0x19
+EVENT_STOPPED = 0xC0
+STATUS_TEXT = ("OK", "bad CRC", "unknown command", "bad length", "CPU is running", "no free breakpoint or bad settings")
+STOP_TEXT = ("cycles done", "breakpoint", "returned to monitor", "stopped", "watchpoint")
+REGISTERS = ("a", "b", "x", "y", "u", "s", "pc", "cc", "dp")
+TIMEOUT_MS = 1000
+
+# Breakpoint settings -- see source/breakpoint.h
+BREAK_KINDS = {"exec": 0x01, "read": 0x02, "write": 0x04, "access": 0x06}
+BREAK_ACTIONS = ("stop", "log", "snapshot")
+BREAK_CONDITIONS = ("", "==", "!=", "<", ">=", "&")
+BREAK_REGISTERS = ("a", "b", "d", "x", "y", "u", "s", "pc", "cc", "dp")
+SNAPSHOT_SIZE = 22
+
+# Opcode profile layout -- see source/profile.h
+PROFILE_PAGES = 3
+PROFILE_FORMS = 33
+PROFILE_HISTOGRAM_SIZE = 32
+PROFILE_MODES = ("unknown", "immediate", "direct", "indexed", "extended", "inherent", "relative")
+PROFILE_FORM_NAMES = (",R+", ",R++", ",-R", ",--R", ",R", "B,R", "A,R", "?",
+                      "n8,R", "n16,R", "?", "D,R", "n8,PC", "n16,PC", "?", "?",
+                      "?", "[,R++]", "?", "[,--R]", "[,R]", "[B,R]", "[A,R]", "?",
+                      "[n8,R]", "[n16,R]", "?", "[D,R]", "[n8,PC]", "[n16,PC]", "?", "[n16]",
+                      "n5,R")
+PROFILE_PREFIXES = ("   ", "10 ", "11 ")
+
+# PC samples -- see source/sample.h
+SAMPLE_TRUNCATED = 0x80
+
+# Memory access heatmap -- see source/heatmap.h
+HEATMAP_MODES = ("off", "on", "reset")
+HEATMAP_KINDS = 3
+HEATMAP_PAGES = 256
+
+# Instruction traces -- see source/trace.h
+TRACE_FILE_MAGIC = b"e6809tr1"
+
+# Code coverage -- see source/coverage.h
+COVERAGE_MODES = ("off", "on", "reset")
+COVERAGE_SIZE = 3 * 8192
+COVERAGE_FILE_MAGIC = b"e6809cv1"
+
+
+'''
+CLASSES
+'''
+class RemoteError(Exception):
+    pass
+
+
+class Remote:
+    '''
+    Drive a monitor board over its USB serial link. Each command waits
+    for its response; STOPPED events that arrive meanwhile are queued
+    for wait_for_stop().
+
+    Args:
+        uart (Serial): An open serial port, or anything with the same
+                       write(), read() and in_waiting members.
+    '''
+    def __init__(self, uart):
+        self.uart = uart
+        self.buffer = bytearray()
+        self.tag = 0
+        self.events = []
+        self.hit = None
+
+
+    def command(self, cmd, payload=b''):
+        self.tag = (self.tag + 1) & 0xFF
+        header = bytes([cmd, self.tag, len(payload) >> 8, len(payload) & 0xFF])
+        body = header + bytes(payload)
+        self.uart.write(FRAME_SYNC + body + crc32(body).to_bytes(4, "big"))
+
+        end = (time_ns() // 1000000) + TIMEOUT_MS
+        response = None
+        while response is None and (time_ns() // 1000000) < end:
+            for code, tag, status, data in self.read_frames():
+                if code == EVENT_STOPPED:
+                    self.events.append(data)
+                elif code == cmd | RESPONSE_BIT and tag == self.tag:
+                    response = (status, data)
+
+        if response is None: raise RemoteError("no response")
+        status, data = response
+        if status != 0:
+            raise RemoteError(STATUS_TEXT[status] if status < len(STATUS_TEXT) else str(status))
+        return data
+
+
+    def read_frames(self):
+        waiting = self.uart.in_waiting
+        if waiting > 0:
+            self.buffer += self.uart.read(waiting)
+        else:
+            sleep(0.0005)
+
+        frames = []
+        while len(self.buffer) >= 11:
+            if self.buffer[:2] != FRAME_SYNC:
+                del self.buffer[0]
+                continue
+            size = (self.buffer[4] << 8) | self.buffer[5]
+            if size > MAX_PAYLOAD:
+                del self.buffer[0]
+                continue
+            if len(self.buffer) < size + 10: break
+            body = bytes(self.buffer[2:6 + size])
+            if crc32(body) != int.from_bytes(self.buffer[6 + size:10 + size], "big"):
+                del self.buffer[0]
+                continue
+            frames.append((body[0], body[1], body[4], body[5:]))
+            del self.buffer[:size + 10]
+        return frames
+
+
+    def ping(self):
+        return self.command(CMD_PING)[0]
+
+
+    def peek(self, address, count):
+        data = b''
+        while count > 0:
+            size = min(count, MAX_PAYLOAD - 1)
+            data += self.command(CMD_PEEK, address.to_bytes(2, "big") + size.to_bytes(2, "big"))
+            address += size
+            count -= size
+        return data
+
+
+    def poke(self, address, data):
+        for offset in range(0, len(data), MAX_PAYLOAD - 2):
+            chunk = bytes(data[offset:offset + MAX_PAYLOAD - 2])
+            self.command(CMD_POKE, (address + offset).to_bytes(2, "big") + chunk)
+
+
+    def get_registers(self):
+        return unpack_registers(self.command(CMD_GET_REGS))
+
+
+    def set_registers(self, **values):
+        regs = self.get_registers()
+        regs.update(values)
+        self.command(CMD_SET_REGS, pack_registers(regs))
+
+
+    def step(self):
+        return unpack_registers(self.command(CMD_STEP))
+
+
+    def run(self, cycles=0):
+        self.events = []
+        self.command(CMD_RUN, cycles.to_bytes(4, "big"))
+
+
+    def stop(self):
+        self.command(CMD_STOP)
+
+
+    def wait_for_stop(self, timeout=10000):
+        '''
+        Returns:
+            Tuple: The reason the run ended, the PC and the cycles run.
+                   After a breakpoint or watchpoint stop, `hit` holds its
+                   index and the address hit.
+        '''
+        end = (time_ns() // 1000000) + timeout
+        while len(self.events) == 0:
+            if (time_ns() // 1000000) >= end: raise RemoteError("run did not stop")
+            for code, _, _, data in self.read_frames():
+                if code == EVENT_STOPPED: self.events.append(data)
+        data = self.events.pop(0)
+        self.hit = (data[7], (data[8] << 8) | data[9]) if len(data) >= 10 else None
+        return (data[0], (data[1] << 8) | data[2], int.from_bytes(data[3:7], "big"))
+
+
+    def set_breakpoint(self, address):
+        self.command(CMD_BREAK_SET, address.to_bytes(2, "big"))
+
+
+    def clear_breakpoint(self, address=None):
+        if address is None:
+            self.command(CMD_BREAK_CLEAR_ALL)
+        else:
+            self.command(CMD_BREAK_CLEAR, address.to_bytes(2, "big"))
+
+
+    def add_breakpoint(self, kinds, start, end, action=0, condition=0, register=0, value=0, count=0):
+        '''
+        Set a breakpoint or watchpoint. See source/breakpoint.h for the values.
+
+        Returns:
+            Int: The breakpoint's index.
+        '''
+        payload = bytes([kinds]) + start.to_bytes(2, "big") + end.to_bytes(2, "big")
+        payload += bytes([action, condition, register]) + value.to_bytes(2, "big") + count.to_bytes(4, "big")
+        return self.command(CMD_BREAK_ADD, payload)[0]
+
+
+    def remove_breakpoint(self, index):
+        self.command(CMD_BREAK_REMOVE, bytes([index]))
+
+
+    def get_snapshots(self):
+        '''
+        Returns:
+            List: The breakpoint snapshots, newest first, each a dict of
+                  the breakpoint's index, the kind of hit, the address,
+                  the hit count and the registers.
+        '''
+        data = self.command(CMD_SNAPSHOTS)
+        snapshots = []
+        for offset in range(0, len(data) - SNAPSHOT_SIZE + 1, SNAPSHOT_SIZE):
+            item = data[offset:offset + SNAPSHOT_SIZE]
+            snapshots.append({"index": item[0], "kind": item[1], "address": (item[2] << 8) | item[3],
+                              "hits": int.from_bytes(item[4:8], "big"), "regs": unpack_registers(item[8:])})
+        return snapshots
+
+
+    def status(self):
+        data = self.command(CMD_STATUS)
+        return (data[0] != 0, int.from_bytes(data[1:5], "big"))
+
+
+    def get_profile(self):
+        '''
+        Returns:
+            List: The opcode profile's counters, as laid out in source/profile.h.
+        '''
+        data = b''
+        while True:
+            chunk = self.command(CMD_PROFILE, len(data).to_bytes(4, "big") + (MAX_PAYLOAD - 4).to_bytes(2, "big"))
+            data += chunk
+            if len(chunk) < MAX_PAYLOAD - 4: break
+        return [int.from_bytes(data[i:i + 4], "big") for i in range(0, len(data) - 3, 4)]
+
+
+    def reset_profile(self):
+        self.command(CMD_PROFILE_RESET)
+
+
+    def set_heatmap(self, mode):
+        self.command(CMD_HEATMAP, bytes([HEATMAP_MODES.index(mode)]))
+
+
+    def get_heatmap(self):
+        '''
+        Returns:
+            List: The fetch, read and write counts, each a list by page.
+        '''
+        data = b''
+        while True:
+            chunk = self.command(CMD_HEATMAP_READ, len(data).to_bytes(4, "big") + (MAX_PAYLOAD - 4).to_bytes(2, "big"))
+            data += chunk
+            if len(chunk) < MAX_PAYLOAD - 4: break
+        words = [int.from_bytes(data[i:i + 4], "big") for i in range(0, len(data) - 3, 4)]
+        return [words[k * HEATMAP_PAGES:(k + 1) * HEATMAP_PAGES] for k in range(HEATMAP_KINDS)]
+
+
+    def set_coverage(self, mode):
+        self.command(CMD_COVERAGE, bytes([COVERAGE_MODES.index(mode)]))
+
+
+    def get_coverage(self):
+        '''
+        Returns:
+            Bytes: The coverage maps, as laid out in source/coverage.h.
+        '''
+        data = b''
+        while len(data) < COVERAGE_SIZE:
+            chunk = self.command(CMD_COVERAGE_READ, len(data).to_bytes(4, "big") + (MAX_PAYLOAD - 4).to_bytes(2, "big"))
+            if len(chunk) == 0: break
+            data += chunk
+        return data
+
+
+    def read_samples(self):
+        '''
+        Returns:
+            Tuple: The number of samples dropped so far, and the samples
+                   collected, each a truncation flag and a list of the
+                   return addresses, outermost first, then the PC.
+        '''
+        data = self.command(CMD_SAMPLE_READ)
+        samples = []
+        index = 4
+        while index < len(data):
+            depth = data[index] & ~SAMPLE_TRUNCATED
+            addresses = [(data[i] << 8) | data[i + 1] for i in range(index + 1, index + 3 + 2 * depth, 2)]
+            samples.append((data[index] & SAMPLE_TRUNCATED != 0, addresses))
+            index += 3 + 2 * depth
+        return (int.from_bytes(data[:4], "big"), samples)
+
+
+    def sample_run(self, period, cycles=0, timeout=60000):
+        '''
+        Run with the PC sampled every `period` cycles, collecting samples
+        as the run proceeds so that the board's ring does not fill.
+
+        Returns:
+            Tuple: The wait_for_stop() values, the samples and the number dropped.
+        '''
+        self.command(CMD_SAMPLE_START, period.to_bytes(4, "big"))
+        dropped_before, _ = self.read_samples()
+        samples = []
+        self.run(cycles)
+
+        end = (time_ns() // 1000000) + timeout
+        while len(self.events) == 0:
+            if (time_ns() // 1000000) >= end:
+                self.stop()
+                break
+            _, batch = self.read_samples()
+            samples += batch
+            if len(batch) == 0: sleep(0.01)
+
+        stop = self.wait_for_stop()
+        dropped, batch = self.read_samples()
+        self.command(CMD_SAMPLE_START, (0).to_bytes(4, "big"))
+        return (stop, samples + batch, dropped - dropped_before)
+
+
+    def trace_run(self, cycles=0, timeout=60000):
+        '''
+        Run with every op traced, collecting the encoded records as the
+        run proceeds so that the board's ring does not fill.
+
+        Returns:
+            Tuple: The wait_for_stop() values, the encoded records and
+                   the number dropped.
+        '''
+        dropped_before = int.from_bytes(self.command(CMD_TRACE_READ)[:4], "big")
+        self.command(CMD_TRACE, bytes([1]))
+        data = b''
+        self.run(cycles)
+
+        end = (time_ns() // 1000000) + timeout
+        while len(self.events) == 0:
+            if (time_ns() // 1000000) >= end:
+                self.stop()
+                break
+            chunk = self.command(CMD_TRACE_READ)[4:]
+            data += chunk
+            if len(chunk) == 0: sleep(0.01)
+
+        stop = self.wait_for_stop()
+        self.command(CMD_TRACE, bytes([0]))
+        while True:
+            chunk = self.command(CMD_TRACE_READ)
+            data += chunk[4:]
+            if len(chunk) == 4: break
+        return (stop, data, int.from_bytes(chunk[:4], "big") - dropped_before)
+
+
+'''
+FUNCTIONS
+'''
+
+'''
+Convert register bytes, as sent by the device, to a dict.
+
+Args:
+    data (Bytes): The 14 register bytes.
+
+Returns:
+    Dict: The register values, keyed by name.
+'''
+def unpack_registers(data):
+    return {"a": data[0], "b": data[1],
+            "x": (data[2] << 8) | data[3], "y": (data[4] << 8) | data[5],
+            "u": (data[6] << 8) | data[7], "s": (data[8] << 8) | data[9],
+            "pc": (data[10] << 8) | data[11], "cc": data[12], "dp": data[13]}
+
+
+'''
+Convert a register dict to the bytes the device expects.
+
+Args:
+    regs (Dict): The register values, keyed by name.
+
+Returns:
+    Bytes: The 14 register bytes.
+'''
+def pack_registers(regs):
+    out = bytes([regs["a"], regs["b"]])
+    for name in ("x", "y", "u", "s", "pc"):
+        out += regs[name].to_bytes(2, "big")
+    return out + bytes([regs["cc"], regs["dp"]])
+
+
+'''
+Get an op's addressing mode, as source/profile.c does.
+
+Args:
+    opcode (Int): The opcode, less any prefix.
+
+Returns:
+    Int: The mode's index in PROFILE_MODES.
+'''
+def op_mode(opcode):
+    msn = opcode >> 4
+    if msn == 0x02 or opcode in (0x8D, 0x16, 0x17): return 6
+    if 0x30 <= opcode <= 0x33: return 3
+    if 0x34 <= opcode <= 0x37 or opcode in (0x3C, 0x1A, 0x1C, 0x1E, 0x1F): return 1
+    return {0x08: 1, 0x0C: 1, 0x00: 2, 0x09: 2, 0x0D: 2, 0x06: 3, 0x0A: 3, 0x0E: 3,
+            0x07: 4, 0x0B: 4, 0x0F: 4}.get(msn, 5)
+
+
+'''
+Format an opcode profile as source/profile.c does: ops by cycles used,
+then totals by addressing mode and by indexed form, then the histogram
+of cycles per instruction.
+
+Args:
+    words (List): The profile's counters, as sent by the device.
+
+Returns:
+    str: The report.
+'''
+def format_profile(words):
+    size = PROFILE_PAGES * 256
+    instructions, cycles = words[:size], words[size:2 * size]
+    forms = 2 * size
+    form_counts, form_cycles = words[forms:forms + PROFILE_FORMS], words[forms + PROFILE_FORMS:forms + 2 * PROFILE_FORMS]
+    histogram = words[forms + 2 * PROFILE_FORMS:forms + 2 * PROFILE_FORMS + PROFILE_HISTOGRAM_SIZE]
+    modes = forms + 2 * PROFILE_FORMS + PROFILE_HISTOGRAM_SIZE
+    mode_counts, mode_cycles = words[modes:modes + len(PROFILE_MODES)], words[modes + len(PROFILE_MODES):]
+    total = sum(mode_cycles)
+
+    def line(label, count, used):
+        return "{} {:10d} {:13d} {:7.2f} {:8.2f}".format(label, count, used, used / count, 100 * used / total if total > 0 else 0)
+
+    lines = ["{} instructions, {} cycles".format(sum(mode_counts), total), "",
+             "Opcode  Mode           Count        Cycles  Cyc/op  Cycles%"]
+    ops = sorted((i for i in range(size) if instructions[i] > 0), key=lambda i: (-cycles[i], i))
+    for i in ops:
+        label = "{}{:02X}   {:9s}".format(PROFILE_PREFIXES[i >> 8], i & 0xFF, PROFILE_MODES[op_mode(i & 0xFF)])
+        lines.append(line(label, instructions[i], cycles[i]))
+
+    lines += ["", "Mode                   Count        Cycles  Cyc/op  Cycles%"]
+    for i in range(1, len(PROFILE_MODES)):
+        if mode_counts[i] > 0: lines.append(line(PROFILE_MODES[i].ljust(17), mode_counts[i], mode_cycles[i]))
+
+    lines += ["", "Indexed form           Count        Cycles  Cyc/op  Cycles%"]
+    for i in range(PROFILE_FORMS):
+        if form_counts[i] > 0: lines.append(line(PROFILE_FORM_NAMES[i].ljust(17), form_counts[i], form_cycles[i]))
+
+    lines += ["", "Cycles         Count"]
+    for i in range(PROFILE_HISTOGRAM_SIZE):
+        if histogram[i] > 0:
+            lines.append("{:6d}{} {:12d}".format(i, "+" if i == PROFILE_HISTOGRAM_SIZE - 1 else " ", histogram[i]))
+    return "\n".join(lines) + "\n"
+
+
+'''
+Read breakpoint settings from the command line:
+<start> [<end>] [exec|read|write|access] [if <reg> <op> <value>] [count <n>] [stop|log|snapshot]
+
+Args:
+    words (List): The settings' words.
+
+Returns:
+    Tuple: The add_breakpoint() arguments, or None if the settings are bad.
+'''
+def parse_breakpoint(words):
+    try:
+        start = str_to_int(words[0])
+        end, kinds, action, condition, register, value, count = start, BREAK_KINDS["exec"], 0, 0, 0, 0, 0
+        i = 1
+        if i < len(words) and words[i][0] in "$0123456789":
+            end = str_to_int(words[i])
+            i += 1
+        while i < len(words):
+            word = words[i].lower()
+            if word in BREAK_KINDS:
+                kinds = BREAK_KINDS[word]
+            elif word in BREAK_ACTIONS:
+                action = BREAK_ACTIONS.index(word)
+            elif word == "if":
+                register = BREAK_REGISTERS.index(words[i + 1].lower())
+                condition = BREAK_CONDITIONS.index(words[i + 2])
+                value = str_to_int(words[i + 3])
+                i += 3
+            elif word == "count":
+                count = str_to_int(words[i + 1])
+                i += 1
+            else:
+                return None
+            i += 1
+        return (kinds, start, end, action, condition, register, value, count)
+    except (ValueError, IndexError):
+        return None
+
+
+'''
+Convert a number string -- decimal, or hex with a $ or 0x prefix.
+
+Args:
+    num_str (str): The number.
+
+Returns:
+    int: The numerical value
+'''
+def str_to_int(num_str):
+    num_base = 10
+    if num_str[0] == "$": num_str = "0x" + num_str[1:]
+    if num_str[:2] == "0x": num_base = 16
+    return int(num_str, num_base)
+
+
+'''
+Format page counts as CSV, as source/heatmap.c does: a line per page
+that was accessed.
+
+Args:
+    pages (List): The fetch, read and write counts, each by page.
+
+Returns:
+    str: The CSV text.
+'''
+def format_heatmap_csv(pages):
+    lines = ["page,fetches,reads,writes"]
+    for page in range(HEATMAP_PAGES):
+        counts = [pages[k][page] for k in range(HEATMAP_KINDS)]
+        if any(counts): lines.append("0x{:02X},{},{},{}".format(page, *counts))
+    return "\n".join(lines) + "\n"
+
+
+'''
+Draw page counts as a 256x256 PPM image, as source/heatmap.c does: a
+row per page, writes red, reads green and fetches blue, each scaled
+logarithmically to its busiest page.
+
+Args:
+    pages (List): The fetch, read and write counts, each by page.
+
+Returns:
+    Bytes: The image file's contents.
+'''
+def format_heatmap_ppm(pages):
+    levels = [[heat_level(count) for count in pages[k]] for k in range(HEATMAP_KINDS)]
+    tops = [max(levels[k]) for k in range(HEATMAP_KINDS)]
+    image = bytearray(b"P6\n256 256\n255\n")
+    for page in range(HEATMAP_PAGES):
+        pixel = bytes(levels[k][page] * 255 // tops[k] if tops[k] > 0 else 0 for k in reversed(range(HEATMAP_KINDS)))
+        image += pixel * 256
+    return bytes(image)
+
+
+'''
+Scale a count logarithmically, as source/heatmap.c does: log2(count + 1)
+in sixteenths.
+
+Args:
+    count (Int): The count.
+
+Returns:
+    Int: The scaled value.
+'''
+def heat_level(count):
+    value = count + 1
+    bits = value.bit_length() - 1
+    fraction = (value >> (bits - 4)) & 0x0F if bits >= 4 else (value << (4 - bits)) & 0x0F
+    return (bits << 4) | fraction
+
+
+'''
+Show the utility help
+'''
+def show_help():
+    print("Remote 1.0.0 copyright (c) 2025 Tony Smith (@smittytone)")
+    print("\nControl the 6809e Monitor Board over USB.\n")
+    print("Usage:\n\n  remote.py -d <device> <command> [<args>]\n")
+    print("Commands:\n")
+    print("  regs                       Show the registers.")
+    print("  set <reg> <value>          Set a register.")
+    print("  peek <address> <count>     Show memory.")
+    print("  poke <address> <byte> ...  Write memory.")
+    print("  step                       Run one instruction.")
+    print("  run [<cycles>]             Run, until a breakpoint or RTI if no cycle count is given.")
+    print("  stop                       Stop a run.")
+    print("  break <address>            Set a breakpoint.")
+    print("  break <address> [<end>] [exec|read|write|access] [if <reg> ==|!=|<|>=|& <value>]")
+    print("        [count <n>] [stop|log|snapshot]")
+    print("                             Set a breakpoint, or a watchpoint on an address range, and show its index.")
+    print("  clear [<address>]          Clear a breakpoint, or all breakpoints and watchpoints.")
+    print("  remove <index>             Clear a breakpoint or watchpoint by its index.")
+    print("  snapshots                  Show the registers kept by 'snapshot' breakpoints, newest first.")
+    print("  profile [<file>]           Show or save the opcode profile. Needs an E6809_PROFILE build.")
+    print("  profile reset              Zero the opcode profile.")
+    print("  sample <period> <file> [<cycles>]")
+    print("                             Run, saving PC samples taken every <period> cycles for flame.py.")
+    print("                             Needs an E6809_SAMPLE build.")
+    print("  heatmap on|off|reset       Count memory fetches, reads and writes by page, or stop, or zero the counts.")
+    print("  heatmap <file>             Save the page counts as CSV, or as an image if <file> ends '.ppm'.")
+    print("  trace <file> [<cycles>]    Run, saving a trace of every op for trace.py. Needs an E6809_TRACE build.")
+    print("  coverage on|off|reset      Record the bytes executed and the branches taken and not taken, or stop, or clear them.")
+    print("  coverage <file>            Save the coverage maps for coverage.py.")
+    print()
+
+
+'''
+RUNTIME START
+'''
+if __name__ == '__main__':
+
+    if len(argv) < 4 or argv[1] not in ("-d", "--device"):
+        show_help()
+        exit(0 if len(argv) > 1 and argv[1] in ("-h", "--help") else 1)
+
+    try:
+        import serial
+        port = serial.Serial(port=argv[2], baudrate=115200)
+    except:
+        print("[ERROR] An invalid e6809 device file was specified:", argv[2])
+        exit(1)
+
+    board = Remote(port)
+    action = argv[3]
+    args = [] if action in ("profile", "sample", "heatmap", "trace", "break", "coverage") else [str_to_int(a) for a in argv[5 if action == "set" else 4:]]
+
+    try:
+        if action == "regs":
+            regs = board.get_registers()
+            print(" ".join("{}={:X}".format(name.upper(), regs[name]) for name in REGISTERS))
+        elif action == "set" and len(argv) == 6 and argv[4].lower() in REGISTERS:
+            board.set_registers(**{argv[4].lower(): args[0]})
+        elif action == "peek" and len(args) == 2:
+            data = board.peek(args[0], args[1])
+            for offset in range(0, len(data), 16):
+                print("{:04X}  {}".format(args[0] + offset, data[offset:offset + 16].hex(" ").upper()))
+        elif action == "poke" and len(args) > 1:
+            board.poke(args[0], bytes(args[1:]))
+        elif action == "step":
+            regs = board.step()
+            print(" ".join("{}={:X}".format(name.upper(), regs[name]) for name in REGISTERS))
+        elif action == "run":
+            board.run(args[0] if len(args) > 0 else 0)
+            reason, pc, cycles = board.wait_for_stop(60000)
+            print("Stopped at 0x{:04X} after {} cycles: {}".format(pc, cycles, STOP_TEXT[reason]))
+            if board.hit is not None: print("Breakpoint {} hit at 0x{:04X}".format(*board.hit))
+        elif action == "stop":
+            board.stop()
+        elif action == "break" and len(argv) == 5:
+            board.set_breakpoint(str_to_int(argv[4]))
+        elif action == "break" and len(argv) > 5 and parse_breakpoint(argv[4:]) is not None:
+            print("Breakpoint", board.add_breakpoint(*parse_breakpoint(argv[4:])))
+        elif action == "remove" and len(args) == 1:
+            board.remove_breakpoint(args[0])
+        elif action == "snapshots":
+            kinds = {v: k for k, v in BREAK_KINDS.items()}
+            for snapshot in board.get_snapshots():
+                regs = snapshot["regs"]
+                print("#{} {} 0x{:04X} hit {}: {}".format(snapshot["index"], kinds[snapshot["kind"]], snapshot["address"], snapshot["hits"],
+                      " ".join("{}={:X}".format(name.upper(), regs[name]) for name in REGISTERS)))
+        elif action == "clear":
+            board.clear_breakpoint(args[0] if len(args) > 0 else None)
+        elif action == "profile" and len(argv) == 5 and argv[4] == "reset":
+            board.reset_profile()
+        elif action == "profile" and len(argv) < 6:
+            report = format_profile(board.get_profile())
+            if len(argv) == 5:
+                with open(argv[4], "w") as file: file.write(report)
+            else:
+                print(report, end="")
+        elif action == "heatmap" and len(argv) == 5 and argv[4] in HEATMAP_MODES:
+            board.set_heatmap(argv[4])
+        elif action == "heatmap" and len(argv) == 5:
+            pages = board.get_heatmap()
+            if argv[4].endswith(".ppm"):
+                with open(argv[4], "wb") as file: file.write(format_heatmap_ppm(pages))
+            else:
+                with open(argv[4], "w") as file: file.write(format_heatmap_csv(pages))
+        elif action == "coverage" and len(argv) == 5 and argv[4] in COVERAGE_MODES:
+            board.set_coverage(argv[4])
+        elif action == "coverage" and len(argv) == 5:
+            with open(argv[4], "wb") as file: file.write(COVERAGE_FILE_MAGIC + board.get_coverage())
+        elif action == "sample" and len(argv) in (6, 7):
+            period = str_to_int(argv[4])
+            (reason, pc, cycles), samples, dropped = board.sample_run(period, str_to_int(argv[6]) if len(argv) == 7 else 0)
+            with open(argv[5], "w") as file:
+                file.write("# e6809 PC samples every {} cycles: return addresses, outermost first, then PC\n".format(period))
+                for truncated, addresses in samples:
+                    file.write(("... " if truncated else "") + " ".join("{:04X}".format(a) for a in addresses) + "\n")
+            print("Stopped at 0x{:04X} after {} cycles: {}".format(pc, cycles, STOP_TEXT[reason]))
+            print("{} sample(s) saved, {} dropped".format(len(samples), dropped))
+        elif action == "trace" and len(argv) in (5, 6):
+            (reason, pc, cycles), data, dropped = board.trace_run(str_to_int(argv[5]) if len(argv) == 6 else 0)
+            with open(argv[4], "wb") as file: file.write(TRACE_FILE_MAGIC + data)
+            print("Stopped at 0x{:04X} after {} cycles: {}".format(pc, cycles, STOP_TEXT[reason]))
+            print("{} byte(s) of trace saved, {} record(s) dropped".format(len(data), dropped))
+        else:
+            show_help()
+            exit(1)
+    except RemoteError as err:
+        print("[ERROR]", err)
+        exit(1)
+    finally:
+        port.close()
@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+
+'''
+Trace -- decode e6809 instruction traces
+
+Version:
+    1.0.0
+
+Copyright:
+    2025, Tony Smith (@smittytone)
+
+License:
+    MIT (terms attached to this repo)
+'''
+
+'''
+IMPORTS
+'''
+from sys import exit, argv, stdout
+
+
+'''
+GLOBALS
+'''
+# Trace files, as written by e6809_d32 -t and remote.py trace, hold
+# this, then delta-encoded records -- see source/trace.h
+FILE_MAGIC = b"e6809tr1"
+
+HEADER_PC = 0x80
+HEADER_BYTES = 0x40
+HEADER_ADDRESS = 0x20
+HEADER_REGS = 0x10
+HEADER_NEXT_PC = 0x08
+HEADER_CYCLES = 0x07
+BYTE_CACHE_SIZE = 256
+
+# Register mask bits, in encoding order, and their widths in bytes
+REGISTERS = (("cc", 1), ("a", 1), ("b", 1), ("dp", 1), ("x", 2), ("y", 2), ("u", 2), ("s", 2))
+
+
+'''
+FUNCTIONS
+'''
+
+'''
+Decode a trace.
+
+Args:
+    data (Bytes): The encoded records, without the file magic.
+
+Returns:
+    List: The records, each a dict of 'pc', 'next_pc', 'bytes',
+          'address' (or None), 'cycles' and the registers after the op.
+          A None entry marks a gap, where records were lost.
+'''
+def decode_trace(data):
+    records = []
+    cache = {}
+    last = None
+    index = 0
+
+    while index < len(data):
+        header = data[index]
+        index += 1
+        cycles = header & HEADER_CYCLES
+        if cycles == HEADER_CYCLES:
+            cycles = data[index]
+            index += 1
+
+            # A gap: start again from a whole record
+            if cycles == 0:
+                records.append(None)
+                cache = {}
+                last = None
+                continue
+
+        record = dict(last) if last is not None else {}
+        record["cycles"] = cycles
+
+        if header & HEADER_PC:
+            record["pc"] = (data[index] << 8) | data[index + 1]
+            index += 2
+        elif last is not None:
+            record["pc"] = last["next_pc"]
+        else:
+            raise ValueError("record without a PC")
+
+        if header & HEADER_BYTES:
+            length = data[index]
+            record["bytes"] = bytes(data[index + 1:index + 1 + length])
+            index += 1 + length
+            cache[record["pc"] & (BYTE_CACHE_SIZE - 1)] = record["bytes"]
+        else:
+            record["bytes"] = cache[record["pc"] & (BYTE_CACHE_SIZE - 1)]
+
+        record["address"] = None
+        if header & HEADER_ADDRESS:
+            record["address"] = (data[index] << 8) | data[index + 1]
+            index += 2
+
+        if header & HEADER_REGS:
+            mask = data[index]
+            index += 1
+            for bit, (name, width) in enumerate(REGISTERS):
+                if mask & (1 << bit):
+                    record[name] = int.from_bytes(data[index:index + width], "big")
+                    index += width
+
+        record["next_pc"] = (record["pc"] + len(record["bytes"])) & 0xFFFF
+        if header & HEADER_NEXT_PC:
+            record["next_pc"] = (data[index] << 8) | data[index + 1]
+            index += 2
+
+        if index > len(data): raise ValueError("trace is truncated")
+        records.append(record)
+        last = record
+
+    return records
+
+
+'''
+Format a record as a line of text: its address, bytes and effective
+address, the registers after it and the cycles it took. An interrupt
+entry has no bytes.
+
+Args:
+    record (Dict): The record, from decode_trace().
+
+Returns:
+    str: The line.
+'''
+def format_record(record):
+    if record is None: return "-- records lost --"
+    op = record["bytes"].hex(" ").upper() if len(record["bytes"]) > 0 else "interrupt"
+    address = "{:04X}".format(record["address"]) if record["address"] is not None else "    "
+    return "{:04X}  {:<15} {}  A={:02X} B={:02X} X={:04X} Y={:04X} U={:04X} S={:04X} DP={:02X} CC={:02X}  {:>3}".format(
+        record["pc"], op, address, record["a"], record["b"], record["x"], record["y"],
+        record["u"], record["s"], record["dp"], record["cc"], record["cycles"])
+
+
+'''
+Show the utility help
+'''
+def show_help():
+    print("Trace 1.0.0 copyright (c) 2025 Tony Smith (@smittytone)")
+    print("\nDecode an e6809 instruction trace.\n")
+    print("Usage:\n\n  trace.py [-o <output file>] [-n <count>] <trace file>\n")
+    print("Options:\n")
+    print("  -o / --output   Write the decoded trace to a file rather than stdout.")
+    print("  -n / --count    Decode only the last <count> records.")
+    print("  -h / --help     This help page.")
+    print("\nEach line gives the op's address, bytes and effective address, the")
+    print("registers after it and the cycles it took.\n")
+
+
+'''
+RUNTIME START
+'''
+if __name__ == '__main__':
+
+    trace_file = None
+    out_file = None
+    count = 0
+
+    index = 1
+    while index < len(argv):
+        item = argv[index]
+        if item in ("-h", "--help"):
+            show_help()
+            exit(0)
+        elif item in ("-o", "--output", "-n", "--count"):
+            if index + 1 >= len(argv):
+                print("[ERROR]", item, "is missing a value")
+                exit(1)
+            if item in ("-o", "--output"):
+                out_file = argv[index + 1]
+            else:
+                count = int(argv[index + 1])
+            index += 2
+        else:
+            trace_file = item
+            index += 1
+
+    if trace_file is None:
+        show_help()
+        exit(1)
+
+    try:
+        with open(trace_file, "rb") as file: data = file.read()
+    except OSError:
+        print("[ERROR] Cannot read", trace_file)
+        exit(1)
+
+    if not data.startswith(FILE_MAGIC):
+        print("[ERROR]", trace_file, "is not an e6809 trace")
+        exit(1)
+
+    try:
+        records = decode_trace(data[len(FILE_MAGIC):])
+    except (ValueError, IndexError, KeyError):
+        print("[ERROR]", trace_file, "is malformed")
+        exit(1)
+
+    output = open(out_file, "w") if out_file is not None else stdout
+    for record in records[-count if count > 0 else 0:]: output.write(format_record(record) + "\n")
+    if out_file is not None: output.close()
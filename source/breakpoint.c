@@ -0,0 +1,370 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Breakpoints and watchpoints: execute breakpoints are checked before
+ * each op, watchpoints after it, and only by breakpoint_step(). Callers
+ * run process_next_instruction() instead while none are armed
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+// App
+#include "breakpoint.h"
+#include "cpu.h"
+#include "log.h"
+
+
+/*
+ * STATICS
+ */
+static bool     check_hit(uint8_t index, uint8_t kind, uint16_t address);
+static bool     is_condition_met(const BREAKPOINT* breakpoint);
+static uint16_t get_register(uint8_t reg_index);
+static void     take_snapshot(uint8_t index, uint8_t kind, uint16_t address);
+static void     mark(const BREAKPOINT* breakpoint);
+static void     rebuild(void);
+
+
+/*
+ * GLOBALS
+ */
+BREAKPOINTS breakpoints;
+
+extern REG_6809         reg;
+extern MEMORY_MAP_6809  memory_map;
+
+
+/**
+ * @brief Add a breakpoint. Execute breakpoints use only `start`; data
+ *        watchpoints cover `start` to `end`. The breakpoint's hit count
+ *        starts at zero.
+ *
+ * @param breakpoint: The breakpoint's settings.
+ *
+ * @retval The breakpoint's index, or BREAKPOINT_NONE if the settings
+ *         are bad or all BREAKPOINT_MAX are in use.
+ */
+uint8_t breakpoint_set(const BREAKPOINT* breakpoint) {
+
+    uint8_t kinds = breakpoint->kinds;
+    if (kinds == 0 || (kinds & ~(BREAKPOINT_EXECUTE | BREAKPOINT_READ | BREAKPOINT_WRITE)) != 0) return BREAKPOINT_NONE;
+    if (breakpoint->end < breakpoint->start && (kinds & (BREAKPOINT_READ | BREAKPOINT_WRITE))) return BREAKPOINT_NONE;
+    if (breakpoint->action > BREAKPOINT_ACTION_SNAPSHOT || breakpoint->condition > BREAKPOINT_IF_ANY_BITS) return BREAKPOINT_NONE;
+    if (breakpoint->reg_index > BREAKPOINT_REG_DP) return BREAKPOINT_NONE;
+
+    for (uint8_t i = 0 ; i < BREAKPOINT_MAX ; ++i) {
+        BREAKPOINT* entry = &breakpoints.entries[i];
+        if (!entry->is_set) {
+            *entry = *breakpoint;
+            if (!(kinds & (BREAKPOINT_READ | BREAKPOINT_WRITE))) entry->end = entry->start;
+            entry->hits = 0;
+            entry->is_set = true;
+            breakpoints.count++;
+            mark(entry);
+            return i;
+        }
+    }
+
+    return BREAKPOINT_NONE;
+}
+
+
+/**
+ * @brief Find a breakpoint.
+ *
+ * @param start: Its address, or the start of its range.
+ * @param kinds: Its BREAKPOINT_EXECUTE, _READ and _WRITE bits.
+ *
+ * @retval The breakpoint's index, or BREAKPOINT_NONE.
+ */
+uint8_t breakpoint_find(uint16_t start, uint8_t kinds) {
+
+    for (uint8_t i = 0 ; i < BREAKPOINT_MAX ; ++i) {
+        BREAKPOINT* entry = &breakpoints.entries[i];
+        if (entry->is_set && entry->start == start && entry->kinds == kinds) return i;
+    }
+
+    return BREAKPOINT_NONE;
+}
+
+
+/**
+ * @brief Remove a breakpoint.
+ *
+ * @param index: The breakpoint's index.
+ *
+ * @retval Whether a breakpoint was set there.
+ */
+bool breakpoint_clear(uint8_t index) {
+
+    if (index >= BREAKPOINT_MAX || !breakpoints.entries[index].is_set) return false;
+    breakpoints.entries[index].is_set = false;
+    breakpoints.count--;
+
+    // Ranges may overlap, so redraw the bitmaps from those left
+    rebuild();
+    return true;
+}
+
+
+/**
+ * @brief Remove every breakpoint and watchpoint.
+ */
+void breakpoint_clear_all(void) {
+
+    for (uint8_t i = 0 ; i < BREAKPOINT_MAX ; ++i) breakpoints.entries[i].is_set = false;
+    breakpoints.count = 0;
+    rebuild();
+}
+
+
+/**
+ * @brief Check whether any breakpoints are set. Callers run ops with
+ *        breakpoint_step() if so, otherwise with process_next_instruction().
+ *
+ * @retval `true` if a breakpoint or watchpoint is set, otherwise `false`.
+ */
+bool breakpoint_is_armed(void) {
+
+    return breakpoints.count > 0;
+}
+
+
+/**
+ * @brief Don't check execute breakpoints before the next op, so a run
+ *        can continue from the one that stopped it.
+ */
+void breakpoint_resume(void) {
+
+    breakpoints.is_resuming = true;
+}
+
+
+/**
+ * @brief Run the next op, checking breakpoints. An execute breakpoint
+ *        that stops the CPU does so before its op runs; a watchpoint
+ *        after the op that made the access, whose cycles are then in
+ *        `breakpoints.hit_cycles`.
+ *
+ * @retval The op's cycle count, BREAK_TO_MONITOR, or BREAKPOINT_HIT.
+ */
+uint32_t breakpoint_step(void) {
+
+    uint16_t pc = reg.pc;
+    if (breakpoints.is_resuming) {
+        breakpoints.is_resuming = false;
+    } else if (breakpoints.execute[pc >> 3] & (1 << (pc & 0x07))) {
+        for (uint8_t i = 0 ; i < BREAKPOINT_MAX ; ++i) {
+            BREAKPOINT* entry = &breakpoints.entries[i];
+            if (entry->is_set && (entry->kinds & BREAKPOINT_EXECUTE) && entry->start == pc && check_hit(i, BREAKPOINT_EXECUTE, pc)) {
+                breakpoints.hit_cycles = 0;
+                return BREAKPOINT_HIT;
+            }
+        }
+    }
+
+    WATCH_MAP* watch = &breakpoints.watch;
+    watch->hit_count = 0;
+    uint32_t cycles = process_next_instruction();
+    if (watch->hit_count == 0 || cycles == BREAK_TO_MONITOR) return cycles;
+
+    bool is_stopped = false;
+    for (uint8_t kind = WATCH_READ ; kind < WATCH_KINDS ; ++kind) {
+        uint8_t breakpoint_kind = kind == WATCH_READ ? BREAKPOINT_READ : BREAKPOINT_WRITE;
+        for (uint8_t i = 0 ; i < BREAKPOINT_MAX ; ++i) {
+            BREAKPOINT* entry = &breakpoints.entries[i];
+            if (!entry->is_set || !(entry->kinds & breakpoint_kind)) continue;
+
+            // A watchpoint scores one hit per op and kind, at the op's
+            // first access to its range. Every hit is counted, even
+            // after one stops the CPU
+            for (uint8_t j = 0 ; j < watch->hit_count ; ++j) {
+                uint16_t address = watch->hit_addresses[j];
+                if (watch->hit_kinds[j] == kind && address >= entry->start && address <= entry->end) {
+                    if (check_hit(i, breakpoint_kind, address)) is_stopped = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (!is_stopped) return cycles;
+    breakpoints.hit_cycles = cycles;
+    return BREAKPOINT_HIT;
+}
+
+
+/**
+ * @brief Copy the snapshots taken by BREAKPOINT_ACTION_SNAPSHOT hits,
+ *        newest first. Only the last BREAKPOINT_SNAPSHOTS are kept.
+ *
+ * @param snapshots: Receives the snapshots.
+ * @param count:     The most to copy.
+ *
+ * @retval The number copied.
+ */
+uint8_t breakpoint_snapshots(BREAKPOINT_SNAPSHOT* snapshots, uint8_t count) {
+
+    uint32_t taken = breakpoints.snapshots_taken;
+    if (taken > BREAKPOINT_SNAPSHOTS) taken = BREAKPOINT_SNAPSHOTS;
+    if (count > taken) count = (uint8_t)taken;
+
+    for (uint8_t i = 0 ; i < count ; ++i) {
+        snapshots[i] = breakpoints.snapshots[(breakpoints.snapshots_taken - 1 - i) % BREAKPOINT_SNAPSHOTS];
+    }
+
+    return count;
+}
+
+
+/**
+ * @brief Count a hit, if the breakpoint's condition holds, and act on
+ *        it once the count is reached.
+ *
+ * @param index:   The breakpoint's index.
+ * @param kind:    The BREAKPOINT_EXECUTE, _READ or _WRITE access.
+ * @param address: The op's address, or the data address accessed.
+ *
+ * @retval Whether the breakpoint stops the CPU.
+ */
+static bool check_hit(uint8_t index, uint8_t kind, uint16_t address) {
+
+    BREAKPOINT* breakpoint = &breakpoints.entries[index];
+    if (!is_condition_met(breakpoint)) return false;
+    if (++breakpoint->hits < breakpoint->count) return false;
+
+    switch (breakpoint->action) {
+        case BREAKPOINT_ACTION_LOG:
+            LOG_INFO("Breakpoint %u: 0x%04X, hit %u", index, address, breakpoint->hits);
+            return false;
+
+        case BREAKPOINT_ACTION_SNAPSHOT:
+            take_snapshot(index, kind, address);
+            return false;
+
+        default:
+            breakpoints.hit_index = index;
+            breakpoints.hit_kind = kind;
+            breakpoints.hit_address = address;
+            return true;
+    }
+}
+
+
+/**
+ * @brief Test a breakpoint's condition against the registers.
+ *
+ * @param breakpoint: Pointer to the breakpoint.
+ *
+ * @retval Whether the condition holds.
+ */
+static bool is_condition_met(const BREAKPOINT* breakpoint) {
+
+    if (breakpoint->condition == BREAKPOINT_IF_ALWAYS) return true;
+
+    uint16_t value = get_register(breakpoint->reg_index);
+    switch (breakpoint->condition) {
+        case BREAKPOINT_IF_EQUAL:
+            return value == breakpoint->value;
+        case BREAKPOINT_IF_NOT_EQUAL:
+            return value != breakpoint->value;
+        case BREAKPOINT_IF_LESS:
+            return value < breakpoint->value;
+        case BREAKPOINT_IF_NOT_LESS:
+            return value >= breakpoint->value;
+        default:
+            return (value & breakpoint->value) != 0;
+    }
+}
+
+
+/**
+ * @brief Read a register by its BREAKPOINT_REG_* index.
+ *
+ * @param reg_index: The register's index.
+ *
+ * @retval The register's value.
+ */
+static uint16_t get_register(uint8_t reg_index) {
+
+    switch (reg_index) {
+        case BREAKPOINT_REG_A:
+            return reg.a;
+        case BREAKPOINT_REG_B:
+            return reg.b;
+        case BREAKPOINT_REG_D:
+            return (reg.a << 8) | reg.b;
+        case BREAKPOINT_REG_X:
+            return reg.x;
+        case BREAKPOINT_REG_Y:
+            return reg.y;
+        case BREAKPOINT_REG_U:
+            return reg.u;
+        case BREAKPOINT_REG_S:
+            return reg.s;
+        case BREAKPOINT_REG_PC:
+            return reg.pc;
+        case BREAKPOINT_REG_CC:
+            return reg.cc;
+        default:
+            return reg.dp;
+    }
+}
+
+
+/**
+ * @brief Keep the registers at a hit, overwriting the oldest snapshot
+ *        once the ring is full.
+ */
+static void take_snapshot(uint8_t index, uint8_t kind, uint16_t address) {
+
+    BREAKPOINT_SNAPSHOT* snapshot = &breakpoints.snapshots[breakpoints.snapshots_taken % BREAKPOINT_SNAPSHOTS];
+    snapshot->regs = reg;
+    snapshot->hits = breakpoints.entries[index].hits;
+    snapshot->address = address;
+    snapshot->index = index;
+    snapshot->kind = kind;
+    breakpoints.snapshots_taken++;
+}
+
+
+/**
+ * @brief Set a breakpoint's bits in the bitmaps, and hand the CPU the
+ *        watch bitmap if it now has any data watchpoints.
+ */
+static void mark(const BREAKPOINT* breakpoint) {
+
+    for (uint32_t address = breakpoint->start ; address <= breakpoint->end ; ++address) {
+        uint8_t bit = 1 << (address & 0x07);
+        if (breakpoint->kinds & BREAKPOINT_EXECUTE) breakpoints.execute[address >> 3] |= bit;
+        if (breakpoint->kinds & BREAKPOINT_READ) breakpoints.watch.bits[WATCH_READ][address >> 3] |= bit;
+        if (breakpoint->kinds & BREAKPOINT_WRITE) breakpoints.watch.bits[WATCH_WRITE][address >> 3] |= bit;
+    }
+
+    if ((breakpoint->kinds & (BREAKPOINT_READ | BREAKPOINT_WRITE)) && memory_map.watch == NULL) {
+        memory_map.watch = &breakpoints.watch;
+        update_observers();
+    }
+}
+
+
+/**
+ * @brief Redraw the bitmaps from the breakpoints still set. The CPU
+ *        stops checking reads and writes if no watchpoints are left.
+ */
+static void rebuild(void) {
+
+    memset(breakpoints.execute, 0, sizeof(breakpoints.execute));
+    memset(breakpoints.watch.bits, 0, sizeof(breakpoints.watch.bits));
+    memory_map.watch = NULL;
+    update_observers();
+
+    for (uint8_t i = 0 ; i < BREAKPOINT_MAX ; ++i) {
+        if (breakpoints.entries[i].is_set) mark(&breakpoints.entries[i]);
+    }
+}
@@ -0,0 +1,125 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Breakpoints and watchpoints
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _BREAKPOINT_HEADER_
+#define _BREAKPOINT_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "cpu.h"
+
+
+/*
+ *      CONSTANTS
+ */
+#define BREAKPOINT_MAX              16
+#define BREAKPOINT_NONE             0xFF
+
+// What a breakpoint watches: the op at an address, or data reads or
+// writes anywhere in a range of addresses
+#define BREAKPOINT_EXECUTE          0x01
+#define BREAKPOINT_READ             0x02
+#define BREAKPOINT_WRITE            0x04
+
+// What a hit does
+#define BREAKPOINT_ACTION_STOP      0x00
+#define BREAKPOINT_ACTION_LOG       0x01
+#define BREAKPOINT_ACTION_SNAPSHOT  0x02        // Keep the registers; see breakpoint_snapshots()
+
+// Conditions on a register's value. An execute breakpoint sees the
+// registers before the op, a watchpoint those after it
+#define BREAKPOINT_IF_ALWAYS        0x00
+#define BREAKPOINT_IF_EQUAL         0x01
+#define BREAKPOINT_IF_NOT_EQUAL     0x02
+#define BREAKPOINT_IF_LESS          0x03
+#define BREAKPOINT_IF_NOT_LESS      0x04
+#define BREAKPOINT_IF_ANY_BITS      0x05        // Any of the value's bits are set in the register
+
+#define BREAKPOINT_REG_A            0x00
+#define BREAKPOINT_REG_B            0x01
+#define BREAKPOINT_REG_D            0x02
+#define BREAKPOINT_REG_X            0x03
+#define BREAKPOINT_REG_Y            0x04
+#define BREAKPOINT_REG_U            0x05
+#define BREAKPOINT_REG_S            0x06
+#define BREAKPOINT_REG_PC           0x07
+#define BREAKPOINT_REG_CC           0x08
+#define BREAKPOINT_REG_DP           0x09
+
+// breakpoint_step() returns this, not a cycle count, when a breakpoint
+// stops the CPU. Cf. BREAK_TO_MONITOR
+#define BREAKPOINT_HIT              0xFE
+
+#define BREAKPOINT_SNAPSHOTS        16          // Kept, newest first
+
+
+/*
+ * STRUCTS
+ */
+// Execute breakpoints use only `start`. `count` is the number of hits
+// -- times the condition held -- before the breakpoint acts; 0 or 1
+// to act on every hit
+typedef struct {
+    uint16_t    start;
+    uint16_t    end;            // Inclusive
+    uint8_t     kinds;
+    uint8_t     action;
+    uint8_t     condition;
+    uint8_t     reg_index;
+    uint16_t    value;
+    uint32_t    count;
+    uint32_t    hits;
+    bool        is_set;
+} BREAKPOINT;
+
+typedef struct {
+    REG_6809    regs;
+    uint32_t    hits;
+    uint16_t    address;        // The op's, or the data address accessed
+    uint8_t     index;
+    uint8_t     kind;
+} BREAKPOINT_SNAPSHOT;
+
+// The bitmaps flag every address some breakpoint covers; only on a
+// flagged address are the breakpoints themselves checked
+typedef struct {
+    uint8_t             execute[KB64 / 8];
+    WATCH_MAP           watch;
+    BREAKPOINT          entries[BREAKPOINT_MAX];
+    uint8_t             count;
+    bool                is_resuming;
+    BREAKPOINT_SNAPSHOT snapshots[BREAKPOINT_SNAPSHOTS];
+    uint32_t            snapshots_taken;
+    // The hit that last stopped the CPU
+    uint8_t             hit_index;
+    uint8_t             hit_kind;
+    uint16_t            hit_address;
+    uint32_t            hit_cycles;     // Cycles the op took, for a watchpoint
+} BREAKPOINTS;
+
+
+/*
+ *      PROTOTYPES
+ */
+uint8_t     breakpoint_set(const BREAKPOINT* breakpoint);
+uint8_t     breakpoint_find(uint16_t start, uint8_t kinds);
+bool        breakpoint_clear(uint8_t index);
+void        breakpoint_clear_all(void);
+bool        breakpoint_is_armed(void);
+void        breakpoint_resume(void);
+uint32_t    breakpoint_step(void);
+uint8_t     breakpoint_snapshots(BREAKPOINT_SNAPSHOT* snapshots, uint8_t count);
+
+
+#endif  // _BREAKPOINT_HEADER_
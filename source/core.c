@@ -0,0 +1,241 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * CPU core runner: executes the 6809 on its own core or thread
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stddef.h>
+#include <string.h>
+// App
+#include "breakpoint.h"
+#include "core.h"
+
+
+/*
+ * STATICS
+ */
+static bool handle_command(CORE* core, const MAILBOX_MSG* msg);
+static void post_event(CORE* core, uint8_t type, uint8_t arg, uint32_t value);
+static void publish(CORE* core);
+
+
+/*
+ * GLOBALS
+ */
+extern REG_6809     reg;
+extern STATE_6809   state;
+extern BREAKPOINTS  breakpoints;
+
+
+/**
+ * @brief Set up a core runner. Call before core_loop() starts.
+ *
+ * @param core:              Pointer to a CORE struct.
+ * @param memory:            The 6809's memory.
+ * @param sample_interrupts: Returns the interrupt lines, or NULL to leave them alone.
+ * @param idle:              Called while there is nothing to do, or NULL to spin.
+ */
+void core_init(CORE* core, uint8_t* memory, uint8_t (*sample_interrupts)(void), void (*idle)(void)) {
+
+    mailbox_init(&core->commands);
+    mailbox_init(&core->events);
+    atomic_store_explicit(&core->sequence, 0, memory_order_relaxed);
+    core->memory = memory;
+    core->sample_interrupts = sample_interrupts;
+    core->idle = idle;
+    core->is_running = false;
+    core->cycles = 0;
+    core->snapshot.reg = reg;
+    core->snapshot.cycles = 0;
+    core->snapshot.is_running = false;
+}
+
+
+/**
+ * @brief The CPU side: action commands and, while running, execute
+ *        instructions in batches, publishing a snapshot after each.
+ *        Breakpoints are only checked if some are set.
+ *        Does not return, except on CORE_CMD_QUIT.
+ *
+ * @param core: Pointer to a CORE struct.
+ */
+void core_loop(CORE* core) {
+
+    while (true) {
+        MAILBOX_MSG msg;
+        bool has_command = false;
+        while (mailbox_get(&core->commands, &msg)) {
+            if (!handle_command(core, &msg)) return;
+            has_command = true;
+        }
+
+        if (core->is_running) {
+            uint32_t (*step)(void) = breakpoint_is_armed() ? breakpoint_step : process_next_instruction;
+            uint8_t reason = CORE_STOP_RETURN;
+            for (uint32_t i = 0 ; i < CORE_BATCH ; ++i) {
+                uint32_t result = step();
+                if (result == BREAK_TO_MONITOR) {
+                    core->is_running = false;
+                    break;
+                }
+
+                if (result == BREAKPOINT_HIT) {
+                    core->cycles += breakpoints.hit_cycles;
+                    core->is_running = false;
+                    reason = CORE_STOP_BREAKPOINT;
+                    break;
+                }
+
+                core->cycles += result;
+                if (core->cycle_limit > 0 && core->cycles >= core->cycle_limit) {
+                    core->is_running = false;
+                    reason = CORE_STOP_CYCLES;
+                    break;
+                }
+            }
+
+            if (core->sample_interrupts != NULL) state.interrupts = core->sample_interrupts();
+            publish(core);
+
+            // The UI may take over `reg` once it has this event, so
+            // nothing here reads it afterwards
+            if (!core->is_running) post_event(core, CORE_EVENT_STOPPED, reason, core->cycles);
+        } else if (!has_command && core->idle != NULL) {
+            core->idle();
+        }
+    }
+}
+
+
+/**
+ * @brief Send the CPU a command. UI side only.
+ *
+ * @param core:    Pointer to a CORE struct.
+ * @param type:    The CORE_CMD_* command.
+ * @param address: The command's address, if it takes one.
+ * @param value:   The command's value, if it takes one.
+ *
+ * @retval `true` if the command was sent, `false` if the mailbox is full.
+ */
+bool core_send(CORE* core, uint8_t type, uint16_t address, uint32_t value) {
+
+    MAILBOX_MSG msg = {type, 0, address, value};
+    return mailbox_put(&core->commands, &msg);
+}
+
+
+/**
+ * @brief Take the oldest CPU event, if any. UI side only.
+ *
+ * @param core:  Pointer to a CORE struct.
+ * @param event: Receives the event.
+ *
+ * @retval `true` if there was an event, otherwise `false`.
+ */
+bool core_get_event(CORE* core, MAILBOX_MSG* event) {
+
+    return mailbox_get(&core->events, event);
+}
+
+
+/**
+ * @brief Copy the latest published state. Retries if the CPU side
+ *        published meanwhile, so the copy is never torn. UI side only.
+ *
+ * @param core:     Pointer to a CORE struct.
+ * @param snapshot: Receives the state.
+ */
+void core_read_snapshot(CORE* core, CORE_SNAPSHOT* snapshot) {
+
+    uint32_t before = 0;
+    uint32_t after = 0;
+
+    do {
+        before = atomic_load_explicit(&core->sequence, memory_order_acquire);
+        if (before & 1) continue;
+        memcpy(snapshot, &core->snapshot, sizeof(CORE_SNAPSHOT));
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&core->sequence, memory_order_relaxed);
+    } while ((before & 1) || before != after);
+}
+
+
+/**
+ * @brief Action one command.
+ *
+ * @param core: Pointer to a CORE struct.
+ * @param msg:  The command.
+ *
+ * @retval `false` if the loop should end, otherwise `true`.
+ */
+static bool handle_command(CORE* core, const MAILBOX_MSG* msg) {
+
+    switch(msg->type) {
+        case CORE_CMD_RUN:
+            core->cycles = 0;
+            core->cycle_limit = msg->value;
+            core->is_running = true;
+            breakpoint_resume();
+            break;
+        case CORE_CMD_STEP:
+            if (!core->is_running) {
+                uint32_t result = process_next_instruction();
+                if (core->sample_interrupts != NULL) state.interrupts = core->sample_interrupts();
+                publish(core);
+                post_event(core, CORE_EVENT_STEPPED, 0, result);
+            }
+            break;
+        case CORE_CMD_PAUSE:
+            // Always answered, so the UI can wait on it
+            core->is_running = false;
+            publish(core);
+            post_event(core, CORE_EVENT_STOPPED, CORE_STOP_PAUSED, core->cycles);
+            break;
+        case CORE_CMD_POKE:
+            core->memory[msg->address] = (uint8_t)msg->value;
+            break;
+        case CORE_CMD_SET_PC:
+            if (!core->is_running) reg.pc = msg->address;
+            break;
+        case CORE_CMD_QUIT:
+            core->is_running = false;
+            publish(core);
+            return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Post an event to the UI, waiting for room if need be: events
+ *        are rare, and the UI takes them on every pass of its loop.
+ */
+static void post_event(CORE* core, uint8_t type, uint8_t arg, uint32_t value) {
+
+    MAILBOX_MSG msg = {type, arg, reg.pc, value};
+    while (!mailbox_put(&core->events, &msg)) {
+        if (core->idle != NULL) core->idle();
+    }
+}
+
+
+/**
+ * @brief Publish the CPU's state under the sequence lock.
+ */
+static void publish(CORE* core) {
+
+    uint32_t sequence = atomic_load_explicit(&core->sequence, memory_order_relaxed);
+    atomic_store_explicit(&core->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    core->snapshot.reg = reg;
+    core->snapshot.cycles = core->cycles;
+    core->snapshot.is_running = core->is_running;
+
+    atomic_store_explicit(&core->sequence, sequence + 2, memory_order_release);
+}
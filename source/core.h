@@ -0,0 +1,87 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * CPU core runner: executes the 6809 on its own core or thread
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _CORE_HEADER_
+#define _CORE_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "cpu.h"
+#include "mailbox.h"
+
+
+/*
+ *      CONSTANTS
+ */
+// Commands, UI to CPU
+#define CORE_CMD_RUN                0x01        // value: cycles to run, 0 for no limit
+#define CORE_CMD_STEP               0x02        // -> CORE_EVENT_STEPPED; ignored while running
+#define CORE_CMD_PAUSE              0x03        // -> CORE_EVENT_STOPPED
+#define CORE_CMD_POKE               0x04        // address, value (byte)
+#define CORE_CMD_SET_PC             0x05        // address
+#define CORE_CMD_QUIT               0x06        // Host only: core_loop() returns
+
+// Events, CPU to UI
+#define CORE_EVENT_STOPPED          0x81        // arg: reason, value: cycles run
+#define CORE_EVENT_STEPPED          0x82        // value: the instruction's result
+
+#define CORE_STOP_RETURN            0x00        // Code returned to the monitor
+#define CORE_STOP_PAUSED            0x01
+#define CORE_STOP_BREAKPOINT        0x02        // See `breakpoints` for which
+#define CORE_STOP_CYCLES            0x03        // Ran the cycles RUN asked for
+
+// Instructions run between checks for commands and snapshot updates
+#define CORE_BATCH                  32
+
+
+/*
+ * STRUCTS
+ */
+// What the UI may show while the CPU runs
+typedef struct {
+    REG_6809    reg;
+    uint32_t    cycles;         // Cycles run since the last RUN
+    bool        is_running;
+} CORE_SNAPSHOT;
+
+// While the core runs, the UI must not touch `reg` or `state`, and
+// changes memory only via CORE_CMD_POKE. The snapshot is published
+// under a sequence lock: odd while being written
+typedef struct {
+    MAILBOX             commands;
+    MAILBOX             events;
+    _Atomic uint32_t    sequence;
+    CORE_SNAPSHOT       snapshot;
+    uint8_t*            memory;
+    uint8_t             (*sample_interrupts)(void);
+    void                (*idle)(void);
+    // Owned by core_loop()
+    bool                is_running;
+    uint32_t            cycles;
+    uint32_t            cycle_limit;
+} CORE;
+
+
+/*
+ *      PROTOTYPES
+ */
+void        core_init(CORE* core, uint8_t* memory, uint8_t (*sample_interrupts)(void), void (*idle)(void));
+void        core_loop(CORE* core);
+bool        core_send(CORE* core, uint8_t type, uint16_t address, uint32_t value);
+bool        core_get_event(CORE* core, MAILBOX_MSG* event);
+void        core_read_snapshot(CORE* core, CORE_SNAPSHOT* snapshot);
+
+
+#endif  // _CORE_HEADER_
@@ -0,0 +1,126 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Guest code coverage: while it is on, cpu.c flags each byte fetched
+ * through the PC, and each branch's outcome, in the bitmaps here; this
+ * code switches it, merges runs and exports the maps
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+// App
+#include "cpu.h"
+#include "coverage.h"
+
+
+/*
+ * GLOBALS
+ */
+COVERAGE    coverage;
+
+extern MEMORY_MAP_6809  memory_map;
+
+
+/**
+ * @brief Start recording coverage. The maps carry on from where they
+ *        were; call coverage_reset() to clear them.
+ */
+void coverage_start(void) {
+
+    memory_map.coverage = &coverage;
+}
+
+
+/**
+ * @brief Stop recording coverage. The CPU is then back to a single
+ *        pointer check per fetch and per branch.
+ */
+void coverage_stop(void) {
+
+    memory_map.coverage = NULL;
+}
+
+
+/**
+ * @brief Check whether coverage is being recorded.
+ *
+ * @retval `true` if coverage is on, otherwise `false`.
+ */
+bool coverage_is_on(void) {
+
+    return memory_map.coverage != NULL;
+}
+
+
+/**
+ * @brief Clear every map.
+ */
+void coverage_reset(void) {
+
+    memset(&coverage, 0, sizeof(coverage));
+}
+
+
+/**
+ * @brief Add one run's coverage to another's: a bitwise OR of every
+ *        map, eight bytes at a time.
+ *
+ * @param into: Pointer to the coverage to add to.
+ * @param from: Pointer to the coverage to add.
+ */
+void coverage_merge(COVERAGE* into, const COVERAGE* from) {
+
+    uint8_t* out = (uint8_t*)into->maps;
+    const uint8_t* in = (const uint8_t*)from->maps;
+    for (uint32_t i = 0 ; i < COVERAGE_SIZE ; i += 8) {
+        uint64_t a, b;
+        memcpy(&a, &out[i], 8);
+        memcpy(&b, &in[i], 8);
+        a |= b;
+        memcpy(&out[i], &a, 8);
+    }
+}
+
+
+/**
+ * @brief Count the addresses flagged in a map.
+ *
+ * @param coverage: Pointer to the coverage.
+ * @param map:      The COVERAGE_* map.
+ *
+ * @retval The number of addresses flagged.
+ */
+uint32_t coverage_count(const COVERAGE* coverage, uint8_t map) {
+
+    if (map >= COVERAGE_MAPS) return 0;
+
+    uint32_t count = 0;
+    for (uint32_t i = 0 ; i < COVERAGE_MAP_SIZE ; ++i) {
+        for (uint8_t bits = coverage->maps[map][i] ; bits != 0 ; bits &= bits - 1) count++;
+    }
+
+    return count;
+}
+
+
+/**
+ * @brief Copy part of the serialised maps, as laid out in coverage.h.
+ *
+ * @param offset: The first byte to copy.
+ * @param data:   Pointer to the destination.
+ * @param count:  The number of bytes wanted.
+ *
+ * @retval The number of bytes copied: fewer than `count` at the end.
+ */
+uint32_t coverage_read(uint32_t offset, uint8_t* data, uint32_t count) {
+
+    if (offset >= COVERAGE_SIZE) return 0;
+    if (count > COVERAGE_SIZE - offset) count = COVERAGE_SIZE - offset;
+    memcpy(data, &((const uint8_t*)coverage.maps)[offset], count);
+    return count;
+}
@@ -0,0 +1,67 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Guest code coverage bitmaps
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _COVERAGE_HEADER_
+#define _COVERAGE_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*
+ *      CONSTANTS
+ */
+// Maps: bytes fetched through the PC, then the branch ops seen to
+// branch and seen to fall through, flagged at the address of the op's
+// first byte -- its 0x10 prefix for a long conditional. Every op's
+// first byte is fetched, as are prefixes, postbytes, extended addresses
+// and branch offsets; immediate and direct-page operands are read as
+// data, so are not flagged. Reports should judge an op by its first byte
+#define COVERAGE_EXECUTED           0
+#define COVERAGE_TAKEN              1
+#define COVERAGE_NOT_TAKEN          2
+#define COVERAGE_MAPS               3
+
+#define COVERAGE_MAP_SIZE           (65536 / 8)
+
+// coverage_read() serialises the maps in COVERAGE_* order, a bit per
+// address, address 0 in bit 0 of the first byte. Coverage files are
+// COVERAGE_FILE_MAGIC followed by the same bytes, so runs merge with
+// a bitwise OR of everything after the magic
+#define COVERAGE_SIZE               (COVERAGE_MAPS * COVERAGE_MAP_SIZE)
+#define COVERAGE_FILE_MAGIC         "e6809cv1"
+#define COVERAGE_FILE_MAGIC_SIZE    8
+
+
+/*
+ * STRUCTS
+ */
+typedef struct {
+    uint8_t     maps[COVERAGE_MAPS][COVERAGE_MAP_SIZE];
+} COVERAGE;
+
+
+/*
+ *      PROTOTYPES
+ */
+void        coverage_start(void);
+void        coverage_stop(void);
+bool        coverage_is_on(void);
+void        coverage_reset(void);
+void        coverage_merge(COVERAGE* into, const COVERAGE* from);
+uint32_t    coverage_count(const COVERAGE* coverage, uint8_t map);
+uint32_t    coverage_read(uint32_t offset, uint8_t* data, uint32_t count);
+
+
+#endif  // _COVERAGE_HEADER_
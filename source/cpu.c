@@ -9,27 +9,17 @@
  */
 // C
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
-#include <time.h>
-// Pico
-#include "pico/stdlib.h"
-#include "pico/binary_info.h"
-#include "hardware/gpio.h"
-#include "hardware/i2c.h"
-#include "hardware/spi.h"
-#include "hardware/adc.h"
-#include "hardware/flash.h"
-#include "hardware/sync.h"
 // App
 #include "ops.h"
 #include "cpu.h"
-#include "cpu_tests.h"
-#include "keypad.h"
-#include "ht16k33.h"
-#include "monitor.h"
-#include "pia.h"
+#include "log.h"
 #include "main.h"
+#include "profile.h"
+#include "sample.h"
+#include "trace.h"
 
 
 /*
@@ -39,6 +29,8 @@
 static uint8_t  get_next_byte(void);
 static uint8_t  get_byte(uint16_t address);
 static void     set_byte(uint16_t address, uint8_t value);
+static void     observe_access(uint8_t kind, uint16_t address);
+static void     count_access(uint8_t kind, uint16_t address);
 static void     move_pc(int16_t amount);
 // Condition code register bit-level getters and setters
 static bool     is_cc_bit_set(uint8_t bit);
@@ -56,15 +48,99 @@ static uint16_t address_from_dpr(int16_t offset);
 static uint16_t indexed_address(uint8_t post_byte);
 static uint16_t register_value(uint8_t source_reg);
 static void     increment_register(uint8_t source_reg, int16_t amount);
+static uint32_t stack_cycles(uint8_t post_byte);
+// Dispatch
+static uint32_t execute_instruction(void);
 // IO
 //static void     process_interrupt(uint8_t irq);
 
 /*
  * GLOBALS
  */
-REG_6809    reg;
-uint8_t     mem[KB64];
-STATE_6809  state;
+REG_6809        reg;
+uint8_t         mem[KB64];
+STATE_6809      state;
+MEMORY_MAP_6809 memory_map = {KB64, KB64, NULL, NULL, NULL, NULL, NULL, NULL, false};
+
+// Cycles accrued by the current op over and above its base count,
+// eg. by indexed addressing, stack transfers or taken long branches
+static uint32_t cycles_extra = 0;
+
+// Base cycle counts for page 0 ops. Prefixed (page 1 and 2) ops take
+// one cycle more, long branches two more.
+// See MC6809 Datasheet p.25-7
+static const uint8_t CYCLE_COUNTS[256] = {
+//  x0  x1  x2  x3  x4  x5  x6  x7  x8  x9  xA  xB  xC  xD  xE  xF
+     6,  2,  2,  6,  6,  2,  6,  6,  6,  6,  6,  2,  6,  6,  3,  6,    // 0x
+     0,  0,  2,  4,  2,  2,  5,  9,  2,  2,  3,  2,  3,  2,  8,  6,    // 1x
+     3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,    // 2x
+     4,  4,  4,  4,  5,  5,  5,  5,  2,  5,  3,  6, 20, 11,  2, 19,    // 3x
+     2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,    // 4x
+     2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,    // 5x
+     6,  2,  2,  6,  6,  2,  6,  6,  6,  6,  6,  2,  6,  6,  3,  6,    // 6x
+     7,  2,  2,  7,  7,  2,  7,  7,  7,  7,  7,  2,  7,  7,  4,  7,    // 7x
+     2,  2,  2,  4,  2,  2,  2,  2,  2,  2,  2,  2,  4,  7,  3,  2,    // 8x
+     4,  4,  4,  6,  4,  4,  4,  4,  4,  4,  4,  4,  6,  7,  5,  5,    // 9x
+     4,  4,  4,  6,  4,  4,  4,  4,  4,  4,  4,  4,  6,  7,  5,  5,    // Ax
+     5,  5,  5,  7,  5,  5,  5,  5,  5,  5,  5,  5,  7,  8,  6,  6,    // Bx
+     2,  2,  2,  4,  2,  2,  2,  2,  2,  2,  2,  2,  3,  2,  3,  2,    // Cx
+     4,  4,  4,  6,  4,  4,  4,  4,  4,  4,  4,  4,  5,  5,  5,  5,    // Dx
+     4,  4,  4,  6,  4,  4,  4,  4,  4,  4,  4,  4,  5,  5,  5,  5,    // Ex
+     5,  5,  5,  7,  5,  5,  5,  5,  5,  5,  5,  5,  6,  6,  6,  6     // Fx
+};
+
+// Extra cycles taken by each indexed addressing form, by postbyte bits 0-4
+// when bit 7 is set. 5-bit offsets (bit 7 clear) take one extra cycle.
+// See MC6809 Datasheet p.18
+static const uint8_t INDEXED_CYCLES[32] = {
+     2,  3,  2,  3,  0,  1,  1,  0,  1,  4,  0,  4,  1,  5,  0,  0,
+     0,  6,  0,  6,  3,  4,  4,  0,  4,  7,  0,  7,  4,  8,  0,  5
+};
+
+#ifdef E6809_PROFILE
+extern PROFILE  profile;
+
+// The op being executed, as page << 8 | opcode, and its indexed form
+static uint16_t profile_op = PROFILE_NO_OPCODE;
+static uint8_t  profile_form = PROFILE_NO_FORM;
+
+#define PROFILE_OP(ex_op, op)       profile_op = ((ex_op) == 0 ? 0 : ((ex_op) == OPCODE_EXTENDED_1 ? 0x100 : 0x200)) | (op)
+#define PROFILE_FORM(form)          profile_form = (form)
+#else
+#define PROFILE_OP(ex_op, op)       ((void)0)
+#define PROFILE_FORM(form)          ((void)0)
+#endif
+
+#ifdef E6809_SAMPLE
+extern int32_t  sample_countdown;
+
+#define SAMPLE_CALL(address, sp)    sample_call(address, sp)
+#define SAMPLE_RETURN(sp)           sample_return(sp)
+#else
+#define SAMPLE_CALL(address, sp)    ((void)0)
+#define SAMPLE_RETURN(sp)           ((void)0)
+#endif
+
+#ifdef E6809_TRACE
+extern bool     trace_is_on;
+
+// The op being traced: its address and bytes, whether one was fetched
+// (rather than an interrupt taken) and its effective address, if any
+static uint16_t trace_pc = 0;
+static uint8_t  trace_bytes[TRACE_MAX_BYTES];
+static bool     trace_is_op = false;
+static bool     trace_has_address = false;
+static uint16_t trace_address = 0;
+
+static void     begin_trace(void);
+static void     end_trace(uint32_t cycles);
+
+#define TRACE_OP()                  trace_is_op = true
+#define TRACE_ADDRESS(address)      trace_address = (address), trace_has_address = true
+#else
+#define TRACE_OP()                  ((void)0)
+#define TRACE_ADDRESS(address)      ((void)0)
+#endif
 
 
 /*
@@ -109,10 +185,10 @@ void init_vectors(uint16_t* vectors) {
 
     for (uint8_t i = 0 ; i < 8 ; ++i) {
         uint16_t vector = vectors[i];
-        printf("***  %04X\n", vector);
+        LOG_DEBUG("Vector %04X", vector);
         mem[start--] = (uint8_t)(vector & 0xFF);
         mem[start--] = (uint8_t)((vector >> 8) & 0xFF);
-        printf("***  %02X %02X @ %04X\n", mem[start + 1], mem[start], start);
+        LOG_DEBUG("Vector bytes %02X %02X @ %04X", mem[start + 1], mem[start], start);
     }
 }
 
@@ -124,66 +200,163 @@ void init_vectors(uint16_t* vectors) {
  */
 uint32_t process_next_instruction(void) {
 
+#ifdef E6809_PROFILE
+    profile_op = PROFILE_NO_OPCODE;
+    profile_form = PROFILE_NO_FORM;
+#endif
+
+#ifdef E6809_TRACE
+    bool is_tracing = trace_is_on;
+    if (is_tracing) begin_trace();
+#endif
+
+    uint32_t cycles = execute_instruction();
+
+#ifdef E6809_PROFILE
+    // Interrupt entries and CWAI/SYNC waits fetch no op
+    if (profile_op != PROFILE_NO_OPCODE && cycles != BREAK_TO_MONITOR) {
+        profile.instructions[profile_op >> 8][profile_op & 0xFF]++;
+        profile.cycles[profile_op >> 8][profile_op & 0xFF] += cycles;
+        profile.histogram[cycles < PROFILE_HISTOGRAM_SIZE ? cycles : PROFILE_HISTOGRAM_SIZE - 1]++;
+        if (profile_form != PROFILE_NO_FORM) {
+            profile.form_instructions[profile_form]++;
+            profile.form_cycles[profile_form] += cycles;
+        }
+    }
+#endif
+
+#ifdef E6809_SAMPLE
+    // Sample between instructions, when the PC and the stack agree
+    sample_countdown -= (int32_t)cycles;
+    if (sample_countdown <= 0) sample_take(reg.pc, reg.s);
+#endif
+
+#ifdef E6809_TRACE
+    if (is_tracing) end_trace(cycles);
+#endif
+
+    return cycles;
+}
+
+
+#ifdef E6809_TRACE
+/**
+ * @brief Note the next op's address and bytes before it runs, in case
+ *        it writes over them.
+ */
+static void begin_trace(void) {
+
+    trace_pc = reg.pc;
+    if (trace_pc <= KB64 - TRACE_MAX_BYTES) {
+        memcpy(trace_bytes, &mem[trace_pc], TRACE_MAX_BYTES);
+    } else {
+        for (uint8_t i = 0 ; i < TRACE_MAX_BYTES ; ++i) trace_bytes[i] = mem[(uint16_t)(trace_pc + i)];
+    }
+
+    trace_is_op = false;
+    trace_has_address = false;
+}
+
+
+/**
+ * @brief Store a trace record of the op just run, or of the interrupt
+ *        just taken.
+ *
+ * @param cycles: The cycles the op took.
+ */
+static void end_trace(uint32_t cycles) {
+
+    // CWAI and SYNC waits run no op and take no interrupt
+    if (!trace_is_op && state.wait_for_interrupt) return;
+
+    TRACE_RECORD* record = trace_next();
+    if (record == NULL) return;
+
+    record->regs = reg;
+    record->pc = trace_pc;
+    record->address = trace_address;
+    record->cycles = cycles < 0xFF ? cycles : 0xFF;
+    if (!trace_has_address) record->flags |= TRACE_NO_ADDRESS;
+    if (!trace_is_op) record->flags |= TRACE_INTERRUPT;
+    memcpy(record->bytes, trace_bytes, TRACE_MAX_BYTES);
+    trace_commit();
+}
+#endif
+
+
+/**
+ * @brief Decode and run the next instruction, or take an interrupt.
+ *
+ * @retval The number of CPU cycles consumed, or a break signal on RTI/RTS.
+ */
+static uint32_t execute_instruction(void) {
+
     // See Zaks p.250
 
     uint32_t cycles_used = 0;
+    cycles_extra = 0;
 
     // IF HALT
     //      bus_state_pins = 3
 
     state.bus_state_pins = 0;
 
-    if (state.wait_for_interrupt || state.interrupts > 0) {
-        // Process interrupts
-        if (state.interrupts > 0) {
-            state.interrupt_state = IRQ_STATE_ASSERTED;
+    // Process interrupts
+    if (state.interrupts > 0) {
+        state.interrupt_state = IRQ_STATE_ASSERTED;
 
-            // NMI -- always fires but see MC6809 datasheet p.9
-            if (is_bit_set(state.interrupts, NMI_BIT)) {
-                if (!state.nmi_disarmed) {
-                    process_interrupt(NMI_BIT);
-                    state.interrupt_state = IRQ_STATE_HANDLED;
-                }
+        // NMI -- always fires but see MC6809 datasheet p.9
+        if (is_bit_set(state.interrupts, NMI_BIT)) {
+            if (!state.nmi_disarmed) {
+                process_interrupt(NMI_BIT);
+                state.interrupt_state = IRQ_STATE_HANDLED;
             }
+        }
 
-            // FIRQ -- fires if CC F bit clear
-            if (is_bit_set(state.interrupts, FIRQ_BIT)) {
-                // Clear IRQ record bit
-                state.interrupts &= ~(1 << FIRQ_BIT);
+        // FIRQ -- fires if CC F bit clear
+        if (is_bit_set(state.interrupts, FIRQ_BIT)) {
+            // Clear IRQ record bit
+            state.interrupts &= ~(1 << FIRQ_BIT);
 
-                // Process if CC F bit is not set
-                if (!is_cc_bit_set(CC_F_BIT)) {
-                    process_interrupt(FIRQ_BIT);
-                    state.interrupt_state = IRQ_STATE_HANDLED;
-                }
+            // Process if CC F bit is not set
+            if (!is_cc_bit_set(CC_F_BIT)) {
+                process_interrupt(FIRQ_BIT);
+                state.interrupt_state = IRQ_STATE_HANDLED;
             }
+        }
 
-            // IRQ -- fires if CC I bit clear
-            if (is_bit_set(state.interrupts, IRQ_BIT)) {
-                // Clear IRQ record bit
-                state.interrupts &= ~(1 << IRQ_BIT);
+        // IRQ -- fires if CC I bit clear
+        if (is_bit_set(state.interrupts, IRQ_BIT)) {
+            // Clear IRQ record bit
+            state.interrupts &= ~(1 << IRQ_BIT);
 
-                // Process if CC I bit not set
-                if (!is_cc_bit_set(CC_I_BIT)) {
-                    process_interrupt(IRQ_BIT);
-                    state.interrupt_state = IRQ_STATE_HANDLED;
-                }
+            // Process if CC I bit not set
+            if (!is_cc_bit_set(CC_I_BIT)) {
+                process_interrupt(IRQ_BIT);
+                state.interrupt_state = IRQ_STATE_HANDLED;
             }
+        }
 
-            // CWAI and SYNC end if the IRQ was handled
-            if (state.interrupt_state == IRQ_STATE_HANDLED) {
-                state.wait_for_interrupt = false;
-                state.is_sync = false;
-            } else if (state.is_sync) {
-                // SYNC continues processing on unhandled IRQ
-                state.wait_for_interrupt = false;
-                state.is_sync = false;
-            }
+        // CWAI and SYNC end if the IRQ was handled
+        if (state.interrupt_state == IRQ_STATE_HANDLED) {
+            state.wait_for_interrupt = false;
+            state.is_sync = false;
+
+            // NOTE A serviced interrupt occupies the whole instruction
+            //      slot; the handler's first op runs on the next call
+            return cycles_extra;
         }
 
-        return cycles_used;
+        if (state.is_sync) {
+            // SYNC continues processing on unhandled IRQ
+            state.wait_for_interrupt = false;
+            state.is_sync = false;
+        }
     }
 
+    // Idle for a cycle while CWAI or SYNC wait for an interrupt
+    if (state.wait_for_interrupt) return 1;
+
     // 1 -> LIC -- signals on last cycle of instruction
 
     uint8_t opcode = get_next_byte();
@@ -197,6 +370,14 @@ uint32_t process_next_instruction(void) {
         opcode = get_next_byte();
     }
 
+    PROFILE_OP(extended_opcode, opcode);
+    TRACE_OP();
+
+    // Set the base cycle count: prefixed ops take one cycle more than
+    // their page 0 equivalents, long branches two more
+    cycles_used = CYCLE_COUNTS[opcode];
+    if (extended_opcode != 0) cycles_used += ((opcode & 0xF0) == 0x20 ? 2 : 1);
+
     // Process all ops but NOP
     if (opcode != NOP) {
         uint8_t msn = (opcode & 0xF0) >> 4;
@@ -206,29 +387,37 @@ uint32_t process_next_instruction(void) {
         //      See Zaks p.250
         if (msn == 0x03) {
             // These ops have only one, specific address mode each
-            if (lsn == 0x0F) swi(extended_opcode);
+            if (lsn == 0x0F) swi(extended_opcode == 0 ? 1 : (extended_opcode == OPCODE_EXTENDED_1 ? 2 : 3));
             if (lsn == 0x0C) cwai();
             if (lsn == 0x0B) {
                 // Use this to break to monitor, unless we're
-                // actually processing an interrupt
-                if (state.interrupts == 0) {
-                    printf("Breaking to monitor on RTI\n");
+                // actually returning from an interrupt or SWI
+                if (state.interrupt_depth == 0) {
+                    LOG_DEBUG("Breaking to monitor on RTI");
                     return BREAK_TO_MONITOR;
-                } else {
-                    printf("Returning on 1/%i interrupts\n", state.interrupts);
                 }
 
+                LOG_DEBUG("Returning on 1/%i interrupts", state.interrupt_depth);
+
                 rti();
+
+                // Returning a full register set takes nine more cycles
+                if (is_cc_bit_set(CC_E_BIT)) cycles_extra += 9;
             }
             if (lsn  < 0x04) lea(opcode);
-            if (lsn == 0x04) push(true,  get_next_byte());
-            if (lsn == 0x06) push(false, get_next_byte());
-            if (lsn == 0x05) pull(true,  get_next_byte());
-            if (lsn == 0x07) pull(false, get_next_byte());
+            if (lsn > 0x03 && lsn < 0x08) {
+                // Push and pull ops take an extra cycle per byte moved
+                uint8_t post_byte = get_next_byte();
+                cycles_extra += stack_cycles(post_byte);
+                if (lsn == 0x04) push(true,  post_byte);
+                if (lsn == 0x06) push(false, post_byte);
+                if (lsn == 0x05) pull(true,  post_byte);
+                if (lsn == 0x07) pull(false, post_byte);
+            }
             if (lsn == 0x09) rts();
             if (lsn == 0x0A) abx();
             if (lsn == 0x0D) mul();
-            return cycles_used;
+            return cycles_used + cycles_extra;
         }
 
         if (msn == 0x01) {
@@ -242,13 +431,13 @@ uint32_t process_next_instruction(void) {
             if (lsn == 0x0D) sex();
             if (lsn == 0x0E) transfer_decode(get_next_byte(), true);
             if (lsn == 0x0F) transfer_decode(get_next_byte(), false);
-            return cycles_used;
+            return cycles_used + cycles_extra;
         }
 
         if (msn == 0x02 || opcode == BSR) {
             // All 0x02 ops are branch ops, but BSR is 0x8D
             do_branch(opcode, (extended_opcode != 0));
-            return cycles_used;
+            return cycles_used + cycles_extra;
         }
 
         // Set the addressing mode as far as we can
@@ -260,35 +449,38 @@ uint32_t process_next_instruction(void) {
 
         // Jump to specific ops or groups of ops
         if (lsn == 0x00) {
-            if (msn == 0x07) {
+            if (msn > 0x07) {
                 sub(opcode, address_mode);
             } else {
                 neg(opcode, address_mode);
             }
 
-            return cycles_used;
+            return cycles_used + cycles_extra;
         }
 
         if (lsn == 0x01) {
             cmp(opcode, address_mode);
-            return cycles_used;
+            return cycles_used + cycles_extra;
         }
 
         if (lsn == 0x02) {
             sbc(opcode, address_mode);
-            return cycles_used;
+            return cycles_used + cycles_extra;
         }
 
         if (lsn == 0x03) {
             if (msn > 0x0B) {
                 add_16(opcode, address_mode);
+            } else if (msn > 0x07 && extended_opcode != 0) {
+                // CMPD, CMPU
+                cmp_16(opcode, address_mode, extended_opcode);
             } else if (msn > 0x07) {
                 sub_16(opcode, address_mode, extended_opcode);
             } else {
                 com(opcode, address_mode);
             }
 
-            return cycles_used;
+            return cycles_used + cycles_extra;
         }
 
         if (lsn == 0x04) {
@@ -298,12 +490,12 @@ uint32_t process_next_instruction(void) {
                 and(opcode, address_mode);
             }
 
-            return cycles_used;
+            return cycles_used + cycles_extra;
         }
 
         if (lsn == 0x05) {
             bit(opcode, address_mode);
-            return cycles_used;
+            return cycles_used + cycles_extra;
         }
 
         if (lsn == 0x06) {
@@ -313,7 +505,7 @@ uint32_t process_next_instruction(void) {
                 ld(opcode, address_mode);
             }
 
-            return cycles_used;
+            return cycles_used + cycles_extra;
         }
 
         if (lsn == 0x07) {
@@ -323,7 +515,7 @@ uint32_t process_next_instruction(void) {
                 st(opcode, address_mode);
             }
 
-            return cycles_used;
+            return cycles_used + cycles_extra;
         }
 
         if (lsn == 0x08) {
@@ -333,7 +525,7 @@ uint32_t process_next_instruction(void) {
                 eor(opcode, address_mode);
             }
 
-            return cycles_used;
+            return cycles_used + cycles_extra;
         }
 
         if (lsn == 0x09) {
@@ -343,7 +535,7 @@ uint32_t process_next_instruction(void) {
                 adc(opcode, address_mode);
             }
 
-            return cycles_used;
+            return cycles_used + cycles_extra;
         }
 
         if (lsn == 0x0A) {
@@ -353,12 +545,12 @@ uint32_t process_next_instruction(void) {
                 orr(opcode, address_mode);
             }
 
-            return cycles_used;
+            return cycles_used + cycles_extra;
         }
 
         if (lsn == 0x0B) {
             add(opcode, address_mode);
-            return cycles_used;
+            return cycles_used + cycles_extra;
         }
 
         if (lsn == 0x0C) {
@@ -371,7 +563,7 @@ uint32_t process_next_instruction(void) {
                 cmp_16(opcode, address_mode, extended_opcode);
             }
 
-            return cycles_used;
+            return cycles_used + cycles_extra;
         }
 
         if (lsn == 0x0D) {
@@ -384,7 +576,7 @@ uint32_t process_next_instruction(void) {
                 jsr(address_mode);
             }
 
-            return cycles_used;
+            return cycles_used + cycles_extra;
         }
 
         if (lsn == 0x0E) {
@@ -394,7 +586,7 @@ uint32_t process_next_instruction(void) {
                 ld_16(opcode, address_mode, extended_opcode);
             }
 
-            return cycles_used;
+            return cycles_used + cycles_extra;
         }
 
         if (lsn == 0x0F) {
@@ -406,7 +598,7 @@ uint32_t process_next_instruction(void) {
         }
     }
 
-    return cycles_used;
+    return cycles_used + cycles_extra;
 }
 
 /**
@@ -424,7 +616,8 @@ void do_branch(uint8_t bop, bool is_long) {
         if (is_bit_set(offset, SIGN_BIT_16)) offset -= 65536;
     } else {
         // Need all the typecasting? YES!!
-        offset = (int16_t)((int8_t)get_byte(reg.pc));
+        // NOTE The offset is relative to the address of the next op
+        offset = (int16_t)((int8_t)get_next_byte());
     }
 
     bool branch = false;
@@ -458,9 +651,22 @@ void do_branch(uint8_t bop, bool is_long) {
         set_byte(reg.s, (reg.pc & 0xFF));
         reg.s--;
         set_byte(reg.s, ((reg.pc >> 8) & 0xFF));
+        SAMPLE_CALL(reg.pc, reg.s);
+    }
+
+    if (memory_map.coverage != NULL) {
+        // Flag the op's first byte: back over the offset, the opcode
+        // and, for a long conditional, its prefix
+        uint16_t address = reg.pc - (is_long ? 3 : 2) - (is_long && bop != BRA && bop != BSR ? 1 : 0);
+        memory_map.coverage->maps[branch ? COVERAGE_TAKEN : COVERAGE_NOT_TAKEN][address >> 3] |= 1 << (address & 0x07);
     }
 
-    if (branch) reg.pc += (uint16_t)offset;
+    if (branch) {
+        reg.pc += (uint16_t)offset;
+
+        // Taken long conditional branches cost an extra cycle
+        if (is_long && bop != BRA && bop != BSR) cycles_extra++;
+    }
 }
 
 
@@ -475,6 +681,8 @@ void do_branch(uint8_t bop, bool is_long) {
  */
 uint8_t get_next_byte(void) {
 
+    if (memory_map.heatmap != NULL) count_access(HEATMAP_FETCH, reg.pc);
+    if (memory_map.coverage != NULL) memory_map.coverage->maps[COVERAGE_EXECUTED][reg.pc >> 3] |= 1 << (reg.pc & 0x07);
     return mem[reg.pc++];
 }
 
@@ -488,6 +696,8 @@ uint8_t get_next_byte(void) {
  */
 uint8_t get_byte(uint16_t address) {
 
+    if (memory_map.is_observed) observe_access(HEATMAP_READ, address);
+    if (address >= memory_map.io_start) return memory_map.io_read(address);
     return mem[address];
 }
 
@@ -500,7 +710,82 @@ uint8_t get_byte(uint16_t address) {
  */
 void set_byte(uint16_t address, uint8_t value) {
 
-    mem[address] = value;
+    if (memory_map.is_observed) observe_access(HEATMAP_WRITE, address);
+    if (address >= memory_map.io_start) {
+        memory_map.io_write(address, value);
+    } else if (address < memory_map.rom_start) {
+        mem[address] = value;
+
+        if (memory_map.write_dirty != NULL) {
+            uint16_t line = address >> DIRTY_LINE_SHIFT;
+            memory_map.write_dirty[line >> 3] |= (1 << (line & 0x07));
+        }
+    }
+}
+
+
+/**
+ * @brief Mark bytes written other than by set_byte() -- eg. by a
+ *        debugger -- in the dirty map, if there is one. Writes wrap
+ *        at the top of memory.
+ *
+ * @param address: The first byte written.
+ * @param length:  The number of bytes written.
+ */
+void cpu_mark_dirty(uint16_t address, uint32_t length) {
+
+    if (memory_map.write_dirty == NULL || length == 0) return;
+    uint32_t first = address >> DIRTY_LINE_SHIFT;
+    uint32_t last = (address + length - 1) >> DIRTY_LINE_SHIFT;
+    for (uint32_t i = first ; i <= last ; ++i) {
+        uint16_t line = i % (KB64 >> DIRTY_LINE_SHIFT);
+        memory_map.write_dirty[line >> 3] |= (1 << (line & 0x07));
+    }
+}
+
+
+/**
+ * @brief Note that the heatmap or the watchpoints have been switched
+ *        on or off, so reads and writes check them only when needed.
+ */
+void update_observers(void) {
+
+    memory_map.is_observed = memory_map.heatmap != NULL || memory_map.watch != NULL;
+}
+
+
+/**
+ * @brief Count a read or write in the heatmap and note it if it is
+ *        watched.
+ *
+ * @param kind:    HEATMAP_READ or HEATMAP_WRITE.
+ * @param address: The 16-bit memory address.
+ */
+static void observe_access(uint8_t kind, uint16_t address) {
+
+    if (memory_map.heatmap != NULL) count_access(kind, address);
+
+    WATCH_MAP* watch = memory_map.watch;
+    if (watch == NULL) return;
+    uint8_t watch_kind = kind == HEATMAP_READ ? WATCH_READ : WATCH_WRITE;
+    if ((watch->bits[watch_kind][address >> 3] & (1 << (address & 0x07))) && watch->hit_count < WATCH_MAX_HITS) {
+        watch->hit_kinds[watch->hit_count] = watch_kind;
+        watch->hit_addresses[watch->hit_count++] = address;
+    }
+}
+
+
+/**
+ * @brief Count a memory access in the heatmap, which must be on.
+ *
+ * @param kind:    The HEATMAP_* access kind.
+ * @param address: The 16-bit memory address.
+ */
+static void count_access(uint8_t kind, uint16_t address) {
+
+    HEATMAP* heatmap = memory_map.heatmap;
+    heatmap->pages[kind][address >> 8]++;
+    if (heatmap->cells != NULL) heatmap->cells[kind][address]++;
 }
 
 
@@ -690,6 +975,9 @@ void add_16(uint8_t op, uint8_t mode) {
     uint8_t msb = get_byte(address);
     uint8_t lsb = get_byte(address + 1);
 
+    // 'address_from_mode()' assumes an 8-bit read, so we need to increase PC by 1
+    if (mode == MODE_IMMEDIATE) reg.pc++;
+
     // Add the two LSBs (M+1, B) to set the carry,
     // then add the two MSBs (M, A) with the carry
     lsb = alu(reg.b, lsb, false);
@@ -865,8 +1153,8 @@ void cmp_16(uint8_t op, uint8_t mode, uint8_t ex_op) {
     // Set a pointer to the target register, D by default
     uint16_t d = (reg.a << 8) + reg.b;
     uint16_t *reg_ptr = &d;
-    if (op == 0x83 && ex_op == OPCODE_EXTENDED_2) reg_ptr = &reg.u;
-    if (op == CMPX_immed) reg_ptr = ex_op == 0 ? &reg.x : (ex_op == OPCODE_EXTENDED_1 ? &reg.y : &reg.s);
+    if ((op & 0x0F) == 0x03 && ex_op == OPCODE_EXTENDED_2) reg_ptr = &reg.u;
+    if ((op & 0x0F) == 0x0C) reg_ptr = ex_op == 0 ? &reg.x : (ex_op == OPCODE_EXTENDED_1 ? &reg.y : &reg.s);
 
     // Get the data and subtract from the target register
     uint16_t comp_value = (get_byte(address) << 8) | (get_byte(address + 1));
@@ -920,17 +1208,21 @@ void cwai(void) {
 void daa(void) {
 
     bool carry = is_bit_set(reg.cc, CC_C_BIT);
-    clr_cc_bit(CC_C_BIT);
 
     uint8_t lsn = reg.a & 0x0F;
     uint8_t msn = (reg.a & 0xF0) >> 4;
     uint8_t conversion = 0;
 
-    if (carry || msn > 9 || (msn > 8 && lsn > 9)) conversion = DAA_CONVERSION_FACTOR;
-    if (is_bit_set(reg.cc, CC_H_BIT) || lsn > 9) conversion = DAA_CONVERSION_FACTOR;
-    if (msn > 0x0F) set_cc_bit(CC_C_BIT);
+    // Correct each nibble separately: the MSN gets 0x60, the LSN 0x06
+    if (carry || msn > 9 || (msn > 8 && lsn > 9)) conversion |= (DAA_CONVERSION_FACTOR << 4);
+    if (is_bit_set(reg.cc, CC_H_BIT) || lsn > 9) conversion |= DAA_CONVERSION_FACTOR;
+
+    // C is set by the MSN correction but never cleared
+    uint16_t answer = reg.a + conversion;
+    if (answer > 0xFF) set_cc_bit(CC_C_BIT);
 
-    reg.a += conversion;
+    reg.a = answer & 0xFF;
+    clr_cc_bit(CC_V_BIT);
     set_cc_nz(reg.a, IS_8_BIT);
 }
 
@@ -1026,6 +1318,7 @@ void jsr(uint8_t mode) {
     set_byte(reg.s, (reg.pc & 0xFF));
     reg.s--;
     set_byte(reg.s, ((reg.pc >> 8) & 0xFF));
+    SAMPLE_CALL(reg.pc, reg.s);
     reg.pc = address;
 }
 
@@ -1103,7 +1396,9 @@ void ld_16(uint8_t op, uint8_t mode, uint8_t ex_op) {
  */
 void lea(uint8_t op) {
 
-    load_effective(indexed_address(get_next_byte()), (op & 0x03));
+    uint16_t address = indexed_address(get_next_byte());
+    TRACE_ADDRESS(address);
+    load_effective(address, (op & 0x03));
 }
 
 
@@ -1250,6 +1545,7 @@ void ror(uint8_t op, uint8_t mode) {
  */
 void rti(void) {
 
+    if (state.interrupt_depth > 0) state.interrupt_depth--;
     pull(true, PUSH_PULL_CC_REG);
     if (is_cc_bit_set(CC_E_BIT)) {
         pull(true, PUSH_PULL_ALL_REGS);
@@ -1397,28 +1693,14 @@ void sub(uint8_t op, uint8_t mode) {
  */
 void sub_16(uint8_t op, uint8_t mode, uint8_t ex_op) {
 
-    reg.cc &= MASK_NZV;
-    uint8_t cc = reg.cc;
-
-    // Complement the value at M:M + 1
-    // NOTE Don't use 'negate()' because we need to
-    //      include the carry into the MSB
     uint16_t address = address_from_mode(mode);
-    uint8_t msb = complement(get_byte(address));
-    uint8_t lsb = complement(get_byte(address + 1));
 
-    // Add 1 to form the 2's complement
-    lsb = alu(lsb, 1, false);
-    msb = alu(msb, 0, true);
-    reg.cc = cc;
-
-    // Add D - A and B
-    lsb = alu(reg.b, lsb, false);
-    msb = alu(reg.a, msb, true);
+    // 'address_from_mode()' assumes an 8-bit read, so we need to increase PC by 1
+    if (mode == MODE_IMMEDIATE) reg.pc++;
 
-    // Convert the bytes back to a 16-bit value and set the CC
-    uint16_t answer = (msb << 8) | lsb;
-    set_cc_nz(answer, IS_16_BIT);
+    // Subtract M:M + 1 from D -- this sets N, Z, V, C
+    uint16_t amount = (get_byte(address) << 8) | get_byte(address + 1);
+    uint16_t answer = subtract_16((reg.a << 8) | reg.b, amount);
 
     // Set D's component registers
     reg.a = (answer >> 8) & 0x0FF;
@@ -1438,6 +1720,8 @@ void swi(uint8_t number) {
     // Set e to 1 then push every register to the hardware stac
     set_cc_bit(CC_E_BIT);
     push(true, PUSH_PULL_EVERY_REG);
+    SAMPLE_CALL(reg.pc, reg.s);
+    state.interrupt_depth++;
 
     if (number == 1) {
         // Set I and F
@@ -1653,8 +1937,7 @@ uint8_t sub_with_carry(uint8_t value, uint8_t amount) {
 
 /**
  * @brief Generic 8-bit subtraction function.
- *        Affects N, Z, V, C -- V, C set by 'negate()'
- *                           -- V, C (H) set by 'alu()'
+ *        Affects N, Z, V, C -- C represents a borrow.
  *
  * @param value:     The addee.
  * @param amount:    The adder.
@@ -1664,29 +1947,26 @@ uint8_t sub_with_carry(uint8_t value, uint8_t amount) {
  */
 uint8_t base_sub(uint8_t value, uint8_t amount, bool use_carry) {
 
-    bool carry_set = is_bit_set(reg.cc, CC_C_BIT);
-    uint8_t comp = twos_complement(amount);
-    uint8_t answer = alu(value, comp, false);
+    uint8_t borrow = (use_carry && is_cc_bit_set(CC_C_BIT)) ? 1 : 0;
+    uint16_t answer = value - amount - borrow;
 
-    // Don't run 'use_carry' through alu() as will may ADD 1,
-    // so peform the borrow here, if C is set. 0xFF = 2C of 1.
-    if (use_carry && carry_set) {
-        answer = alu(answer, 0xFF, false);
-    }
+    // C is set on a borrow out of bit 7. V is set when the operands'
+    // signs differ and the result's sign differs from the minuend's
+    reg.cc &= MASK_NZVC;
+    if (is_bit_set(answer, 8)) set_cc_bit(CC_C_BIT);
+    if (is_bit_set((value ^ amount) & (value ^ answer), SIGN_BIT_8)) set_cc_bit(CC_V_BIT);
 
-    // C represents a borrow and is set to the complement of the carry
-    // of the internal binary addition
-    flp_cc_bit(CC_C_BIT);
+    // H is undefined, but match the internal two's complement addition
+    if ((value & 0x0F) + (twos_complement(amount) & 0x0F) > 0x0F) set_cc_bit(CC_H_BIT);
 
-    set_cc_nz(answer, IS_8_BIT);
-    return answer;
+    set_cc_nz(answer & 0xFF, IS_8_BIT);
+    return (answer & 0xFF);
 }
 
 
 /**
  * @brief Generic 16-bit subtraction function.
- *        Affects N, Z, V, C -- N, Z, V, C set by 'complement()'
- *                           -- V, C (H) set by 'alu()'
+ *        Affects N, Z, V, C -- C represents a borrow.
  *
  * @param value:     The addee.
  * @param amount:    The adder.
@@ -1695,32 +1975,16 @@ uint8_t base_sub(uint8_t value, uint8_t amount, bool use_carry) {
  */
 uint16_t subtract_16(uint16_t value, uint16_t amount) {
 
-    // Complement the value at M:M + 1
-    uint8_t msb = ones_complement((amount >> 8) & 0xFF);
-    uint8_t lsb = ones_complement(amount & 0xFF);
-    uint16_t am2 = (msb << 8) + lsb + 1;
-    lsb = (am2 & 0xFF);
-    msb = (am2 >> 8) & 0xFF;
-
-    reg.cc &= MASK_NZ;
-
-    // Add 1 to form the 2's complement
-    //lsb = alu(lsb, 1, false);
-    //msb = alu(msb, 0, true);
-
-    // Add the register value
-    lsb = alu(value & 0xFF, lsb, false);
-    msb = alu((value >> 8) & 0xFF, msb, true);
-
-    // Convert the bytes back to a 16-bit value and set the CC
-    uint16_t answer = (msb << 8) | lsb;
-    set_cc_nz(answer, IS_16_BIT);
+    uint32_t answer = value - amount;
 
-    // c represents a borrow and is set to the complement of the carry
-    // of the internal binary addition
-    flp_cc_bit(CC_C_BIT);
+    // C is set on a borrow out of bit 15. V is set when the operands'
+    // signs differ and the result's sign differs from the minuend's
+    reg.cc &= MASK_NZVC;
+    if (answer & 0x10000) set_cc_bit(CC_C_BIT);
+    if (is_bit_set((value ^ amount) & (value ^ answer), SIGN_BIT_16)) set_cc_bit(CC_V_BIT);
 
-    return answer;
+    set_cc_nz(answer & 0xFFFF, IS_16_BIT);
+    return (answer & 0xFFFF);
 }
 
 
@@ -2492,6 +2756,9 @@ void pull(bool from_hardware, uint8_t post_byte) {
         reg.u = source;
         reg.s = dest;
     }
+
+    // Pulling PC from S returns from a call
+    if (from_hardware && is_bit_set(post_byte, 7)) SAMPLE_RETURN(reg.s);
 }
 
 void test(uint8_t value) {
@@ -2545,6 +2812,7 @@ uint16_t address_from_mode(uint8_t mode) {
         address = address_from_next_two_bytes();
     }
 
+    if (mode != MODE_IMMEDIATE) TRACE_ADDRESS(address);
     return address;
 }
 
@@ -2604,7 +2872,12 @@ uint16_t indexed_address(uint8_t post_byte) {
         // 5-bit non-indirect offset
         int16_t offset = is_bit_set(op, 4) ? op - 0x20 : op;
         address += offset;
+        cycles_extra++;
+        PROFILE_FORM(PROFILE_FORM_OFFSET_5);
     } else {
+        cycles_extra += INDEXED_CYCLES[op];
+        PROFILE_FORM(op);
+
         // All other opcodes have bit 7 set to 1
         uint8_t msb, lsb;
         int8_t value;
@@ -2644,7 +2917,7 @@ uint16_t indexed_address(uint8_t post_byte) {
             case 8:
                 // 8-bit constant offset; offset is 2s-comp
                 value = get_next_byte();
-                address += is_bit_set(value, SIGN_BIT_8) ? value - 256 : value;
+                address += value;
                 break;
             case 9:
                 // 16-bit constant offset; offset is 2s-comp
@@ -2661,7 +2934,7 @@ uint16_t indexed_address(uint8_t post_byte) {
             case 12:
                 // PC relative 8-bit offset; offset is 2s-comp
                 value = get_next_byte();
-                address = reg.pc + (is_bit_set(value, SIGN_BIT_8) ? value - 256 : value);
+                address = reg.pc + value;
                 break;
             case 13:
                 // regPC relative 16-bit offset; offset is 2s-comp
@@ -2701,7 +2974,7 @@ uint16_t indexed_address(uint8_t post_byte) {
                 // Indirect constant 8-bit offset
                 // eg. LDA [n,X]
                 value = get_next_byte();
-                address += (is_bit_set(value, SIGN_BIT_8) ? value - 256 : value);
+                address += value;
                 break;
             case 25:
                 // Indirect constant 16-bit offset
@@ -2721,7 +2994,7 @@ uint16_t indexed_address(uint8_t post_byte) {
                 // Indirect regPC relative 8-bit offset
                 // eg. LDA [n,PCR]
                 value = get_next_byte();
-                address = reg.pc + (is_bit_set(value, SIGN_BIT_8) ? value - 256 : value);
+                address = reg.pc + value;
                 break;
             case 29:
                 // Indirect regPC relative 16-bit offset
@@ -2793,6 +3066,25 @@ void increment_register(uint8_t source_reg, int16_t amount) {
 }
 
 
+/**
+ * @brief Count the cycles a push or pull op spends moving registers:
+ *        one per byte transferred.
+ *
+ * @param post_byte: The byte indicating the registers to transfer.
+ *
+ * @retval The number of extra cycles.
+ */
+uint32_t stack_cycles(uint8_t post_byte) {
+
+    uint32_t count = 0;
+    for (uint8_t i = 0 ; i < 8 ; ++i) {
+        if (is_bit_set(post_byte, i)) count += (i < 4 ? 1 : 2);
+    }
+
+    return count;
+}
+
+
 /**
  * @brief Set certain registers after RESET.
  *
@@ -2809,6 +3101,9 @@ void reset_registers(void) {
 
     // Set PC from reset vector
     reg.pc = (mem[RESET_VECTOR] << 8) | mem[RESET_VECTOR + 1];
+
+    // No interrupt is in service after a reset
+    state.interrupt_depth = 0;
 }
 
 
@@ -2835,41 +3130,61 @@ void clear_all_registers(void) {
  */
 void process_interrupt(uint8_t irq) {
 
+    // CWAI has already stacked the entire register set
+    bool is_stacked = state.wait_for_interrupt && !state.is_sync;
+
     // FIRQ
     if (irq == FIRQ_BIT) {
-        clr_cc_bit(CC_E_BIT);
-        push(true, PUSH_PULL_CC_REG | PUSH_PULL_PC_REG);
+        if (!is_stacked) {
+            clr_cc_bit(CC_E_BIT);
+            push(true, PUSH_PULL_CC_REG | PUSH_PULL_PC_REG);
+        }
+
         set_cc_bit(CC_F_BIT);
         set_cc_bit(CC_I_BIT);
         state.bus_state_pins = 0x02;
+        SAMPLE_CALL(reg.pc, reg.s);
         reg.pc = (mem[FIRQ_VECTOR] << 8) | mem[FIRQ_VECTOR + 1];
         //state.bus_state_pins = 0x00;
+        cycles_extra += 10;
         flash_led(2);
     }
 
     // IRQ
     if (irq == IRQ_BIT) {
-        set_cc_bit(CC_E_BIT);
-        push(true, PUSH_PULL_EVERY_REG);
+        if (!is_stacked) {
+            set_cc_bit(CC_E_BIT);
+            push(true, PUSH_PULL_EVERY_REG);
+        }
+
         set_cc_bit(CC_I_BIT);
         state.bus_state_pins = 0x02;
+        SAMPLE_CALL(reg.pc, reg.s);
         reg.pc = (mem[IRQ_VECTOR] << 8) | mem[IRQ_VECTOR + 1];
         //state.bus_state_pins = 0x00;
+        cycles_extra += 19;
         flash_led(4);
     }
 
     // NMI
     if (irq == NMI_BIT) {
-        set_cc_bit(CC_E_BIT);
-        push(true, PUSH_PULL_EVERY_REG);
+        if (!is_stacked) {
+            set_cc_bit(CC_E_BIT);
+            push(true, PUSH_PULL_EVERY_REG);
+        }
+
         set_cc_bit(CC_F_BIT);
         set_cc_bit(CC_I_BIT);
         state.bus_state_pins = 0x02;
+        SAMPLE_CALL(reg.pc, reg.s);
         reg.pc = (mem[NMI_VECTOR] << 8) | mem[NMI_VECTOR + 1];
         //state.bus_state_pins = 0x00;
+        cycles_extra += 19;
         flash_led(6);
     }
 
+    if (irq != RESET_BIT) state.interrupt_depth++;
+
     if (irq == RESET_BIT) {
 
     }
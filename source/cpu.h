@@ -15,6 +15,8 @@
  * INCLUDES
  */
 #include <stdlib.h>
+#include "coverage.h"
+#include "heatmap.h"
 
 
 /*
@@ -96,6 +98,15 @@
 
 #define DAA_CONVERSION_FACTOR   6
 
+#define DIRTY_LINE_SHIFT        5
+#define DIRTY_MAP_SIZE          (KB64 >> (DIRTY_LINE_SHIFT + 3))
+
+#define WATCH_READ              0
+#define WATCH_WRITE             1
+#define WATCH_KINDS             2
+// More than any op, interrupt entry included, makes
+#define WATCH_MAX_HITS          32
+
 
 /*
  * STRUCTURES
@@ -118,16 +129,54 @@ typedef struct {
     bool        is_sync;
     bool        nmi_disarmed;
     uint8_t     interrupts;
+    uint8_t     interrupt_depth;
     // May drop these below
     uint8_t     bus_state_pins;
     uint8_t     interrupt_state;
 } STATE_6809;
 
+// Data watchpoints: a bit per address for each WATCH_* kind. The CPU
+// notes every watched access an op makes, in order; the op's caller
+// zeroes `hit_count` before the op
+typedef struct {
+    uint8_t     bits[WATCH_KINDS][KB64 / 8];
+    uint8_t     hit_count;
+    uint8_t     hit_kinds[WATCH_MAX_HITS];      // WATCH_* kind of each
+    uint16_t    hit_addresses[WATCH_MAX_HITS];
+} WATCH_MAP;
+
+// Machine-specific address decoding. Reads and writes at or above
+// `io_start` go to the handlers; writes at or above `rom_start` are
+// discarded. Set both to KB64 for a flat 64KB RAM space.
+// If `write_dirty` is set, each RAM write sets the bit for its 32-byte
+// line in that DIRTY_MAP_SIZE-byte bitmap.
+// If `heatmap` is set, every fetch, read and write is counted in it;
+// see heatmap_start().
+// If `coverage` is set, every byte fetched through the PC, and every
+// branch's outcome, is flagged in it; see coverage_start().
+// If `watch` is set, reads and writes at addresses whose bits are set
+// in it are noted; see breakpoint.h.
+// Reads and writes only check `heatmap` and `watch` when `is_observed`
+// is set: call update_observers() after changing either.
+typedef struct {
+    uint32_t    rom_start;
+    uint32_t    io_start;
+    uint8_t     (*io_read)(uint16_t address);
+    void        (*io_write)(uint16_t address, uint8_t value);
+    uint8_t*    write_dirty;
+    HEATMAP*    heatmap;
+    COVERAGE*   coverage;
+    WATCH_MAP*  watch;
+    bool        is_observed;
+} MEMORY_MAP_6809;
+
 
 /*
  * PROTOTYPES
  */
 uint32_t    process_next_instruction(void);
+void        update_observers(void);
+void        cpu_mark_dirty(uint16_t address, uint32_t length);
 // Op Primary Functions
 void        abx(void);
 void        adc(uint8_t op, uint8_t mode);
@@ -44,7 +44,12 @@ extern uint8_t      mem[KB64];
 extern STATE_6809   state;
 
 
-void test_main(void) {
+/**
+ * @brief Run the CPU tests and print a summary.
+ *
+ * @retval The number of failures.
+ */
+uint32_t test_main(void) {
 
     tests = 0;
     errors = 0;
@@ -62,6 +67,7 @@ void test_main(void) {
     printf("Passes: %i\n", passes);
     printf("Fails: %i\n", errors);
     printf("--------------------------------------------------\n");
+    return errors;
 }
 
 
@@ -451,11 +457,12 @@ static void test_alu(void) {
     mem[0x0001] = 0x3E;
     mem[reg.y + mem[0x0001]] = 0x34;
     sbc(SBCB_indexed, MODE_INDEXED);
-    if (reg.b == 0xDF && (reg.cc & 0x0F) == 0x08) {
+    // NOTE 0x14 - 0x34 - 1 borrows, so C is set
+    if (reg.b == 0xDF && (reg.cc & 0x0F) == 0x09) {
         passes++;
     } else {
         errors++;
-        expected(0xDF08, (uint16_t)((reg.b << 8) | (reg.cc & 0x0F)));
+        expected(0xDF09, (uint16_t)((reg.b << 8) | (reg.cc & 0x0F)));
     }
 
     // SUB 8-bit
@@ -1373,11 +1380,11 @@ static void test_branch(void) {
     reg.pc = 0xFFF;
     mem[0x0FFF] = 0xFF;
     do_branch(BCC, false);
-    if (reg.pc == 0x0FFE) {
+    if (reg.pc == 0x0FFF) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFE, reg.pc);
+        expected(0x0FFF, reg.pc);
     }
     
     // Branch forward
@@ -1386,11 +1393,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BCC, false);
-    if (reg.pc == 0x1000) {
+    if (reg.pc == 0x1001) {
         passes++;
     } else {
         errors++;
-        expected(0x1000, reg.pc);
+        expected(0x1001, reg.pc);
     }
     
     // No branch
@@ -1399,11 +1406,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BCC, false);
-    if (reg.pc == 0x0FFF) {
+    if (reg.pc == 0x1000) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFF, reg.pc);
+        expected(0x1000, reg.pc);
     }
     
     // BCS
@@ -1413,11 +1420,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0xFF;
     do_branch(BCS, false);
-    if (reg.pc == 0x0FFE) {
+    if (reg.pc == 0x0FFF) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFE, reg.pc);
+        expected(0x0FFF, reg.pc);
     }
     
     // Branch forward
@@ -1426,11 +1433,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BCS, false);
-    if (reg.pc == 0x1000) {
+    if (reg.pc == 0x1001) {
         passes++;
     } else {
         errors++;
-        expected(0x1000, reg.pc);
+        expected(0x1001, reg.pc);
     }
     
     // No branch
@@ -1439,11 +1446,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BCS, false);
-    if (reg.pc == 0x0FFF) {
+    if (reg.pc == 0x1000) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFF, reg.pc);
+        expected(0x1000, reg.pc);
     }
     
     // BEQ
@@ -1453,11 +1460,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0xFF;
     do_branch(BEQ, false);
-    if (reg.pc == 0x0FFE) {
+    if (reg.pc == 0x0FFF) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFE, reg.pc);
+        expected(0x0FFF, reg.pc);
     }
     
     // Branch forward
@@ -1466,11 +1473,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BEQ, false);
-    if (reg.pc == 0x1000) {
+    if (reg.pc == 0x1001) {
         passes++;
     } else {
         errors++;
-        expected(0x1000, reg.pc);
+        expected(0x1001, reg.pc);
     }
     
     // No branch
@@ -1479,11 +1486,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BEQ, false);
-    if (reg.pc == 0x0FFF) {
+    if (reg.pc == 0x1000) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFF, reg.pc);
+        expected(0x1000, reg.pc);
     }
     
     // BGE
@@ -1493,11 +1500,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0xFF;
     do_branch(BGE, false);
-    if (reg.pc == 0x0FFE) {
+    if (reg.pc == 0x0FFF) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFE, reg.pc);
+        expected(0x0FFF, reg.pc);
     }
     
     // Branch forward
@@ -1506,11 +1513,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BGE, false);
-    if (reg.pc == 0x1000) {
+    if (reg.pc == 0x1001) {
         passes++;
     } else {
         errors++;
-        expected(0x1000, reg.pc);
+        expected(0x1001, reg.pc);
     }
     
     // No branch
@@ -1519,11 +1526,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BGE, false);
-    if (reg.pc == 0x0FFF) {
+    if (reg.pc == 0x1000) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFF, reg.pc);
+        expected(0x1000, reg.pc);
     }
     
     // BGT
@@ -1533,11 +1540,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0xFF;
     do_branch(BGT, false);
-    if (reg.pc == 0x0FFE) {
+    if (reg.pc == 0x0FFF) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFE, reg.pc);
+        expected(0x0FFF, reg.pc);
     }
     
     // Branch forward
@@ -1546,11 +1553,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BGT, false);
-    if (reg.pc == 0x1000) {
+    if (reg.pc == 0x1001) {
         passes++;
     } else {
         errors++;
-        expected(0x1000, reg.pc);
+        expected(0x1001, reg.pc);
     }
     
     // No branch
@@ -1559,11 +1566,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BGT, false);
-    if (reg.pc == 0x0FFF) {
+    if (reg.pc == 0x1000) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFF, reg.pc);
+        expected(0x1000, reg.pc);
     }
     
     // BHI
@@ -1573,11 +1580,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0xFF;
     do_branch(BHI, false);
-    if (reg.pc == 0x0FFE) {
+    if (reg.pc == 0x0FFF) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFE, reg.pc);
+        expected(0x0FFF, reg.pc);
     }
     
     // Branch forward
@@ -1586,11 +1593,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BHI, false);
-    if (reg.pc == 0x1000) {
+    if (reg.pc == 0x1001) {
         passes++;
     } else {
         errors++;
-        expected(0x1000, reg.pc);
+        expected(0x1001, reg.pc);
     }
     
     // No branch - C = 1
@@ -1599,11 +1606,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BHI, false);
-    if (reg.pc == 0x0FFF) {
+    if (reg.pc == 0x1000) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFF, reg.pc);
+        expected(0x1000, reg.pc);
     }
     
     // No branch - Z = 1
@@ -1612,11 +1619,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BHI, false);
-    if (reg.pc == 0x0FFF) {
+    if (reg.pc == 0x1000) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFF, reg.pc);
+        expected(0x1000, reg.pc);
     }
     
     // No branch - Z = C = 1
@@ -1625,11 +1632,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BHI, false);
-    if (reg.pc == 0x0FFF) {
+    if (reg.pc == 0x1000) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFF, reg.pc);
+        expected(0x1000, reg.pc);
     }
     
     // BHS
@@ -1639,11 +1646,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0xFF;
     do_branch(BHS, false);
-    if (reg.pc == 0x0FFE) {
+    if (reg.pc == 0x0FFF) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFE, reg.pc);
+        expected(0x0FFF, reg.pc);
     }
     
     // Branch forward
@@ -1652,11 +1659,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BHS, false);
-    if (reg.pc == 0x1000) {
+    if (reg.pc == 0x1001) {
         passes++;
     } else {
         errors++;
-        expected(0x1000, reg.pc);
+        expected(0x1001, reg.pc);
     }
     
     // No branch
@@ -1665,11 +1672,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BHS, false);
-    if (reg.pc == 0x0FFF) {
+    if (reg.pc == 0x1000) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFF, reg.pc);
+        expected(0x1000, reg.pc);
     }
     
     // BLE
@@ -1679,11 +1686,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0xFF;
     do_branch(BLE, false);
-    if (reg.pc == 0x0FFE) {
+    if (reg.pc == 0x0FFF) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFE, reg.pc);
+        expected(0x0FFF, reg.pc);
     }
     
     // Branch forward
@@ -1692,11 +1699,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BLE, false);
-    if (reg.pc == 0x1000) {
+    if (reg.pc == 0x1001) {
         passes++;
     } else {
         errors++;
-        expected(0x1000, reg.pc);
+        expected(0x1001, reg.pc);
     }
     
     // No branch
@@ -1706,11 +1713,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BLE, false);
-    if (reg.pc == 0x0FFF) {
+    if (reg.pc == 0x1000) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFF, reg.pc);
+        expected(0x1000, reg.pc);
     }
     
     // BLO
@@ -1720,11 +1727,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0xFF;
     do_branch(BLO, false);
-    if (reg.pc == 0x0FFE) {
+    if (reg.pc == 0x0FFF) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFE, reg.pc);
+        expected(0x0FFF, reg.pc);
     }
     
     // Branch forward
@@ -1733,11 +1740,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BLO, false);
-    if (reg.pc == 0x1000) {
+    if (reg.pc == 0x1001) {
         passes++;
     } else {
         errors++;
-        expected(0x1000, reg.pc);
+        expected(0x1001, reg.pc);
     }
     
     // No branch
@@ -1746,11 +1753,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BLO, false);
-    if (reg.pc == 0x0FFF) {
+    if (reg.pc == 0x1000) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFF, reg.pc);
+        expected(0x1000, reg.pc);
     }
     
     // BLS
@@ -1760,11 +1767,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0xFF;
     do_branch(BLS, false);
-    if (reg.pc == 0x0FFE) {
+    if (reg.pc == 0x0FFF) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFE, reg.pc);
+        expected(0x0FFF, reg.pc);
     }
     
     // Branch forward
@@ -1773,11 +1780,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BLS, false);
-    if (reg.pc == 0x1000) {
+    if (reg.pc == 0x1001) {
         passes++;
     } else {
         errors++;
-        expected(0x1000, reg.pc);
+        expected(0x1001, reg.pc);
     }
     
     // No branch
@@ -1786,11 +1793,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BLS, false);
-    if (reg.pc == 0x0FFF) {
+    if (reg.pc == 0x1000) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFF, reg.pc);
+        expected(0x1000, reg.pc);
     }
     
     // BLT
@@ -1800,11 +1807,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0xFF;
     do_branch(BLT, false);
-    if (reg.pc == 0x0FFE) {
+    if (reg.pc == 0x0FFF) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFE, reg.pc);
+        expected(0x0FFF, reg.pc);
     }
     
     // Branch forward
@@ -1813,11 +1820,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BLT, false);
-    if (reg.pc == 0x1000) {
+    if (reg.pc == 0x1001) {
         passes++;
     } else {
         errors++;
-        expected(0x1000, reg.pc);
+        expected(0x1001, reg.pc);
     }
     
     // No branch
@@ -1826,11 +1833,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BLT, false);
-    if (reg.pc == 0x0FFF) {
+    if (reg.pc == 0x1000) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFF, reg.pc);
+        expected(0x1000, reg.pc);
     }
     
     // BMI
@@ -1840,11 +1847,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0xFF;
     do_branch(BMI, false);
-    if (reg.pc == 0x0FFE) {
+    if (reg.pc == 0x0FFF) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFE, reg.pc);
+        expected(0x0FFF, reg.pc);
     }
     
     // Branch forward
@@ -1853,11 +1860,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BMI, false);
-    if (reg.pc == 0x1000) {
+    if (reg.pc == 0x1001) {
         passes++;
     } else {
         errors++;
-        expected(0x1000, reg.pc);
+        expected(0x1001, reg.pc);
     }
     
     // No branch
@@ -1866,11 +1873,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BMI, false);
-    if (reg.pc == 0x0FFF) {
+    if (reg.pc == 0x1000) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFF, reg.pc);
+        expected(0x1000, reg.pc);
     }
     
     // BNE
@@ -1880,11 +1887,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0xFF;
     do_branch(BNE, false);
-    if (reg.pc == 0x0FFE) {
+    if (reg.pc == 0x0FFF) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFE, reg.pc);
+        expected(0x0FFF, reg.pc);
     }
     
     // Branch forward
@@ -1893,11 +1900,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BNE, false);
-    if (reg.pc == 0x1000) {
+    if (reg.pc == 0x1001) {
         passes++;
     } else {
         errors++;
-        expected(0x1000, reg.pc);
+        expected(0x1001, reg.pc);
     }
     
     // No branch
@@ -1906,11 +1913,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BNE, false);
-    if (reg.pc == 0x0FFF) {
+    if (reg.pc == 0x1000) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFF, reg.pc);
+        expected(0x1000, reg.pc);
     }
     
     // BPL
@@ -1920,11 +1927,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0xFF;
     do_branch(BPL, false);
-    if (reg.pc == 0x0FFE) {
+    if (reg.pc == 0x0FFF) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFE, reg.pc);
+        expected(0x0FFF, reg.pc);
     }
     
     // Branch forward
@@ -1933,11 +1940,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BPL, false);
-    if (reg.pc == 0x1000) {
+    if (reg.pc == 0x1001) {
         passes++;
     } else {
         errors++;
-        expected(0x1000, reg.pc);
+        expected(0x1001, reg.pc);
     }
     
     // No branch
@@ -1946,11 +1953,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BPL, false);
-    if (reg.pc == 0x0FFF) {
+    if (reg.pc == 0x1000) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFF, reg.pc);
+        expected(0x1000, reg.pc);
     }
     
     // BRA
@@ -1960,11 +1967,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0xFF;
     do_branch(BRA, false);
-    if (reg.pc == 0x0FFE) {
+    if (reg.pc == 0x0FFF) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFE, reg.pc);
+        expected(0x0FFF, reg.pc);
     }
     
     // Branch forward
@@ -1973,11 +1980,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BRA, false);
-    if (reg.pc == 0x1000) {
+    if (reg.pc == 0x1001) {
         passes++;
     } else {
         errors++;
-        expected(0x1000, reg.pc);
+        expected(0x1001, reg.pc);
     }
     
     // BRN
@@ -1987,11 +1994,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0xFF;
     do_branch(BRN, false);
-    if (reg.pc == 0x0FFF) {
+    if (reg.pc == 0x1000) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFF, reg.pc);
+        expected(0x1000, reg.pc);
     }
     
     // Branch forward
@@ -2000,11 +2007,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BRN, false);
-    if (reg.pc == 0x0FFF) {
+    if (reg.pc == 0x1000) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFF, reg.pc);
+        expected(0x1000, reg.pc);
     }
     
     // BVC
@@ -2014,11 +2021,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0xFF;
     do_branch(BVC, false);
-    if (reg.pc == 0x0FFE) {
+    if (reg.pc == 0x0FFF) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFE, reg.pc);
+        expected(0x0FFF, reg.pc);
     }
     
     // Branch forward
@@ -2027,11 +2034,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BVC, false);
-    if (reg.pc == 0x1000) {
+    if (reg.pc == 0x1001) {
         passes++;
     } else {
         errors++;
-        expected(0x1000, reg.pc);
+        expected(0x1001, reg.pc);
     }
     
     // No branch
@@ -2040,11 +2047,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BVC, false);
-    if (reg.pc == 0x0FFF) {
+    if (reg.pc == 0x1000) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFF, reg.pc);
+        expected(0x1000, reg.pc);
     }
     
     // BVS
@@ -2054,11 +2061,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0xFF;
     do_branch(BVS, false);
-    if (reg.pc == 0x0FFE) {
+    if (reg.pc == 0x0FFF) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFE, reg.pc);
+        expected(0x0FFF, reg.pc);
     }
     
     // Branch forward
@@ -2067,11 +2074,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BVS, false);
-    if (reg.pc == 0x1000) {
+    if (reg.pc == 0x1001) {
         passes++;
     } else {
         errors++;
-        expected(0x1000, reg.pc);
+        expected(0x1001, reg.pc);
     }
     
     // No branch
@@ -2080,11 +2087,11 @@ static void test_branch(void) {
     reg.pc = 0x0FFF;
     mem[0x0FFF] = 0x01;
     do_branch(BVS, false);
-    if (reg.pc == 0x0FFF) {
+    if (reg.pc == 0x1000) {
         passes++;
     } else {
         errors++;
-        expected(0x0FFF, reg.pc);
+        expected(0x1000, reg.pc);
     }
     
     test_report(5, errors - current_errors);
@@ -11,10 +11,16 @@
 #define _CPU_TESTS_HEADER_
 
 
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+
+
 /*
  * PROTOTYPES
  */
-void test_main(void);
+uint32_t test_main(void);
 
 
 #endif // _CPU_TESTS_HEADER_
@@ -0,0 +1,41 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * CRC32 checksums
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _CRC_HEADER_
+#define _CRC_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+
+
+/*
+ *      CONSTANTS
+ */
+// Start and end values for a CRC32 run; matches zlib's crc32()
+#define CRC32_INITIAL               0xFFFFFFFF
+#define CRC32_FINAL_XOR             0xFFFFFFFF
+
+// FNV-1a parameters, applied a 32-bit word at a time by page_hash()
+#define FNV_OFFSET_BASIS            0x811C9DC5
+#define FNV_PRIME                   0x01000193
+
+
+/*
+ *      PROTOTYPES
+ */
+uint32_t    crc32_update(uint32_t crc, const uint8_t* data, uint32_t length);
+uint32_t    crc32(const uint8_t* data, uint32_t length);
+uint32_t    page_hash(const uint8_t* data, uint32_t length);
+
+
+#endif  // _CRC_HEADER_
@@ -0,0 +1,511 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * 6809 disassembler: decodes ops from table lookups, one per page,
+ * into caller buffers. It holds no state, so it is safe to call from
+ * either core
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+// App
+#include "cpu.h"
+#include "disasm.h"
+
+
+/*
+ * STATICS
+ */
+static const DISASM_ENTRY* get_entry(const uint8_t* bytes, uint8_t* index);
+static uint8_t  get_extra(uint8_t post_byte);
+static char*    put_text(char* text, const char* source);
+static char*    put_hex(char* text, uint16_t value, uint8_t digits);
+static char*    put_offset(char* text, int16_t value, uint8_t digits);
+static char*    put_indexed(char* text, const DISASM_OP* op);
+static char*    put_registers(char* text, uint8_t post_byte, const char* other_stack);
+
+
+/*
+ * GLOBALS
+ */
+// Shorthand for the tables' modes
+#define IN      DISASM_MODE_INHERENT
+#define I8      DISASM_MODE_IMMEDIATE_8
+#define I16     DISASM_MODE_IMMEDIATE_16
+#define DI      DISASM_MODE_DIRECT
+#define IX      DISASM_MODE_INDEXED
+#define EX      DISASM_MODE_EXTENDED
+#define R8      DISASM_MODE_RELATIVE_8
+#define R16     DISASM_MODE_RELATIVE_16
+#define RG      DISASM_MODE_REGISTERS
+#define SS      DISASM_MODE_STACK_S
+#define SU      DISASM_MODE_STACK_U
+
+// The CPU runs an unknown prefixed op as its page 0 equivalent, so
+// illegal entries in the page 1 and 2 tables keep page 0's mode: the
+// lengths then match the bytes the CPU takes. An empty mnemonic marks an illegal op.
+// See MC6809 Datasheet p.25-7
+
+// Page 0 ops
+static const DISASM_ENTRY PAGE_0[256] = {
+    {"NEG",   DI},  {"",      DI},  {"",      DI},  {"COM",   DI},  {"LSR",   DI},  {"",      DI},  {"ROR",   DI},  {"ASR",   DI},  // 00
+    {"ASL",   DI},  {"ROL",   DI},  {"DEC",   DI},  {"",      DI},  {"INC",   DI},  {"TST",   DI},  {"JMP",   DI},  {"CLR",   DI},  // 08
+    {"",      IN},  {"",      IN},  {"NOP",   IN},  {"SYNC",  IN},  {"",      IN},  {"",      IN},  {"LBRA",  R16}, {"LBSR",  R16}, // 10
+    {"",      IN},  {"DAA",   IN},  {"ORCC",  I8},  {"",      IN},  {"ANDCC", I8},  {"SEX",   IN},  {"EXG",   RG},  {"TFR",   RG},  // 18
+    {"BRA",   R8},  {"BRN",   R8},  {"BHI",   R8},  {"BLS",   R8},  {"BCC",   R8},  {"BCS",   R8},  {"BNE",   R8},  {"BEQ",   R8},  // 20
+    {"BVC",   R8},  {"BVS",   R8},  {"BPL",   R8},  {"BMI",   R8},  {"BGE",   R8},  {"BLT",   R8},  {"BGT",   R8},  {"BLE",   R8},  // 28
+    {"LEAX",  IX},  {"LEAY",  IX},  {"LEAS",  IX},  {"LEAU",  IX},  {"PSHS",  SS},  {"PULS",  SS},  {"PSHU",  SU},  {"PULU",  SU},  // 30
+    {"",      IN},  {"RTS",   IN},  {"ABX",   IN},  {"RTI",   IN},  {"CWAI",  I8},  {"MUL",   IN},  {"",      IN},  {"SWI",   IN},  // 38
+    {"NEGA",  IN},  {"",      IN},  {"",      IN},  {"COMA",  IN},  {"LSRA",  IN},  {"",      IN},  {"RORA",  IN},  {"ASRA",  IN},  // 40
+    {"ASLA",  IN},  {"ROLA",  IN},  {"DECA",  IN},  {"",      IN},  {"INCA",  IN},  {"TSTA",  IN},  {"",      IN},  {"CLRA",  IN},  // 48
+    {"NEGB",  IN},  {"",      IN},  {"",      IN},  {"COMB",  IN},  {"LSRB",  IN},  {"",      IN},  {"RORB",  IN},  {"ASRB",  IN},  // 50
+    {"ASLB",  IN},  {"ROLB",  IN},  {"DECB",  IN},  {"",      IN},  {"INCB",  IN},  {"TSTB",  IN},  {"",      IN},  {"CLRB",  IN},  // 58
+    {"NEG",   IX},  {"",      IX},  {"",      IX},  {"COM",   IX},  {"LSR",   IX},  {"",      IX},  {"ROR",   IX},  {"ASR",   IX},  // 60
+    {"ASL",   IX},  {"ROL",   IX},  {"DEC",   IX},  {"",      IX},  {"INC",   IX},  {"TST",   IX},  {"JMP",   IX},  {"CLR",   IX},  // 68
+    {"NEG",   EX},  {"",      EX},  {"",      EX},  {"COM",   EX},  {"LSR",   EX},  {"",      EX},  {"ROR",   EX},  {"ASR",   EX},  // 70
+    {"ASL",   EX},  {"ROL",   EX},  {"DEC",   EX},  {"",      EX},  {"INC",   EX},  {"TST",   EX},  {"JMP",   EX},  {"CLR",   EX},  // 78
+    {"SUBA",  I8},  {"CMPA",  I8},  {"SBCA",  I8},  {"SUBD",  I16}, {"ANDA",  I8},  {"BITA",  I8},  {"LDA",   I8},  {"",      I8},  // 80
+    {"EORA",  I8},  {"ADCA",  I8},  {"ORA",   I8},  {"ADDA",  I8},  {"CMPX",  I16}, {"BSR",   R8},  {"LDX",   I16}, {"",      I8},  // 88
+    {"SUBA",  DI},  {"CMPA",  DI},  {"SBCA",  DI},  {"SUBD",  DI},  {"ANDA",  DI},  {"BITA",  DI},  {"LDA",   DI},  {"STA",   DI},  // 90
+    {"EORA",  DI},  {"ADCA",  DI},  {"ORA",   DI},  {"ADDA",  DI},  {"CMPX",  DI},  {"JSR",   DI},  {"LDX",   DI},  {"STX",   DI},  // 98
+    {"SUBA",  IX},  {"CMPA",  IX},  {"SBCA",  IX},  {"SUBD",  IX},  {"ANDA",  IX},  {"BITA",  IX},  {"LDA",   IX},  {"STA",   IX},  // A0
+    {"EORA",  IX},  {"ADCA",  IX},  {"ORA",   IX},  {"ADDA",  IX},  {"CMPX",  IX},  {"JSR",   IX},  {"LDX",   IX},  {"STX",   IX},  // A8
+    {"SUBA",  EX},  {"CMPA",  EX},  {"SBCA",  EX},  {"SUBD",  EX},  {"ANDA",  EX},  {"BITA",  EX},  {"LDA",   EX},  {"STA",   EX},  // B0
+    {"EORA",  EX},  {"ADCA",  EX},  {"ORA",   EX},  {"ADDA",  EX},  {"CMPX",  EX},  {"JSR",   EX},  {"LDX",   EX},  {"STX",   EX},  // B8
+    {"SUBB",  I8},  {"CMPB",  I8},  {"SBCB",  I8},  {"ADDD",  I16}, {"ANDB",  I8},  {"BITB",  I8},  {"LDB",   I8},  {"",      I8},  // C0
+    {"EORB",  I8},  {"ADCB",  I8},  {"ORB",   I8},  {"ADDB",  I8},  {"LDD",   I16}, {"",      I8},  {"LDU",   I16}, {"",      I8},  // C8
+    {"SUBB",  DI},  {"CMPB",  DI},  {"SBCB",  DI},  {"ADDD",  DI},  {"ANDB",  DI},  {"BITB",  DI},  {"LDB",   DI},  {"STB",   DI},  // D0
+    {"EORB",  DI},  {"ADCB",  DI},  {"ORB",   DI},  {"ADDB",  DI},  {"LDD",   DI},  {"STD",   DI},  {"LDU",   DI},  {"STU",   DI},  // D8
+    {"SUBB",  IX},  {"CMPB",  IX},  {"SBCB",  IX},  {"ADDD",  IX},  {"ANDB",  IX},  {"BITB",  IX},  {"LDB",   IX},  {"STB",   IX},  // E0
+    {"EORB",  IX},  {"ADCB",  IX},  {"ORB",   IX},  {"ADDB",  IX},  {"LDD",   IX},  {"STD",   IX},  {"LDU",   IX},  {"STU",   IX},  // E8
+    {"SUBB",  EX},  {"CMPB",  EX},  {"SBCB",  EX},  {"ADDD",  EX},  {"ANDB",  EX},  {"BITB",  EX},  {"LDB",   EX},  {"STB",   EX},  // F0
+    {"EORB",  EX},  {"ADCB",  EX},  {"ORB",   EX},  {"ADDB",  EX},  {"LDD",   EX},  {"STD",   EX},  {"LDU",   EX},  {"STU",   EX}   // F8
+};
+
+// Ops prefixed 0x10
+static const DISASM_ENTRY PAGE_1[256] = {
+    {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  // 00
+    {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  // 08
+    {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      R16}, {"",      R16}, // 10
+    {"",      IN},  {"",      IN},  {"",      I8},  {"",      IN},  {"",      I8},  {"",      IN},  {"",      RG},  {"",      RG},  // 18
+    {"LBRA",  R16}, {"LBRN",  R16}, {"LBHI",  R16}, {"LBLS",  R16}, {"LBCC",  R16}, {"LBCS",  R16}, {"LBNE",  R16}, {"LBEQ",  R16}, // 20
+    {"LBVC",  R16}, {"LBVS",  R16}, {"LBPL",  R16}, {"LBMI",  R16}, {"LBGE",  R16}, {"LBLT",  R16}, {"LBGT",  R16}, {"LBLE",  R16}, // 28
+    {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      SS},  {"",      SS},  {"",      SU},  {"",      SU},  // 30
+    {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      I8},  {"",      IN},  {"",      IN},  {"SWI2",  IN},  // 38
+    {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  // 40
+    {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  // 48
+    {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  // 50
+    {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  // 58
+    {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  // 60
+    {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  // 68
+    {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  // 70
+    {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  // 78
+    {"",      I8},  {"",      I8},  {"",      I8},  {"CMPD",  I16}, {"",      I8},  {"",      I8},  {"",      I8},  {"",      I8},  // 80
+    {"",      I8},  {"",      I8},  {"",      I8},  {"",      I8},  {"CMPY",  I16}, {"",      R8},  {"LDY",   I16}, {"",      I8},  // 88
+    {"",      DI},  {"",      DI},  {"",      DI},  {"CMPD",  DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  // 90
+    {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"CMPY",  DI},  {"",      DI},  {"LDY",   DI},  {"STY",   DI},  // 98
+    {"",      IX},  {"",      IX},  {"",      IX},  {"CMPD",  IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  // A0
+    {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"CMPY",  IX},  {"",      IX},  {"LDY",   IX},  {"STY",   IX},  // A8
+    {"",      EX},  {"",      EX},  {"",      EX},  {"CMPD",  EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  // B0
+    {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"CMPY",  EX},  {"",      EX},  {"LDY",   EX},  {"STY",   EX},  // B8
+    {"",      I8},  {"",      I8},  {"",      I8},  {"",      I16}, {"",      I8},  {"",      I8},  {"",      I8},  {"",      I8},  // C0
+    {"",      I8},  {"",      I8},  {"",      I8},  {"",      I8},  {"",      I16}, {"",      I8},  {"LDS",   I16}, {"",      I8},  // C8
+    {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  // D0
+    {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"LDS",   DI},  {"STS",   DI},  // D8
+    {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  // E0
+    {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"LDS",   IX},  {"STS",   IX},  // E8
+    {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  // F0
+    {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"LDS",   EX},  {"STS",   EX}   // F8
+};
+
+// Ops prefixed 0x11
+static const DISASM_ENTRY PAGE_2[256] = {
+    {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  // 00
+    {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  // 08
+    {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      R16}, {"",      R16}, // 10
+    {"",      IN},  {"",      IN},  {"",      I8},  {"",      IN},  {"",      I8},  {"",      IN},  {"",      RG},  {"",      RG},  // 18
+    {"",      R8},  {"",      R8},  {"",      R8},  {"",      R8},  {"",      R8},  {"",      R8},  {"",      R8},  {"",      R8},  // 20
+    {"",      R8},  {"",      R8},  {"",      R8},  {"",      R8},  {"",      R8},  {"",      R8},  {"",      R8},  {"",      R8},  // 28
+    {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      SS},  {"",      SS},  {"",      SU},  {"",      SU},  // 30
+    {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      I8},  {"",      IN},  {"",      IN},  {"SWI3",  IN},  // 38
+    {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  // 40
+    {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  // 48
+    {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  // 50
+    {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  {"",      IN},  // 58
+    {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  // 60
+    {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  // 68
+    {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  // 70
+    {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  // 78
+    {"",      I8},  {"",      I8},  {"",      I8},  {"CMPU",  I16}, {"",      I8},  {"",      I8},  {"",      I8},  {"",      I8},  // 80
+    {"",      I8},  {"",      I8},  {"",      I8},  {"",      I8},  {"CMPS",  I16}, {"",      R8},  {"",      I16}, {"",      I8},  // 88
+    {"",      DI},  {"",      DI},  {"",      DI},  {"CMPU",  DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  // 90
+    {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"CMPS",  DI},  {"",      DI},  {"",      DI},  {"",      DI},  // 98
+    {"",      IX},  {"",      IX},  {"",      IX},  {"CMPU",  IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  // A0
+    {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"CMPS",  IX},  {"",      IX},  {"",      IX},  {"",      IX},  // A8
+    {"",      EX},  {"",      EX},  {"",      EX},  {"CMPU",  EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  // B0
+    {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"CMPS",  EX},  {"",      EX},  {"",      EX},  {"",      EX},  // B8
+    {"",      I8},  {"",      I8},  {"",      I8},  {"",      I16}, {"",      I8},  {"",      I8},  {"",      I8},  {"",      I8},  // C0
+    {"",      I8},  {"",      I8},  {"",      I8},  {"",      I8},  {"",      I16}, {"",      I8},  {"",      I16}, {"",      I8},  // C8
+    {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  // D0
+    {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  {"",      DI},  // D8
+    {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  // E0
+    {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  {"",      IX},  // E8
+    {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  // F0
+    {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX},  {"",      EX}   // F8
+};
+
+#undef IN
+#undef I8
+#undef I16
+#undef DI
+#undef IX
+#undef EX
+#undef R8
+#undef R16
+#undef RG
+#undef SS
+#undef SU
+
+// Operand bytes by mode; indexed ops may have more after the postbyte
+static const uint8_t OPERANDS[DISASM_MODES] = {0, 1, 2, 1, 1, 2, 1, 2, 1, 1, 1};
+
+// Indexed postbyte forms, by bits 0-3 when bit 7 is set: extra
+// operand bytes, and the form, with R for the register
+static const uint8_t INDEXED_EXTRA[16] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 0, 0, 1, 2, 0, 2};
+static const char* INDEXED_FORMS[16] = {
+    ",R+", ",R++", ",-R", ",--R", ",R", "B,R", "A,R", NULL, NULL, NULL, NULL, "D,R", NULL, NULL, NULL, NULL
+};
+
+static const char* INDEX_REGISTERS[4] = {"X", "Y", "U", "S"};
+static const char* TRANSFER_REGISTERS[16] = {
+    "D", "X", "Y", "U", "S", "PC", "?", "?", "A", "B", "CC", "DP", "?", "?", "?", "?"
+};
+
+static const char HEX_DIGITS[16] = "0123456789ABCDEF";
+
+
+/**
+ * @brief Get the length of an op from its bytes, as the CPU would take
+ *        them.
+ *
+ * @param bytes: Pointer to DISASM_MAX_BYTES bytes from the op's address.
+ *
+ * @retval The op's length, at most DISASM_MAX_BYTES.
+ */
+uint8_t disasm_length(const uint8_t* bytes) {
+
+    uint8_t length = 0;
+    const DISASM_ENTRY* entry = get_entry(bytes, &length);
+    length += 1 + OPERANDS[entry->mode];
+    if (entry->mode == DISASM_MODE_INDEXED && length <= DISASM_MAX_BYTES) length += get_extra(bytes[length - 1]);
+    return length < DISASM_MAX_BYTES ? length : DISASM_MAX_BYTES;
+}
+
+
+/**
+ * @brief Decode an op.
+ *
+ * @param bytes:   Pointer to DISASM_MAX_BYTES bytes from the op's address.
+ * @param address: The op's address, for branch and PC-relative targets.
+ * @param op:      Pointer to a DISASM_OP struct to fill in.
+ *
+ * @retval The op's length.
+ */
+uint8_t disasm_decode(const uint8_t* bytes, uint16_t address, DISASM_OP* op) {
+
+    uint8_t index = 0;
+    const DISASM_ENTRY* entry = get_entry(bytes, &index);
+    op->mnemonic = entry->mnemonic;
+    op->address = address;
+    op->operand = 0;
+    op->mode = entry->mode;
+    op->post_byte = 0;
+
+    // A repeated prefix is legal, but no assembler makes one
+    op->is_valid = entry->mnemonic[0] != 0 && index < 2;
+    index++;
+
+    uint8_t length = index + OPERANDS[entry->mode];
+    if (entry->mode == DISASM_MODE_INDEXED && length <= DISASM_MAX_BYTES) length += get_extra(bytes[index]);
+    if (length > DISASM_MAX_BYTES) {
+        // Only repeated prefixes run past the bytes given
+        op->mnemonic = "";
+        op->length = DISASM_MAX_BYTES;
+        op->is_valid = false;
+        return op->length;
+    }
+
+    op->length = length;
+    uint16_t next = address + length;
+    switch (entry->mode) {
+        case DISASM_MODE_IMMEDIATE_8:
+        case DISASM_MODE_DIRECT:
+            op->operand = bytes[index];
+            break;
+        case DISASM_MODE_IMMEDIATE_16:
+        case DISASM_MODE_EXTENDED:
+            op->operand = (bytes[index] << 8) | bytes[index + 1];
+            break;
+        case DISASM_MODE_RELATIVE_8:
+            op->operand = next + (int8_t)bytes[index];
+            break;
+        case DISASM_MODE_RELATIVE_16:
+            op->operand = next + ((bytes[index] << 8) | bytes[index + 1]);
+            break;
+        case DISASM_MODE_REGISTERS:
+        case DISASM_MODE_STACK_S:
+        case DISASM_MODE_STACK_U:
+            op->post_byte = bytes[index];
+            break;
+        case DISASM_MODE_INDEXED:
+        {
+            uint8_t post_byte = bytes[index];
+            op->post_byte = post_byte;
+            if (!(post_byte & 0x80)) {
+                // 5-bit offset, sign-extended
+                op->operand = (post_byte & 0x10) ? (post_byte | 0xFFE0) : (post_byte & 0x1F);
+                break;
+            }
+
+            uint8_t form = post_byte & 0x0F;
+            bool is_indirect = (post_byte & 0x10) != 0;
+            if (form == 0x08 || form == 0x0C) op->operand = (int8_t)bytes[index + 1];
+            if (form == 0x09 || form == 0x0D || form == 0x0F) op->operand = (bytes[index + 1] << 8) | bytes[index + 2];
+            if (form == 0x0C || form == 0x0D) op->operand += next;
+
+            // Unused forms, and auto-increments by one, which can't be indirect
+            if (form == 0x07 || form == 0x0A || form == 0x0E) op->is_valid = false;
+            if (is_indirect && (form == 0x00 || form == 0x02)) op->is_valid = false;
+            if (form == 0x0F && !is_indirect) op->is_valid = false;
+            break;
+        }
+        default:
+            break;
+    }
+
+    return op->length;
+}
+
+
+/**
+ * @brief Write a decoded op as text: its mnemonic, padded, and then its
+ *        operand in Motorola syntax. Branch and PC-relative operands
+ *        are given as their targets. Illegal ops and indexed forms are
+ *        written as '???'.
+ *
+ * @param op:   Pointer to the op, from disasm_decode().
+ * @param text: Pointer to a buffer of at least DISASM_TEXT_SIZE chars.
+ *
+ * @retval The length of the text, which is NUL-terminated.
+ */
+uint32_t disasm_format(const DISASM_OP* op, char* text) {
+
+    char* out = text;
+    if (op->mnemonic[0] == 0) {
+        out = put_text(out, "???");
+        *out = 0;
+        return out - text;
+    }
+
+    out = put_text(out, op->mnemonic);
+    if (op->mode != DISASM_MODE_INHERENT) {
+        while (out - text < 6) *out++ = ' ';
+    }
+
+    switch (op->mode) {
+        case DISASM_MODE_IMMEDIATE_8:
+            *out++ = '#';
+            out = put_hex(out, op->operand, 2);
+            break;
+        case DISASM_MODE_IMMEDIATE_16:
+            *out++ = '#';
+            out = put_hex(out, op->operand, 4);
+            break;
+        case DISASM_MODE_DIRECT:
+            *out++ = '<';
+            out = put_hex(out, op->operand, 2);
+            break;
+        case DISASM_MODE_EXTENDED:
+        case DISASM_MODE_RELATIVE_8:
+        case DISASM_MODE_RELATIVE_16:
+            out = put_hex(out, op->operand, 4);
+            break;
+        case DISASM_MODE_INDEXED:
+            out = put_indexed(out, op);
+            break;
+        case DISASM_MODE_REGISTERS:
+            out = put_text(out, TRANSFER_REGISTERS[op->post_byte >> 4]);
+            *out++ = ',';
+            out = put_text(out, TRANSFER_REGISTERS[op->post_byte & 0x0F]);
+            break;
+        case DISASM_MODE_STACK_S:
+            out = put_registers(out, op->post_byte, "U");
+            break;
+        case DISASM_MODE_STACK_U:
+            out = put_registers(out, op->post_byte, "S");
+            break;
+        default:
+            break;
+    }
+
+    *out = 0;
+    return out - text;
+}
+
+
+/**
+ * @brief Decode an op and write it as text.
+ *
+ * @param bytes:   Pointer to DISASM_MAX_BYTES bytes from the op's address.
+ * @param address: The op's address.
+ * @param text:    Pointer to a buffer of at least DISASM_TEXT_SIZE chars.
+ *
+ * @retval The op's length.
+ */
+uint8_t disasm(const uint8_t* bytes, uint16_t address, char* text) {
+
+    DISASM_OP op;
+    disasm_decode(bytes, address, &op);
+    disasm_format(&op, text);
+    return op.length;
+}
+
+
+/**
+ * @brief Find an op's table entry, skipping its prefixes. Prefixes may
+ *        repeat; the CPU reads on until it finds an op, and the last
+ *        prefix sets the page.
+ *
+ * @param bytes: Pointer to the op's bytes.
+ * @param index: Pointer to where to store the opcode's index.
+ *
+ * @retval Pointer to the entry.
+ */
+static const DISASM_ENTRY* get_entry(const uint8_t* bytes, uint8_t* index) {
+
+    uint8_t i = 0;
+    while (i < DISASM_MAX_BYTES - 1 && (bytes[i] == OPCODE_EXTENDED_1 || bytes[i] == OPCODE_EXTENDED_2)) i++;
+    *index = i;
+    if (i == 0) return &PAGE_0[bytes[0]];
+    return bytes[i - 1] == OPCODE_EXTENDED_1 ? &PAGE_1[bytes[i]] : &PAGE_2[bytes[i]];
+}
+
+
+/**
+ * @brief The operand bytes an indexed postbyte adds.
+ */
+static uint8_t get_extra(uint8_t post_byte) {
+
+    return (post_byte & 0x80) ? INDEXED_EXTRA[post_byte & 0x0F] : 0;
+}
+
+
+static char* put_text(char* text, const char* source) {
+
+    while (*source != 0) *text++ = *source++;
+    return text;
+}
+
+
+/**
+ * @brief Write a value as '$' and two or four hex digits.
+ */
+static char* put_hex(char* text, uint16_t value, uint8_t digits) {
+
+    *text++ = '$';
+    if (digits == 4) {
+        *text++ = HEX_DIGITS[value >> 12];
+        *text++ = HEX_DIGITS[(value >> 8) & 0x0F];
+    }
+
+    *text++ = HEX_DIGITS[(value >> 4) & 0x0F];
+    *text++ = HEX_DIGITS[value & 0x0F];
+    return text;
+}
+
+
+/**
+ * @brief Write a signed 5- or 8-bit offset, eg. '-$10'.
+ */
+static char* put_offset(char* text, int16_t value, uint8_t digits) {
+
+    if (value < 0) {
+        *text++ = '-';
+        value = -value;
+    }
+
+    return put_hex(text, (uint16_t)value, digits);
+}
+
+
+/**
+ * @brief Write an indexed operand, eg. '[$10,X]' or '$C01A,PCR'.
+ */
+static char* put_indexed(char* text, const DISASM_OP* op) {
+
+    uint8_t post_byte = op->post_byte;
+    const char* reg_name = INDEX_REGISTERS[(post_byte >> 5) & 0x03];
+    if (!(post_byte & 0x80)) {
+        text = put_offset(text, (int16_t)op->operand, 2);
+        *text++ = ',';
+        return put_text(text, reg_name);
+    }
+
+    if (!op->is_valid) return put_text(text, "???");
+
+    uint8_t form = post_byte & 0x0F;
+    bool is_indirect = (post_byte & 0x10) != 0;
+    if (is_indirect) *text++ = '[';
+
+    if (INDEXED_FORMS[form] != NULL) {
+        for (const char* f = INDEXED_FORMS[form] ; *f != 0 ; ++f) {
+            if (*f == 'R') {
+                text = put_text(text, reg_name);
+            } else {
+                *text++ = *f;
+            }
+        }
+    } else if (form == 0x08) {
+        text = put_offset(text, (int16_t)op->operand, 2);
+        *text++ = ',';
+        text = put_text(text, reg_name);
+    } else if (form == 0x09) {
+        text = put_hex(text, op->operand, 4);
+        *text++ = ',';
+        text = put_text(text, reg_name);
+    } else if (form == 0x0C || form == 0x0D) {
+        text = put_hex(text, op->operand, 4);
+        text = put_text(text, ",PCR");
+    } else {
+        text = put_hex(text, op->operand, 4);
+    }
+
+    if (is_indirect) *text++ = ']';
+    return text;
+}
+
+
+/**
+ * @brief Write a PSH or PUL register list, in push order.
+ *
+ * @param text:        Where to write the list.
+ * @param post_byte:   The op's postbyte.
+ * @param other_stack: The other stack pointer's name, which bit 6 stands for.
+ */
+static char* put_registers(char* text, uint8_t post_byte, const char* other_stack) {
+
+    const char* names[8] = {"CC", "A", "B", "DP", "X", "Y", other_stack, "PC"};
+    bool is_first = true;
+    for (int8_t i = 7 ; i >= 0 ; --i) {
+        if (!(post_byte & (1 << i))) continue;
+        if (!is_first) *text++ = ',';
+        text = put_text(text, names[i]);
+        is_first = false;
+    }
+
+    return text;
+}
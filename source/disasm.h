@@ -0,0 +1,81 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * 6809 disassembler
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _DISASM_HEADER_
+#define _DISASM_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*
+ *      CONSTANTS
+ */
+// Callers pass a pointer to at least this many bytes from the op's
+// address. Longest op, eg. 10 AE 9F 12 34
+#define DISASM_MAX_BYTES            5
+
+// Callers pass a buffer of at least this many chars for the text,
+// eg. 'PSHS  PC,U,Y,X,DP,B,A,CC'
+#define DISASM_TEXT_SIZE            32
+
+// Operand forms
+#define DISASM_MODE_INHERENT        0
+#define DISASM_MODE_IMMEDIATE_8     1
+#define DISASM_MODE_IMMEDIATE_16    2
+#define DISASM_MODE_DIRECT          3
+#define DISASM_MODE_INDEXED         4
+#define DISASM_MODE_EXTENDED        5
+#define DISASM_MODE_RELATIVE_8      6
+#define DISASM_MODE_RELATIVE_16     7
+#define DISASM_MODE_REGISTERS       8           // TFR and EXG
+#define DISASM_MODE_STACK_S         9           // PSHS and PULS
+#define DISASM_MODE_STACK_U         10          // PSHU and PULU
+#define DISASM_MODES                11
+
+
+/*
+ * STRUCTS
+ */
+typedef struct {
+    char        mnemonic[6];                    // Empty for an illegal op
+    uint8_t     mode;
+} DISASM_ENTRY;
+
+// `operand` holds the immediate value, the direct page offset, the
+// extended address or the branch target. For indexed ops, it holds the
+// sign-extended offset, the target of a PC-relative form, or the
+// address of an extended indirect one. `post_byte` is the indexed,
+// register or stack postbyte
+typedef struct {
+    const char* mnemonic;
+    uint16_t    address;
+    uint16_t    operand;
+    uint8_t     length;
+    uint8_t     mode;
+    uint8_t     post_byte;
+    bool        is_valid;
+} DISASM_OP;
+
+
+/*
+ *      PROTOTYPES
+ */
+uint8_t     disasm_length(const uint8_t* bytes);
+uint8_t     disasm_decode(const uint8_t* bytes, uint16_t address, DISASM_OP* op);
+uint32_t    disasm_format(const DISASM_OP* op, char* text);
+uint8_t     disasm(const uint8_t* bytes, uint16_t address, char* text);
+
+
+#endif  // _DISASM_HEADER_
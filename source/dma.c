@@ -0,0 +1,192 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * DMA transfer port for the I2C and SPI buses
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdint.h>
+#include <stdbool.h>
+// Pico
+#include "pico/stdlib.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/i2c.h"
+#include "hardware/spi.h"
+// App
+#include "transfer.h"
+#include "dma.h"
+
+
+/*
+ * STATICS
+ */
+static void     dma_start(uint8_t bus, TRANSFER_JOB* job);
+static uint8_t  dma_check(uint8_t bus, TRANSFER_JOB* job);
+static void     dma_start_i2c(TRANSFER_JOB* job);
+static uint8_t  dma_check_i2c(TRANSFER_JOB* job);
+static void     dma_start_spi(TRANSFER_JOB* job);
+static uint8_t  dma_check_spi(TRANSFER_JOB* job);
+
+
+/*
+ * GLOBALS
+ */
+const TRANSFER_PORT dma_port = {dma_start, dma_check};
+int                 dma_channel[TRANSFER_BUS_COUNT];
+// The I2C block takes 9-bit commands, not bytes: one per byte written
+// or read, flagged for the restart and the stop
+uint32_t            i2c_commands[TRANSFER_MAX_DATA + DMA_I2C_MAX_READ];
+
+
+/**
+ * @brief Claim a DMA channel for each bus and attach the queue to them.
+ *        Call once I2C0 and SPI0 have been set up.
+ */
+void dma_port_init(void) {
+
+    dma_channel[TRANSFER_BUS_I2C] = dma_claim_unused_channel(true);
+    dma_channel[TRANSFER_BUS_SPI] = dma_claim_unused_channel(true);
+    transfer_init(&dma_port);
+}
+
+
+/**
+ * @brief Start a job on its bus.
+ *
+ * @param bus: The job's bus.
+ * @param job: The job.
+ */
+static void dma_start(uint8_t bus, TRANSFER_JOB* job) {
+
+    if (bus == TRANSFER_BUS_I2C) {
+        dma_start_i2c(job);
+    } else {
+        dma_start_spi(job);
+    }
+}
+
+
+/**
+ * @brief Report on the job in flight on a bus.
+ *
+ * @param bus: The job's bus.
+ * @param job: The job.
+ *
+ * @retval TRANSFER_BUSY, TRANSFER_OK or TRANSFER_FAILED.
+ */
+static uint8_t dma_check(uint8_t bus, TRANSFER_JOB* job) {
+
+    return bus == TRANSFER_BUS_I2C ? dma_check_i2c(job) : dma_check_spi(job);
+}
+
+
+/**
+ * @brief Feed an I2C job's commands to I2C0's TX FIFO by DMA: the
+ *        writes, then any reads after a restart, with a stop on the last.
+ *
+ * @param job: The job.
+ */
+static void dma_start_i2c(TRANSFER_JOB* job) {
+
+    i2c_hw_t* hw = i2c_get_hw(i2c0);
+    uint16_t read_length = job->read_length > DMA_I2C_MAX_READ ? DMA_I2C_MAX_READ : job->read_length;
+    uint16_t count = 0;
+
+    for (uint16_t i = 0 ; i < job->length ; ++i) {
+        i2c_commands[count++] = job->data[i];
+    }
+
+    for (uint16_t i = 0 ; i < read_length ; ++i) {
+        i2c_commands[count++] = I2C_IC_DATA_CMD_CMD_BITS | (i == 0 ? I2C_IC_DATA_CMD_RESTART_BITS : 0);
+    }
+
+    if (count > 0) i2c_commands[count - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+    // The target address can only change while the block is disabled
+    hw->enable = 0;
+    hw->tar = job->target;
+    hw->enable = 1;
+    (void)hw->clr_stop_det;
+    (void)hw->clr_tx_abrt;
+
+    dma_channel_config config = dma_channel_get_default_config(dma_channel[TRANSFER_BUS_I2C]);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_32);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, i2c_get_dreq(i2c0, true));
+    dma_channel_configure(dma_channel[TRANSFER_BUS_I2C], &config, &hw->data_cmd, i2c_commands, count, true);
+}
+
+
+/**
+ * @brief Check the I2C job in flight. It is done when the stop has gone
+ *        out, and has failed if the target did not acknowledge.
+ *
+ * @param job: The job, which receives any bytes read.
+ *
+ * @retval TRANSFER_BUSY, TRANSFER_OK or TRANSFER_FAILED.
+ */
+static uint8_t dma_check_i2c(TRANSFER_JOB* job) {
+
+    i2c_hw_t* hw = i2c_get_hw(i2c0);
+
+    // An abort flushes the TX FIFO, so stop the DMA feeding it
+    if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+        dma_channel_abort(dma_channel[TRANSFER_BUS_I2C]);
+        (void)hw->clr_tx_abrt;
+        (void)hw->clr_stop_det;
+        return TRANSFER_FAILED;
+    }
+
+    if (dma_channel_is_busy(dma_channel[TRANSFER_BUS_I2C])) return TRANSFER_BUSY;
+    if (!(hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_STOP_DET_BITS)) return TRANSFER_BUSY;
+
+    uint16_t read_length = job->read_length > DMA_I2C_MAX_READ ? DMA_I2C_MAX_READ : job->read_length;
+    for (uint16_t i = 0 ; i < read_length && hw->rxflr > 0 ; ++i) {
+        job->data[i] = (uint8_t)hw->data_cmd;
+    }
+
+    (void)hw->clr_stop_det;
+    return TRANSFER_OK;
+}
+
+
+/**
+ * @brief Select an SPI job's target and feed its bytes to SPI0 by DMA.
+ *
+ * @param job: The job.
+ */
+static void dma_start_spi(TRANSFER_JOB* job) {
+
+    gpio_put(job->target, 0);
+
+    dma_channel_config config = dma_channel_get_default_config(dma_channel[TRANSFER_BUS_SPI]);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, spi_get_dreq(spi0, true));
+    dma_channel_configure(dma_channel[TRANSFER_BUS_SPI], &config, &spi_get_hw(spi0)->dr, job->data, job->length, true);
+}
+
+
+/**
+ * @brief Check the SPI job in flight. When the last byte has left the
+ *        shifter, discard what was clocked in and deselect the target.
+ *
+ * @param job: The job.
+ *
+ * @retval TRANSFER_BUSY or TRANSFER_OK.
+ */
+static uint8_t dma_check_spi(TRANSFER_JOB* job) {
+
+    if (dma_channel_is_busy(dma_channel[TRANSFER_BUS_SPI]) || spi_is_busy(spi0)) return TRANSFER_BUSY;
+
+    while (spi_is_readable(spi0)) (void)spi_get_hw(spi0)->dr;
+    spi_get_hw(spi0)->icr = SPI_SSPICR_RORIC_BITS;
+    gpio_put(job->target, 1);
+    return TRANSFER_OK;
+}
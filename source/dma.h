@@ -0,0 +1,28 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * DMA transfer port for the I2C and SPI buses
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _DMA_HEADER_
+#define _DMA_HEADER_
+
+
+/*
+ *      CONSTANTS
+ */
+// An I2C read lands in the RX FIFO, so can be no longer than it
+#define DMA_I2C_MAX_READ            16
+
+
+/*
+ *      PROTOTYPES
+ */
+void        dma_port_init(void);
+
+
+#endif  // _DMA_HEADER_
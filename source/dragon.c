@@ -0,0 +1,478 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Dragon 32 machine profile
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+// App
+#include "cpu.h"
+#include "sam.h"
+#include "vdg.h"
+#include "dragon.h"
+
+
+/*
+ * STATICS
+ */
+static uint8_t  pia_read(PIA_VIRTUAL* pia, uint8_t reg_offset);
+static void     pia_write(PIA_VIRTUAL* pia, uint8_t reg_offset, uint8_t value);
+static bool     pia_port_irq(PIA_PORT* port);
+static void     pia_port_c1_edge(PIA_PORT* port, bool is_rising);
+static uint8_t  scan_keyboard(void);
+static void     update_interrupts(void);
+static void     clock_video(uint32_t cycles);
+static uint8_t  dragon_io_read(uint16_t address);
+static void     dragon_io_write(uint16_t address, uint8_t value);
+
+// Key positions by ASCII value, encoded as (row << 4) | column,
+// bit 7 set for a shifted key. Zero marks an unmapped character.
+// See Dragon 32 Technical Reference, 'Keyboard'
+static const uint8_t ASCII_KEYS[128] = {
+    // 0x00-0x1F: LEFT (BS), CLEAR (FF), ENTER (CR), BREAK (ESC)
+    0, 0, 0, 0, 0, 0, 0, 0, 0x55, 0, 0, 0, 0x61, 0x60, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x62, 0, 0, 0, 0,
+    // 0x20-0x2F: SPACE ! " # $ % & ' ( ) * + , - . /
+    0x57, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x90, 0x91, 0x92, 0x93, 0x14, 0x15, 0x16, 0x17,
+    // 0x30-0x3F: 0-9 : ; < = > ?
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x10, 0x11, 0x12, 0x13, 0x94, 0x95, 0x96, 0x97,
+    // 0x40-0x5F: @ A-Z
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27,
+    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,
+    0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47,
+    0x50, 0x51, 0x52, 0, 0, 0, 0, 0,
+    // 0x60-0x7F: lower case maps to upper case
+    0, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27,
+    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,
+    0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47,
+    0x50, 0x51, 0x52, 0, 0, 0, 0, 0
+};
+
+
+/*
+ * GLOBALS
+ */
+extern uint8_t          mem[KB64];
+extern MEMORY_MAP_6809  memory_map;
+extern STATE_6809       state;
+
+STATE_DRAGON            dragon;
+
+
+/**
+ * @brief Configure the emulated machine: SAM, PIAs, memory map and RAM.
+ *        Call before loading the ROM.
+ */
+void dragon_init(void) {
+
+    memset(&dragon, 0, sizeof(STATE_DRAGON));
+    sam_reset(&dragon.sam);
+
+    // Route the ROM and I/O areas through the Dragon's decoder
+    memory_map.rom_start = DRAGON_ROM_START;
+    memory_map.io_start = DRAGON_IO_START;
+    memory_map.io_read = dragon_io_read;
+    memory_map.io_write = dragon_io_write;
+    memory_map.write_dirty = dragon.video_dirty;
+
+    // Clear RAM; the empty cartridge area floats high
+    memset(mem, 0x00, DRAGON_RAM_SIZE);
+    memset(&mem[DRAGON_ROM_START], 0xFF, KB64 - DRAGON_ROM_START);
+}
+
+
+/**
+ * @brief Copy a BASIC ROM image into the ROM area and mirror its
+ *        vector table to the top of memory, where the CPU reads it.
+ *
+ * @param data:   Pointer to the ROM image.
+ * @param length: The image size in bytes. Must be 16KB.
+ *
+ * @retval Whether the image was loaded.
+ */
+bool dragon_load_rom(const uint8_t* data, uint32_t length) {
+
+    if (data == NULL || length != DRAGON_ROM_SIZE) return false;
+
+    memcpy(&mem[DRAGON_ROM_START], data, DRAGON_ROM_SIZE);
+
+    // The SAM maps 0xFFE0-0xFFFF to 0xBFE0-0xBFFF
+    memcpy(&mem[DRAGON_VECTORS_START], &mem[DRAGON_VECTORS_ROM], KB64 - DRAGON_VECTORS_START);
+    return true;
+}
+
+
+/**
+ * @brief Reset the machine, as if the reset button were pressed.
+ *        RAM is left untouched.
+ */
+void dragon_reset(void) {
+
+    sam_reset(&dragon.sam);
+    memset(dragon.pia, 0, sizeof(dragon.pia));
+
+    dragon.is_halted = false;
+    dragon.line = 0;
+    dragon.line_cycles = 0;
+
+    init_cpu();
+}
+
+
+/**
+ * @brief Run the machine for at least the specified number of cycles.
+ *        Stops early if the CPU hits an illegal op.
+ *
+ * @param cycles: The number of CPU cycles to run.
+ *
+ * @retval The number of cycles actually run.
+ */
+uint32_t dragon_run(uint32_t cycles) {
+
+    uint32_t cycles_run = 0;
+
+    while (cycles_run < cycles && !dragon.is_halted) {
+        update_interrupts();
+
+        uint32_t used = process_next_instruction();
+        if (used == BREAK_TO_MONITOR) {
+            dragon.is_halted = true;
+            break;
+        }
+
+        dragon.instructions++;
+        cycles_run += used;
+        clock_video(used);
+    }
+
+    dragon.cycles += cycles_run;
+    return cycles_run;
+}
+
+
+/**
+ * @brief Press or release a key in the keyboard matrix.
+ *
+ * @param row:     The matrix row, 0-6 (PIA 0 PA0-PA6).
+ * @param col:     The matrix column, 0-7 (PIA 0 PB0-PB7).
+ * @param is_down: Whether the key is pressed.
+ */
+void dragon_set_key(uint8_t row, uint8_t col, bool is_down) {
+
+    if (row >= DRAGON_KEY_ROWS || col >= DRAGON_KEY_COLS) return;
+
+    if (is_down) {
+        dragon.keyboard[col] |= (1 << row);
+    } else {
+        dragon.keyboard[col] &= ~(1 << row);
+    }
+}
+
+
+/**
+ * @brief Press or release the key(s) that generate an ASCII character,
+ *        including SHIFT where required. SHIFT stays down until every
+ *        shifted character pressed has been released.
+ *
+ * @param chr:     The character.
+ * @param is_down: Whether the key is pressed.
+ *
+ * @retval Whether the character is on the keyboard.
+ */
+bool dragon_set_ascii_key(char chr, bool is_down) {
+
+    if ((uint8_t)chr > 0x7F) return false;
+    uint8_t key = ASCII_KEYS[(uint8_t)chr];
+    if (key == 0 && chr != '0') return false;
+
+    if (key & 0x80) {
+        if (is_down) {
+            dragon.shifted_keys++;
+        } else if (dragon.shifted_keys > 0) {
+            dragon.shifted_keys--;
+        }
+
+        dragon_set_key(DRAGON_KEY_ROW_SHIFT, DRAGON_KEY_COL_SHIFT, dragon.shifted_keys > 0);
+    }
+
+    dragon_set_key((key >> 4) & 0x07, key & 0x0F, is_down);
+    return true;
+}
+
+
+/**
+ * @brief Get the VDG mode pins, driven by PIA 1 PB3-PB7.
+ *        Undriven pins float high.
+ *
+ * @retval The mode, as VDG_MODE_* bits.
+ */
+uint8_t dragon_get_vdg_mode(void) {
+
+    PIA_PORT* port = &dragon.pia[1].b;
+    return (port->reg_output | ~port->reg_direction) & VDG_MODE_MASK;
+}
+
+
+/**
+ * @brief Render the current screen, redrawing only rows written to
+ *        since the previous call.
+ *
+ * @param vdg: Pointer to the MC6847 framebuffer to update.
+ *
+ * @retval The number of scanlines redrawn.
+ */
+uint32_t dragon_render(MC6847* vdg) {
+
+    return vdg_render(vdg, mem, sam_get_display_offset(&dragon.sam), dragon_get_vdg_mode(), dragon.video_dirty);
+}
+
+
+/**
+ * @brief Check whether BASIC's 'OK' prompt is at the start of any
+ *        line of the text screen.
+ *
+ * @retval Whether the prompt is showing.
+ */
+bool dragon_is_at_prompt(void) {
+
+    uint16_t address = sam_get_display_offset(&dragon.sam);
+
+    for (uint32_t i = 0 ; i < DRAGON_TEXT_ROWS ; ++i) {
+        // Normal video 'O' and 'K'
+        if (mem[address] == 0x4F && mem[address + 1] == 0x4B) return true;
+        address += DRAGON_TEXT_COLS;
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief Render the text screen as ASCII, one NUL-terminated line
+ *        per row, ie. DRAGON_TEXT_ROWS * (DRAGON_TEXT_COLS + 1) bytes.
+ *
+ * @param text: Pointer to the output buffer.
+ */
+void dragon_get_screen_text(char* text) {
+
+    uint16_t address = sam_get_display_offset(&dragon.sam);
+
+    for (uint32_t i = 0 ; i < DRAGON_TEXT_ROWS ; ++i) {
+        for (uint32_t j = 0 ; j < DRAGON_TEXT_COLS ; ++j) {
+            // Bit 7 selects semigraphics, bit 6 normal/inverse video
+            uint8_t code = mem[address++];
+            if (code & 0x80) {
+                *text++ = ' ';
+            } else {
+                code &= 0x3F;
+                *text++ = code < 0x20 ? '@' + code : code;
+            }
+        }
+
+        *text++ = 0;
+    }
+}
+
+
+/*
+ * MC6821 FUNCTIONS
+ *
+ * These emulate the chips in full, unlike pia.c, which binds a
+ * physical port to the RP2040's GPIO pins.
+ */
+
+/**
+ * @brief Read one of a PIA's four registers. Reading a data
+ *        register clears that side's interrupt flags.
+ *
+ *        See MC6821 Data Sheet p.6
+ *
+ * @param pia:        Pointer to the PIA.
+ * @param reg_offset: The register, 0-3.
+ *
+ * @retval The register value.
+ */
+static uint8_t pia_read(PIA_VIRTUAL* pia, uint8_t reg_offset) {
+
+    PIA_PORT* port = (reg_offset & 0x02) ? &pia->b : &pia->a;
+    if (reg_offset & 0x01) return port->reg_control;
+
+    if (port->reg_control & PIA_CR_DATA_ACCESS) {
+        port->reg_control &= ~(PIA_CR_C1_FLAG | PIA_CR_C2_FLAG);
+        return (port->reg_output & port->reg_direction) | (port->input & ~port->reg_direction);
+    }
+
+    return port->reg_direction;
+}
+
+
+/**
+ * @brief Write one of a PIA's four registers. The interrupt flags
+ *        are read-only.
+ *
+ * @param pia:        Pointer to the PIA.
+ * @param reg_offset: The register, 0-3.
+ * @param value:      The value to write.
+ */
+static void pia_write(PIA_VIRTUAL* pia, uint8_t reg_offset, uint8_t value) {
+
+    PIA_PORT* port = (reg_offset & 0x02) ? &pia->b : &pia->a;
+
+    if (reg_offset & 0x01) {
+        port->reg_control = (port->reg_control & ~PIA_CR_WRITE_MASK) | (value & PIA_CR_WRITE_MASK);
+    } else if (port->reg_control & PIA_CR_DATA_ACCESS) {
+        port->reg_output = value;
+    } else {
+        port->reg_direction = value;
+    }
+}
+
+
+/**
+ * @brief Determine whether a PIA side is asserting its IRQ line.
+ *
+ * @param port: Pointer to the PIA side.
+ *
+ * @retval Whether the IRQ output is active.
+ */
+static bool pia_port_irq(PIA_PORT* port) {
+
+    uint8_t cr = port->reg_control;
+    if ((cr & PIA_CR_C1_FLAG) && (cr & PIA_CR_C1_IRQ_ENABLE)) return true;
+    return ((cr & PIA_CR_C2_FLAG) && (cr & PIA_CR_C2_IRQ_ENABLE) && !(cr & PIA_CR_C2_IS_OUTPUT));
+}
+
+
+/**
+ * @brief Signal a transition on a PIA side's C1 input. The flag
+ *        is set if the edge matches the one selected by CR bit 1.
+ *
+ * @param port:      Pointer to the PIA side.
+ * @param is_rising: Whether the edge is low-to-high.
+ */
+static void pia_port_c1_edge(PIA_PORT* port, bool is_rising) {
+
+    bool wants_rising = (port->reg_control & PIA_CR_C1_RISING_EDGE) != 0;
+    if (wants_rising == is_rising) port->reg_control |= PIA_CR_C1_FLAG;
+}
+
+
+/*
+ * MACHINE FUNCTIONS
+ */
+
+/**
+ * @brief Calculate the row inputs on PIA 0 port A from the columns
+ *        PIA 0 port B is driving low. Undriven pins float high.
+ *
+ * @retval The port A input levels.
+ */
+static uint8_t scan_keyboard(void) {
+
+    PIA_PORT* cols = &dragon.pia[0].b;
+    uint8_t driven = cols->reg_output | ~cols->reg_direction;
+    uint8_t rows = 0xFF;
+
+    for (uint32_t i = 0 ; i < DRAGON_KEY_COLS ; ++i) {
+        if ((driven & (1 << i)) == 0) rows &= ~dragon.keyboard[i];
+    }
+
+    return rows;
+}
+
+
+/**
+ * @brief Mirror the PIAs' IRQ outputs onto the CPU's lines:
+ *        PIA 0 drives IRQ, PIA 1 drives FIRQ.
+ */
+static void update_interrupts(void) {
+
+    uint8_t lines = 0;
+    if (pia_port_irq(&dragon.pia[0].a) || pia_port_irq(&dragon.pia[0].b)) lines |= (1 << IRQ_BIT);
+    if (pia_port_irq(&dragon.pia[1].a) || pia_port_irq(&dragon.pia[1].b)) lines |= (1 << FIRQ_BIT);
+    state.interrupts = lines;
+}
+
+
+/**
+ * @brief Advance the VDG's beam by the specified number of cycles,
+ *        raising HS on PIA 0 CA1 each line and FS on PIA 0 CB1
+ *        each field.
+ *
+ * @param cycles: The number of CPU cycles elapsed.
+ */
+static void clock_video(uint32_t cycles) {
+
+    dragon.line_cycles += cycles;
+
+    while (dragon.line_cycles >= DRAGON_CYCLES_PER_LINE) {
+        dragon.line_cycles -= DRAGON_CYCLES_PER_LINE;
+
+        // HS is a short low pulse, so both edges occur together
+        pia_port_c1_edge(&dragon.pia[0].a, false);
+        pia_port_c1_edge(&dragon.pia[0].a, true);
+
+        dragon.line++;
+        if (dragon.line == DRAGON_ACTIVE_LINES) {
+            // FS falls at the end of the active area...
+            pia_port_c1_edge(&dragon.pia[0].b, false);
+        } else if (dragon.line == DRAGON_ACTIVE_LINES + DRAGON_FS_LOW_LINES) {
+            // ...and rises during vertical blanking
+            pia_port_c1_edge(&dragon.pia[0].b, true);
+        } else if (dragon.line == DRAGON_LINES_PER_FIELD) {
+            dragon.line = 0;
+            dragon.frames++;
+        }
+    }
+}
+
+
+/**
+ * @brief Memory-mapped I/O read handler, 0xFF00-0xFFFF.
+ *
+ * @param address: The 16-bit address to read.
+ *
+ * @retval The byte read.
+ */
+static uint8_t dragon_io_read(uint16_t address) {
+
+    if (address < DRAGON_PIA_1_START) {
+        dragon.pia[0].a.input = scan_keyboard();
+        return pia_read(&dragon.pia[0], address & 0x03);
+    }
+
+    if (address < DRAGON_CART_IO_START) return pia_read(&dragon.pia[1], address & 0x03);
+
+    // Vectors are read from the ROM, via the mirror made at load
+    if (address >= DRAGON_VECTORS_START) return mem[address];
+
+    // Unused I/O space and the write-only SAM
+    return 0xFF;
+}
+
+
+/**
+ * @brief Memory-mapped I/O write handler, 0xFF00-0xFFFF.
+ *
+ * @param address: The 16-bit address to write.
+ * @param value:   The byte to write.
+ */
+static void dragon_io_write(uint16_t address, uint8_t value) {
+
+    if (address < DRAGON_PIA_1_START) {
+        pia_write(&dragon.pia[0], address & 0x03, value);
+    } else if (address < DRAGON_CART_IO_START) {
+        pia_write(&dragon.pia[1], address & 0x03, value);
+    } else if (address >= SAM_REG_START && address <= SAM_REG_END) {
+        sam_write(&dragon.sam, address);
+    }
+}
@@ -0,0 +1,122 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Dragon 32 machine profile
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _DRAGON_HEADER_
+#define _DRAGON_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "cpu.h"
+#include "sam.h"
+#include "vdg.h"
+
+
+/*
+ *      CONSTANTS
+ */
+// Memory map -- MEMORY_MAP_DG32
+#define DRAGON_RAM_SIZE             32768
+#define DRAGON_ROM_START            0x8000
+#define DRAGON_ROM_SIZE             16384
+#define DRAGON_CART_START           0xC000
+#define DRAGON_IO_START             0xFF00
+#define DRAGON_PIA_0_START          0xFF00
+#define DRAGON_PIA_1_START          0xFF20
+#define DRAGON_CART_IO_START        0xFF40
+#define DRAGON_VECTORS_START        0xFFE0
+#define DRAGON_VECTORS_ROM          0xBFE0
+
+// Video timing (PAL)
+#define DRAGON_CPU_CLOCK_HZ         888625
+#define DRAGON_CYCLES_PER_LINE      57
+#define DRAGON_LINES_PER_FIELD      312
+#define DRAGON_ACTIVE_LINES         192
+#define DRAGON_FS_LOW_LINES         32
+#define DRAGON_CYCLES_PER_FIELD     (DRAGON_CYCLES_PER_LINE * DRAGON_LINES_PER_FIELD)
+
+// Text screen
+#define DRAGON_TEXT_COLS            32
+#define DRAGON_TEXT_ROWS            16
+
+// MC6821 register offsets and control register bits
+// See MC6821 Data Sheet p.6-8
+#define PIA_REG_DATA_A              0
+#define PIA_REG_CONTROL_A           1
+#define PIA_REG_DATA_B              2
+#define PIA_REG_CONTROL_B           3
+
+#define PIA_CR_C1_IRQ_ENABLE        0x01
+#define PIA_CR_C1_RISING_EDGE       0x02
+#define PIA_CR_DATA_ACCESS          0x04
+#define PIA_CR_C2_IRQ_ENABLE        0x08
+#define PIA_CR_C2_IS_OUTPUT         0x20
+#define PIA_CR_C2_FLAG              0x40
+#define PIA_CR_C1_FLAG              0x80
+#define PIA_CR_WRITE_MASK           0x3F
+
+// Keyboard matrix
+#define DRAGON_KEY_COLS             8
+#define DRAGON_KEY_ROWS             7
+#define DRAGON_KEY_ROW_SHIFT        6
+#define DRAGON_KEY_COL_SHIFT        7
+
+
+/*
+ * STRUCTS
+ */
+typedef struct {
+    uint8_t     reg_output;
+    uint8_t     reg_direction;
+    uint8_t     reg_control;
+    uint8_t     input;          // The levels presented to the port's pins
+} PIA_PORT;
+
+typedef struct {
+    PIA_PORT    a;
+    PIA_PORT    b;
+} PIA_VIRTUAL;
+
+typedef struct {
+    MC6883      sam;
+    PIA_VIRTUAL pia[2];
+    uint8_t     keyboard[DRAGON_KEY_COLS];
+    uint8_t     shifted_keys;   // Shifted characters held down
+    uint8_t     video_dirty[DIRTY_MAP_SIZE];
+    bool        is_halted;
+    uint16_t    line;
+    uint32_t    line_cycles;
+    uint32_t    frames;
+    uint64_t    cycles;
+    uint64_t    instructions;
+} STATE_DRAGON;
+
+
+/*
+ *      PROTOTYPES
+ */
+void        dragon_init(void);
+bool        dragon_load_rom(const uint8_t* data, uint32_t length);
+void        dragon_reset(void);
+uint32_t    dragon_run(uint32_t cycles);
+
+void        dragon_set_key(uint8_t row, uint8_t col, bool is_down);
+bool        dragon_set_ascii_key(char chr, bool is_down);
+
+uint8_t     dragon_get_vdg_mode(void);
+uint32_t    dragon_render(MC6847* vdg);
+bool        dragon_is_at_prompt(void);
+void        dragon_get_screen_text(char* text);
+
+
+#endif  // _DRAGON_HEADER_
@@ -0,0 +1,794 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * GDB remote serial protocol stub
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+// App
+#include "breakpoint.h"
+#include "cpu.h"
+#include "disasm.h"
+#include "gdb.h"
+
+
+/*
+ * STATICS
+ */
+static bool     poll_core(GDB* gdb);
+static void     end_packet(GDB* gdb);
+static void     do_packet(GDB* gdb);
+static void     do_query(GDB* gdb, const char* query);
+static void     do_monitor(GDB* gdb, const char* command);
+static void     do_breakpoint(GDB* gdb, const char* args, bool is_insert);
+static void     step(GDB* gdb);
+static void     resume(GDB* gdb, const char* address);
+static void     stop_reply(GDB* gdb, uint8_t kind);
+static void     send_stop(GDB* gdb);
+static void     send_packet(GDB* gdb, const char* data, uint32_t length);
+static void     send_text(GDB* gdb, const char* text);
+static void     send_console(GDB* gdb, const char* text);
+static uint32_t get_registers(char* out);
+static bool     set_registers(const char* in);
+static bool     set_register(uint8_t index, const char* in);
+static uint32_t put_hex(char* out, uint32_t value, uint8_t digits);
+static bool     get_hex(const char** in, uint32_t* value);
+static int8_t   hex_digit(char c);
+
+// Parser states
+#define STATE_IDLE                  0
+#define STATE_DATA                  1
+#define STATE_ESCAPE                2
+#define STATE_CHECKSUM              3
+
+// Register sizes in bytes, in the order of GDB_REGISTERS
+static const uint8_t REG_SIZES[GDB_REGISTERS] = {1, 1, 2, 2, 2, 2, 2, 1, 1};
+
+static const char TARGET_XML[] =
+    "<?xml version=\"1.0\"?><!DOCTYPE target SYSTEM \"gdb-target.dtd\">"
+    "<target version=\"1.0\"><feature name=\"org.e6809.cpu\">"
+    "<reg name=\"a\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"b\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"x\" bitsize=\"16\" type=\"data_ptr\"/>"
+    "<reg name=\"y\" bitsize=\"16\" type=\"data_ptr\"/>"
+    "<reg name=\"u\" bitsize=\"16\" type=\"data_ptr\"/>"
+    "<reg name=\"sp\" bitsize=\"16\" type=\"data_ptr\"/>"
+    "<reg name=\"pc\" bitsize=\"16\" type=\"code_ptr\"/>"
+    "<reg name=\"cc\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"dp\" bitsize=\"8\" type=\"uint8\"/>"
+    "</feature></target>";
+
+
+/*
+ * GLOBALS
+ */
+extern REG_6809     reg;
+extern BREAKPOINTS  breakpoints;
+
+// Replies are built here; the largest is a memory read
+static char         reply[GDB_MAX_PACKET + 4];
+
+
+/**
+ * @brief Prepare to serve a debugger.
+ *
+ * @param gdb:    Pointer to a GDB struct.
+ * @param memory: Pointer to the 64KB memory space.
+ * @param send:   Function that writes bytes to the debugger.
+ */
+void gdb_init(GDB* gdb, uint8_t* memory, void (*send)(const uint8_t* data, uint32_t length)) {
+
+    memset(gdb, 0, sizeof(GDB));
+    gdb->memory = memory;
+    gdb->send = send;
+    gdb->signal = GDB_SIGNAL_TRAP;
+}
+
+
+/**
+ * @brief Process bytes received from the debugger. Packets may be split
+ *        across calls at any point. Each is actioned, and answered, as
+ *        soon as it completes, except that 'c' only starts a run: the
+ *        stop is reported by gdb_poll().
+ *
+ * @param gdb:    Pointer to a GDB struct.
+ * @param data:   Pointer to the received bytes.
+ * @param length: The number of bytes.
+ */
+void gdb_feed(GDB* gdb, const uint8_t* data, uint32_t length) {
+
+    for (uint32_t i = 0 ; i < length ; ++i) {
+        char c = (char)data[i];
+        switch (gdb->state) {
+            case STATE_IDLE:
+                if (c == '$') {
+                    gdb->is_attached = true;
+                    gdb->length = 0;
+                    gdb->checksum = 0;
+                    gdb->state = STATE_DATA;
+                } else if (c == GDB_INTERRUPT && gdb->is_running) {
+                    if (gdb->core != NULL) {
+                        // Reported by gdb_poll() once the core has paused
+                        if (!gdb->is_stopping) gdb->is_stopping = core_send(gdb->core, CORE_CMD_PAUSE, 0, 0);
+                    } else {
+                        gdb->is_running = false;
+                        gdb->signal = GDB_SIGNAL_INT;
+                        send_stop(gdb);
+                    }
+                }
+
+                // Acknowledgements from the debugger need no action
+                break;
+
+            case STATE_DATA:
+            case STATE_ESCAPE:
+                if (c == '#' && gdb->state == STATE_DATA) {
+                    gdb->sum_count = 0;
+                    gdb->state = STATE_CHECKSUM;
+                    break;
+                }
+
+                gdb->checksum += (uint8_t)c;
+                if (gdb->state == STATE_ESCAPE) {
+                    // Binary data escapes '#', '$', '}' and '*' with '}', then the byte XOR 0x20
+                    c ^= 0x20;
+                    gdb->state = STATE_DATA;
+                } else if (c == '}') {
+                    gdb->state = STATE_ESCAPE;
+                    break;
+                }
+
+                // An overlong packet is read to its end, then rejected
+                if (gdb->length < GDB_MAX_PACKET) gdb->packet[gdb->length] = c;
+                gdb->length++;
+                break;
+
+            case STATE_CHECKSUM:
+                gdb->sum_digits[gdb->sum_count++] = c;
+                if (gdb->sum_count == 2) {
+                    end_packet(gdb);
+                    gdb->state = STATE_IDLE;
+                }
+        }
+    }
+}
+
+
+/**
+ * @brief Run the CPU for up to GDB_SLICE_CYCLES if the debugger has
+ *        continued it. Call this from the main loop: it returns quickly
+ *        so the debugger's interrupt is still seen. The run stops at a
+ *        breakpoint or watchpoint, or when the code returns to the
+ *        monitor, and the stop is reported. If the run is on a core,
+ *        this only checks whether it has stopped.
+ *
+ * @param gdb: Pointer to a GDB struct.
+ *
+ * @retval Whether a run is still in progress.
+ */
+bool gdb_poll(GDB* gdb) {
+
+    if (!gdb->is_running) return false;
+    if (gdb->core != NULL) return poll_core(gdb);
+
+    uint32_t (*step_op)(void) = breakpoint_is_armed() ? breakpoint_step : process_next_instruction;
+    uint32_t slice = 0;
+    while (slice < GDB_SLICE_CYCLES) {
+        uint32_t cycles = step_op();
+        if (cycles == BREAK_TO_MONITOR || cycles == BREAKPOINT_HIT) {
+            gdb->is_running = false;
+            stop_reply(gdb, cycles == BREAKPOINT_HIT ? breakpoints.hit_kind : 0);
+            return false;
+        }
+
+        // Count at least one cycle so a slice always ends
+        slice += cycles > 0 ? cycles : 1;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Report a run on the core once it has stopped. An interrupt's
+ *        pause is always answered, so if the run ends on its own first,
+ *        its reason is kept until the pause's event is in.
+ *
+ * @param gdb: Pointer to a GDB struct.
+ *
+ * @retval Whether the run is still in progress.
+ */
+static bool poll_core(GDB* gdb) {
+
+    MAILBOX_MSG event;
+    while (core_get_event(gdb->core, &event)) {
+        if (event.type != CORE_EVENT_STOPPED) continue;
+        if (event.arg != CORE_STOP_PAUSED) gdb->stop_reason = event.arg;
+        if (gdb->is_stopping && event.arg != CORE_STOP_PAUSED) continue;
+
+        // The core is idle now, so `reg` and `breakpoints` may be read
+        gdb->is_stopping = false;
+        gdb->is_running = false;
+        if (gdb->stop_reason == CORE_STOP_PAUSED) {
+            gdb->signal = GDB_SIGNAL_INT;
+            send_stop(gdb);
+        } else {
+            stop_reply(gdb, gdb->stop_reason == CORE_STOP_BREAKPOINT ? breakpoints.hit_kind : 0);
+        }
+
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Whether a debugger is attached, or has the CPU running, so
+ *        nothing else should set the registers or start a run.
+ *
+ * @param gdb: Pointer to a GDB struct.
+ *
+ * @retval `true` if the debugger owns the CPU, otherwise `false`.
+ */
+bool gdb_owns_cpu(const GDB* gdb) {
+
+    return gdb->is_attached || gdb->is_running;
+}
+
+
+/**
+ * @brief Check a completed packet's checksum, acknowledge it and, if
+ *        good, action it.
+ *
+ * @param gdb: Pointer to a GDB struct.
+ */
+static void end_packet(GDB* gdb) {
+
+    int8_t high = hex_digit(gdb->sum_digits[0]);
+    int8_t low = hex_digit(gdb->sum_digits[1]);
+    bool is_good = high >= 0 && low >= 0 && ((high << 4) | low) == gdb->checksum && gdb->length <= GDB_MAX_PACKET;
+
+    if (!gdb->is_no_ack) gdb->send((const uint8_t*)(is_good ? "+" : "-"), 1);
+    if (!is_good) {
+        gdb->bad_packets++;
+        return;
+    }
+
+    gdb->packet[gdb->length] = '\0';
+    do_packet(gdb);
+}
+
+
+/**
+ * @brief Action a packet and answer it. Unsupported packets get an
+ *        empty reply, as the protocol requires.
+ *
+ * @param gdb: Pointer to a GDB struct.
+ */
+static void do_packet(GDB* gdb) {
+
+    const char* args = &gdb->packet[1];
+    uint32_t address = 0;
+    uint32_t count = 0;
+
+    // A run on the core owns the CPU: only an interrupt may reach it
+    if (gdb->core != NULL && gdb->is_running) {
+        send_text(gdb, "E01");
+        return;
+    }
+
+    switch (gdb->packet[0]) {
+        case '?':
+            send_stop(gdb);
+            return;
+
+        case 'g':
+            send_packet(gdb, reply, get_registers(reply));
+            return;
+
+        case 'G':
+            send_text(gdb, set_registers(args) ? "OK" : "E01");
+            return;
+
+        case 'p':
+        {
+            if (!get_hex(&args, &address) || address >= GDB_REGISTERS) break;
+
+            // Each register's hex follows the previous ones'
+            uint32_t offset = 0;
+            get_registers(reply);
+            for (uint8_t i = 0 ; i < address ; ++i) offset += REG_SIZES[i] * 2;
+            send_packet(gdb, &reply[offset], REG_SIZES[address] * 2);
+            return;
+        }
+
+        case 'P':
+            if (!get_hex(&args, &address) || *args++ != '=' || address >= GDB_REGISTERS) break;
+            send_text(gdb, set_register(address, args) ? "OK" : "E01");
+            return;
+
+        case 'm':
+        {
+            if (!get_hex(&args, &address) || *args++ != ',' || !get_hex(&args, &count)) break;
+            if (count > GDB_MAX_PACKET / 2) count = GDB_MAX_PACKET / 2;
+            for (uint32_t i = 0 ; i < count ; ++i) put_hex(&reply[i * 2], gdb->memory[(address + i) & 0xFFFF], 2);
+            send_packet(gdb, reply, count * 2);
+            return;
+        }
+
+        case 'M':
+        {
+            if (!get_hex(&args, &address) || *args++ != ',' || !get_hex(&args, &count) || *args++ != ':') break;
+            if (strlen(args) != count * 2) break;
+            uint32_t i = 0;
+            while (i < count * 2 && hex_digit(args[i]) >= 0) i++;
+            if (i < count * 2) break;
+
+            for (i = 0 ; i < count ; ++i) {
+                gdb->memory[(address + i) & 0xFFFF] = (uint8_t)((hex_digit(args[i * 2]) << 4) | hex_digit(args[i * 2 + 1]));
+            }
+
+            cpu_mark_dirty((uint16_t)address, count);
+            send_text(gdb, "OK");
+            return;
+        }
+
+        case 'X':
+        {
+            // Binary data, unescaped by gdb_feed()
+            if (!get_hex(&args, &address) || *args++ != ',' || !get_hex(&args, &count) || *args++ != ':') break;
+            if ((uint32_t)(&gdb->packet[gdb->length] - args) != count) break;
+            for (uint32_t i = 0 ; i < count ; ++i) gdb->memory[(address + i) & 0xFFFF] = (uint8_t)args[i];
+            cpu_mark_dirty((uint16_t)address, count);
+            send_text(gdb, "OK");
+            return;
+        }
+
+        case 's':
+            if (*args != '\0') {
+                if (!get_hex(&args, &address)) break;
+                reg.pc = (uint16_t)address;
+            }
+
+            step(gdb);
+            return;
+
+        case 'c':
+            resume(gdb, args);
+            return;
+
+        case 'Z':
+        case 'z':
+            do_breakpoint(gdb, args, gdb->packet[0] == 'Z');
+            return;
+
+        case 'q':
+        case 'Q':
+            do_query(gdb, gdb->packet);
+            return;
+
+        case 'H':
+        case 'T':
+            // There is one thread
+            send_text(gdb, "OK");
+            return;
+
+        case 'D':
+        case 'k':
+            // Leave the CPU as it is, with the debugger's breakpoints gone
+            gdb->is_running = false;
+            breakpoint_clear_all();
+            if (gdb->packet[0] == 'D') send_text(gdb, "OK");
+            gdb->is_attached = false;
+            gdb->is_no_ack = false;
+            return;
+
+        default:
+            send_text(gdb, "");
+            return;
+    }
+
+    // Packets that break out of the switch are malformed
+    send_text(gdb, "E01");
+}
+
+
+/**
+ * @brief Answer a 'q' or 'Q' packet.
+ *
+ * @param gdb:   Pointer to a GDB struct.
+ * @param query: The packet.
+ */
+static void do_query(GDB* gdb, const char* query) {
+
+    if (strncmp(query, "qSupported", 10) == 0) {
+        snprintf(reply, sizeof(reply), "PacketSize=%X;qXfer:features:read+;QStartNoAckMode+", GDB_MAX_PACKET);
+        send_text(gdb, reply);
+    } else if (strcmp(query, "QStartNoAckMode") == 0) {
+        // The reply is still acknowledged
+        send_text(gdb, "OK");
+        gdb->is_no_ack = true;
+    } else if (strcmp(query, "qAttached") == 0) {
+        send_text(gdb, "1");
+    } else if (strcmp(query, "qC") == 0) {
+        send_text(gdb, "QC1");
+    } else if (strcmp(query, "qfThreadInfo") == 0) {
+        send_text(gdb, "m1");
+    } else if (strcmp(query, "qsThreadInfo") == 0) {
+        send_text(gdb, "l");
+    } else if (strncmp(query, "qXfer:features:read:target.xml:", 31) == 0) {
+        const char* args = &query[31];
+        uint32_t offset = 0;
+        uint32_t length = 0;
+        if (!get_hex(&args, &offset) || *args++ != ',' || !get_hex(&args, &length)) {
+            send_text(gdb, "E01");
+            return;
+        }
+
+        // 'm' if there is more to read, 'l' for the last part
+        uint32_t size = sizeof(TARGET_XML) - 1;
+        if (offset > size) offset = size;
+        if (length > GDB_MAX_PACKET - 1) length = GDB_MAX_PACKET - 1;
+        if (length > size - offset) length = size - offset;
+        reply[0] = offset + length < size ? 'm' : 'l';
+        memcpy(&reply[1], &TARGET_XML[offset], length);
+        send_packet(gdb, reply, length + 1);
+    } else if (strncmp(query, "qRcmd,", 6) == 0) {
+        // 'monitor' commands arrive hex-encoded
+        const char* hex = &query[6];
+        char command[64];
+        uint32_t length = 0;
+        while (hex[0] != '\0' && hex[1] != '\0' && length < sizeof(command) - 1) {
+            if (hex_digit(hex[0]) < 0 || hex_digit(hex[1]) < 0) break;
+            command[length++] = (char)((hex_digit(hex[0]) << 4) | hex_digit(hex[1]));
+            hex += 2;
+        }
+
+        command[length] = '\0';
+        do_monitor(gdb, command);
+    } else {
+        send_text(gdb, "");
+    }
+}
+
+
+/**
+ * @brief Run a 'monitor' command, sending its output to the debugger's
+ *        console. `dis [address] [count]` disassembles, by default ten
+ *        ops from the PC.
+ *
+ * @param gdb:     Pointer to a GDB struct.
+ * @param command: The command text.
+ */
+static void do_monitor(GDB* gdb, const char* command) {
+
+    if (strncmp(command, "dis", 3) != 0 || (command[3] != '\0' && command[3] != ' ')) {
+        send_console(gdb, "Commands: dis [address] [count]\n");
+        send_text(gdb, "OK");
+        return;
+    }
+
+    const char* args = &command[3];
+    uint32_t address = reg.pc;
+    uint32_t count = 10;
+    while (*args == ' ') args++;
+    if (*args != '\0') {
+        if (args[0] == '0' && (args[1] == 'x' || args[1] == 'X')) args += 2;
+        get_hex(&args, &address);
+        while (*args == ' ') args++;
+        if (*args != '\0') get_hex(&args, &count);
+    }
+
+    // Copy each op's bytes so ops at the top of memory wrap round
+    char text[DISASM_TEXT_SIZE];
+    char line[DISASM_TEXT_SIZE + 32];
+    for (uint32_t i = 0 ; i < count && i < 64 ; ++i) {
+        uint8_t bytes[DISASM_MAX_BYTES];
+        for (uint8_t j = 0 ; j < DISASM_MAX_BYTES ; ++j) bytes[j] = gdb->memory[(address + j) & 0xFFFF];
+        uint8_t length = disasm(bytes, (uint16_t)address, text);
+        snprintf(line, sizeof(line), "%04X  %s\n", address & 0xFFFF, text);
+        send_console(gdb, line);
+        address += length;
+    }
+
+    send_text(gdb, "OK");
+}
+
+
+/**
+ * @brief Insert or remove a breakpoint or watchpoint: 'Z' or 'z', then
+ *        type, address, and kind -- for watchpoints, the length watched.
+ *
+ * @param gdb:       Pointer to a GDB struct.
+ * @param args:      The packet after the 'Z' or 'z'.
+ * @param is_insert: `true` for 'Z', `false` for 'z'.
+ */
+static void do_breakpoint(GDB* gdb, const char* args, bool is_insert) {
+
+    static const uint8_t KINDS[] = {
+        BREAKPOINT_EXECUTE, BREAKPOINT_EXECUTE, BREAKPOINT_WRITE, BREAKPOINT_READ, BREAKPOINT_READ | BREAKPOINT_WRITE
+    };
+
+    uint32_t type = 0;
+    uint32_t address = 0;
+    uint32_t length = 0;
+    if (!get_hex(&args, &type) || *args++ != ',' || !get_hex(&args, &address) || *args++ != ',' || !get_hex(&args, &length)) {
+        send_text(gdb, "E01");
+        return;
+    }
+
+    if (type > 4 || address > 0xFFFF) {
+        send_text(gdb, "");
+        return;
+    }
+
+    uint8_t kinds = KINDS[type];
+    uint8_t index = breakpoint_find((uint16_t)address, kinds);
+    if (!is_insert) {
+        breakpoint_clear(index);
+        send_text(gdb, "OK");
+        return;
+    }
+
+    // Software and hardware breakpoints are alike here
+    if (index == BREAKPOINT_NONE) {
+        uint32_t end = address + (type > 1 && length > 0 ? length - 1 : 0);
+        BREAKPOINT breakpoint = {(uint16_t)address, (uint16_t)(end > 0xFFFF ? 0xFFFF : end), kinds,
+                                 BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_ALWAYS, 0, 0, 0, 0, false};
+        index = breakpoint_set(&breakpoint);
+    }
+
+    send_text(gdb, index != BREAKPOINT_NONE ? "OK" : "E0E");
+}
+
+
+/**
+ * @brief Run one op, with the breakpoint at the PC, if any, passed, and
+ *        report the stop.
+ *
+ * @param gdb: Pointer to a GDB struct.
+ */
+static void step(GDB* gdb) {
+
+    uint8_t kind = 0;
+    if (breakpoint_is_armed()) {
+        breakpoint_resume();
+        if (breakpoint_step() == BREAKPOINT_HIT) kind = breakpoints.hit_kind;
+    } else {
+        process_next_instruction();
+    }
+
+    stop_reply(gdb, kind);
+}
+
+
+/**
+ * @brief Start a run, from an address if one is given. The run itself
+ *        happens in gdb_poll(), or on the core.
+ *
+ * @param gdb:     Pointer to a GDB struct.
+ * @param address: The packet after the 'c'.
+ */
+static void resume(GDB* gdb, const char* address) {
+
+    uint32_t pc = 0;
+    if (*address != '\0' && get_hex(&address, &pc)) reg.pc = (uint16_t)pc;
+
+    if (gdb->core != NULL) {
+        // The core passes the breakpoint the run starts from
+        if (!core_send(gdb->core, CORE_CMD_RUN, 0, 0)) {
+            send_text(gdb, "E01");
+            return;
+        }
+
+        gdb->stop_reason = CORE_STOP_PAUSED;
+    } else {
+        // Don't stop at the breakpoint the run starts from
+        breakpoint_resume();
+    }
+
+    gdb->is_running = true;
+}
+
+
+/**
+ * @brief Note a stop with SIGTRAP and report it. A watchpoint's report
+ *        names the address hit; it is only made once.
+ *
+ * @param gdb:  Pointer to a GDB struct.
+ * @param kind: The BREAKPOINT_* kind of any breakpoint hit, or 0.
+ */
+static void stop_reply(GDB* gdb, uint8_t kind) {
+
+    gdb->signal = GDB_SIGNAL_TRAP;
+    uint32_t length = (uint32_t)snprintf(reply, sizeof(reply), "T%02x", gdb->signal);
+    if (kind == BREAKPOINT_READ || kind == BREAKPOINT_WRITE) {
+        // GDB matches the report to the kind of watchpoint it set
+        uint8_t kinds = breakpoints.entries[breakpoints.hit_index].kinds;
+        const char* name = kinds == (BREAKPOINT_READ | BREAKPOINT_WRITE) ? "awatch" : (kind == BREAKPOINT_READ ? "rwatch" : "watch");
+        length += (uint32_t)snprintf(&reply[length], sizeof(reply) - length, "%s:%04x;", name, breakpoints.hit_address);
+    }
+
+    send_packet(gdb, reply, length);
+}
+
+
+/**
+ * @brief Report the last stop's signal.
+ *
+ * @param gdb: Pointer to a GDB struct.
+ */
+static void send_stop(GDB* gdb) {
+
+    uint32_t length = (uint32_t)snprintf(reply, sizeof(reply), "S%02x", gdb->signal);
+    send_packet(gdb, reply, length);
+}
+
+
+/**
+ * @brief Send a packet: '$', the data, '#' and the checksum.
+ *
+ * @param gdb:    Pointer to a GDB struct.
+ * @param data:   The packet data.
+ * @param length: The number of data bytes.
+ */
+static void send_packet(GDB* gdb, const char* data, uint32_t length) {
+
+    uint8_t checksum = 0;
+    for (uint32_t i = 0 ; i < length ; ++i) checksum += (uint8_t)data[i];
+
+    char tail[3] = {'#', 0, 0};
+    put_hex(&tail[1], checksum, 2);
+    gdb->send((const uint8_t*)"$", 1);
+    if (length > 0) gdb->send((const uint8_t*)data, length);
+    gdb->send((const uint8_t*)tail, 3);
+}
+
+
+/**
+ * @brief Send a string as a packet.
+ */
+static void send_text(GDB* gdb, const char* text) {
+
+    send_packet(gdb, text, (uint32_t)strlen(text));
+}
+
+
+/**
+ * @brief Write text to the debugger's console with an 'O' packet.
+ */
+static void send_console(GDB* gdb, const char* text) {
+
+    char packet[DISASM_TEXT_SIZE * 2 + 66];
+    uint32_t length = 1;
+    packet[0] = 'O';
+    while (*text != '\0' && length < sizeof(packet) - 2) length += put_hex(&packet[length], (uint8_t)*text++, 2);
+    send_packet(gdb, packet, length);
+}
+
+
+/**
+ * @brief Write the registers as hex, in GDB_REGISTERS order.
+ *
+ * @param out: Pointer to GDB_REGS_SIZE * 2 chars.
+ *
+ * @retval The number of chars written.
+ */
+static uint32_t get_registers(char* out) {
+
+    uint16_t values[GDB_REGISTERS] = {reg.a, reg.b, reg.x, reg.y, reg.u, reg.s, reg.pc, reg.cc, reg.dp};
+    uint32_t length = 0;
+    for (uint8_t i = 0 ; i < GDB_REGISTERS ; ++i) length += put_hex(&out[length], values[i], REG_SIZES[i] * 2);
+    return length;
+}
+
+
+/**
+ * @brief Set every register from hex, as laid out by get_registers().
+ *
+ * @param in: The hex.
+ *
+ * @retval Whether the hex was good.
+ */
+static bool set_registers(const char* in) {
+
+    // Check it all first, so bad hex changes nothing
+    if (strlen(in) != GDB_REGS_SIZE * 2) return false;
+    for (uint8_t i = 0 ; i < GDB_REGS_SIZE * 2 ; ++i) {
+        if (hex_digit(in[i]) < 0) return false;
+    }
+
+    for (uint8_t i = 0 ; i < GDB_REGISTERS ; ++i) {
+        set_register(i, in);
+        in += REG_SIZES[i] * 2;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Set one register from its big-endian hex.
+ *
+ * @param index: The register's place in GDB_REGISTERS order.
+ * @param in:    The hex.
+ *
+ * @retval Whether the hex was good.
+ */
+static bool set_register(uint8_t index, const char* in) {
+
+    uint32_t value = 0;
+    for (uint8_t i = 0 ; i < REG_SIZES[index] * 2 ; ++i) {
+        int8_t digit = hex_digit(in[i]);
+        if (digit < 0) return false;
+        value = (value << 4) | digit;
+    }
+
+    switch (index) {
+        case 0: reg.a = (uint8_t)value; break;
+        case 1: reg.b = (uint8_t)value; break;
+        case 2: reg.x = (uint16_t)value; break;
+        case 3: reg.y = (uint16_t)value; break;
+        case 4: reg.u = (uint16_t)value; break;
+        case 5: reg.s = (uint16_t)value; break;
+        case 6: reg.pc = (uint16_t)value; break;
+        case 7: reg.cc = (uint8_t)value; break;
+        default: reg.dp = (uint8_t)value;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Write a value as hex digits, most significant first.
+ *
+ * @retval The number of digits written.
+ */
+static uint32_t put_hex(char* out, uint32_t value, uint8_t digits) {
+
+    static const char HEX[] = "0123456789abcdef";
+    for (uint8_t i = 0 ; i < digits ; ++i) out[i] = HEX[(value >> ((digits - 1 - i) * 4)) & 0x0F];
+    return digits;
+}
+
+
+/**
+ * @brief Read hex digits, leaving the pointer after them.
+ *
+ * @retval Whether there was at least one digit.
+ */
+static bool get_hex(const char** in, uint32_t* value) {
+
+    const char* start = *in;
+    *value = 0;
+    while (hex_digit(**in) >= 0) {
+        *value = (*value << 4) | hex_digit(**in);
+        (*in)++;
+    }
+
+    return *in != start;
+}
+
+
+/**
+ * @brief Get a hex digit's value.
+ *
+ * @retval The value, or -1 if the char is not a hex digit.
+ */
+static int8_t hex_digit(char c) {
+
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
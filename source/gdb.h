@@ -0,0 +1,81 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * GDB remote serial protocol stub
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _GDB_HEADER_
+#define _GDB_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "core.h"
+
+
+/*
+ *      CONSTANTS
+ */
+// Packets: '$', data, '#', two hex digits of the data's checksum. Each
+// is acknowledged with '+', or '-' to ask for it again, unless the
+// debugger has switched acknowledgements off. A 0x03 byte outside a
+// packet interrupts a run
+#define GDB_MAX_PACKET              1024
+#define GDB_INTERRUPT               0x03
+
+// Registers, as the target description lays them out: A, B, X, Y, U,
+// S, PC, CC, DP, each sent as big-endian hex
+#define GDB_REGISTERS               9
+#define GDB_REGS_SIZE               14
+
+#define GDB_SIGNAL_INT              2
+#define GDB_SIGNAL_TRAP             5
+
+// Most cycles gdb_poll() will run in one call, so the caller's loop
+// keeps servicing its input while code runs. Runs given to a core are
+// not sliced: gdb_poll() just looks for their end
+#define GDB_SLICE_CYCLES            2000
+
+
+/*
+ * STRUCTS
+ */
+typedef struct {
+    uint8_t*    memory;
+    void        (*send)(const uint8_t* data, uint32_t length);
+    // Packet parser state
+    uint8_t     state;
+    char        packet[GDB_MAX_PACKET + 1];
+    uint32_t    length;
+    uint8_t     checksum;
+    char        sum_digits[2];
+    uint8_t     sum_count;
+    uint32_t    bad_packets;
+    // Session state
+    bool        is_attached;    // Set by the first packet, cleared by 'D' and 'k'
+    bool        is_no_ack;
+    bool        is_running;
+    uint8_t     signal;         // Of the last stop
+    CORE*       core;           // If set, runs go to this core, not gdb_poll()
+    bool        is_stopping;    // The core has been asked to pause
+    uint8_t     stop_reason;    // CORE_STOP_* of a run on the core
+} GDB;
+
+
+/*
+ *      PROTOTYPES
+ */
+void        gdb_init(GDB* gdb, uint8_t* memory, void (*send)(const uint8_t* data, uint32_t length));
+void        gdb_feed(GDB* gdb, const uint8_t* data, uint32_t length);
+bool        gdb_poll(GDB* gdb);
+bool        gdb_owns_cpu(const GDB* gdb);
+
+
+#endif  // _GDB_HEADER_
@@ -0,0 +1,68 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Hardware abstraction layer: the GPIO, I2C, SPI, timing, flash and
+ * stdio calls the emulator makes, implemented for the RP2040 in
+ * hal_rp2040.c and for Linux in host/hal_linux.c
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _HAL_HEADER_
+#define _HAL_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*
+ *      CONSTANTS
+ */
+#define HAL_GPIO_COUNT              30
+
+// Returned by hal_stdio_get() when no character arrived in time
+#define HAL_NO_CHAR                 -1
+// Returned by the bus calls when the device does not respond
+#define HAL_BUS_ERROR               -1
+
+// Flash is erased in sectors, so writes must start on a sector
+// boundary and cover whole sectors
+#define HAL_FLASH_SECTOR_SIZE       4096
+#define HAL_FLASH_SIZE              2097152
+
+
+/*
+ *      PROTOTYPES
+ */
+// GPIO
+void        hal_gpio_init(uint8_t pin, bool is_output);
+void        hal_gpio_set_dir(uint8_t pin, bool is_output);
+void        hal_gpio_pull(uint8_t pin, bool is_up);
+void        hal_gpio_put(uint8_t pin, bool is_high);
+bool        hal_gpio_get(uint8_t pin);
+void        hal_gpio_irq_falling(uint8_t pin, void (*callback)(uint8_t pin));
+// I2C, on the board's bus
+void        hal_i2c_init(uint8_t sda_pin, uint8_t scl_pin, uint32_t baud_rate);
+void        hal_i2c_deinit(void);
+int         hal_i2c_write(uint8_t address, const uint8_t* data, uint32_t count, bool no_stop);
+int         hal_i2c_read(uint8_t address, uint8_t* data, uint32_t count, bool no_stop);
+// SPI, on the board's bus: clock and transmit only
+void        hal_spi_init(uint8_t sck_pin, uint8_t tx_pin, uint32_t baud_rate);
+int         hal_spi_write(const uint8_t* data, uint32_t count);
+// Timing
+uint32_t    hal_time_us(void);
+void        hal_sleep_ms(uint32_t ms);
+// Flash, by offset from the start of the chip
+void        hal_flash_read(uint32_t offset, uint8_t* data, uint32_t count);
+void        hal_flash_write(uint32_t offset, const uint8_t* data, uint32_t count);
+// Stdio
+int         hal_stdio_get(uint32_t timeout_us);
+
+
+#endif  // _HAL_HEADER_
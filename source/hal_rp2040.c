@@ -0,0 +1,196 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Hardware abstraction layer: RP2040
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <string.h>
+// Pico
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "hardware/gpio.h"
+#include "hardware/i2c.h"
+#include "hardware/spi.h"
+#include "hardware/sync.h"
+// App
+#include "hal.h"
+
+
+/*
+ * STATICS
+ */
+static void gpio_irq(uint gpio, uint32_t events);
+
+
+/*
+ * GLOBALS
+ */
+// The SDK has one GPIO callback for all pins
+static void (*gpio_falling_callback)(uint8_t pin) = NULL;
+
+
+/*
+ *      GPIO
+ */
+void hal_gpio_init(uint8_t pin, bool is_output) {
+
+    gpio_init(pin);
+    gpio_set_dir(pin, is_output ? GPIO_OUT : GPIO_IN);
+}
+
+
+void hal_gpio_set_dir(uint8_t pin, bool is_output) {
+
+    gpio_set_dir(pin, is_output ? GPIO_OUT : GPIO_IN);
+}
+
+
+void hal_gpio_pull(uint8_t pin, bool is_up) {
+
+    if (is_up) {
+        gpio_pull_up(pin);
+    } else {
+        gpio_pull_down(pin);
+    }
+}
+
+
+void hal_gpio_put(uint8_t pin, bool is_high) {
+
+    gpio_put(pin, is_high);
+}
+
+
+bool hal_gpio_get(uint8_t pin) {
+
+    return gpio_get(pin);
+}
+
+
+/**
+ * @brief Call a function, in interrupt context, when a pin falls.
+ *        NOTE One callback serves every pin.
+ */
+void hal_gpio_irq_falling(uint8_t pin, void (*callback)(uint8_t pin)) {
+
+    gpio_falling_callback = callback;
+    gpio_set_irq_enabled_with_callback(pin, GPIO_IRQ_EDGE_FALL, true, &gpio_irq);
+}
+
+
+static void gpio_irq(uint gpio, uint32_t events) {
+
+    (void)events;
+    if (gpio_falling_callback != NULL) gpio_falling_callback((uint8_t)gpio);
+}
+
+
+/*
+ *      BUSES
+ */
+void hal_i2c_init(uint8_t sda_pin, uint8_t scl_pin, uint32_t baud_rate) {
+
+    i2c_init(i2c0, baud_rate);
+    gpio_set_function(sda_pin, GPIO_FUNC_I2C);
+    gpio_set_function(scl_pin, GPIO_FUNC_I2C);
+    gpio_pull_up(sda_pin);
+    gpio_pull_up(scl_pin);
+}
+
+
+void hal_i2c_deinit(void) {
+
+    i2c_deinit(i2c0);
+}
+
+
+int hal_i2c_write(uint8_t address, const uint8_t* data, uint32_t count, bool no_stop) {
+
+    int result = i2c_write_blocking(i2c0, address, data, count, no_stop);
+    return result < 0 ? HAL_BUS_ERROR : result;
+}
+
+
+int hal_i2c_read(uint8_t address, uint8_t* data, uint32_t count, bool no_stop) {
+
+    int result = i2c_read_blocking(i2c0, address, data, count, no_stop);
+    return result < 0 ? HAL_BUS_ERROR : result;
+}
+
+
+void hal_spi_init(uint8_t sck_pin, uint8_t tx_pin, uint32_t baud_rate) {
+
+    spi_init(spi0, baud_rate);
+    gpio_set_function(sck_pin, GPIO_FUNC_SPI);
+    gpio_set_function(tx_pin, GPIO_FUNC_SPI);
+}
+
+
+int hal_spi_write(const uint8_t* data, uint32_t count) {
+
+    return spi_write_blocking(spi0, data, count);
+}
+
+
+/*
+ *      TIMING
+ */
+uint32_t hal_time_us(void) {
+
+    return time_us_32();
+}
+
+
+void hal_sleep_ms(uint32_t ms) {
+
+    sleep_ms(ms);
+}
+
+
+/*
+ *      FLASH
+ */
+
+/**
+ * @brief Read flash through the XIP window.
+ *
+ * @param offset: The first byte, from the start of flash.
+ * @param data:   Where to put the bytes.
+ * @param count:  The number of bytes.
+ */
+void hal_flash_read(uint32_t offset, uint8_t* data, uint32_t count) {
+
+    memcpy(data, (const uint8_t*)(XIP_BASE + offset), count);
+}
+
+
+/**
+ * @brief Erase and program whole sectors. Interrupts are off while
+ *        flash is busy, as code cannot run from it meanwhile.
+ *        See https://kevinboone.me/picoflash.html?i=1
+ *
+ * @param offset: The first byte, a multiple of HAL_FLASH_SECTOR_SIZE.
+ * @param data:   The bytes to write.
+ * @param count:  The number of bytes, a multiple of HAL_FLASH_SECTOR_SIZE.
+ */
+void hal_flash_write(uint32_t offset, const uint8_t* data, uint32_t count) {
+
+    uint32_t irqs = save_and_disable_interrupts();
+    flash_range_erase(offset, count);
+    flash_range_program(offset, data, count);
+    restore_interrupts(irqs);
+}
+
+
+/*
+ *      STDIO
+ */
+int hal_stdio_get(uint32_t timeout_us) {
+
+    int c = getchar_timeout_us(timeout_us);
+    return c == PICO_ERROR_TIMEOUT ? HAL_NO_CHAR : c;
+}
@@ -0,0 +1,190 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Memory access heatmap: while it is on, cpu.c counts each memory
+ * access into the tables here, by page and, if storage was supplied,
+ * by address; this code switches it and exports the counts
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+// App
+#include "cpu.h"
+#include "heatmap.h"
+
+
+/*
+ * STATICS
+ */
+static uint32_t get_count(uint8_t kind, uint32_t address);
+static uint32_t get_level(uint32_t count);
+
+
+/*
+ * GLOBALS
+ */
+HEATMAP     heatmap;
+
+extern MEMORY_MAP_6809  memory_map;
+
+
+/**
+ * @brief Start counting accesses. Counts carry on from where they
+ *        were; call heatmap_reset() to zero them.
+ *
+ * @param cells: Storage for per-address counts, or NULL for page counts only.
+ */
+void heatmap_start(uint32_t (*cells)[HEATMAP_ADDRESSES]) {
+
+    heatmap.cells = cells;
+    memory_map.heatmap = &heatmap;
+    update_observers();
+}
+
+
+/**
+ * @brief Stop counting accesses. Unless data watchpoints are set, the
+ *        CPU is then back to a single flag check per read or write.
+ */
+void heatmap_stop(void) {
+
+    memory_map.heatmap = NULL;
+    update_observers();
+}
+
+
+/**
+ * @brief Check whether accesses are being counted.
+ *
+ * @retval `true` if the heatmap is on, otherwise `false`.
+ */
+bool heatmap_is_on(void) {
+
+    return memory_map.heatmap != NULL;
+}
+
+
+/**
+ * @brief Zero every counter.
+ */
+void heatmap_reset(void) {
+
+    memset(heatmap.pages, 0, sizeof(heatmap.pages));
+    if (heatmap.cells != NULL) memset(heatmap.cells, 0, HEATMAP_KINDS * sizeof(*heatmap.cells));
+}
+
+
+/**
+ * @brief Copy part of the serialised page counters, as laid out in heatmap.h.
+ *
+ * @param offset: The first byte to copy.
+ * @param data:   Pointer to the destination.
+ * @param count:  The number of bytes wanted.
+ *
+ * @retval The number of bytes copied: fewer than `count` at the end.
+ */
+uint32_t heatmap_read(uint32_t offset, uint8_t* data, uint32_t count) {
+
+    if (offset >= HEATMAP_SIZE) return 0;
+    if (count > HEATMAP_SIZE - offset) count = HEATMAP_SIZE - offset;
+
+    for (uint32_t i = 0 ; i < count ; ++i) {
+        uint32_t index = (offset + i) >> 2;
+        uint32_t word = heatmap.pages[index >> 8][index & 0xFF];
+        data[i] = (word >> (8 * (3 - ((offset + i) & 3)))) & 0xFF;
+    }
+
+    return count;
+}
+
+
+/**
+ * @brief Write the counts as CSV: a line per address, or per page if
+ *        there are no per-address counts. Untouched addresses and
+ *        pages are skipped.
+ *
+ * @param out: Function that writes CSV text.
+ */
+void heatmap_csv(void (*out)(const char* text, uint32_t length)) {
+
+    char line[64];
+    bool by_address = heatmap.cells != NULL;
+    uint32_t length = snprintf(line, sizeof(line), "%s,fetches,reads,writes\n", by_address ? "address" : "page");
+    out(line, length);
+
+    for (uint32_t i = 0 ; i < (by_address ? HEATMAP_ADDRESSES : HEATMAP_PAGES) ; ++i) {
+        uint32_t fetches = by_address ? heatmap.cells[HEATMAP_FETCH][i] : heatmap.pages[HEATMAP_FETCH][i];
+        uint32_t reads = by_address ? heatmap.cells[HEATMAP_READ][i] : heatmap.pages[HEATMAP_READ][i];
+        uint32_t writes = by_address ? heatmap.cells[HEATMAP_WRITE][i] : heatmap.pages[HEATMAP_WRITE][i];
+        if (fetches == 0 && reads == 0 && writes == 0) continue;
+
+        length = snprintf(line, sizeof(line), by_address ? "0x%04X,%u,%u,%u\n" : "0x%02X,%u,%u,%u\n", i, fetches, reads, writes);
+        out(line, length);
+    }
+}
+
+
+/**
+ * @brief Write the counts as a 256x256 binary PPM image, one pixel per
+ *        address and a row per page. Writes are red, reads green and
+ *        fetches blue, each scaled logarithmically to its busiest
+ *        address. With page counts only, each row is a single colour.
+ *
+ * @param out: Function that writes the image data.
+ */
+void heatmap_ppm(void (*out)(const char* text, uint32_t length)) {
+
+    char row[HEATMAP_IMAGE_SIZE * 3];
+    uint32_t top[HEATMAP_KINDS] = {0, 0, 0};
+    for (uint8_t kind = 0 ; kind < HEATMAP_KINDS ; ++kind) {
+        for (uint32_t i = 0 ; i < HEATMAP_ADDRESSES ; ++i) {
+            uint32_t level = get_level(get_count(kind, i));
+            if (level > top[kind]) top[kind] = level;
+        }
+    }
+
+    uint32_t length = snprintf(row, sizeof(row), "P6\n%u %u\n255\n", HEATMAP_IMAGE_SIZE, HEATMAP_IMAGE_SIZE);
+    out(row, length);
+
+    for (uint32_t page = 0 ; page < HEATMAP_PAGES ; ++page) {
+        for (uint32_t i = 0 ; i < HEATMAP_IMAGE_SIZE ; ++i) {
+            for (uint8_t kind = 0 ; kind < HEATMAP_KINDS ; ++kind) {
+                uint32_t level = get_level(get_count(kind, (page << 8) | i));
+                uint8_t* pixel = (uint8_t*)&row[i * 3 + (HEATMAP_WRITE - kind)];
+                *pixel = top[kind] > 0 ? level * 255 / top[kind] : 0;
+            }
+        }
+
+        out(row, sizeof(row));
+    }
+}
+
+
+/**
+ * @brief Get an address's count, or its page's if there are no per-address counts.
+ */
+static uint32_t get_count(uint8_t kind, uint32_t address) {
+
+    return heatmap.cells != NULL ? heatmap.cells[kind][address] : heatmap.pages[kind][address >> 8];
+}
+
+
+/**
+ * @brief Scale a count logarithmically: log2(count + 1) in sixteenths.
+ */
+static uint32_t get_level(uint32_t count) {
+
+    uint64_t value = (uint64_t)count + 1;
+    uint32_t bits = 0;
+    while ((value >> bits) > 1) bits++;
+
+    // Interpolate within the power of two using the bits below the top one
+    uint32_t fraction = bits >= 4 ? (value >> (bits - 4)) & 0x0F : (value << (4 - bits)) & 0x0F;
+    return (bits << 4) | fraction;
+}
@@ -0,0 +1,67 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Memory access heatmap
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _HEATMAP_HEADER_
+#define _HEATMAP_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*
+ *      CONSTANTS
+ */
+// Access kinds: op and operand bytes fetched through the PC, then data
+// reads and writes through get_byte() and set_byte()
+#define HEATMAP_FETCH               0
+#define HEATMAP_READ                1
+#define HEATMAP_WRITE               2
+#define HEATMAP_KINDS               3
+
+#define HEATMAP_PAGES               256
+#define HEATMAP_ADDRESSES           65536
+
+// heatmap_read() serialises the page counters as big-endian 32-bit
+// words, pages[kind][page] in index order
+#define HEATMAP_SIZE                (HEATMAP_KINDS * HEATMAP_PAGES * 4)
+
+// heatmap_ppm() draws one pixel per address, a row per page: red for
+// writes, green for reads, blue for fetches, each on a log scale
+#define HEATMAP_IMAGE_SIZE          256
+
+
+/*
+ * STRUCTS
+ */
+// Page counters are always kept. Per-address counters take 768KB, so
+// are only kept if the caller supplies the storage, eg. on the host
+typedef struct {
+    uint32_t    pages[HEATMAP_KINDS][HEATMAP_PAGES];
+    uint32_t    (*cells)[HEATMAP_ADDRESSES];            // [HEATMAP_KINDS][HEATMAP_ADDRESSES], or NULL
+} HEATMAP;
+
+
+/*
+ *      PROTOTYPES
+ */
+void        heatmap_start(uint32_t (*cells)[HEATMAP_ADDRESSES]);
+void        heatmap_stop(void);
+bool        heatmap_is_on(void);
+void        heatmap_reset(void);
+uint32_t    heatmap_read(uint32_t offset, uint8_t* data, uint32_t count);
+void        heatmap_csv(void (*out)(const char* text, uint32_t length));
+void        heatmap_ppm(void (*out)(const char* text, uint32_t length));
+
+
+#endif  // _HEATMAP_HEADER_
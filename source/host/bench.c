@@ -0,0 +1,590 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Emulator benchmark: runs each workload for a fixed number of emulated
+ * cycles and reports the speed, overall and by opcode class, as text
+ * and, for tracking across commits, JSON
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+// App
+#include "main.h"
+#include "cpu.h"
+#include "profile.h"
+#include "trace.h"
+#include "bench.h"
+
+
+/*
+ *      CONSTANTS
+ */
+#define BENCH_DEFAULT_CYCLES        10000000
+#define BENCH_DEFAULT_RUNS          3
+#define BENCH_CALIBRATION_STEPS     1000000
+#define BENCH_MAX_WORKLOADS         16
+
+
+/*
+ * STATICS
+ */
+static bool     prepare(const BENCH_WORKLOAD* workload);
+static void     run_timed(const BENCH_WORKLOAD* workload, uint64_t cycles, BENCH_RUN* run);
+static void     run_profiled(const BENCH_WORKLOAD* workload, uint64_t cycles, BENCH_CLASS* classes);
+static double   calibrate(void);
+static uint32_t step_none(void);
+static void     raise_interrupts(const BENCH_WORKLOAD* workload, uint64_t cycles, uint64_t* next_irq, uint64_t* next_firq);
+static void     count_interrupt(uint16_t pc, BENCH_RUN* run);
+static uint8_t  classify(uint16_t pc);
+static bool     is_swi(uint16_t pc);
+static void     print_classes(const BENCH_CLASS* classes);
+static void     write_json(FILE* file, const char* tag, uint64_t cycles);
+#ifdef E6809_PROFILE
+static void     write_profile(const char* text, uint32_t length);
+#endif
+static double   get_seconds(void);
+static uint64_t get_ticks(void);
+static void     show_help(void);
+
+
+/*
+ * GLOBALS
+ */
+extern REG_6809         reg;
+extern uint8_t          mem[KB64];
+extern STATE_6809       state;
+extern MEMORY_MAP_6809  memory_map;
+
+static const char* CLASS_NAMES[BENCH_CLASSES] = {"alu", "rmw", "load_store", "branch", "call",
+                                                 "stack", "lea", "transfer", "misc", "interrupt"};
+
+// Results, by workload, for the JSON output
+static const BENCH_WORKLOAD*    workloads;
+static uint32_t                 workload_count;
+static BENCH_RUN                runs[BENCH_MAX_WORKLOADS];
+static BENCH_CLASS              class_stats[BENCH_MAX_WORKLOADS][BENCH_CLASSES];
+static uint32_t                 iterations[BENCH_MAX_WORKLOADS];
+static bool                     is_run[BENCH_MAX_WORKLOADS];
+static bool                     is_good[BENCH_MAX_WORKLOADS];
+static bool                     is_short[BENCH_MAX_WORKLOADS];
+// Profiler clock rate
+static double                   ticks_per_ns = 1.0;
+// Opcode profile output
+static FILE*                    profile_file = NULL;
+// Trace the timed runs
+static bool                     is_tracing = false;
+
+
+/**
+ * @brief Run the benchmark workloads.
+ *
+ *        Usage: e6809_bench [-c cycles] [-n runs] [-w workload] [-d rom_file] [-j json_file] [-t tag] [-p profile_file] [-r] [-v]
+ *
+ * @retval 0 if every workload that ran passed its check, otherwise 1.
+ */
+int main(int argc, char* argv[]) {
+
+    uint64_t cycles = BENCH_DEFAULT_CYCLES;
+    uint32_t run_count = BENCH_DEFAULT_RUNS;
+    const char* only = NULL;
+    const char* json_path = NULL;
+    const char* profile_path = NULL;
+    const char* tag = "";
+    bool is_verbose = false;
+
+    for (int i = 1 ; i < argc ; ++i) {
+        if (strcmp(argv[i], "-c") == 0 && i < argc - 1) {
+            cycles = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-n") == 0 && i < argc - 1) {
+            run_count = (uint32_t)strtoul(argv[++i], NULL, 10);
+            if (run_count == 0) run_count = 1;
+        } else if (strcmp(argv[i], "-w") == 0 && i < argc - 1) {
+            only = argv[++i];
+        } else if (strcmp(argv[i], "-d") == 0 && i < argc - 1) {
+            bench_set_rom(argv[++i]);
+        } else if (strcmp(argv[i], "-j") == 0 && i < argc - 1) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "-t") == 0 && i < argc - 1) {
+            tag = argv[++i];
+        } else if (strcmp(argv[i], "-p") == 0 && i < argc - 1) {
+            profile_path = argv[++i];
+        } else if (strcmp(argv[i], "-r") == 0) {
+            is_tracing = true;
+        } else if (strcmp(argv[i], "-v") == 0) {
+            is_verbose = true;
+        } else {
+            show_help();
+            return strcmp(argv[i], "-h") == 0 ? 0 : 1;
+        }
+    }
+
+    if (profile_path != NULL) {
+#ifdef E6809_PROFILE
+        profile_file = fopen(profile_path, "w");
+        if (profile_file == NULL) {
+            fprintf(stderr, "[ERROR] Cannot create %s\n", profile_path);
+            return 1;
+        }
+#else
+        fprintf(stderr, "[ERROR] -p needs a build configured with -DE6809_PROFILE=ON\n");
+        return 1;
+#endif
+    }
+
+#ifndef E6809_TRACE
+    if (is_tracing) {
+        fprintf(stderr, "[ERROR] -r needs a build configured with -DE6809_TRACE=ON\n");
+        return 1;
+    }
+#endif
+
+    workloads = bench_get_workloads(&workload_count);
+    double overhead = calibrate();
+    bool is_ok = true;
+    BENCH_CLASS totals[BENCH_CLASSES];
+    memset(totals, 0, sizeof(totals));
+
+    printf("%-12s %8s %12s %12s %9s %7s %7s %9s  %s\n",
+           "Workload", "Passes", "Instructions", "Cycles", "ms", "MIPS", "MHz", "ns/instr", "Check");
+
+    for (uint32_t w = 0 ; w < workload_count ; ++w) {
+        const BENCH_WORKLOAD* workload = &workloads[w];
+        if (only != NULL && strcmp(only, workload->name) != 0) continue;
+
+        // Best of the timed runs, then a profiled run for the class breakdown
+        BENCH_RUN best;
+        for (uint32_t r = 0 ; r < run_count ; ++r) {
+            if (!prepare(workload)) break;
+            BENCH_RUN run;
+#ifdef E6809_PROFILE
+            profile_reset();
+#endif
+            run_timed(workload, cycles, &run);
+            if (r == 0 || run.seconds < best.seconds) best = run;
+            is_run[w] = true;
+            iterations[w] = workload->code != NULL ? bench_get_iterations() : 0;
+            is_short[w] = workload->code != NULL && iterations[w] == 0;
+            is_good[w] = !run.is_broken && !is_short[w] && workload->check(&run);
+            if (!is_good[w]) break;
+        }
+
+        if (!is_run[w]) {
+            printf("%-12s skipped\n", workload->name);
+            continue;
+        }
+
+        runs[w] = best;
+#ifdef E6809_PROFILE
+        // The opcode profile of the last timed run
+        if (profile_file != NULL) {
+            fprintf(profile_file, "%s== %s: ", ftell(profile_file) > 0 ? "\n" : "", workload->name);
+            profile_report(write_profile);
+        }
+#endif
+
+        if (is_good[w] && prepare(workload)) {
+            run_profiled(workload, cycles, class_stats[w]);
+            for (uint32_t c = 0 ; c < BENCH_CLASSES ; ++c) {
+                BENCH_CLASS* stats = &class_stats[w][c];
+                stats->ns -= overhead * stats->instructions;
+                if (stats->ns < 0.0) stats->ns = 0.0;
+                totals[c].instructions += stats->instructions;
+                totals[c].cycles += stats->cycles;
+                totals[c].ns += stats->ns;
+            }
+        }
+
+        is_ok = is_ok && is_good[w];
+        char passes[16] = "-";
+        if (workload->code != NULL) snprintf(passes, sizeof(passes), "%u", iterations[w]);
+        printf("%-12s %8s %12llu %12llu %9.2f %7.2f %7.2f %9.2f  %s\n",
+               workload->name, passes, (unsigned long long)best.instructions, (unsigned long long)best.cycles,
+               best.seconds * 1000.0, best.instructions / best.seconds / 1e6, best.cycles / best.seconds / 1e6,
+               best.seconds * 1e9 / best.instructions,
+               is_good[w] ? "ok" : (is_short[w] ? "FAILED: no full pass, raise -c" : "FAILED"));
+        if (is_verbose && is_good[w]) print_classes(class_stats[w]);
+    }
+
+    printf("\nBy opcode class, all workloads (profiler overhead of %.1f ns per instruction removed):\n", overhead);
+    print_classes(totals);
+
+    if (json_path != NULL) {
+        FILE* file = fopen(json_path, "w");
+        if (file == NULL) {
+            fprintf(stderr, "[ERROR] Cannot create %s\n", json_path);
+            return 1;
+        }
+
+        write_json(file, tag, cycles);
+        fclose(file);
+    }
+
+    if (profile_file != NULL) fclose(profile_file);
+
+    return is_ok ? 0 : 1;
+}
+
+
+/**
+ * @brief Reset the CPU and load a workload.
+ *
+ * @param workload: The workload.
+ *
+ * @retval Whether the workload is ready to run.
+ */
+static bool prepare(const BENCH_WORKLOAD* workload) {
+
+    if (workload->code != NULL) {
+        // Flat 64KB RAM, cleared, with the code at BENCH_ORIGIN
+        memory_map = (MEMORY_MAP_6809){KB64, KB64, NULL, NULL, NULL, NULL, NULL, NULL, false};
+        memset(mem, 0, KB64);
+        memcpy(&mem[BENCH_ORIGIN], workload->code, workload->length);
+        init_cpu();
+        reg.pc = workload->entry;
+        reg.s = BENCH_STACK;
+        reg.cc = 0x50;
+    }
+
+    return workload->setup == NULL || workload->setup();
+}
+
+
+/**
+ * @brief Run a workload for a number of cycles, timing the run.
+ *
+ * @param workload: The workload, prepared.
+ * @param cycles:   The number of emulated cycles to run.
+ * @param run:      Where to record the run.
+ */
+static void run_timed(const BENCH_WORKLOAD* workload, uint64_t cycles, BENCH_RUN* run) {
+
+    uint32_t (*step)(void) = workload->step != NULL ? workload->step : process_next_instruction;
+    uint64_t next_irq = workload->irq_period;
+    uint64_t next_firq = workload->firq_period;
+    memset(run, 0, sizeof(BENCH_RUN));
+
+#ifdef E6809_TRACE
+    if (is_tracing) trace_start();
+#endif
+
+    double start = get_seconds();
+    while (run->cycles < cycles) {
+        raise_interrupts(workload, run->cycles, &next_irq, &next_firq);
+
+        uint16_t pc = reg.pc;
+        uint8_t depth = state.interrupt_depth;
+        uint32_t used = step();
+        if (used == BREAK_TO_MONITOR) {
+            run->is_broken = true;
+            break;
+        }
+
+        if (state.interrupt_depth > depth) count_interrupt(pc, run);
+        run->instructions++;
+        run->cycles += used;
+
+#ifdef E6809_TRACE
+        // Empty the ring well before it fills, without encoding, so
+        // only the CPU's side of tracing is timed
+        if (is_tracing && (run->instructions & 0xFF) == 0) trace_discard();
+#endif
+    }
+
+    run->seconds = get_seconds() - start;
+
+#ifdef E6809_TRACE
+    if (is_tracing) {
+        trace_stop();
+        trace_discard();
+        if (trace_dropped() > 0) run->is_broken = true;
+    }
+#endif
+}
+
+
+/**
+ * @brief Run a workload again, timing every instruction and totting
+ *        up the times by opcode class.
+ *
+ * @param workload: The workload, prepared.
+ * @param cycles:   The number of emulated cycles to run.
+ * @param classes:  BENCH_CLASSES records to fill.
+ */
+static void run_profiled(const BENCH_WORKLOAD* workload, uint64_t cycles, BENCH_CLASS* classes) {
+
+    uint32_t (*step)(void) = workload->step != NULL ? workload->step : process_next_instruction;
+    uint64_t next_irq = workload->irq_period;
+    uint64_t next_firq = workload->firq_period;
+    uint64_t cycles_run = 0;
+    memset(classes, 0, sizeof(BENCH_CLASS) * BENCH_CLASSES);
+
+    uint64_t last = get_ticks();
+    while (cycles_run < cycles) {
+        raise_interrupts(workload, cycles_run, &next_irq, &next_firq);
+
+        uint16_t pc = reg.pc;
+        uint8_t depth = state.interrupt_depth;
+        uint8_t class = classify(pc);
+        uint32_t used = step();
+        if (used == BREAK_TO_MONITOR) break;
+        if (state.interrupt_depth > depth && !is_swi(pc)) class = BENCH_CLASS_INTERRUPT;
+
+        uint64_t now = get_ticks();
+        classes[class].instructions++;
+        classes[class].cycles += used;
+        classes[class].ns += (now - last) / ticks_per_ns;
+        last = now;
+        cycles_run += used;
+    }
+}
+
+
+/**
+ * @brief Set the profiler clock's rate, then time the profiler's own
+ *        work per instruction by running its loop with a step that
+ *        does nothing.
+ *
+ * @retval The overhead in ns per instruction.
+ */
+static double calibrate(void) {
+
+    static const BENCH_WORKLOAD idle = {"idle", NULL, 0, 0, 0, 0, NULL, step_none, NULL};
+    BENCH_CLASS classes[BENCH_CLASSES];
+
+    double start = get_seconds();
+    uint64_t ticks = get_ticks();
+    while (get_seconds() - start < 0.05) {}
+    ticks_per_ns = (get_ticks() - ticks) / ((get_seconds() - start) * 1e9);
+
+    memset(mem, 0, KB64);
+    run_profiled(&idle, BENCH_CALIBRATION_STEPS, classes);
+
+    double ns = 0.0;
+    for (uint32_t c = 0 ; c < BENCH_CLASSES ; ++c) ns += classes[c].ns;
+    return ns / BENCH_CALIBRATION_STEPS;
+}
+
+
+static uint32_t step_none(void) {
+
+    return 1;
+}
+
+
+/**
+ * @brief Assert IRQ and FIRQ at the workload's intervals.
+ */
+static void raise_interrupts(const BENCH_WORKLOAD* workload, uint64_t cycles, uint64_t* next_irq, uint64_t* next_firq) {
+
+    if (workload->irq_period > 0 && cycles >= *next_irq) {
+        state.interrupts |= (1 << IRQ_BIT);
+        *next_irq += workload->irq_period;
+    }
+
+    if (workload->firq_period > 0 && cycles >= *next_firq) {
+        state.interrupts |= (1 << FIRQ_BIT);
+        *next_firq += workload->firq_period;
+    }
+}
+
+
+/**
+ * @brief Record an interrupt taken, telling it from an SWI by the op
+ *        at the old PC and an IRQ from a FIRQ by where the CPU went.
+ */
+static void count_interrupt(uint16_t pc, BENCH_RUN* run) {
+
+    if (is_swi(pc)) return;
+    if (reg.pc == ((mem[IRQ_VECTOR] << 8) | mem[IRQ_VECTOR + 1])) run->irqs++;
+    if (reg.pc == ((mem[FIRQ_VECTOR] << 8) | mem[FIRQ_VECTOR + 1])) run->firqs++;
+}
+
+
+/**
+ * @brief Get the class of the op at an address.
+ *
+ * @param pc: The op's address.
+ *
+ * @retval The class, BENCH_CLASS_ALU to BENCH_CLASS_MISC.
+ */
+static uint8_t classify(uint16_t pc) {
+
+    uint8_t op = mem[pc];
+    while (op == OPCODE_EXTENDED_1 || op == OPCODE_EXTENDED_2) op = mem[++pc];
+
+    uint8_t msn = op >> 4;
+    uint8_t lsn = op & 0x0F;
+    switch (msn) {
+        case 0x0:
+        case 0x4:
+        case 0x5:
+        case 0x6:
+        case 0x7:
+            // JMP shares its column with the RMW ops
+            return lsn == 0x0E ? BENCH_CLASS_BRANCH : BENCH_CLASS_RMW;
+        case 0x1:
+            if (op == 0x16) return BENCH_CLASS_BRANCH;
+            if (op == 0x17) return BENCH_CLASS_CALL;
+            if (op == 0x1E || op == 0x1F) return BENCH_CLASS_TRANSFER;
+            return BENCH_CLASS_MISC;
+        case 0x2:
+            return BENCH_CLASS_BRANCH;
+        case 0x3:
+            if (lsn < 0x04) return BENCH_CLASS_LEA;
+            if (lsn < 0x08) return BENCH_CLASS_STACK;
+            if (op == 0x39 || op == 0x3B || op == 0x3F) return BENCH_CLASS_CALL;
+            if (op == 0x3A || op == 0x3D) return BENCH_CLASS_ALU;
+            return BENCH_CLASS_MISC;
+        default:
+            // 0x80-0xBF are the A-side and X/Y ops, 0xC0-0xFF the B-side,
+            // D and U/S ops
+            if (lsn == 0x06 || lsn == 0x07) return BENCH_CLASS_LOAD_STORE;
+            if (lsn < 0x0C) return BENCH_CLASS_ALU;
+            if (msn < 0xC) {
+                if (lsn == 0x0C) return BENCH_CLASS_ALU;
+                if (lsn == 0x0D) return BENCH_CLASS_CALL;
+            }
+            return BENCH_CLASS_LOAD_STORE;
+    }
+}
+
+
+static bool is_swi(uint16_t pc) {
+
+    uint8_t op = mem[pc];
+    while (op == OPCODE_EXTENDED_1 || op == OPCODE_EXTENDED_2) op = mem[++pc];
+    return op == 0x3F;
+}
+
+
+/**
+ * @brief Print a class breakdown.
+ *
+ * @param classes: BENCH_CLASSES records.
+ */
+static void print_classes(const BENCH_CLASS* classes) {
+
+    uint64_t total = 0;
+    for (uint32_t c = 0 ; c < BENCH_CLASSES ; ++c) total += classes[c].instructions;
+    if (total == 0) return;
+
+    for (uint32_t c = 0 ; c < BENCH_CLASSES ; ++c) {
+        const BENCH_CLASS* stats = &classes[c];
+        if (stats->instructions == 0) continue;
+        printf("    %-12s %12llu instructions %5.1f%% %6.2f cycles/instr %8.2f ns/instr\n",
+               CLASS_NAMES[c], (unsigned long long)stats->instructions, stats->instructions * 100.0 / total,
+               (double)stats->cycles / stats->instructions, stats->ns / stats->instructions);
+    }
+}
+
+
+/**
+ * @brief Write the results as JSON.
+ *
+ * @param file:   The output.
+ * @param tag:    A label for the build, eg. a commit hash.
+ * @param cycles: The cycles each workload ran for.
+ */
+static void write_json(FILE* file, const char* tag, uint64_t cycles) {
+
+    fprintf(file, "{\n  \"version\": \"%s\",\n  \"build\": %d,\n  \"tag\": \"%s\",\n  \"cycles\": %llu,\n  \"workloads\": [",
+            APP_VERSION, BUILD_NUM, tag, (unsigned long long)cycles);
+
+    bool is_first = true;
+    for (uint32_t w = 0 ; w < workload_count ; ++w) {
+        if (!is_run[w]) continue;
+        const BENCH_RUN* run = &runs[w];
+        fprintf(file, "%s\n    {\"name\": \"%s\", \"ok\": %s, \"passes\": %u, \"instructions\": %llu, \"cycles\": %llu, "
+                "\"seconds\": %.6f, \"mips\": %.3f, \"mhz\": %.3f, \"ns_per_instruction\": %.3f, \"classes\": {",
+                is_first ? "" : ",", workloads[w].name, is_good[w] ? "true" : "false", iterations[w],
+                (unsigned long long)run->instructions, (unsigned long long)run->cycles, run->seconds,
+                run->instructions / run->seconds / 1e6, run->cycles / run->seconds / 1e6,
+                run->seconds * 1e9 / run->instructions);
+        is_first = false;
+
+        bool is_first_class = true;
+        for (uint32_t c = 0 ; c < BENCH_CLASSES ; ++c) {
+            const BENCH_CLASS* stats = &class_stats[w][c];
+            if (stats->instructions == 0) continue;
+            fprintf(file, "%s\n      \"%s\": {\"instructions\": %llu, \"cycles\": %llu, \"ns_per_instruction\": %.3f}",
+                    is_first_class ? "" : ",", CLASS_NAMES[c], (unsigned long long)stats->instructions,
+                    (unsigned long long)stats->cycles, stats->ns / stats->instructions);
+            is_first_class = false;
+        }
+
+        fprintf(file, "}}");
+    }
+
+    fprintf(file, "\n  ]\n}\n");
+}
+
+
+/**
+ * @brief Get a monotonic time stamp.
+ *
+ * @retval The time in seconds.
+ */
+static double get_seconds(void) {
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+/**
+ * @brief Get a cheap time stamp for the profiler: the TSC where there
+ *        is one, otherwise the monotonic clock in ns.
+ *
+ * @retval The time in ticks.
+ */
+static uint64_t get_ticks(void) {
+
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+#endif
+}
+
+
+static void show_help(void) {
+
+    printf("Usage: e6809_bench [-c cycles] [-n runs] [-w workload] [-d rom_file] [-j json_file] [-t tag] [-p profile_file] [-r] [-v]\n\n");
+    printf("  -c  Emulated cycles per workload. Default: %d\n", BENCH_DEFAULT_CYCLES);
+    printf("  -n  Timed runs per workload; the best is reported. Default: %d\n", BENCH_DEFAULT_RUNS);
+    printf("  -w  Run only the named workload\n");
+    printf("  -d  Dragon 32 ROM for the dragon_idle workload, which is skipped without one\n");
+    printf("  -j  Write the results as JSON to a file\n");
+    printf("  -t  A label for the JSON, eg. a commit hash\n");
+    printf("  -p  Write each workload's opcode profile to a file. Needs E6809_PROFILE\n");
+    printf("  -r  Trace the timed runs, emptying the ring unread, to time the CPU's side of tracing. Needs E6809_TRACE\n");
+    printf("  -v  Show each workload's opcode classes\n");
+}
+
+
+#ifdef E6809_PROFILE
+/**
+ * @brief Write opcode profile text to the -p file.
+ *
+ * @param text:   The text.
+ * @param length: Its length in bytes.
+ */
+static void write_profile(const char* text, uint32_t length) {
+
+    fwrite(text, 1, length, profile_file);
+}
+#endif
@@ -0,0 +1,87 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Emulator benchmark: workloads and run statistics
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _BENCH_HEADER_
+#define _BENCH_HEADER_
+
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*
+ *      CONSTANTS
+ */
+// Flat-memory workload layout. Each workload loops forever, adding
+// one to the big-endian 32-bit count at BENCH_ITERATIONS per pass
+#define BENCH_RESULT                0x0100
+#define BENCH_ITERATIONS            0x0110
+#define BENCH_COUNT                 0x0120
+#define BENCH_ORIGIN                0x1000
+#define BENCH_DATA                  0x2000
+#define BENCH_STACK                 0x8000
+
+// Opcode classes, for the per-class breakdown
+#define BENCH_CLASS_ALU             0       // Arithmetic and logic on registers
+#define BENCH_CLASS_RMW             1       // Read-modify-write, shifts, CLR, TST
+#define BENCH_CLASS_LOAD_STORE      2
+#define BENCH_CLASS_BRANCH          3       // Bcc, LBcc, JMP
+#define BENCH_CLASS_CALL            4       // BSR, JSR, RTS, RTI, SWI
+#define BENCH_CLASS_STACK           5       // PSHS, PULS, PSHU, PULU
+#define BENCH_CLASS_LEA             6
+#define BENCH_CLASS_TRANSFER        7       // TFR, EXG
+#define BENCH_CLASS_MISC            8       // NOP, SYNC, CWAI, ANDCC, ORCC, DAA, SEX
+#define BENCH_CLASS_INTERRUPT       9       // IRQ, FIRQ and NMI entry
+#define BENCH_CLASSES               10
+
+
+/*
+ * STRUCTS
+ */
+// What a run did, for the report and for a workload's check
+typedef struct {
+    uint64_t    instructions;
+    uint64_t    cycles;
+    uint64_t    irqs;
+    uint64_t    firqs;
+    double      seconds;
+    bool        is_broken;      // Code broke to the monitor
+} BENCH_RUN;
+
+typedef struct {
+    uint64_t    instructions;
+    uint64_t    cycles;
+    double      ns;             // Host time, less the profiler's own
+} BENCH_CLASS;
+
+typedef struct {
+    const char*     name;
+    const uint8_t*  code;           // Loaded at BENCH_ORIGIN
+    uint32_t        length;
+    uint16_t        entry;
+    uint32_t        irq_period;     // Cycles between IRQs; 0 for none
+    uint32_t        firq_period;    // Cycles between FIRQs; 0 for none
+    // A workload with its own machine supplies setup() and step(),
+    // which runs one instruction and returns its cycles
+    bool            (*setup)(void);
+    uint32_t        (*step)(void);
+    bool            (*check)(const BENCH_RUN* run);
+} BENCH_WORKLOAD;
+
+
+/*
+ *      PROTOTYPES
+ */
+const BENCH_WORKLOAD*   bench_get_workloads(uint32_t* count);
+void                    bench_set_rom(const char* path);
+uint32_t                bench_get_iterations(void);
+
+
+#endif  // _BENCH_HEADER_
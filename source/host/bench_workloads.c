@@ -0,0 +1,660 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Emulator benchmark workloads: hand-assembled 6809 code, the data
+ * each works on, and checks of its results against C equivalents, so
+ * a fast but wrong emulator fails the benchmark
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+// App
+#include "cpu.h"
+#include "crc.h"
+#include "dragon.h"
+#include "bench.h"
+
+
+/*
+ *      CONSTANTS
+ */
+#define SIEVE_SIZE                  8191
+#define CRC_LENGTH                  512
+#define COPY_LENGTH                 4096
+#define SORT_LENGTH                 256
+#define MULDIV_PAIRS                64
+#define CALL_DEPTH                  64
+
+#define INTERRUPTS_IRQ              0x1000
+#define INTERRUPTS_FIRQ             0x1009
+#define INTERRUPTS_START            0x1016
+#define INTERRUPTS_IRQ_PERIOD       100
+#define INTERRUPTS_FIRQ_PERIOD      250
+
+// Fields the BASIC ROM idles at its prompt before the run starts
+#define DRAGON_BOOT_FRAMES          500
+
+
+/*
+ * STATICS
+ */
+static void     fill_data(uint32_t length);
+static uint16_t get_word(uint16_t address);
+static bool     setup_data(void);
+static bool     setup_muldiv(void);
+static bool     setup_interrupts(void);
+static bool     setup_dragon(void);
+static uint32_t step_dragon(void);
+static bool     check_sieve(const BENCH_RUN* run);
+static bool     check_crc16(const BENCH_RUN* run);
+static bool     check_crc32(const BENCH_RUN* run);
+static bool     check_memcpy(const BENCH_RUN* run);
+static bool     check_sort(const BENCH_RUN* run);
+static bool     check_muldiv(const BENCH_RUN* run);
+static bool     check_calls(const BENCH_RUN* run);
+static bool     check_interrupts(const BENCH_RUN* run);
+static bool     check_dragon(const BENCH_RUN* run);
+
+
+/*
+ * GLOBALS
+ */
+extern REG_6809     reg;
+extern uint8_t      mem[KB64];
+extern STATE_DRAGON dragon;
+
+static const char*  rom_path = NULL;
+
+
+/*
+ * WORKLOADS
+ */
+// Sieve of Eratosthenes over 8191 byte flags at 0x2000, as in the
+// BYTE benchmark. The count of primes goes to RESULT
+static const uint8_t SIEVE[] = {
+    0x8E, 0x20, 0x00,               // start:   LDX   #FLAGS
+    0x86, 0x01,                     //          LDA   #1
+    0xA7, 0x80,                     // fill:    STA   ,X+
+    0x8C, 0x3F, 0xFF,               //          CMPX  #FLAGS+SIZE
+    0x26, 0xF9,                     //          BNE   fill
+    0x10, 0x8E, 0x00, 0x00,         //          LDY   #0
+    0x8E, 0x20, 0x00,               //          LDX   #FLAGS
+    0x6D, 0x84,                     // loop:    TST   ,X
+    0x27, 0x1A,                     //          BEQ   skip
+    0x1F, 0x10,                     //          TFR   X,D
+    0x83, 0x20, 0x00,               //          SUBD  #FLAGS
+    0x58,                           //          LSLB
+    0x49,                           //          ROLA
+    0xC3, 0x00, 0x03,               //          ADDD  #3
+    0x1F, 0x13,                     //          TFR   X,U
+    0x33, 0xCB,                     // strike:  LEAU  D,U
+    0x11, 0x83, 0x3F, 0xFF,         //          CMPU  #FLAGS+SIZE
+    0x24, 0x04,                     //          BHS   found
+    0x6F, 0xC4,                     //          CLR   ,U
+    0x20, 0xF4,                     //          BRA   strike
+    0x31, 0x21,                     // found:   LEAY  1,Y
+    0x30, 0x01,                     // skip:    LEAX  1,X
+    0x8C, 0x3F, 0xFF,               //          CMPX  #FLAGS+SIZE
+    0x26, 0xDB,                     //          BNE   loop
+    0x10, 0xBF, 0x01, 0x00,         //          STY   RESULT
+    0x7C, 0x01, 0x13,               //          INC   ITER+3
+    0x26, 0x0D,                     //          BNE   next
+    0x7C, 0x01, 0x12,               //          INC   ITER+2
+    0x26, 0x08,                     //          BNE   next
+    0x7C, 0x01, 0x11,               //          INC   ITER+1
+    0x26, 0x03,                     //          BNE   next
+    0x7C, 0x01, 0x10,               //          INC   ITER
+    0x7E, 0x10, 0x00                // next:    JMP   start
+};
+
+// CRC-16/CCITT, bit by bit, of the 512 bytes at 0x2000. The CRC
+// goes to RESULT
+static const uint8_t CRC16[] = {
+    0x8E, 0x20, 0x00,               // start:   LDX   #BUF
+    0xCC, 0xFF, 0xFF,               //          LDD   #$FFFF
+    0xA8, 0x80,                     // byte:    EORA  ,X+
+    0x10, 0x8E, 0x00, 0x08,         //          LDY   #8
+    0x58,                           // bit:     LSLB
+    0x49,                           //          ROLA
+    0x24, 0x04,                     //          BCC   noxor
+    0x88, 0x10,                     //          EORA  #$10
+    0xC8, 0x21,                     //          EORB  #$21
+    0x31, 0x3F,                     // noxor:   LEAY  -1,Y
+    0x26, 0xF4,                     //          BNE   bit
+    0x8C, 0x22, 0x00,               //          CMPX  #BUF+LEN
+    0x26, 0xE9,                     //          BNE   byte
+    0xFD, 0x01, 0x00,               //          STD   RESULT
+    0x7C, 0x01, 0x13,               //          INC   ITER+3
+    0x26, 0x0D,                     //          BNE   next
+    0x7C, 0x01, 0x12,               //          INC   ITER+2
+    0x26, 0x08,                     //          BNE   next
+    0x7C, 0x01, 0x11,               //          INC   ITER+1
+    0x26, 0x03,                     //          BNE   next
+    0x7C, 0x01, 0x10,               //          INC   ITER
+    0x7E, 0x10, 0x00                // next:    JMP   start
+};
+
+// CRC-32, bit by bit, of the 512 bytes at 0x2000, the CRC held
+// big-endian in direct page bytes 0-3. The CRC goes to RESULT
+static const uint8_t CRC32[] = {
+    0x8E, 0x20, 0x00,               // start:   LDX   #BUF
+    0xCC, 0xFF, 0xFF,               //          LDD   #$FFFF
+    0xDD, 0x00,                     //          STD   <0
+    0xDD, 0x02,                     //          STD   <2
+    0xA6, 0x80,                     // byte:    LDA   ,X+
+    0x98, 0x03,                     //          EORA  <3
+    0x97, 0x03,                     //          STA   <3
+    0xC6, 0x08,                     //          LDB   #8
+    0x04, 0x00,                     // bit:     LSR   <0
+    0x06, 0x01,                     //          ROR   <1
+    0x06, 0x02,                     //          ROR   <2
+    0x06, 0x03,                     //          ROR   <3
+    0x24, 0x18,                     //          BCC   noxor
+    0x96, 0x00,                     //          LDA   <0
+    0x88, 0xED,                     //          EORA  #$ED
+    0x97, 0x00,                     //          STA   <0
+    0x96, 0x01,                     //          LDA   <1
+    0x88, 0xB8,                     //          EORA  #$B8
+    0x97, 0x01,                     //          STA   <1
+    0x96, 0x02,                     //          LDA   <2
+    0x88, 0x83,                     //          EORA  #$83
+    0x97, 0x02,                     //          STA   <2
+    0x96, 0x03,                     //          LDA   <3
+    0x88, 0x20,                     //          EORA  #$20
+    0x97, 0x03,                     //          STA   <3
+    0x5A,                           // noxor:   DECB
+    0x26, 0xDB,                     //          BNE   bit
+    0x8C, 0x22, 0x00,               //          CMPX  #BUF+LEN
+    0x10, 0x26, 0xFF, 0xCC,         //          LBNE  byte
+    0x03, 0x00,                     //          COM   <0
+    0x03, 0x01,                     //          COM   <1
+    0x03, 0x02,                     //          COM   <2
+    0x03, 0x03,                     //          COM   <3
+    0xDC, 0x00,                     //          LDD   <0
+    0xFD, 0x01, 0x00,               //          STD   RESULT
+    0xDC, 0x02,                     //          LDD   <2
+    0xFD, 0x01, 0x02,               //          STD   RESULT+2
+    0x7C, 0x01, 0x13,               //          INC   ITER+3
+    0x26, 0x0D,                     //          BNE   next
+    0x7C, 0x01, 0x12,               //          INC   ITER+2
+    0x26, 0x08,                     //          BNE   next
+    0x7C, 0x01, 0x11,               //          INC   ITER+1
+    0x26, 0x03,                     //          BNE   next
+    0x7C, 0x01, 0x10,               //          INC   ITER
+    0x7E, 0x10, 0x00                // next:    JMP   start
+};
+
+// Fill 4KB at 0x3000 a word at a time, copy 4KB from 0x2000 over it
+// a word at a time, then copy that to 0x4000 a byte at a time
+static const uint8_t MEMCPY[] = {
+    0x8E, 0x30, 0x00,               // start:   LDX   #DST
+    0xCC, 0xA5, 0x5A,               //          LDD   #$A55A
+    0xED, 0x81,                     // set:     STD   ,X++
+    0x8C, 0x40, 0x00,               //          CMPX  #DST+$1000
+    0x26, 0xF9,                     //          BNE   set
+    0x8E, 0x20, 0x00,               //          LDX   #SRC
+    0x10, 0x8E, 0x30, 0x00,         //          LDY   #DST
+    0xEC, 0x81,                     // words:   LDD   ,X++
+    0xED, 0xA1,                     //          STD   ,Y++
+    0x8C, 0x30, 0x00,               //          CMPX  #SRC+$1000
+    0x26, 0xF7,                     //          BNE   words
+    0x8E, 0x30, 0x00,               //          LDX   #DST
+    0x10, 0x8E, 0x40, 0x00,         //          LDY   #OUT
+    0xA6, 0x80,                     // bytes:   LDA   ,X+
+    0xA7, 0xA0,                     //          STA   ,Y+
+    0x10, 0x8C, 0x50, 0x00,         //          CMPY  #OUT+$1000
+    0x26, 0xF6,                     //          BNE   bytes
+    0x7C, 0x01, 0x13,               //          INC   ITER+3
+    0x26, 0x0D,                     //          BNE   next
+    0x7C, 0x01, 0x12,               //          INC   ITER+2
+    0x26, 0x08,                     //          BNE   next
+    0x7C, 0x01, 0x11,               //          INC   ITER+1
+    0x26, 0x03,                     //          BNE   next
+    0x7C, 0x01, 0x10,               //          INC   ITER
+    0x7E, 0x10, 0x00                // next:    JMP   start
+};
+
+// Bubble sort a copy of the 256 bytes at 0x2000, then copy the
+// sorted bytes to 0x4000
+static const uint8_t SORT[] = {
+    0x8E, 0x20, 0x00,               // start:   LDX   #SRC
+    0x10, 0x8E, 0x30, 0x00,         //          LDY   #ARR
+    0xA6, 0x80,                     // copy:    LDA   ,X+
+    0xA7, 0xA0,                     //          STA   ,Y+
+    0x8C, 0x21, 0x00,               //          CMPX  #SRC+256
+    0x26, 0xF7,                     //          BNE   copy
+    0x0F, 0x00,                     // pass:    CLR   <0
+    0x8E, 0x30, 0x00,               //          LDX   #ARR
+    0xA6, 0x84,                     // compare: LDA   ,X
+    0xA1, 0x01,                     //          CMPA  1,X
+    0x23, 0x08,                     //          BLS   inorder
+    0xE6, 0x01,                     //          LDB   1,X
+    0xE7, 0x84,                     //          STB   ,X
+    0xA7, 0x01,                     //          STA   1,X
+    0x0C, 0x00,                     //          INC   <0
+    0x30, 0x01,                     // inorder: LEAX  1,X
+    0x8C, 0x30, 0xFF,               //          CMPX  #ARR+255
+    0x26, 0xEB,                     //          BNE   compare
+    0x0D, 0x00,                     //          TST   <0
+    0x26, 0xE2,                     //          BNE   pass
+    0x8E, 0x30, 0x00,               //          LDX   #ARR
+    0x10, 0x8E, 0x40, 0x00,         //          LDY   #OUT
+    0xEC, 0x81,                     // result:  LDD   ,X++
+    0xED, 0xA1,                     //          STD   ,Y++
+    0x8C, 0x31, 0x00,               //          CMPX  #ARR+256
+    0x26, 0xF7,                     //          BNE   result
+    0x7C, 0x01, 0x13,               //          INC   ITER+3
+    0x26, 0x0D,                     //          BNE   next
+    0x7C, 0x01, 0x12,               //          INC   ITER+2
+    0x26, 0x08,                     //          BNE   next
+    0x7C, 0x01, 0x11,               //          INC   ITER+1
+    0x26, 0x03,                     //          BNE   next
+    0x7C, 0x01, 0x10,               //          INC   ITER
+    0x7E, 0x10, 0x00                // next:    JMP   start
+};
+
+// 16 x 16-bit multiplies, built from MUL, and 16 / 16-bit shift-and-
+// subtract divides of the 64 operand pairs at 0x2000. Each pair's
+// product, quotient and remainder go to 0x3000. Both work in direct
+// page scratch bytes, so the results are only ever written whole
+static const uint8_t MULDIV[] = {
+    0x8E, 0x20, 0x00,               // start:   LDX   #OPS
+    0x10, 0x8E, 0x30, 0x00,         //          LDY   #OUT
+    0x8D, 0x20,                     // each:    BSR   mul16
+    0x8D, 0x55,                     //          BSR   div16
+    0x30, 0x04,                     //          LEAX  4,X
+    0x31, 0x28,                     //          LEAY  8,Y
+    0x8C, 0x21, 0x00,               //          CMPX  #OPS+256
+    0x26, 0xF3,                     //          BNE   each
+    0x7C, 0x01, 0x13,               //          INC   ITER+3
+    0x26, 0x0D,                     //          BNE   next
+    0x7C, 0x01, 0x12,               //          INC   ITER+2
+    0x26, 0x08,                     //          BNE   next
+    0x7C, 0x01, 0x11,               //          INC   ITER+1
+    0x26, 0x03,                     //          BNE   next
+    0x7C, 0x01, 0x10,               //          INC   ITER
+    0x7E, 0x10, 0x00,               // next:    JMP   start
+    0x0F, 0x04,                     // mul16:   CLR   <4
+    0x0F, 0x05,                     //          CLR   <5
+    0xA6, 0x01,                     //          LDA   1,X
+    0xE6, 0x03,                     //          LDB   3,X
+    0x3D,                           //          MUL
+    0xDD, 0x06,                     //          STD   <6
+    0xA6, 0x84,                     //          LDA   ,X
+    0xE6, 0x03,                     //          LDB   3,X
+    0x3D,                           //          MUL
+    0xD3, 0x05,                     //          ADDD  <5
+    0xDD, 0x05,                     //          STD   <5
+    0x24, 0x02,                     //          BCC   mul2
+    0x0C, 0x04,                     //          INC   <4
+    0xA6, 0x01,                     // mul2:    LDA   1,X
+    0xE6, 0x02,                     //          LDB   2,X
+    0x3D,                           //          MUL
+    0xD3, 0x05,                     //          ADDD  <5
+    0xDD, 0x05,                     //          STD   <5
+    0x24, 0x02,                     //          BCC   mul3
+    0x0C, 0x04,                     //          INC   <4
+    0xA6, 0x84,                     // mul3:    LDA   ,X
+    0xE6, 0x02,                     //          LDB   2,X
+    0x3D,                           //          MUL
+    0xD3, 0x04,                     //          ADDD  <4
+    0xDD, 0x04,                     //          STD   <4
+    0xDC, 0x04,                     //          LDD   <4
+    0xED, 0xA4,                     //          STD   ,Y
+    0xDC, 0x06,                     //          LDD   <6
+    0xED, 0x22,                     //          STD   2,Y
+    0x39,                           //          RTS
+    0xEC, 0x84,                     // div16:   LDD   ,X
+    0xDD, 0x02,                     //          STD   <2
+    0x86, 0x10,                     //          LDA   #16
+    0x97, 0x00,                     //          STA   <0
+    0x4F,                           //          CLRA
+    0x5F,                           //          CLRB
+    0x08, 0x03,                     // shift:   LSL   <3
+    0x09, 0x02,                     //          ROL   <2
+    0x59,                           //          ROLB
+    0x49,                           //          ROLA
+    0xA3, 0x02,                     //          SUBD  2,X
+    0x25, 0x04,                     //          BCS   restore
+    0x0C, 0x03,                     //          INC   <3
+    0x20, 0x02,                     //          BRA   count
+    0xE3, 0x02,                     // restore: ADDD  2,X
+    0x0A, 0x00,                     // count:   DEC   <0
+    0x26, 0xEC,                     //          BNE   shift
+    0xED, 0x26,                     //          STD   6,Y
+    0xDC, 0x02,                     //          LDD   <2
+    0xED, 0x24,                     //          STD   4,Y
+    0x39                            //          RTS
+};
+
+// Recurse 64 deep, each level stacking and restoring five registers
+// and counting itself in CALLS. A clobbered register on the way out
+// puts 0xFF in RESULT
+static const uint8_t CALLS[] = {
+    0x86, 0x40,                     // start:   LDA   #DEPTH
+    0x8E, 0x11, 0x11,               //          LDX   #$1111
+    0x10, 0x8E, 0x22, 0x22,         //          LDY   #$2222
+    0xCE, 0x33, 0x33,               //          LDU   #$3333
+    0x8D, 0x30,                     //          BSR   nest
+    0x81, 0x40,                     //          CMPA  #DEPTH
+    0x26, 0x25,                     //          BNE   fail
+    0x8C, 0x11, 0x11,               //          CMPX  #$1111
+    0x26, 0x20,                     //          BNE   fail
+    0x10, 0x8C, 0x22, 0x22,         //          CMPY  #$2222
+    0x26, 0x1A,                     //          BNE   fail
+    0x11, 0x83, 0x33, 0x33,         //          CMPU  #$3333
+    0x26, 0x14,                     //          BNE   fail
+    0x7C, 0x01, 0x13,               //          INC   ITER+3
+    0x26, 0x0D,                     //          BNE   next
+    0x7C, 0x01, 0x12,               //          INC   ITER+2
+    0x26, 0x08,                     //          BNE   next
+    0x7C, 0x01, 0x11,               //          INC   ITER+1
+    0x26, 0x03,                     //          BNE   next
+    0x7C, 0x01, 0x10,               //          INC   ITER
+    0x20, 0xC9,                     // next:    BRA   start
+    0x86, 0xFF,                     // fail:    LDA   #$FF
+    0xB7, 0x01, 0x00,               //          STA   RESULT
+    0x20, 0xFE,                     // halt:    BRA   halt
+    0x34, 0x76,                     // nest:    PSHS  U,Y,X,B,A
+    0xBE, 0x01, 0x20,               //          LDX   CALLS
+    0x30, 0x01,                     //          LEAX  1,X
+    0xBF, 0x01, 0x20,               //          STX   CALLS
+    0x10, 0x8E, 0x5A, 0x5A,         //          LDY   #$5A5A
+    0xCE, 0xA5, 0xA5,               //          LDU   #$A5A5
+    0x4A,                           //          DECA
+    0x27, 0x05,                     //          BEQ   leaf
+    0x8D, 0xEA,                     //          BSR   nest
+    0x35, 0x76,                     //          PULS  A,B,X,Y,U
+    0x39,                           //          RTS
+    0x35, 0xF6                      // leaf:    PULS  A,B,X,Y,U,PC
+};
+
+// A counting loop under a stream of IRQs and FIRQs, whose handlers
+// count themselves in TICKS and FTICKS
+static const uint8_t INTERRUPTS[] = {
+    0xBE, 0x01, 0x20,               // irq:     LDX   TICKS
+    0x30, 0x01,                     //          LEAX  1,X
+    0xBF, 0x01, 0x20,               //          STX   TICKS
+    0x3B,                           //          RTI
+    0x34, 0x02,                     // firq:    PSHS  A
+    0x7C, 0x01, 0x23,               //          INC   FTICKS+1
+    0x26, 0x03,                     //          BNE   done
+    0x7C, 0x01, 0x22,               //          INC   FTICKS
+    0x35, 0x02,                     // done:    PULS  A
+    0x3B,                           //          RTI
+    0x1C, 0xAF,                     // start:   ANDCC #$AF
+    0x7C, 0x01, 0x13,               // loop:    INC   ITER+3
+    0x26, 0x0D,                     //          BNE   next
+    0x7C, 0x01, 0x12,               //          INC   ITER+2
+    0x26, 0x08,                     //          BNE   next
+    0x7C, 0x01, 0x11,               //          INC   ITER+1
+    0x26, 0x03,                     //          BNE   next
+    0x7C, 0x01, 0x10,               //          INC   ITER
+    0x20, 0xEC                      // next:    BRA   loop
+};
+
+static const BENCH_WORKLOAD WORKLOADS[] = {
+    {"sieve",      SIEVE,      sizeof(SIEVE),      BENCH_ORIGIN,     0, 0, NULL,             NULL, check_sieve},
+    {"crc16",      CRC16,      sizeof(CRC16),      BENCH_ORIGIN,     0, 0, setup_data,       NULL, check_crc16},
+    {"crc32",      CRC32,      sizeof(CRC32),      BENCH_ORIGIN,     0, 0, setup_data,       NULL, check_crc32},
+    {"memcpy",     MEMCPY,     sizeof(MEMCPY),     BENCH_ORIGIN,     0, 0, setup_data,       NULL, check_memcpy},
+    {"sort",       SORT,       sizeof(SORT),       BENCH_ORIGIN,     0, 0, setup_data,       NULL, check_sort},
+    {"muldiv",     MULDIV,     sizeof(MULDIV),     BENCH_ORIGIN,     0, 0, setup_muldiv,     NULL, check_muldiv},
+    {"calls",      CALLS,      sizeof(CALLS),      BENCH_ORIGIN,     0, 0, NULL,             NULL, check_calls},
+    {"interrupts", INTERRUPTS, sizeof(INTERRUPTS), INTERRUPTS_START, INTERRUPTS_IRQ_PERIOD, INTERRUPTS_FIRQ_PERIOD,
+                   setup_interrupts, NULL, check_interrupts},
+    {"dragon_idle", NULL,      0,                  0,                0, 0, setup_dragon,     step_dragon, check_dragon},
+};
+
+
+/**
+ * @brief Get the workloads, in the order they run.
+ *
+ * @param count: Set to the number of workloads.
+ *
+ * @retval The workload table.
+ */
+const BENCH_WORKLOAD* bench_get_workloads(uint32_t* count) {
+
+    *count = sizeof(WORKLOADS) / sizeof(BENCH_WORKLOAD);
+    return WORKLOADS;
+}
+
+
+/**
+ * @brief Set the Dragon 32 ROM the dragon_idle workload boots.
+ *
+ * @param path: The ROM file's path, or NULL to skip the workload.
+ */
+void bench_set_rom(const char* path) {
+
+    rom_path = path;
+}
+
+
+/**
+ * @brief Get the number of passes a flat-memory workload has completed.
+ *
+ * @retval The count at BENCH_ITERATIONS.
+ */
+uint32_t bench_get_iterations(void) {
+
+    return ((uint32_t)get_word(BENCH_ITERATIONS) << 16) | get_word(BENCH_ITERATIONS + 2);
+}
+
+
+/*
+ * SETUP
+ */
+
+/**
+ * @brief Fill BENCH_DATA with repeatable pseudo-random bytes.
+ *
+ * @param length: The number of bytes.
+ */
+static void fill_data(uint32_t length) {
+
+    uint32_t seed = 0x6809;
+    for (uint32_t i = 0 ; i < length ; ++i) {
+        seed = seed * 1103515245 + 12345;
+        mem[BENCH_DATA + i] = (uint8_t)(seed >> 16);
+    }
+}
+
+
+static uint16_t get_word(uint16_t address) {
+
+    return (uint16_t)((mem[address] << 8) | mem[address + 1]);
+}
+
+
+static bool setup_data(void) {
+
+    fill_data(COPY_LENGTH);
+    return true;
+}
+
+
+/**
+ * @brief Operand pairs: any multiplicand, and divisors of 1-0x7FFF,
+ *        which the shift-and-subtract divide requires.
+ */
+static bool setup_muldiv(void) {
+
+    fill_data(MULDIV_PAIRS * 4);
+    for (uint32_t i = 0 ; i < MULDIV_PAIRS ; ++i) {
+        uint16_t address = BENCH_DATA + i * 4 + 2;
+        mem[address] &= 0x7F;
+        if (get_word(address) == 0) mem[address + 1] = 1;
+    }
+
+    return true;
+}
+
+
+static bool setup_interrupts(void) {
+
+    mem[IRQ_VECTOR] = INTERRUPTS_IRQ >> 8;
+    mem[IRQ_VECTOR + 1] = INTERRUPTS_IRQ & 0xFF;
+    mem[FIRQ_VECTOR] = INTERRUPTS_FIRQ >> 8;
+    mem[FIRQ_VECTOR + 1] = INTERRUPTS_FIRQ & 0xFF;
+    return true;
+}
+
+
+/**
+ * @brief Boot the Dragon 32 ROM to its prompt, where BASIC idles
+ *        polling the keyboard between field sync interrupts.
+ *
+ * @retval Whether the ROM reached its prompt.
+ */
+static bool setup_dragon(void) {
+
+    static uint8_t rom[DRAGON_ROM_SIZE];
+    if (rom_path == NULL) return false;
+
+    FILE* file = fopen(rom_path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "[ERROR] Cannot open %s\n", rom_path);
+        return false;
+    }
+
+    size_t count = fread(rom, 1, DRAGON_ROM_SIZE, file);
+    fclose(file);
+    if (count != DRAGON_ROM_SIZE) {
+        fprintf(stderr, "[ERROR] %s is not a %i-byte ROM image\n", rom_path, DRAGON_ROM_SIZE);
+        return false;
+    }
+
+    dragon_init();
+    dragon_load_rom(rom, DRAGON_ROM_SIZE);
+    dragon_reset();
+    while (dragon.frames < DRAGON_BOOT_FRAMES && !dragon_is_at_prompt()) dragon_run(DRAGON_CYCLES_PER_FIELD);
+    return dragon_is_at_prompt();
+}
+
+
+static uint32_t step_dragon(void) {
+
+    uint32_t cycles = dragon_run(1);
+    return dragon.is_halted ? BREAK_TO_MONITOR : cycles;
+}
+
+
+/*
+ * CHECKS
+ */
+static bool check_sieve(const BENCH_RUN* run) {
+
+    (void)run;
+    static uint8_t flags[SIEVE_SIZE];
+    memset(flags, 1, sizeof(flags));
+    uint16_t primes = 0;
+    for (uint32_t i = 0 ; i < SIEVE_SIZE ; ++i) {
+        if (flags[i]) {
+            uint32_t prime = i + i + 3;
+            for (uint32_t k = i + prime ; k < SIEVE_SIZE ; k += prime) flags[k] = 0;
+            primes++;
+        }
+    }
+
+    return get_word(BENCH_RESULT) == primes;
+}
+
+
+static bool check_crc16(const BENCH_RUN* run) {
+
+    (void)run;
+    uint16_t crc = 0xFFFF;
+    for (uint32_t i = 0 ; i < CRC_LENGTH ; ++i) {
+        crc ^= mem[BENCH_DATA + i] << 8;
+        for (uint8_t j = 0 ; j < 8 ; ++j) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+
+    return get_word(BENCH_RESULT) == crc;
+}
+
+
+static bool check_crc32(const BENCH_RUN* run) {
+
+    (void)run;
+    uint32_t crc = crc32(&mem[BENCH_DATA], CRC_LENGTH);
+    return get_word(BENCH_RESULT) == (crc >> 16) && get_word(BENCH_RESULT + 2) == (crc & 0xFFFF);
+}
+
+
+static bool check_memcpy(const BENCH_RUN* run) {
+
+    (void)run;
+    return memcmp(&mem[BENCH_DATA + 0x2000], &mem[BENCH_DATA], COPY_LENGTH) == 0;
+}
+
+
+static bool check_sort(const BENCH_RUN* run) {
+
+    (void)run;
+    uint32_t counts[256] = {0};
+    for (uint32_t i = 0 ; i < SORT_LENGTH ; ++i) counts[mem[BENCH_DATA + i]]++;
+
+    // The output must be in order and hold the same bytes
+    const uint8_t* sorted = &mem[BENCH_DATA + 0x2000];
+    for (uint32_t i = 0 ; i < SORT_LENGTH ; ++i) {
+        if (i > 0 && sorted[i] < sorted[i - 1]) return false;
+        if (counts[sorted[i]]-- == 0) return false;
+    }
+
+    return true;
+}
+
+
+static bool check_muldiv(const BENCH_RUN* run) {
+
+    (void)run;
+    for (uint32_t i = 0 ; i < MULDIV_PAIRS ; ++i) {
+        uint16_t a = get_word(BENCH_DATA + i * 4);
+        uint16_t b = get_word(BENCH_DATA + i * 4 + 2);
+        uint16_t out = BENCH_DATA + 0x1000 + i * 8;
+        uint32_t product = ((uint32_t)get_word(out) << 16) | get_word(out + 2);
+        if (product != (uint32_t)a * b) return false;
+        if (get_word(out + 4) != a / b || get_word(out + 6) != a % b) return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Each pass makes CALL_DEPTH calls, so the 16-bit call count
+ *        is at most one pass ahead of the passes completed.
+ */
+static bool check_calls(const BENCH_RUN* run) {
+
+    (void)run;
+    uint16_t extra = (uint16_t)(get_word(BENCH_COUNT) - bench_get_iterations() * CALL_DEPTH);
+    return mem[BENCH_RESULT] != 0xFF && extra <= CALL_DEPTH;
+}
+
+
+/**
+ * @brief The handlers' 16-bit counts must match the interrupts
+ *        taken, less one if the run stopped inside a handler.
+ */
+static bool check_interrupts(const BENCH_RUN* run) {
+
+    uint16_t irqs = (uint16_t)(run->irqs - get_word(BENCH_COUNT));
+    uint16_t firqs = (uint16_t)(run->firqs - get_word(BENCH_COUNT + 2));
+    return run->irqs > 0 && run->firqs > 0 && irqs <= 1 && firqs <= 1;
+}
+
+
+static bool check_dragon(const BENCH_RUN* run) {
+
+    (void)run;
+    return !dragon.is_halted && dragon_is_at_prompt();
+}
@@ -0,0 +1,266 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Breakpoint and watchpoint tests
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "main.h"
+#include "breakpoint.h"
+#include "cpu.h"
+#include "heatmap.h"
+
+
+/*
+ * STATICS
+ */
+static void test_settings(void);
+static void test_execute(void);
+static void test_watch(void);
+static void test_conditions(void);
+static void test_actions(void);
+static void test_observers(void);
+static uint8_t set(uint8_t kinds, uint16_t start, uint16_t end, uint8_t action, uint8_t condition, uint8_t reg_index, uint16_t value, uint32_t count);
+static uint32_t run_to_hit(uint32_t limit);
+static void test_setup(void);
+static void check(bool is_good, const char* name);
+
+
+/*
+ * GLOBALS
+ */
+uint32_t errors = 0;
+uint32_t passes = 0;
+uint32_t tests = 0;
+
+extern REG_6809         reg;
+extern uint8_t          mem[KB64];
+extern MEMORY_MAP_6809  memory_map;
+extern BREAKPOINTS      breakpoints;
+
+// 0x1000: LDX #$2000 ; loop: LDA ,X+ ; STA $2100 ; BRA loop
+// 0x2000: 1, 2, 3...
+const uint8_t PROGRAM[] = {0x8E, 0x20, 0x00, 0xA6, 0x80, 0xB7, 0x21, 0x00, 0x20, 0xF9};
+
+
+int main(void) {
+
+    test_settings();
+    test_execute();
+    test_watch();
+    test_conditions();
+    test_actions();
+    test_observers();
+
+    printf("Tests: %i\n", tests);
+    printf("Passes: %i\n", passes);
+    printf("Fails: %i\n", errors);
+    return errors == 0 ? 0 : 1;
+}
+
+
+static void test_settings(void) {
+
+    test_setup();
+    check(!breakpoint_is_armed(), "Nothing armed");
+    check(set(0, 0x1000, 0x1000, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_ALWAYS, 0, 0, 0) == BREAKPOINT_NONE, "No kinds");
+    check(set(BREAKPOINT_READ, 0x2000, 0x1FFF, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_ALWAYS, 0, 0, 0) == BREAKPOINT_NONE, "Bad range");
+    check(set(BREAKPOINT_EXECUTE, 0x1000, 0, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_ANY_BITS + 1, 0, 0, 0) == BREAKPOINT_NONE, "Bad condition");
+    check(set(BREAKPOINT_EXECUTE, 0x1000, 0, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_EQUAL, BREAKPOINT_REG_DP + 1, 0, 0) == BREAKPOINT_NONE, "Bad register");
+
+    // Execute breakpoints ignore `end`
+    for (uint8_t i = 0 ; i < BREAKPOINT_MAX ; ++i) set(BREAKPOINT_EXECUTE, 0x3000 + i, 0, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_ALWAYS, 0, 0, 0);
+    check(breakpoint_is_armed() && breakpoints.count == BREAKPOINT_MAX && breakpoints.entries[3].end == 0x3003, "Table filled");
+    check(set(BREAKPOINT_EXECUTE, 0x4000, 0, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_ALWAYS, 0, 0, 0) == BREAKPOINT_NONE, "Table full");
+
+    check(breakpoint_find(0x3005, BREAKPOINT_EXECUTE) == 5 && breakpoint_find(0x3005, BREAKPOINT_READ) == BREAKPOINT_NONE, "Find");
+    check(breakpoint_clear(5) && !breakpoint_clear(5) && breakpoint_find(0x3005, BREAKPOINT_EXECUTE) == BREAKPOINT_NONE, "Clear");
+    check(!(breakpoints.execute[0x3005 >> 3] & (1 << 5)) && (breakpoints.execute[0x3004 >> 3] & (1 << 4)), "Bitmap rebuilt");
+    check(set(BREAKPOINT_EXECUTE, 0x4000, 0, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_ALWAYS, 0, 0, 0) == 5, "Slot reused");
+
+    breakpoint_clear_all();
+    check(!breakpoint_is_armed() && breakpoints.execute[0x3004 >> 3] == 0, "Clear all");
+}
+
+
+static void test_execute(void) {
+
+    // Stops before the op, and again until resumed
+    test_setup();
+    set(BREAKPOINT_EXECUTE, 0x1005, 0, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_ALWAYS, 0, 0, 0);
+    check(run_to_hit(20) == 3 && reg.pc == 0x1005 && reg.a == 1 && breakpoints.hit_kind == BREAKPOINT_EXECUTE
+          && breakpoints.hit_address == 0x1005 && breakpoints.hit_cycles == 0, "Execute hit");
+    check(run_to_hit(20) == 1 && reg.pc == 0x1005 && reg.a == 1, "Stays stopped");
+
+    breakpoint_resume();
+    check(run_to_hit(20) == 4 && reg.pc == 0x1005 && reg.a == 2 && breakpoints.entries[0].hits == 3, "Resumed");
+}
+
+
+static void test_watch(void) {
+
+    // Write watchpoints stop after the op
+    test_setup();
+    uint8_t index = set(BREAKPOINT_WRITE, 0x2100, 0x2100, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_ALWAYS, 0, 0, 0);
+    check(run_to_hit(20) == 3 && reg.pc == 0x1008 && mem[0x2100] == 1 && breakpoints.hit_index == index
+          && breakpoints.hit_kind == BREAKPOINT_WRITE && breakpoints.hit_address == 0x2100 && breakpoints.hit_cycles == 5, "Write hit");
+
+    // Read watchpoints cover a range, and ignore writes
+    test_setup();
+    set(BREAKPOINT_READ, 0x2002, 0x2100, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_ALWAYS, 0, 0, 0);
+    check(run_to_hit(20) == 8 && reg.a == 3 && reg.x == 0x2003 && breakpoints.hit_address == 0x2002 && breakpoints.hit_cycles == 6, "Read hit");
+
+    // Continuing needs no resume: the op has run
+    check(run_to_hit(20) == 3 && reg.a == 4 && breakpoints.hit_address == 0x2003, "Read continued");
+
+    test_setup();
+    set(BREAKPOINT_READ | BREAKPOINT_WRITE, 0x2100, 0x2100, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_ALWAYS, 0, 0, 0);
+    check(run_to_hit(20) == 3 && breakpoints.hit_kind == BREAKPOINT_WRITE, "Access hit");
+
+    // One op can hit several watchpoints: STD writes both bytes, and a
+    // watchpoint over both scores one hit
+    test_setup();
+    mem[0x1000] = 0xFD;
+    mem[0x1001] = 0x21;
+    mem[0x1002] = 0x00;
+    uint8_t first = set(BREAKPOINT_WRITE, 0x2100, 0x2100, BREAKPOINT_ACTION_LOG, BREAKPOINT_IF_ALWAYS, 0, 0, 0);
+    uint8_t second = set(BREAKPOINT_WRITE, 0x2101, 0x2101, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_ALWAYS, 0, 0, 0);
+    uint8_t both = set(BREAKPOINT_WRITE, 0x2100, 0x2101, BREAKPOINT_ACTION_LOG, BREAKPOINT_IF_ALWAYS, 0, 0, 0);
+    check(run_to_hit(1) == 1 && breakpoints.hit_index == second && breakpoints.hit_address == 0x2101, "Second watchpoint hit");
+    check(breakpoints.entries[first].hits == 1 && breakpoints.entries[both].hits == 1, "Every watchpoint counted once");
+
+    // As can a pull from the stack
+    test_setup();
+    mem[0x1000] = 0x35;
+    mem[0x1001] = 0x16;
+    reg.s = 0x2000;
+    set(BREAKPOINT_READ, 0x2000, 0x2000, BREAKPOINT_ACTION_LOG, BREAKPOINT_IF_ALWAYS, 0, 0, 0);
+    set(BREAKPOINT_READ, 0x2003, 0x2004, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_ALWAYS, 0, 0, 0);
+    check(run_to_hit(1) == 1 && reg.x == 0x0304 && breakpoints.entries[0].hits == 1 && breakpoints.hit_address == 0x2003, "Pull hits");
+}
+
+
+static void test_conditions(void) {
+
+    test_setup();
+    set(BREAKPOINT_EXECUTE, 0x1005, 0, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_EQUAL, BREAKPOINT_REG_A, 3, 0);
+    check(run_to_hit(50) == 9 && reg.a == 3 && breakpoints.entries[0].hits == 1, "Equal");
+
+    test_setup();
+    set(BREAKPOINT_EXECUTE, 0x1005, 0, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_NOT_LESS, BREAKPOINT_REG_X, 0x2004, 0);
+    check(run_to_hit(50) > 0 && reg.a == 4, "Not less");
+
+    test_setup();
+    set(BREAKPOINT_EXECUTE, 0x1005, 0, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_ANY_BITS, BREAKPOINT_REG_D, 0x0400, 0);
+    check(run_to_hit(50) > 0 && reg.a == 4, "Any bits");
+
+    // Watchpoints see the registers after the op
+    test_setup();
+    set(BREAKPOINT_READ, 0x2000, 0x20FF, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_LESS, BREAKPOINT_REG_X, 0x2002, 0);
+    check(run_to_hit(50) == 2 && breakpoint_step() != BREAKPOINT_HIT, "Less");
+
+    // Counts only include hits where the condition held
+    test_setup();
+    set(BREAKPOINT_EXECUTE, 0x1005, 0, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_NOT_EQUAL, BREAKPOINT_REG_A, 2, 3);
+    check(run_to_hit(50) > 0 && reg.a == 4 && breakpoints.entries[0].hits == 3, "Count");
+}
+
+
+static void test_actions(void) {
+
+    // Logging breakpoints never stop the CPU
+    test_setup();
+    set(BREAKPOINT_EXECUTE, 0x1005, 0, BREAKPOINT_ACTION_LOG, BREAKPOINT_IF_ALWAYS, 0, 0, 0);
+    check(run_to_hit(31) == 0 && breakpoints.entries[0].hits == 10, "Log");
+
+    // Snapshots are kept newest first, and the oldest are overwritten
+    test_setup();
+    set(BREAKPOINT_WRITE, 0x2100, 0x2100, BREAKPOINT_ACTION_SNAPSHOT, BREAKPOINT_IF_ALWAYS, 0, 0, 0);
+    BREAKPOINT_SNAPSHOT snapshots[BREAKPOINT_SNAPSHOTS];
+    check(run_to_hit(7) == 0 && breakpoint_snapshots(snapshots, BREAKPOINT_SNAPSHOTS) == 2 && snapshots[0].regs.a == 2
+          && snapshots[0].hits == 2 && snapshots[0].address == 0x2100 && snapshots[0].kind == BREAKPOINT_WRITE
+          && snapshots[0].regs.pc == 0x1008 && snapshots[1].regs.a == 1, "Snapshot");
+    check(breakpoint_snapshots(snapshots, 1) == 1 && snapshots[0].regs.a == 2, "Snapshot count");
+
+    run_to_hit(60);
+    check(breakpoint_snapshots(snapshots, BREAKPOINT_SNAPSHOTS) == BREAKPOINT_SNAPSHOTS && snapshots[0].regs.a == 22
+          && snapshots[BREAKPOINT_SNAPSHOTS - 1].regs.a == 7, "Snapshot ring");
+}
+
+
+static void test_observers(void) {
+
+    // Reads and writes are only checked while there are watchpoints
+    test_setup();
+    set(BREAKPOINT_EXECUTE, 0x1005, 0, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_ALWAYS, 0, 0, 0);
+    check(memory_map.watch == NULL && !memory_map.is_observed, "Execute only");
+
+    uint8_t index = set(BREAKPOINT_WRITE, 0x2100, 0x2100, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_ALWAYS, 0, 0, 0);
+    check(memory_map.watch != NULL && memory_map.is_observed, "Watching");
+
+    heatmap_start(NULL);
+    breakpoint_clear(index);
+    check(memory_map.watch == NULL && memory_map.is_observed, "Heatmap still on");
+
+    heatmap_stop();
+    check(!memory_map.is_observed, "Nothing observed");
+}
+
+
+static uint8_t set(uint8_t kinds, uint16_t start, uint16_t end, uint8_t action, uint8_t condition, uint8_t reg_index, uint16_t value, uint32_t count) {
+
+    BREAKPOINT breakpoint = {start, end, kinds, action, condition, reg_index, value, count, 0, false};
+    return breakpoint_set(&breakpoint);
+}
+
+
+/**
+ * @brief Step until a breakpoint stops the CPU.
+ *
+ * @retval The steps taken, including the one that stopped, or 0 if
+ *         none did within `limit` steps.
+ */
+static uint32_t run_to_hit(uint32_t limit) {
+
+    for (uint32_t i = 1 ; i <= limit ; ++i) {
+        if (breakpoint_step() == BREAKPOINT_HIT) return i;
+    }
+
+    return 0;
+}
+
+
+static void test_setup(void) {
+
+    tests++;
+    memset(mem, 0, KB64);
+    memcpy(&mem[0x1000], PROGRAM, sizeof(PROGRAM));
+    for (uint32_t i = 0 ; i < 0x100 ; ++i) mem[0x2000 + i] = i + 1;
+    memset(&reg, 0, sizeof(reg));
+    init_cpu();
+    reg.pc = 0x1000;
+    reg.s = 0x8000;
+
+    breakpoint_clear_all();
+    breakpoints.is_resuming = false;
+    breakpoints.snapshots_taken = 0;
+}
+
+
+static void check(bool is_good, const char* name) {
+
+    if (is_good) {
+        passes++;
+    } else {
+        errors++;
+        printf("  %02d. %s failed\n", tests, name);
+    }
+}
@@ -0,0 +1,278 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Mailbox and CPU core runner tests: the runner goes on a thread, as
+ * it goes on core 1 on the board
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "main.h"
+#include "cpu.h"
+#include "core.h"
+#include "mailbox.h"
+
+
+/*
+ * STATICS
+ */
+static void test_mailbox(void);
+static void test_mailbox_threads(void);
+static void test_snapshot(void);
+static void test_commands(void);
+static void test_setup(void);
+static void check(bool is_good, const char* name);
+static void* producer(void* arg);
+static void* runner(void* arg);
+static void idle(void);
+static bool wait_event(uint8_t type, MAILBOX_MSG* event);
+static void start_core(pthread_t* thread);
+static void stop_core(pthread_t thread);
+
+
+/*
+ * GLOBALS
+ */
+uint32_t errors = 0;
+uint32_t passes = 0;
+uint32_t tests = 0;
+
+MAILBOX  box;
+CORE     core;
+
+extern REG_6809     reg;
+extern uint8_t      mem[KB64];
+extern STATE_6809   state;
+
+// loop: LEAX 1,X ; BRA loop -- two instructions, so every CORE_BATCH
+// boundary falls at `loop` and the cycles run are a multiple of X
+const uint8_t program[] = {0x30, 0x01, 0x20, 0xFC};
+
+#define PRODUCER_COUNT  200000
+#define SNAPSHOT_READS  10000000
+#define SNAPSHOT_CHANGES 100
+
+
+int main(void) {
+
+    test_mailbox();
+    test_mailbox_threads();
+    test_snapshot();
+    test_commands();
+
+    printf("Tests: %i\n", tests);
+    printf("Passes: %i\n", passes);
+    printf("Fails: %i\n", errors);
+    return errors == 0 ? 0 : 1;
+}
+
+
+static void test_mailbox(void) {
+
+    test_setup();
+    MAILBOX_MSG msg = {0};
+    mailbox_init(&box);
+    check(!mailbox_get(&box, &msg), "Empty mailbox");
+
+    bool is_good = true;
+    for (uint32_t i = 0 ; i < MAILBOX_SIZE ; ++i) {
+        msg.value = i;
+        is_good &= mailbox_put(&box, &msg);
+    }
+
+    check(is_good && !mailbox_put(&box, &msg), "Mailbox fills");
+
+    for (uint32_t i = 0 ; i < MAILBOX_SIZE ; ++i) {
+        is_good &= mailbox_get(&box, &msg) && msg.value == i;
+    }
+
+    check(is_good && !mailbox_get(&box, &msg), "Messages in order");
+}
+
+
+static void test_mailbox_threads(void) {
+
+    // Every message arrives, once, in order, with no lock
+    test_setup();
+    mailbox_init(&box);
+    pthread_t thread;
+    pthread_create(&thread, NULL, producer, NULL);
+
+    uint32_t expected = 0;
+    bool is_good = true;
+    MAILBOX_MSG msg;
+    while (expected < PRODUCER_COUNT) {
+        if (mailbox_get(&box, &msg)) {
+            is_good &= msg.value == expected && msg.address == (expected & 0xFFFF);
+            expected++;
+        } else {
+            sched_yield();
+        }
+    }
+
+    pthread_join(thread, NULL);
+    check(is_good && !mailbox_get(&box, &msg), "Messages cross threads in order");
+}
+
+
+static void test_snapshot(void) {
+
+    // Read snapshots while the code runs: a torn one would break the
+    // link between the cycle count, X and the PC
+    test_setup();
+    pthread_t thread;
+    start_core(&thread);
+
+    // Time one pass of the loop
+    MAILBOX_MSG event;
+    uint32_t per_loop = 0;
+    for (uint32_t i = 0 ; i < 2 ; ++i) {
+        core_send(&core, CORE_CMD_STEP, 0, 0);
+        if (wait_event(CORE_EVENT_STEPPED, &event)) per_loop += event.value;
+    }
+
+    reg.x = 0;
+    core_send(&core, CORE_CMD_RUN, 0, 0);
+
+    CORE_SNAPSHOT snapshot;
+    uint32_t reads = 0;
+    uint32_t changes = 0;
+    uint32_t last_cycles = 0;
+    bool is_good = per_loop > 0;
+    while (is_good && reads < SNAPSHOT_READS && changes < SNAPSHOT_CHANGES) {
+        core_read_snapshot(&core, &snapshot);
+        reads++;
+        if (!snapshot.is_running) continue;
+
+        is_good &= snapshot.reg.pc == 0x4000;
+        is_good &= snapshot.cycles % per_loop == 0 && ((snapshot.cycles / per_loop) & 0xFFFF) == snapshot.reg.x;
+        is_good &= snapshot.cycles >= last_cycles;
+        if (snapshot.cycles != last_cycles) changes++;
+        last_cycles = snapshot.cycles;
+
+        // Let the runner in if there is only one CPU
+        if ((reads & 0xFF) == 0) sched_yield();
+    }
+
+    check(is_good, "Snapshots never torn");
+    check(changes == SNAPSHOT_CHANGES, "Snapshots track the run");
+
+    core_send(&core, CORE_CMD_PAUSE, 0, 0);
+    check(wait_event(CORE_EVENT_STOPPED, &event) && event.arg == CORE_STOP_PAUSED && event.value >= last_cycles, "Pause");
+    stop_core(thread);
+}
+
+
+static void test_commands(void) {
+
+    test_setup();
+    pthread_t thread;
+    start_core(&thread);
+    MAILBOX_MSG event;
+
+    // Step: the core is idle after the event, so `reg` can be read
+    core_send(&core, CORE_CMD_STEP, 0, 0);
+    check(wait_event(CORE_EVENT_STEPPED, &event) && event.value > 0 && reg.pc == 0x4002 && reg.x == 1, "Step");
+
+    // Poke while running: turn the BRA into an RTI to end the run
+    core_send(&core, CORE_CMD_RUN, 0, 0);
+    core_send(&core, CORE_CMD_POKE, 0x4002, 0x3B);
+    check(wait_event(CORE_EVENT_STOPPED, &event) && event.arg == CORE_STOP_RETURN && mem[0x4002] == 0x3B, "Poke while running");
+    check(event.address == reg.pc && reg.pc == 0x4003, "Stopped after the RTI");
+
+    // A run may be limited to some cycles
+    reg.pc = 0x4000;
+    mem[0x4002] = 0x20;
+    core_send(&core, CORE_CMD_RUN, 0, 1000);
+    check(wait_event(CORE_EVENT_STOPPED, &event) && event.arg == CORE_STOP_CYCLES && event.value >= 1000 && event.value < 1010, "Cycle limit");
+
+    // Stepping does nothing while running; pausing is always answered
+    core_send(&core, CORE_CMD_PAUSE, 0, 0);
+    check(wait_event(CORE_EVENT_STOPPED, &event) && event.arg == CORE_STOP_PAUSED, "Pause when idle");
+    stop_core(thread);
+}
+
+
+static void test_setup(void) {
+
+    tests++;
+    memset(mem, 0, KB64);
+    memcpy(&mem[0x4000], program, sizeof(program));
+    memset(&reg, 0, sizeof(reg));
+    memset(&state, 0, sizeof(state));
+    reg.pc = 0x4000;
+    reg.s = 0x7F00;
+}
+
+
+static void check(bool is_good, const char* name) {
+
+    if (is_good) {
+        passes++;
+    } else {
+        errors++;
+        printf("  %02d. %s failed\n", tests, name);
+    }
+}
+
+
+static void* producer(void* arg) {
+
+    (void)arg;
+    MAILBOX_MSG msg = {0};
+    for (uint32_t i = 0 ; i < PRODUCER_COUNT ; ++i) {
+        msg.value = i;
+        msg.address = i & 0xFFFF;
+        while (!mailbox_put(&box, &msg)) sched_yield();
+    }
+
+    return NULL;
+}
+
+
+static void* runner(void* arg) {
+
+    core_loop((CORE*)arg);
+    return NULL;
+}
+
+
+static void idle(void) {
+
+    sched_yield();
+}
+
+
+static bool wait_event(uint8_t type, MAILBOX_MSG* event) {
+
+    // Generous: the runner thread may not be scheduled at once
+    for (uint32_t i = 0 ; i < 10000000 ; ++i) {
+        if (core_get_event(&core, event)) return event->type == type;
+        sched_yield();
+    }
+
+    return false;
+}
+
+
+static void start_core(pthread_t* thread) {
+
+    core_init(&core, mem, NULL, idle);
+    pthread_create(thread, NULL, runner, &core);
+}
+
+
+static void stop_core(pthread_t thread) {
+
+    core_send(&core, CORE_CMD_QUIT, 0, 0);
+    pthread_join(thread, NULL);
+}
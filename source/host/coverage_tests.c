@@ -0,0 +1,211 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Code coverage tests
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "main.h"
+#include "cpu.h"
+#include "coverage.h"
+
+
+/*
+ * STATICS
+ */
+static void test_off(void);
+static void test_executed(void);
+static void test_branches(void);
+static void test_merge(void);
+static void test_read(void);
+static bool is_flagged(const COVERAGE* map, uint8_t kind, uint16_t address);
+static void run_program(void);
+static void test_setup(void);
+static void check(bool is_good, const char* name);
+
+
+/*
+ * GLOBALS
+ */
+uint32_t errors = 0;
+uint32_t passes = 0;
+uint32_t tests = 0;
+
+extern REG_6809     reg;
+extern uint8_t      mem[KB64];
+extern COVERAGE     coverage;
+
+// 0x1000: LDA #0 ; BEQ *+4 ; NOP ; NOP
+// 0x1006: LBNE *+8 ; LBRA *+3 ; BSR *+3 ; NOP
+// 0x1010: BRN *+2
+const uint8_t PROGRAM[] = {
+    0x86, 0x00, 0x27, 0x02, 0x12, 0x12,
+    0x10, 0x26, 0x00, 0x04, 0x16, 0x00, 0x00, 0x8D, 0x01, 0x12,
+    0x21, 0x00
+};
+#define PROGRAM_OPS     6
+
+
+int main(void) {
+
+    test_off();
+    test_executed();
+    test_branches();
+    test_merge();
+    test_read();
+
+    printf("Tests: %i\n", tests);
+    printf("Passes: %i\n", passes);
+    printf("Fails: %i\n", errors);
+    return errors == 0 ? 0 : 1;
+}
+
+
+static void test_off(void) {
+
+    // Nothing is flagged until coverage is started
+    test_setup();
+    run_program();
+    check(!coverage_is_on() && coverage_count(&coverage, COVERAGE_EXECUTED) == 0, "Off flags nothing");
+
+    coverage_start();
+    check(coverage_is_on(), "Started");
+    coverage_stop();
+    run_program();
+    check(!coverage_is_on() && coverage_count(&coverage, COVERAGE_TAKEN) == 0, "Stopped flags nothing");
+}
+
+
+static void test_executed(void) {
+
+    test_setup();
+    coverage_start();
+    run_program();
+    coverage_stop();
+
+    // Every byte fetched through the PC except LDA's immediate operand,
+    // which is read as data
+    bool is_executed = is_flagged(&coverage, COVERAGE_EXECUTED, 0x1000);
+    for (uint16_t i = 0x1002 ; i < 0x1004 ; ++i) is_executed = is_executed && is_flagged(&coverage, COVERAGE_EXECUTED, i);
+    for (uint16_t i = 0x1006 ; i < 0x100F ; ++i) is_executed = is_executed && is_flagged(&coverage, COVERAGE_EXECUTED, i);
+    check(is_executed, "Op and operand bytes flagged");
+    check(!is_flagged(&coverage, COVERAGE_EXECUTED, 0x1001), "Immediate operand not flagged");
+    check(!is_flagged(&coverage, COVERAGE_EXECUTED, 0x1004) && !is_flagged(&coverage, COVERAGE_EXECUTED, 0x100F), "Skipped ops not flagged");
+    check(coverage_count(&coverage, COVERAGE_EXECUTED) == sizeof(PROGRAM) - 4, "Executed count");
+
+    coverage_reset();
+    check(coverage_count(&coverage, COVERAGE_EXECUTED) == 0, "Reset");
+}
+
+
+static void test_branches(void) {
+
+    test_setup();
+    coverage_start();
+    run_program();
+    coverage_stop();
+
+    // Flagged at each op's first byte, prefix included
+    check(is_flagged(&coverage, COVERAGE_TAKEN, 0x1002) && !is_flagged(&coverage, COVERAGE_NOT_TAKEN, 0x1002), "Short branch taken");
+    check(is_flagged(&coverage, COVERAGE_NOT_TAKEN, 0x1006) && !is_flagged(&coverage, COVERAGE_TAKEN, 0x1006), "Long branch not taken");
+    check(is_flagged(&coverage, COVERAGE_TAKEN, 0x100A), "LBRA taken");
+    check(is_flagged(&coverage, COVERAGE_TAKEN, 0x100D), "BSR taken");
+    check(is_flagged(&coverage, COVERAGE_NOT_TAKEN, 0x1010), "BRN not taken");
+    check(coverage_count(&coverage, COVERAGE_TAKEN) == 3 && coverage_count(&coverage, COVERAGE_NOT_TAKEN) == 2, "Branch counts");
+
+    // With Z clear, LBNE branches too
+    coverage_start();
+    reg.pc = 0x1006;
+    reg.cc = 0;
+    process_next_instruction();
+    coverage_stop();
+    check(is_flagged(&coverage, COVERAGE_TAKEN, 0x1006) && is_flagged(&coverage, COVERAGE_NOT_TAKEN, 0x1006), "Both ways");
+}
+
+
+static void test_merge(void) {
+
+    static COVERAGE first;
+    static COVERAGE second;
+
+    test_setup();
+    coverage_start();
+    run_program();
+    memcpy(&first, &coverage, sizeof(COVERAGE));
+
+    coverage_reset();
+    reg.pc = 0x1006;
+    reg.cc = 0;
+    process_next_instruction();
+    coverage_stop();
+    memcpy(&second, &coverage, sizeof(COVERAGE));
+
+    coverage_merge(&first, &second);
+    check(is_flagged(&first, COVERAGE_TAKEN, 0x1006) && is_flagged(&first, COVERAGE_NOT_TAKEN, 0x1006), "Outcomes merged");
+    check(is_flagged(&first, COVERAGE_EXECUTED, 0x100E) && is_flagged(&first, COVERAGE_EXECUTED, 0x1000), "Bytes merged");
+    check(coverage_count(&first, COVERAGE_TAKEN) == 4, "Merged count");
+
+    // Merging is idempotent
+    memcpy(&second, &first, sizeof(COVERAGE));
+    coverage_merge(&first, &second);
+    check(memcmp(&first, &second, sizeof(COVERAGE)) == 0, "Idempotent");
+}
+
+
+static void test_read(void) {
+
+    test_setup();
+    coverage_start();
+    run_program();
+    coverage_stop();
+
+    // A bit per address, address 0 in bit 0, maps in COVERAGE_* order
+    uint8_t data[8];
+    check(coverage_read(COVERAGE_EXECUTED * COVERAGE_MAP_SIZE + 0x200, data, 2) == 2 && data[0] == 0xCD && data[1] == 0x7F, "Serialised bits");
+    check(coverage_read(COVERAGE_TAKEN * COVERAGE_MAP_SIZE + 0x200, data, 1) == 1 && data[0] == 0x04, "Serialised branch");
+    check(coverage_read(COVERAGE_SIZE - 2, data, 8) == 2 && coverage_read(COVERAGE_SIZE, data, 8) == 0, "Read stops at the end");
+}
+
+
+static bool is_flagged(const COVERAGE* map, uint8_t kind, uint16_t address) {
+
+    return (map->maps[kind][address >> 3] & (1 << (address & 0x07))) != 0;
+}
+
+
+static void run_program(void) {
+
+    reg.pc = 0x1000;
+    for (uint8_t i = 0 ; i < PROGRAM_OPS ; ++i) process_next_instruction();
+}
+
+
+static void test_setup(void) {
+
+    tests++;
+    memset(mem, 0, KB64);
+    memcpy(&mem[0x1000], PROGRAM, sizeof(PROGRAM));
+    init_cpu();
+    reg.s = 0x8000;
+    coverage_stop();
+    coverage_reset();
+}
+
+
+static void check(bool is_good, const char* name) {
+
+    if (is_good) {
+        passes++;
+    } else {
+        errors++;
+        printf("  %02d. %s failed\n", tests, name);
+    }
+}
@@ -0,0 +1,22 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Host runner for the CPU tests in cpu_tests.c, which the board runs
+ * from the monitor's menu
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "main.h"
+#include "cpu_tests.h"
+
+
+int main(void) {
+
+    return test_main() == 0 ? 0 : 1;
+}
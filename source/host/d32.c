@@ -0,0 +1,653 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Dragon 32 host runner and boot benchmark
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+// App
+#include "main.h"
+#include "cpu.h"
+#include "vdg.h"
+#include "dragon.h"
+#include "loader.h"
+#include "file_loader.h"
+#include "coverage.h"
+#include "heatmap.h"
+#include "sample.h"
+#include "trace.h"
+
+
+/*
+ * STATICS
+ */
+static bool     load_rom_file(const char* path, uint8_t* buffer);
+static bool     boot_to_prompt(uint32_t max_frames, MC6847* vdg);
+static bool     write_frame(MC6847* vdg, const char* path);
+static bool     bench_render(MC6847* vdg);
+static bool     run_program(const char* path, uint32_t frames, bool is_quiet);
+static bool     type_keys(const char* keys, bool is_quiet);
+static void     run_fields(uint32_t fields);
+static bool     is_on_screen(const char* text);
+static double   get_wall_seconds(void);
+static void     print_screen(void);
+static void     save_samples(void);
+static void     save_trace(void);
+static bool     write_heatmap(const char* path);
+static void     heatmap_out(const char* text, uint32_t length);
+static bool     write_coverage(const char* path);
+static void     show_help(void);
+
+
+/*
+ * GLOBALS
+ */
+extern REG_6809     reg;
+extern uint8_t      mem[KB64];
+extern STATE_DRAGON dragon;
+extern COVERAGE     coverage;
+
+static uint64_t     lines_drawn = 0;
+static FILE*        sample_file = NULL;
+static FILE*        heatmap_file = NULL;
+static FILE*        trace_file = NULL;
+
+
+/**
+ * @brief Load and boot a Dragon 32 ROM without a display, reporting
+ *        emulated cycles and wall-clock time to reach the 'OK' prompt.
+ *
+ *        Usage: e6809_d32 [-r runs] [-f max_frames] [-p ppm_file] [-l program] [-k keys] [-s sample_file] [-i period] [-m heatmap_file] [-c coverage_file] [-t trace_file] [-q] <rom file>
+ *
+ * @retval 0 if every run reached the prompt, otherwise 1.
+ */
+int main(int argc, char* argv[]) {
+
+    const char* rom_path = NULL;
+    const char* ppm_path = NULL;
+    const char* program_path = NULL;
+    const char* keys = NULL;
+    const char* sample_path = NULL;
+    const char* heatmap_path = NULL;
+    const char* coverage_path = NULL;
+    const char* trace_path = NULL;
+    uint32_t sample_period = SAMPLE_DEFAULT_PERIOD;
+    uint32_t runs = 1;
+    uint32_t max_frames = 500;
+    bool is_quiet = false;
+
+    for (int i = 1 ; i < argc ; ++i) {
+        if (strcmp(argv[i], "-r") == 0 && i < argc - 1) {
+            runs = (uint32_t)strtoul(argv[++i], NULL, 10);
+            if (runs == 0) runs = 1;
+        } else if (strcmp(argv[i], "-f") == 0 && i < argc - 1) {
+            max_frames = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-p") == 0 && i < argc - 1) {
+            ppm_path = argv[++i];
+        } else if (strcmp(argv[i], "-l") == 0 && i < argc - 1) {
+            program_path = argv[++i];
+        } else if (strcmp(argv[i], "-k") == 0 && i < argc - 1) {
+            keys = argv[++i];
+        } else if (strcmp(argv[i], "-s") == 0 && i < argc - 1) {
+            sample_path = argv[++i];
+        } else if (strcmp(argv[i], "-i") == 0 && i < argc - 1) {
+            sample_period = (uint32_t)strtoul(argv[++i], NULL, 10);
+            if (sample_period == 0) sample_period = SAMPLE_DEFAULT_PERIOD;
+        } else if (strcmp(argv[i], "-m") == 0 && i < argc - 1) {
+            heatmap_path = argv[++i];
+        } else if (strcmp(argv[i], "-c") == 0 && i < argc - 1) {
+            coverage_path = argv[++i];
+        } else if (strcmp(argv[i], "-t") == 0 && i < argc - 1) {
+            trace_path = argv[++i];
+        } else if (strcmp(argv[i], "-q") == 0) {
+            is_quiet = true;
+        } else if (strcmp(argv[i], "-h") == 0) {
+            show_help();
+            return 0;
+        } else {
+            rom_path = argv[i];
+        }
+    }
+
+    if (rom_path == NULL) {
+        show_help();
+        return 1;
+    }
+
+    static uint8_t rom[DRAGON_ROM_SIZE];
+    if (!load_rom_file(rom_path, rom)) return 1;
+
+    if (sample_path != NULL) {
+#ifdef E6809_SAMPLE
+        sample_file = fopen(sample_path, "w");
+        if (sample_file == NULL) {
+            fprintf(stderr, "[ERROR] Cannot create %s\n", sample_path);
+            return 1;
+        }
+
+        fprintf(sample_file, "# e6809 PC samples every %u cycles: return addresses, outermost first, then PC\n", sample_period);
+        sample_start(sample_period);
+#else
+        (void)sample_period;
+        fprintf(stderr, "[ERROR] -s needs a build configured with -DE6809_SAMPLE=ON\n");
+        return 1;
+#endif
+    }
+
+    if (trace_path != NULL) {
+#ifdef E6809_TRACE
+        trace_file = fopen(trace_path, "wb");
+        if (trace_file == NULL) {
+            fprintf(stderr, "[ERROR] Cannot create %s\n", trace_path);
+            return 1;
+        }
+
+        fwrite(TRACE_FILE_MAGIC, 1, TRACE_FILE_MAGIC_SIZE, trace_file);
+        trace_start();
+#else
+        fprintf(stderr, "[ERROR] -t needs a build configured with -DE6809_TRACE=ON\n");
+        return 1;
+#endif
+    }
+
+    // Count accesses by address as well as by page
+    static uint32_t heatmap_cells[HEATMAP_KINDS][HEATMAP_ADDRESSES];
+    if (heatmap_path != NULL) heatmap_start(heatmap_cells);
+    if (coverage_path != NULL) coverage_start();
+
+    // Only render when asked, so the boot benchmark times the CPU alone
+    static MC6847 vdg;
+    MC6847* video = ppm_path != NULL ? &vdg : NULL;
+
+    double best = 0.0;
+    double total = 0.0;
+
+    for (uint32_t i = 0 ; i < runs ; ++i) {
+        dragon_init();
+        dragon_load_rom(rom, DRAGON_ROM_SIZE);
+        dragon_reset();
+        if (video != NULL) vdg_init(video);
+        if (heatmap_path != NULL) heatmap_reset();
+        if (coverage_path != NULL) coverage_reset();
+        lines_drawn = 0;
+
+        double start = get_wall_seconds();
+        bool is_booted = boot_to_prompt(max_frames, video);
+        double elapsed = get_wall_seconds() - start;
+
+        if (!is_booted) {
+            print_screen();
+            fprintf(stderr, "[ERROR] No prompt after %u frames (PC 0x%04X%s)\n",
+                    dragon.frames, reg.pc, dragon.is_halted ? ", CPU halted" : "");
+            return 1;
+        }
+
+        total += elapsed;
+        if (i == 0 || elapsed < best) best = elapsed;
+    }
+
+    if (!is_quiet) print_screen();
+
+    double emulated = (double)dragon.cycles / DRAGON_CPU_CLOCK_HZ;
+    printf("Boot to prompt: %llu cycles, %llu instructions, %u frames\n",
+           (unsigned long long)dragon.cycles, (unsigned long long)dragon.instructions, dragon.frames);
+    printf("Emulated time:  %.3f s\n", emulated);
+    printf("Wall time:      %.3f ms best, %.3f ms mean over %u run(s)\n",
+           best * 1000.0, total * 1000.0 / runs, runs);
+    if (best > 0.0) {
+        printf("Speed:          %.1f MHz, %.1fx real time\n",
+               dragon.cycles / best / 1000000.0, emulated / best);
+    }
+
+    if (video != NULL) {
+        printf("Rendering:      %llu scanlines redrawn over %u frames\n",
+               (unsigned long long)lines_drawn, dragon.frames);
+        if (!bench_render(video)) return 1;
+        if (!write_frame(video, ppm_path)) return 1;
+    }
+
+    if (keys != NULL && !type_keys(keys, is_quiet)) return 1;
+    if (program_path != NULL && !run_program(program_path, max_frames, is_quiet)) return 1;
+
+    if (sample_file != NULL) {
+        save_samples();
+#ifdef E6809_SAMPLE
+        if (sample_dropped() > 0) fprintf(stderr, "[WARNING] %u sample(s) dropped\n", sample_dropped());
+#endif
+        fclose(sample_file);
+    }
+
+    if (trace_file != NULL) {
+        save_trace();
+#ifdef E6809_TRACE
+        if (trace_dropped() > 0) fprintf(stderr, "[WARNING] %u trace record(s) dropped\n", trace_dropped());
+#endif
+        fclose(trace_file);
+    }
+
+    if (heatmap_path != NULL && !write_heatmap(heatmap_path)) return 1;
+    if (coverage_path != NULL && !write_coverage(coverage_path)) return 1;
+    return 0;
+}
+
+
+/**
+ * @brief Read a 16KB ROM image from a file.
+ *
+ * @param path:   The file's path.
+ * @param buffer: Pointer to a DRAGON_ROM_SIZE-byte buffer.
+ *
+ * @retval Whether the ROM was read.
+ */
+static bool load_rom_file(const char* path, uint8_t* buffer) {
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "[ERROR] Cannot open %s\n", path);
+        return false;
+    }
+
+    size_t count = fread(buffer, 1, DRAGON_ROM_SIZE, file);
+    fclose(file);
+
+    if (count != DRAGON_ROM_SIZE) {
+        fprintf(stderr, "[ERROR] %s is not a %i-byte ROM image\n", path, DRAGON_ROM_SIZE);
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Run the machine a field at a time until the 'OK' prompt appears.
+ *
+ * @param max_frames: The number of fields to run before giving up.
+ * @param vdg:        Pointer to a framebuffer to render each field into, or NULL.
+ *
+ * @retval Whether the prompt appeared.
+ */
+static bool boot_to_prompt(uint32_t max_frames, MC6847* vdg) {
+
+    while (dragon.frames < max_frames && !dragon.is_halted) {
+        dragon_run(DRAGON_CYCLES_PER_FIELD);
+        save_samples();
+        save_trace();
+        if (vdg != NULL) lines_drawn += dragon_render(vdg);
+        if (dragon_is_at_prompt()) return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief Render the final frame and write it out as a PPM image.
+ *
+ * @param vdg:  Pointer to the framebuffer.
+ * @param path: The output file's path.
+ *
+ * @retval Whether the image was written.
+ */
+static bool write_frame(MC6847* vdg, const char* path) {
+
+    dragon_render(vdg);
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "[ERROR] Cannot create %s\n", path);
+        return false;
+    }
+
+    bool is_written = vdg_write_ppm(vdg, file);
+    fclose(file);
+
+    if (!is_written) fprintf(stderr, "[ERROR] Cannot write %s\n", path);
+    return is_written;
+}
+
+
+/**
+ * @brief Compare the cost of rendering an unchanged screen with that
+ *        of a full redraw.
+ *
+ * @param vdg: Pointer to the framebuffer.
+ *
+ * @retval `false` if an unchanged screen was redrawn at all.
+ */
+static bool bench_render(MC6847* vdg) {
+
+    const uint32_t count = 1000;
+
+    dragon_render(vdg);
+    uint32_t lines = 0;
+    double start = get_wall_seconds();
+    for (uint32_t i = 0 ; i < count ; ++i) lines += dragon_render(vdg);
+    double unchanged = (get_wall_seconds() - start) / count;
+
+    start = get_wall_seconds();
+    for (uint32_t i = 0 ; i < count ; ++i) {
+        vdg->is_valid = false;
+        dragon_render(vdg);
+    }
+    double full = (get_wall_seconds() - start) / count;
+
+    printf("Unchanged frame: %.2f us, %u scanlines; full redraw: %.2f us\n",
+           unchanged * 1e6, lines / count, full * 1e6);
+
+    if (lines > 0) fprintf(stderr, "[ERROR] %u scanlines redrawn over %u unchanged frames\n", lines, count);
+    return lines == 0;
+}
+
+
+/**
+ * @brief Load an S-record, Intel HEX or DECB program into the booted
+ *        machine and, if the file gives an entry point, run it.
+ *
+ * @param path:     The program file's path.
+ * @param frames:   The number of fields to run the program for.
+ * @param is_quiet: Don't print the screen afterwards.
+ *
+ * @retval Whether the program loaded.
+ */
+static bool run_program(const char* path, uint32_t frames, bool is_quiet) {
+
+    static LOADER loader;
+    loader_init(&loader, mem);
+
+    double start = get_wall_seconds();
+    uint8_t result = load_file(&loader, path);
+    double elapsed = get_wall_seconds() - start;
+
+    if (result != LOADER_OK) {
+        fprintf(stderr, "[ERROR] %s: %s (line %u)\n", path, loader_error_message(result), loader.line);
+        return false;
+    }
+
+    if (loader.bytes_loaded > 0 && loader.high_address >= DRAGON_ROM_START) {
+        fprintf(stderr, "[ERROR] %s overlaps ROM\n", path);
+        return false;
+    }
+
+    printf("Loaded %s: %u bytes in %u records, 0x%04X-0x%04X, %.3f ms\n",
+           path, loader.bytes_loaded, loader.records, loader.low_address, loader.high_address, elapsed * 1000.0);
+    if (!loader.has_entry) return true;
+
+    printf("Running from 0x%04X\n", loader.entry);
+    reg.pc = loader.entry;
+    for (uint32_t i = 0 ; i < frames && !dragon.is_halted ; ++i) {
+        dragon_run(DRAGON_CYCLES_PER_FIELD);
+        save_samples();
+        save_trace();
+    }
+
+    if (!is_quiet) print_screen();
+    return true;
+}
+
+
+/**
+ * @brief Type at the BASIC prompt through the keyboard matrix, a key
+ *        at a time, checking each line is echoed before ENTER sends it.
+ *
+ * @param keys:     The text to type. '\r', as two characters, is ENTER.
+ * @param is_quiet: Don't print the screen afterwards.
+ *
+ * @retval Whether every key was typed and every line echoed.
+ */
+static bool type_keys(const char* keys, bool is_quiet) {
+
+    // BASIC scans the keyboard once a field and debounces each key
+    const uint32_t key_fields = 3;
+    const uint32_t command_fields = 50;
+
+    char line[DRAGON_TEXT_COLS + 1];
+    uint32_t length = 0;
+    uint32_t typed = 0;
+
+    for (const char* key = keys ; *key != 0 ; ++key) {
+        char chr = *key;
+        if (chr == '\\' && key[1] == 'r') {
+            chr = '\r';
+            key++;
+        }
+
+        line[length] = 0;
+        if (chr == '\r' && !is_on_screen(line)) break;
+
+        if (!dragon_set_ascii_key(chr, true)) {
+            fprintf(stderr, "[ERROR] '%c' is not on the keyboard\n", chr);
+            return false;
+        }
+
+        run_fields(key_fields);
+        dragon_set_ascii_key(chr, false);
+        run_fields(key_fields);
+        typed++;
+
+        if (chr == '\r') {
+            length = 0;
+            run_fields(command_fields);
+        } else if (length < DRAGON_TEXT_COLS) {
+            // The screen shows lower case as upper case
+            line[length++] = chr >= 'a' && chr <= 'z' ? chr - 0x20 : chr;
+        }
+    }
+
+    // Any line not yet entered should still be on the screen
+    line[length] = 0;
+    if (!is_on_screen(line)) {
+        print_screen();
+        fprintf(stderr, "[ERROR] '%s' was not echoed\n", line);
+        return false;
+    }
+
+    if (!is_quiet) print_screen();
+    printf("Typed %u key(s)\n", typed);
+    return !dragon.is_halted;
+}
+
+
+/**
+ * @brief Run the machine a field at a time, collecting samples and
+ *        trace records as it goes.
+ *
+ * @param fields: The number of fields to run.
+ */
+static void run_fields(uint32_t fields) {
+
+    for (uint32_t i = 0 ; i < fields && !dragon.is_halted ; ++i) {
+        dragon_run(DRAGON_CYCLES_PER_FIELD);
+        save_samples();
+        save_trace();
+    }
+}
+
+
+/**
+ * @brief Check whether a line of the text screen starts with some text.
+ *
+ * @param text: The text, in upper case.
+ *
+ * @retval Whether a line starts with the text.
+ */
+static bool is_on_screen(const char* text) {
+
+    static char screen[DRAGON_TEXT_ROWS * (DRAGON_TEXT_COLS + 1)];
+    dragon_get_screen_text(screen);
+
+    for (uint32_t i = 0 ; i < DRAGON_TEXT_ROWS ; ++i) {
+        if (strncmp(&screen[i * (DRAGON_TEXT_COLS + 1)], text, strlen(text)) == 0) return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief Get a monotonic time stamp.
+ *
+ * @retval The time in seconds.
+ */
+static double get_wall_seconds(void) {
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+/**
+ * @brief Print the text screen, framed.
+ */
+static void print_screen(void) {
+
+    static char text[DRAGON_TEXT_ROWS * (DRAGON_TEXT_COLS + 1)];
+    dragon_get_screen_text(text);
+
+    printf("+--------------------------------+\n");
+    for (uint32_t i = 0 ; i < DRAGON_TEXT_ROWS ; ++i) {
+        printf("|%s|\n", &text[i * (DRAGON_TEXT_COLS + 1)]);
+    }
+    printf("+--------------------------------+\n");
+}
+
+
+/**
+ * @brief Write out the PC samples taken so far, one per line: the
+ *        stacked return addresses, outermost first, then the PC.
+ *        A leading '...' marks a stack too deep to keep whole.
+ */
+static void save_samples(void) {
+
+#ifdef E6809_SAMPLE
+    SAMPLE sample;
+    if (sample_file == NULL) return;
+    while (sample_get(&sample)) {
+        uint8_t depth = sample.depth & ~SAMPLE_TRUNCATED;
+        if (sample.depth & SAMPLE_TRUNCATED) fprintf(sample_file, "... ");
+        for (uint8_t i = 0 ; i < depth ; ++i) fprintf(sample_file, "%04X ", sample.stack[i]);
+        fprintf(sample_file, "%04X\n", sample.pc);
+    }
+#endif
+}
+
+
+/**
+ * @brief Write out the trace records stored so far, delta-encoded.
+ */
+static void save_trace(void) {
+
+#ifdef E6809_TRACE
+    static uint8_t data[4096];
+    if (trace_file == NULL) return;
+
+    uint32_t length;
+    while ((length = trace_read(data, sizeof(data))) > 0) fwrite(data, 1, length, trace_file);
+#endif
+}
+
+
+/**
+ * @brief Write out the memory access counts: as an image if the file
+ *        name ends '.ppm', otherwise as CSV.
+ *
+ * @param path: The output file's path.
+ *
+ * @retval Whether the file was written.
+ */
+static bool write_heatmap(const char* path) {
+
+    heatmap_file = fopen(path, "wb");
+    if (heatmap_file == NULL) {
+        fprintf(stderr, "[ERROR] Cannot create %s\n", path);
+        return false;
+    }
+
+    size_t length = strlen(path);
+    if (length > 4 && strcmp(&path[length - 4], ".ppm") == 0) {
+        heatmap_ppm(heatmap_out);
+    } else {
+        heatmap_csv(heatmap_out);
+    }
+
+    bool is_written = ferror(heatmap_file) == 0;
+    fclose(heatmap_file);
+    heatmap_file = NULL;
+
+    if (!is_written) fprintf(stderr, "[ERROR] Cannot write %s\n", path);
+    return is_written;
+}
+
+
+/**
+ * @brief Write heatmap output to the open heatmap file.
+ */
+static void heatmap_out(const char* text, uint32_t length) {
+
+    fwrite(text, 1, length, heatmap_file);
+}
+
+
+/**
+ * @brief Write out the coverage maps, after COVERAGE_FILE_MAGIC, and
+ *        summarise them.
+ *
+ * @param path: The output file's path.
+ *
+ * @retval Whether the file was written.
+ */
+static bool write_coverage(const char* path) {
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "[ERROR] Cannot create %s\n", path);
+        return false;
+    }
+
+    fwrite(COVERAGE_FILE_MAGIC, 1, COVERAGE_FILE_MAGIC_SIZE, file);
+    fwrite(coverage.maps, 1, COVERAGE_SIZE, file);
+    bool is_written = ferror(file) == 0;
+    fclose(file);
+
+    if (!is_written) {
+        fprintf(stderr, "[ERROR] Cannot write %s\n", path);
+        return false;
+    }
+
+    printf("Coverage:       %u bytes executed, %u branches taken, %u not taken\n",
+           coverage_count(&coverage, COVERAGE_EXECUTED), coverage_count(&coverage, COVERAGE_TAKEN),
+           coverage_count(&coverage, COVERAGE_NOT_TAKEN));
+    return true;
+}
+
+
+/**
+ * @brief Show usage information.
+ */
+static void show_help(void) {
+
+    printf("Usage: e6809_d32 [-r runs] [-f max_frames] [-p ppm_file] [-l program] [-k keys] [-s sample_file] [-i period] [-m heatmap_file] [-c coverage_file] [-t trace_file] [-q] <rom file>\n");
+    printf("  -r  Boot the ROM this many times and report the best wall time\n");
+    printf("  -f  Give up after this many video fields. Default: 500\n");
+    printf("  -p  Render every field and save the final frame as a PPM image\n");
+    printf("  -l  After booting, load an S-record, Intel HEX or DECB program and run it\n");
+    printf("  -k  After booting, type at the prompt and check BASIC echoes each line. '\\r' is ENTER\n");
+    printf("  -s  Sample the PC and call stack to a file, for scripts/flame.py. Needs E6809_SAMPLE\n");
+    printf("  -i  Cycles between samples. Default: %u\n", SAMPLE_DEFAULT_PERIOD);
+    printf("  -m  Count memory fetches, reads and writes by address and save them as CSV,\n");
+    printf("      or as a 256x256 image if the file name ends '.ppm'\n");
+    printf("  -c  Record the bytes executed and the branches taken and not taken, for scripts/coverage.py\n");
+    printf("  -t  Trace every instruction to a file, for scripts/trace.py. Needs E6809_TRACE\n");
+    printf("  -q  Don't print the screen\n");
+}
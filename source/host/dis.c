@@ -0,0 +1,240 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Host disassembler
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+// App
+#include "cpu.h"
+#include "disasm.h"
+#include "loader.h"
+#include "file_loader.h"
+
+
+/*
+ * STATICS
+ */
+static bool     load_binary(const char* path, uint32_t base);
+static bool     load_program(const char* path);
+static void     list_ops(uint32_t start, uint32_t end);
+static void     time_ops(uint32_t start, uint32_t end, uint32_t runs);
+static double   get_wall_seconds(void);
+static void     show_help(void);
+
+
+/*
+ * GLOBALS
+ */
+// The 64KB space, plus a copy of its first bytes so ops at the top
+// of memory wrap round, as the CPU reads them
+static uint8_t      memory[KB64 + DISASM_MAX_BYTES];
+static uint32_t     low_address = 0;
+static uint32_t     high_address = 0;
+
+
+/**
+ * @brief Disassemble a program or a binary image.
+ *
+ *        Usage: e6809_dis [-b base] [-s start] [-e end] [-r runs] <file>
+ *
+ * @retval 0 if the file was disassembled, otherwise 1.
+ */
+int main(int argc, char* argv[]) {
+
+    const char* path = NULL;
+    uint32_t base = 0;
+    uint32_t start = 0;
+    uint32_t end = 0;
+    uint32_t runs = 0;
+    bool is_binary = false;
+    bool has_start = false;
+    bool has_end = false;
+
+    for (int i = 1 ; i < argc ; ++i) {
+        if (strcmp(argv[i], "-b") == 0 && i < argc - 1) {
+            base = (uint32_t)strtoul(argv[++i], NULL, 0);
+            is_binary = true;
+        } else if (strcmp(argv[i], "-s") == 0 && i < argc - 1) {
+            start = (uint32_t)strtoul(argv[++i], NULL, 0);
+            has_start = true;
+        } else if (strcmp(argv[i], "-e") == 0 && i < argc - 1) {
+            end = (uint32_t)strtoul(argv[++i], NULL, 0);
+            has_end = true;
+        } else if (strcmp(argv[i], "-r") == 0 && i < argc - 1) {
+            runs = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-h") == 0) {
+            show_help();
+            return 0;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    if (path == NULL || base >= KB64) {
+        show_help();
+        return 1;
+    }
+
+    if (!(is_binary ? load_binary(path, base) : load_program(path))) return 1;
+    memcpy(&memory[KB64], memory, DISASM_MAX_BYTES);
+
+    if (!has_start) start = low_address;
+    if (!has_end) end = high_address;
+    if (start >= KB64 || end >= KB64 || end < start) {
+        fprintf(stderr, "[ERROR] Bad address range 0x%04X-0x%04X\n", start, end);
+        return 1;
+    }
+
+    if (runs > 0) {
+        time_ops(start, end, runs);
+    } else {
+        list_ops(start, end);
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief Read a binary image into memory.
+ *
+ * @param path: The file's path.
+ * @param base: The address of its first byte.
+ *
+ * @retval Whether the image was read.
+ */
+static bool load_binary(const char* path, uint32_t base) {
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "[ERROR] Cannot open %s\n", path);
+        return false;
+    }
+
+    size_t count = fread(&memory[base], 1, KB64 - base, file);
+    fclose(file);
+
+    if (count == 0) {
+        fprintf(stderr, "[ERROR] %s is empty\n", path);
+        return false;
+    }
+
+    low_address = base;
+    high_address = base + count - 1;
+    return true;
+}
+
+
+/**
+ * @brief Load an S-record, Intel HEX or DECB program into memory.
+ *
+ * @param path: The file's path.
+ *
+ * @retval Whether the program was loaded.
+ */
+static bool load_program(const char* path) {
+
+    static LOADER loader;
+    loader_init(&loader, memory);
+
+    uint8_t result = load_file(&loader, path);
+    if (result != LOADER_OK) {
+        fprintf(stderr, "[ERROR] %s: %s (line %u)\n", path, loader_error_message(result), loader.line);
+        return false;
+    }
+
+    if (loader.bytes_loaded == 0) {
+        fprintf(stderr, "[ERROR] %s holds no data\n", path);
+        return false;
+    }
+
+    low_address = loader.low_address;
+    high_address = loader.high_address;
+    return true;
+}
+
+
+/**
+ * @brief Print an op per line: its address, bytes and text.
+ */
+static void list_ops(uint32_t start, uint32_t end) {
+
+    char text[DISASM_TEXT_SIZE];
+    char hex[DISASM_MAX_BYTES * 3 + 1];
+    uint32_t address = start;
+    while (address <= end) {
+        uint8_t length = disasm(&memory[address], address, text);
+        for (uint8_t i = 0 ; i < length ; ++i) sprintf(&hex[i * 3], i < length - 1 ? "%02X " : "%02X", memory[address + i]);
+        printf("%04X  %-15s %s\n", address, hex, text);
+        address += length;
+    }
+}
+
+
+/**
+ * @brief Disassemble a range repeatedly, without output, and report the
+ *        best speed.
+ */
+static void time_ops(uint32_t start, uint32_t end, uint32_t runs) {
+
+    char text[DISASM_TEXT_SIZE];
+    uint32_t ops = 0;
+    uint32_t check = 0;
+    double best = 0.0;
+
+    for (uint32_t i = 0 ; i < runs ; ++i) {
+        ops = 0;
+        double begin = get_wall_seconds();
+        uint32_t address = start;
+        while (address <= end) {
+            address += disasm(&memory[address], address, text);
+            check += text[0];
+            ops++;
+        }
+
+        double elapsed = get_wall_seconds() - begin;
+        if (i == 0 || elapsed < best) best = elapsed;
+    }
+
+    // Print the checksum of the text so the work can't be optimised away
+    printf("%u ops, 0x%04X-0x%04X, %.3f ms best of %u run(s), checksum %u\n", ops, start, end, best * 1000.0, runs, check);
+    if (best > 0.0) printf("Speed: %.1f million ops per second\n", ops / best / 1000000.0);
+}
+
+
+/**
+ * @brief Get a monotonic time stamp.
+ *
+ * @retval The time in seconds.
+ */
+static double get_wall_seconds(void) {
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+/**
+ * @brief Show usage information.
+ */
+static void show_help(void) {
+
+    printf("Usage: e6809_dis [-b base] [-s start] [-e end] [-r runs] <file>\n");
+    printf("  -b  Read the file as a binary image loaded at this address, eg. 0x8000.\n");
+    printf("      Otherwise, it is loaded as an S-record, Intel HEX or DECB program\n");
+    printf("  -s  Start at this address. Default: the lowest address loaded\n");
+    printf("  -e  Stop after the op at this address. Default: the highest address loaded\n");
+    printf("  -r  Disassemble this many times without output and report the speed\n");
+}
@@ -0,0 +1,242 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Disassembler tests
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "main.h"
+#include "cpu.h"
+#include "disasm.h"
+
+
+/*
+ * STATICS
+ */
+static void test_lengths(void);
+static void test_modes(void);
+static void test_indexed(void);
+static void test_illegal(void);
+static void test_all_ops(void);
+static void test_cpu_lengths(void);
+static bool is_control_flow(const DISASM_OP* op);
+static bool check_text(const uint8_t* bytes, uint16_t address, const char* expected);
+static void check(bool is_good, const char* name);
+
+
+/*
+ * GLOBALS
+ */
+uint32_t errors = 0;
+uint32_t passes = 0;
+uint32_t tests = 0;
+
+extern REG_6809     reg;
+extern uint8_t      mem[KB64];
+
+
+int main(void) {
+
+    test_lengths();
+    test_modes();
+    test_indexed();
+    test_illegal();
+    test_all_ops();
+    test_cpu_lengths();
+
+    printf("Tests: %i\n", tests);
+    printf("Passes: %i\n", passes);
+    printf("Fails: %i\n", errors);
+    return errors == 0 ? 0 : 1;
+}
+
+
+static void test_lengths(void) {
+
+    tests++;
+    const uint8_t ops[][DISASM_MAX_BYTES] = {
+        {0x12},                             // NOP
+        {0x10, 0xAE, 0x9F, 0x12, 0x34},     // LDY [$1234]
+        {0x10, 0x27, 0x12, 0x34},           // LBEQ
+        {0x11, 0x3F},                       // SWI3
+        {0xA6, 0x89, 0x12, 0x34},           // LDA $1234,X
+        {0x30, 0x8C, 0x12},                 // LEAX 18,PCR
+        {0x30, 0x05},                       // LEAX 5,X
+        {0x10, 0x10, 0x8E, 0x12, 0x34},     // LDY # with a repeated prefix
+        {0x17, 0x12, 0x34},                 // LBSR
+        {0x34, 0x16}                        // PSHS
+    };
+    const uint8_t lengths[] = {1, 5, 4, 2, 4, 3, 2, 5, 3, 2};
+
+    bool is_good = true;
+    for (uint32_t i = 0 ; i < sizeof(lengths) ; ++i) {
+        if (disasm_length(ops[i]) != lengths[i]) {
+            printf("  Op %u: length %u\n", i, disasm_length(ops[i]));
+            is_good = false;
+        }
+    }
+
+    check(is_good, "Op lengths");
+}
+
+
+static void test_modes(void) {
+
+    tests++;
+    check(check_text((uint8_t[]){0x12, 0, 0, 0, 0}, 0x1000, "NOP"), "Inherent");
+    check(check_text((uint8_t[]){0x86, 0x0A, 0, 0, 0}, 0x1000, "LDA   #$0A"), "Immediate 8-bit");
+    check(check_text((uint8_t[]){0x10, 0x8E, 0x12, 0x34, 0}, 0x1000, "LDY   #$1234"), "Immediate 16-bit, page 1");
+    check(check_text((uint8_t[]){0x11, 0x83, 0xBE, 0xEF, 0}, 0x1000, "CMPU  #$BEEF"), "Immediate 16-bit, page 2");
+    check(check_text((uint8_t[]){0x97, 0x40, 0, 0, 0}, 0x1000, "STA   <$40"), "Direct");
+    check(check_text((uint8_t[]){0x7E, 0xC0, 0x00, 0, 0}, 0x1000, "JMP   $C000"), "Extended");
+    check(check_text((uint8_t[]){0x20, 0xFE, 0, 0, 0}, 0x1000, "BRA   $1000"), "Branch back");
+    check(check_text((uint8_t[]){0x8D, 0x10, 0, 0, 0}, 0x1000, "BSR   $1012"), "Branch forward");
+    check(check_text((uint8_t[]){0x10, 0x26, 0xFF, 0xFC, 0}, 0x1000, "LBNE  $1000"), "Long branch");
+    check(check_text((uint8_t[]){0x17, 0x10, 0x00, 0, 0}, 0xF000, "LBSR  $0003"), "Long branch wraps");
+    check(check_text((uint8_t[]){0x1F, 0x8B, 0, 0, 0}, 0x1000, "TFR   A,DP"), "Transfer");
+    check(check_text((uint8_t[]){0x1E, 0x15, 0, 0, 0}, 0x1000, "EXG   X,PC"), "Exchange");
+    check(check_text((uint8_t[]){0x34, 0xFF, 0, 0, 0}, 0x1000, "PSHS  PC,U,Y,X,DP,B,A,CC"), "Push all");
+    check(check_text((uint8_t[]){0x37, 0x46, 0, 0, 0}, 0x1000, "PULU  S,B,A"), "Pull from U");
+    check(check_text((uint8_t[]){0x1C, 0xAF, 0, 0, 0}, 0x1000, "ANDCC #$AF"), "Long mnemonic");
+}
+
+
+static void test_indexed(void) {
+
+    tests++;
+    check(check_text((uint8_t[]){0xA6, 0x05, 0, 0, 0}, 0x1000, "LDA   $05,X"), "5-bit offset");
+    check(check_text((uint8_t[]){0xA6, 0x7F, 0, 0, 0}, 0x1000, "LDA   -$01,S"), "Negative 5-bit offset");
+    check(check_text((uint8_t[]){0xA6, 0xA0, 0, 0, 0}, 0x1000, "LDA   ,Y+"), "Post-increment");
+    check(check_text((uint8_t[]){0xEC, 0xC1, 0, 0, 0}, 0x1000, "LDD   ,U++"), "Post-increment by 2");
+    check(check_text((uint8_t[]){0xA6, 0xE2, 0, 0, 0}, 0x1000, "LDA   ,-S"), "Pre-decrement");
+    check(check_text((uint8_t[]){0xEC, 0x93, 0, 0, 0}, 0x1000, "LDD   [,--X]"), "Indirect pre-decrement by 2");
+    check(check_text((uint8_t[]){0xA6, 0x84, 0, 0, 0}, 0x1000, "LDA   ,X"), "No offset");
+    check(check_text((uint8_t[]){0xA6, 0x85, 0, 0, 0}, 0x1000, "LDA   B,X"), "B offset");
+    check(check_text((uint8_t[]){0xA6, 0x86, 0, 0, 0}, 0x1000, "LDA   A,X"), "A offset");
+    check(check_text((uint8_t[]){0xA6, 0x8B, 0, 0, 0}, 0x1000, "LDA   D,X"), "D offset");
+    check(check_text((uint8_t[]){0xA6, 0x88, 0x80, 0, 0}, 0x1000, "LDA   -$80,X"), "8-bit offset");
+    check(check_text((uint8_t[]){0xA6, 0xB8, 0x10, 0, 0}, 0x1000, "LDA   [$10,Y]"), "Indirect 8-bit offset");
+    check(check_text((uint8_t[]){0xA6, 0x89, 0x12, 0x34, 0}, 0x1000, "LDA   $1234,X"), "16-bit offset");
+    check(check_text((uint8_t[]){0x30, 0x8C, 0xFD, 0, 0}, 0x1000, "LEAX  $1000,PCR"), "8-bit PC-relative");
+    check(check_text((uint8_t[]){0x10, 0xAE, 0x9D, 0x01, 0x00}, 0x1000, "LDY   [$1105,PCR]"), "Indirect 16-bit PC-relative");
+    check(check_text((uint8_t[]){0xAD, 0x9F, 0xFF, 0xFE, 0}, 0x1000, "JSR   [$FFFE]"), "Extended indirect");
+}
+
+
+static void test_illegal(void) {
+
+    tests++;
+    DISASM_OP op;
+    check(disasm_decode((uint8_t[]){0x01, 0x40, 0, 0, 0}, 0x1000, &op) == 2 && !op.is_valid
+          && check_text((uint8_t[]){0x01, 0x40, 0, 0, 0}, 0x1000, "???"), "Illegal op takes its operands");
+    check(disasm_decode((uint8_t[]){0x10, 0x86, 0x12, 0, 0}, 0x1000, &op) == 3 && !op.is_valid, "Illegal prefixed op");
+    check(disasm_decode((uint8_t[]){0xA6, 0x87, 0, 0, 0}, 0x1000, &op) == 2 && !op.is_valid
+          && check_text((uint8_t[]){0xA6, 0x87, 0, 0, 0}, 0x1000, "LDA   ???"), "Unused indexed form");
+    check(disasm_decode((uint8_t[]){0xA6, 0x90, 0, 0, 0}, 0x1000, &op) == 2 && !op.is_valid, "Indirect post-increment by 1");
+    check(disasm_decode((uint8_t[]){0x10, 0x10, 0x10, 0x10, 0x8E}, 0x1000, &op) == DISASM_MAX_BYTES && !op.is_valid, "Prefixes run past the bytes");
+}
+
+
+static void test_all_ops(void) {
+
+    // Every op and postbyte decodes to text that fits, at the length
+    // disasm_length() gives
+    tests++;
+    bool is_good = true;
+    char text[DISASM_TEXT_SIZE + 8];
+    uint8_t bytes[DISASM_MAX_BYTES];
+    for (uint32_t page = 0 ; page < 3 ; ++page) {
+        for (uint32_t opcode = 0 ; opcode < 256 ; ++opcode) {
+            for (uint32_t post_byte = 0 ; post_byte < 256 ; ++post_byte) {
+                uint8_t index = 0;
+                if (page > 0) bytes[index++] = page == 1 ? OPCODE_EXTENDED_1 : OPCODE_EXTENDED_2;
+                bytes[index++] = opcode;
+                bytes[index++] = post_byte;
+                while (index < DISASM_MAX_BYTES) bytes[index++] = 0xFF;
+
+                memset(text, 0x55, sizeof(text));
+                uint8_t length = disasm(bytes, 0x8000, text);
+                if (length != disasm_length(bytes) || strlen(text) >= DISASM_TEXT_SIZE) {
+                    if (is_good) printf("  Page %u op %02X postbyte %02X: length %u, '%s'\n", page, opcode, post_byte, length, text);
+                    is_good = false;
+                }
+            }
+        }
+    }
+
+    check(is_good, "All ops decode");
+}
+
+
+static void test_cpu_lengths(void) {
+
+    // Every legal op that doesn't change the flow moves the PC on by its length
+    tests++;
+    bool is_good = true;
+    for (uint32_t page = 0 ; page < 3 ; ++page) {
+        for (uint32_t opcode = 0 ; opcode < 256 ; ++opcode) {
+            memset(mem, 0, KB64);
+            uint16_t address = 0x1000;
+            if (page > 0) mem[address++] = page == 1 ? OPCODE_EXTENDED_1 : OPCODE_EXTENDED_2;
+            mem[address] = opcode;
+
+            DISASM_OP op;
+            disasm_decode(&mem[0x1000], 0x1000, &op);
+            if (!op.is_valid || is_control_flow(&op)) continue;
+
+            memset(&reg, 0, sizeof(reg));
+            init_cpu();
+            reg.pc = 0x1000;
+            reg.s = 0x8000;
+            reg.u = 0x7000;
+            process_next_instruction();
+            if (reg.pc != 0x1000 + op.length) {
+                printf("  %s (page %u op %02X): PC 0x%04X, length %u\n", op.mnemonic, page, opcode, reg.pc, op.length);
+                is_good = false;
+            }
+        }
+    }
+
+    check(is_good, "Lengths match the CPU");
+}
+
+
+static bool is_control_flow(const DISASM_OP* op) {
+
+    const char* names[] = {"JMP", "JSR", "RTS", "RTI", "SWI", "SWI2", "SWI3", "CWAI", "SYNC"};
+    if (op->mode == DISASM_MODE_RELATIVE_8 || op->mode == DISASM_MODE_RELATIVE_16) return true;
+    for (uint32_t i = 0 ; i < sizeof(names) / sizeof(names[0]) ; ++i) {
+        if (strcmp(op->mnemonic, names[i]) == 0) return true;
+    }
+
+    return false;
+}
+
+
+static bool check_text(const uint8_t* bytes, uint16_t address, const char* expected) {
+
+    char text[DISASM_TEXT_SIZE];
+    disasm(bytes, address, text);
+    if (strcmp(text, expected) == 0) return true;
+    printf("  Got '%s', expected '%s'\n", text, expected);
+    return false;
+}
+
+
+static void check(bool is_good, const char* name) {
+
+    if (is_good) {
+        passes++;
+    } else {
+        errors++;
+        printf("  %02d. %s failed\n", tests, name);
+    }
+}
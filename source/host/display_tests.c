@@ -0,0 +1,249 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * HT16K33 driver tests, on the mock I2C bus
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ht16k33.h"
+#include "mock_i2c.h"
+#include "mock_transfer.h"
+
+
+/*
+ * STATICS
+ */
+static void test_init(void);
+static void test_skip(void);
+static void test_partial(void);
+static void test_flush(void);
+static void test_savings(void);
+static void test_queue_full(void);
+static void test_setup(void);
+static void check(bool is_good, const char* name);
+static void show_value(uint8_t index, uint16_t value);
+static bool chip_matches(uint8_t index);
+
+
+/*
+ * GLOBALS
+ */
+uint32_t errors = 0;
+uint32_t passes = 0;
+uint32_t tests = 0;
+
+// As the monitor sets them up
+uint8_t  buffer[32];
+uint8_t* display_buffer[2] = {buffer, buffer + 16};
+uint8_t  display_address[2] = {0x71, 0x70};
+
+extern HT16K33_STATS ht16k33_stats;
+
+
+int main(void) {
+
+    test_init();
+    test_skip();
+    test_partial();
+    test_flush();
+    test_savings();
+    test_queue_full();
+
+    printf("Tests: %i\n", tests);
+    printf("Passes: %i\n", passes);
+    printf("Fails: %i\n", errors);
+    return errors == 0 ? 0 : 1;
+}
+
+
+static void test_init(void) {
+
+    // Power, brightness, then the whole RAM
+    test_setup();
+    memset(mock_i2c_bus.ram[0x71], 0xFF, MOCK_I2C_RAM_SIZE);
+    ht16k33_init(display_address[0], display_buffer[0]);
+    check(mock_i2c_bus.transactions == 4 && mock_i2c_bus.bytes == 3 + HT16K33_RAM_SIZE + 1, "Init writes all RAM");
+    check(chip_matches(0), "Init clears the chip");
+}
+
+
+static void test_skip(void) {
+
+    test_setup();
+    ht16k33_init(display_address[0], display_buffer[0]);
+    show_value(0, 0x1234);
+    ht16k33_flush();
+
+    // Redrawing the same value costs nothing
+    mock_i2c_bus.transactions = 0;
+    show_value(0, 0x1234);
+    ht16k33_flush();
+    ht16k33_draw(display_address[0], display_buffer[0]);
+    check(mock_i2c_bus.transactions == 0 && ht16k33_stats.skipped == 2, "Unchanged draws skipped");
+    check(chip_matches(0), "Chip still matches");
+}
+
+
+static void test_partial(void) {
+
+    test_setup();
+    ht16k33_init(display_address[0], display_buffer[0]);
+    show_value(0, 0x1234);
+    ht16k33_flush();
+
+    // One digit: its RAM address and one byte
+    mock_i2c_bus.transactions = 0;
+    mock_i2c_bus.bytes = 0;
+    show_value(0, 0x1235);
+    ht16k33_flush();
+    check(mock_i2c_bus.transactions == 1 && mock_i2c_bus.bytes == 2 && chip_matches(0), "Last digit only");
+
+    // First and last digits: the run between them
+    mock_i2c_bus.bytes = 0;
+    show_value(0, 0x2236);
+    ht16k33_flush();
+    check(mock_i2c_bus.bytes == 1 + 9 && chip_matches(0), "Run of changed bytes");
+
+    // After invalidating, everything goes again
+    mock_i2c_bus.bytes = 0;
+    ht16k33_invalidate(display_address[0]);
+    ht16k33_draw(display_address[0], display_buffer[0]);
+    check(mock_i2c_bus.bytes == 1 + HT16K33_RAM_SIZE && chip_matches(0), "Invalidate forces a full write");
+}
+
+
+static void test_flush(void) {
+
+    // Several changes to both displays: one write each at the flush
+    test_setup();
+    ht16k33_init(display_address[0], display_buffer[0]);
+    ht16k33_init(display_address[1], display_buffer[1]);
+    mock_i2c_bus.transactions = 0;
+
+    show_value(0, 0x1111);
+    show_value(1, 0x2222);
+    show_value(0, 0xABCD);
+    show_value(1, 0x00EF);
+    check(mock_i2c_bus.transactions == 0, "Queued draws wait for the flush");
+
+    ht16k33_flush();
+    check(mock_i2c_bus.transactions == 2 && chip_matches(0) && chip_matches(1), "One write per display");
+
+    ht16k33_flush();
+    check(mock_i2c_bus.transactions == 2, "Nothing left to flush");
+}
+
+
+static void test_savings(void) {
+
+    // Track a PC stepping through 1000 instructions, redrawing both
+    // displays each time as the monitor does; before, each redraw was
+    // two 17-byte writes
+    test_setup();
+    ht16k33_init(display_address[0], display_buffer[0]);
+    ht16k33_init(display_address[1], display_buffer[1]);
+    mock_i2c_bus.transactions = 0;
+    mock_i2c_bus.bytes = 0;
+
+    uint16_t pc = 0x4000;
+    bool is_good = true;
+    for (uint32_t i = 0 ; i < 1000 ; ++i) {
+        pc += (i % 3) + 1;
+        show_value(0, pc);
+        show_value(1, (i / 50) & 0xFF);
+        ht16k33_flush();
+        is_good &= chip_matches(0) && chip_matches(1);
+    }
+
+    uint32_t before = 1000 * 2 * (HT16K33_RAM_SIZE + 1);
+    printf("1000 redraws: %u transactions, %u bytes (was 2000, %u)\n", mock_i2c_bus.transactions, mock_i2c_bus.bytes, before);
+    check(is_good, "Chips track every redraw");
+    check(mock_i2c_bus.transactions < 1100 && mock_i2c_bus.bytes < before / 4, "I2C traffic cut");
+}
+
+
+static void test_queue_full(void) {
+
+    // With the bus queue full, a draw waits for the next flush rather
+    // than for the bus
+    test_setup();
+    ht16k33_init(display_address[0], display_buffer[0]);
+    mock_transfer_reset();
+    transfer_init(&mock_transfer_port);
+    ht16k33_stats.transactions = 0;
+    uint8_t byte = 0;
+    for (uint8_t i = 0 ; i < TRANSFER_QUEUE_SIZE ; ++i) transfer_queue(TRANSFER_BUS_I2C, 0x50, &byte, 1, 0, NULL, NULL);
+
+    show_value(0, 0x1234);
+    ht16k33_flush();
+    check(mock_transfer.started == 1 && ht16k33_stats.transactions == 0, "Draw refused");
+
+    ht16k33_flush();
+    check(mock_transfer.started == 1, "Still waiting");
+
+    // A slot frees: the flush sends the latest value
+    show_value(0, 0x5678);
+    mock_transfer_finish(TRANSFER_BUS_I2C, TRANSFER_OK, NULL, 0);
+    transfer_poll();
+    ht16k33_flush();
+    for (uint8_t i = 0 ; i < TRANSFER_QUEUE_SIZE ; ++i) {
+        mock_transfer_finish(TRANSFER_BUS_I2C, TRANSFER_OK, NULL, 0);
+        transfer_poll();
+    }
+
+    TRANSFER_JOB* job = &mock_transfer.log[TRANSFER_QUEUE_SIZE];
+    check(mock_transfer.started == TRANSFER_QUEUE_SIZE + 1 && job->target == display_address[0]
+          && job->data[0] == HT16K33_GENERIC_DISPLAY_ADDRESS && memcmp(&job->data[1], display_buffer[0], job->length - 1) == 0, "Sent once there is room");
+
+    ht16k33_flush();
+    check(mock_transfer.started == TRANSFER_QUEUE_SIZE + 1, "Sent once");
+}
+
+
+static void test_setup(void) {
+
+    tests++;
+    transfer_init(NULL);
+    mock_i2c_reset();
+    memset(&ht16k33_stats, 0, sizeof(ht16k33_stats));
+    memset(buffer, 0, sizeof(buffer));
+    ht16k33_invalidate(display_address[0]);
+    ht16k33_invalidate(display_address[1]);
+}
+
+
+static void check(bool is_good, const char* name) {
+
+    if (is_good) {
+        passes++;
+    } else {
+        errors++;
+        printf("  %02d. %s failed\n", tests, name);
+    }
+}
+
+
+static void show_value(uint8_t index, uint16_t value) {
+
+    // The monitor's display_value()
+    ht16k33_clear(display_address[index], display_buffer[index]);
+    for (uint8_t i = 0 ; i < 4 ; ++i) {
+        ht16k33_set_number(display_address[index], display_buffer[index], (value >> (12 - i * 4)) & 0x0F, i, false);
+    }
+
+    ht16k33_queue(display_address[index], display_buffer[index]);
+}
+
+
+static bool chip_matches(uint8_t index) {
+
+    return memcmp(mock_i2c_bus.ram[display_address[index]], display_buffer[index], HT16K33_RAM_SIZE) == 0;
+}
@@ -0,0 +1,172 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Dragon 32 keyboard matrix tests
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "main.h"
+#include "cpu.h"
+#include "dragon.h"
+
+
+/*
+ * STATICS
+ */
+static void test_matrix(void);
+static void test_ascii(void);
+static void test_shift(void);
+static uint8_t read_rows(uint8_t col);
+static bool is_down(uint8_t row, uint8_t col);
+static void test_setup(void);
+static void check(bool is_good, const char* name);
+
+
+/*
+ * GLOBALS
+ */
+uint32_t errors = 0;
+uint32_t passes = 0;
+uint32_t tests = 0;
+
+extern MEMORY_MAP_6809  memory_map;
+
+
+int main(void) {
+
+    test_matrix();
+    test_ascii();
+    test_shift();
+
+    printf("Tests: %i\n", tests);
+    printf("Passes: %i\n", passes);
+    printf("Fails: %i\n", errors);
+    return errors == 0 ? 0 : 1;
+}
+
+
+static void test_matrix(void) {
+
+    // Nothing pressed: every row reads high
+    test_setup();
+    check(read_rows(0) == 0xFF && read_rows(7) == 0xFF, "No keys");
+
+    // A key pulls its row low only while its column is driven low
+    dragon_set_key(2, 1, true);
+    check(read_rows(1) == 0xFB, "Key row low");
+    check(read_rows(0) == 0xFF, "Other column high");
+
+    dragon_set_key(2, 1, false);
+    check(read_rows(1) == 0xFF, "Key released");
+
+    // Out of range keys are ignored
+    dragon_set_key(DRAGON_KEY_ROWS, 0, true);
+    dragon_set_key(0, DRAGON_KEY_COLS, true);
+    check(read_rows(0) == 0xFF, "Out of range");
+}
+
+
+static void test_ascii(void) {
+
+    test_setup();
+    check(dragon_set_ascii_key('A', true) && is_down(2, 1) && !is_down(DRAGON_KEY_ROW_SHIFT, DRAGON_KEY_COL_SHIFT), "Letter");
+    dragon_set_ascii_key('A', false);
+
+    check(dragon_set_ascii_key('a', true) && is_down(2, 1), "Lower case");
+    dragon_set_ascii_key('a', false);
+
+    check(dragon_set_ascii_key('0', true) && is_down(0, 0), "Zero");
+    dragon_set_ascii_key('0', false);
+
+    check(dragon_set_ascii_key('\r', true) && is_down(6, 0), "ENTER");
+    dragon_set_ascii_key('\r', false);
+
+    check(dragon_set_ascii_key('$', true) && is_down(0, 4) && is_down(DRAGON_KEY_ROW_SHIFT, DRAGON_KEY_COL_SHIFT), "Shifted");
+    dragon_set_ascii_key('$', false);
+    check(!is_down(0, 4) && !is_down(DRAGON_KEY_ROW_SHIFT, DRAGON_KEY_COL_SHIFT), "Shifted released");
+
+    check(!dragon_set_ascii_key('[', true) && !dragon_set_ascii_key((char)0x80, true), "Unmapped");
+}
+
+
+static void test_shift(void) {
+
+    // SHIFT stays down while any shifted character is held
+    test_setup();
+    dragon_set_ascii_key('"', true);
+    dragon_set_ascii_key('$', true);
+    dragon_set_ascii_key('"', false);
+    check(is_down(DRAGON_KEY_ROW_SHIFT, DRAGON_KEY_COL_SHIFT) && is_down(0, 4), "Shift held");
+
+    dragon_set_ascii_key('$', false);
+    check(!is_down(DRAGON_KEY_ROW_SHIFT, DRAGON_KEY_COL_SHIFT), "Shift released");
+
+    // Releasing an unshifted key leaves it alone, as does a spare release
+    dragon_set_ascii_key('!', true);
+    dragon_set_ascii_key('A', true);
+    dragon_set_ascii_key('A', false);
+    check(is_down(DRAGON_KEY_ROW_SHIFT, DRAGON_KEY_COL_SHIFT), "Unshifted release");
+
+    dragon_set_ascii_key('!', false);
+    dragon_set_ascii_key('!', false);
+    dragon_set_ascii_key('#', true);
+    bool is_shifted = is_down(DRAGON_KEY_ROW_SHIFT, DRAGON_KEY_COL_SHIFT);
+    dragon_set_ascii_key('#', false);
+    check(is_shifted && !is_down(DRAGON_KEY_ROW_SHIFT, DRAGON_KEY_COL_SHIFT), "Spare release");
+}
+
+
+/**
+ * @brief Drive one keyboard column low through PIA 0 port B, as BASIC
+ *        does, and read the rows on port A.
+ *
+ * @param col: The column, 0-7.
+ *
+ * @retval The rows, PA0-PA6, a pressed key's row low.
+ */
+static uint8_t read_rows(uint8_t col) {
+
+    // Select each port's direction register, set B as outputs, then
+    // select the data registers
+    memory_map.io_write(DRAGON_PIA_0_START + 1, 0x00);
+    memory_map.io_write(DRAGON_PIA_0_START + 3, 0x00);
+    memory_map.io_write(DRAGON_PIA_0_START, 0x00);
+    memory_map.io_write(DRAGON_PIA_0_START + 2, 0xFF);
+    memory_map.io_write(DRAGON_PIA_0_START + 1, 0x04);
+    memory_map.io_write(DRAGON_PIA_0_START + 3, 0x04);
+
+    memory_map.io_write(DRAGON_PIA_0_START + 2, ~(1 << col));
+    return memory_map.io_read(DRAGON_PIA_0_START) | 0x80;
+}
+
+
+static bool is_down(uint8_t row, uint8_t col) {
+
+    return (read_rows(col) & (1 << row)) == 0;
+}
+
+
+static void test_setup(void) {
+
+    tests++;
+    dragon_init();
+    dragon_reset();
+}
+
+
+static void check(bool is_good, const char* name) {
+
+    if (is_good) {
+        passes++;
+    } else {
+        errors++;
+        printf("  %02d. %s failed\n", tests, name);
+    }
+}
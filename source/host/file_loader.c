@@ -0,0 +1,56 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Host-side program file loading
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+// App
+#include "file_loader.h"
+
+
+/**
+ * @brief Map a program file into memory and stream it through the
+ *        loader, so the file is parsed in place rather than copied.
+ *        The loader must already be initialised.
+ *
+ * @param loader: Pointer to a LOADER struct.
+ * @param path:   The file's path.
+ *
+ * @retval LOADER_OK, or the error encountered.
+ */
+uint8_t load_file(LOADER* loader, const char* path) {
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return LOADER_ERR_FILE;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return LOADER_ERR_FILE;
+    }
+
+    // An empty file can't be mapped, but is a format error, not an I/O one
+    if (info.st_size > 0) {
+        void* data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return LOADER_ERR_FILE;
+        }
+
+        madvise(data, info.st_size, MADV_SEQUENTIAL);
+        loader_feed(loader, (const uint8_t*)data, (uint32_t)info.st_size);
+        munmap(data, info.st_size);
+    }
+
+    close(fd);
+    return loader_finish(loader);
+}
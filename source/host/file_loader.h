@@ -0,0 +1,27 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Host-side program file loading
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _FILE_LOADER_HEADER_
+#define _FILE_LOADER_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include "loader.h"
+
+
+/*
+ *      PROTOTYPES
+ */
+uint8_t     load_file(LOADER* loader, const char* path);
+
+
+#endif  // _FILE_LOADER_HEADER_
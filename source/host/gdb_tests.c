@@ -0,0 +1,435 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * GDB remote serial protocol stub tests
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "main.h"
+#include "breakpoint.h"
+#include "core.h"
+#include "cpu.h"
+#include "gdb.h"
+#include "mailbox.h"
+
+
+/*
+ * STATICS
+ */
+static void test_packets(void);
+static void test_registers(void);
+static void test_memory(void);
+static void test_step(void);
+static void test_breakpoints(void);
+static void test_watchpoints(void);
+static void test_interrupt(void);
+static void test_core_run(void);
+static void test_queries(void);
+static void test_detach(void);
+static void command(const char* data);
+static bool replied(const char* data);
+static void capture(const uint8_t* data, uint32_t length);
+static void test_setup(void);
+static void check(bool is_good, const char* name);
+
+
+/*
+ * GLOBALS
+ */
+uint32_t errors = 0;
+uint32_t passes = 0;
+uint32_t tests = 0;
+
+extern REG_6809         reg;
+extern uint8_t          mem[KB64];
+extern BREAKPOINTS      breakpoints;
+extern MEMORY_MAP_6809  memory_map;
+
+GDB         gdb;
+char        output[8192];
+uint32_t    output_length = 0;
+
+// 0x1000: LDX #$2000 ; loop: LDA ,X+ ; STA $2100 ; BRA loop
+// 0x2000: 1, 2, 3...
+const uint8_t PROGRAM[] = {0x8E, 0x20, 0x00, 0xA6, 0x80, 0xB7, 0x21, 0x00, 0x20, 0xF9};
+
+
+int main(void) {
+
+    test_packets();
+    test_registers();
+    test_memory();
+    test_step();
+    test_breakpoints();
+    test_watchpoints();
+    test_interrupt();
+    test_core_run();
+    test_queries();
+    test_detach();
+
+    printf("Tests: %i\n", tests);
+    printf("Passes: %i\n", passes);
+    printf("Fails: %i\n", errors);
+    return errors == 0 ? 0 : 1;
+}
+
+
+static void test_packets(void) {
+
+    test_setup();
+    command("?");
+    check(output[0] == '+', "Ack");
+    check(replied("S05"), "Stop reason");
+    check(gdb.is_attached, "Attached");
+
+    // Bad checksum
+    output_length = 0;
+    gdb_feed(&gdb, (const uint8_t*)"$?#00", 5);
+    check(output_length == 1 && output[0] == '-', "Nak");
+    check(gdb.bad_packets == 1, "Bad packet counted");
+
+    // Split across feeds, with the debugger's own acks ignored
+    output_length = 0;
+    gdb_feed(&gdb, (const uint8_t*)"+$", 2);
+    gdb_feed(&gdb, (const uint8_t*)"?#", 2);
+    check(output_length == 0, "Nothing before the checksum");
+    gdb_feed(&gdb, (const uint8_t*)"3f", 2);
+    check(replied("S05"), "Split packet");
+
+    command("vMustReplyEmpty");
+    check(replied(""), "Unsupported packet");
+    command("m1000");
+    check(replied("E01"), "Malformed packet");
+}
+
+
+static void test_registers(void) {
+
+    test_setup();
+    reg.a = 0x12;
+    reg.b = 0x34;
+    reg.x = 0x5678;
+    reg.y = 0x9ABC;
+    reg.u = 0xDEF0;
+    reg.s = 0x8000;
+    reg.cc = 0x50;
+    reg.dp = 0x20;
+    command("g");
+    check(replied("123456789abcdef080001000" "5020"), "Read all");
+
+    command("G" "0102030405060708090a0b0c" "0d0e");
+    check(replied("OK"), "Write all");
+    check(reg.a == 0x01 && reg.b == 0x02 && reg.x == 0x0304 && reg.y == 0x0506, "Written A to Y");
+    check(reg.u == 0x0708 && reg.s == 0x090A && reg.pc == 0x0B0C && reg.cc == 0x0D && reg.dp == 0x0E, "Written U to DP");
+    command("G0102");
+    check(replied("E01"), "Short write");
+
+    // A bad digit in a later register leaves every register alone
+    command("G" "1112131415161718191a1b1c" "1d0g");
+    check(replied("E01"), "Bad digit");
+    check(reg.a == 0x01 && reg.pc == 0x0B0C && reg.cc == 0x0D, "Nothing written");
+
+    command("p6");
+    check(replied("0b0c"), "Read PC");
+    command("P2=beef");
+    check(replied("OK") && reg.x == 0xBEEF, "Write X");
+    command("p9");
+    check(replied("E01"), "No such register");
+}
+
+
+static void test_memory(void) {
+
+    test_setup();
+    command("m1000,3");
+    check(replied("8e2000"), "Read memory");
+
+    uint8_t dirty[DIRTY_MAP_SIZE] = {0};
+    memory_map.write_dirty = dirty;
+    command("M3000,2:abcd");
+    check(replied("OK") && mem[0x3000] == 0xAB && mem[0x3001] == 0xCD, "Write memory");
+    check(dirty[0x30] == 0x01, "Write marked dirty");
+    command("M3000,2:ab");
+    check(replied("E01"), "Short data");
+
+    // Binary data: 0x23 ('#') escaped as '}' 0x03
+    output_length = 0;
+    const char packet[] = "$X3010,3:\x01}\x03\x02#";
+    uint8_t sum = 0;
+    for (uint32_t i = 1 ; i < sizeof(packet) - 2 ; ++i) sum += (uint8_t)packet[i];
+    char tail[3];
+    snprintf(tail, sizeof(tail), "%02x", sum);
+    gdb_feed(&gdb, (const uint8_t*)packet, sizeof(packet) - 1);
+    gdb_feed(&gdb, (const uint8_t*)tail, 2);
+    check(replied("OK"), "Binary write");
+    check(mem[0x3010] == 0x01 && mem[0x3011] == 0x23 && mem[0x3012] == 0x02, "Binary data");
+
+    // Addresses wrap
+    command("mffff,2");
+    check(replied("0000"), "Wrapped read");
+
+    // Writes across a line boundary mark both lines, and wrap
+    dirty[0x30] = 0;
+    command("X301f,0:");
+    check(replied("OK") && dirty[0x30] == 0x00, "Empty write clean");
+    command("M301f,2:1122");
+    command("Mffff,2:3344");
+    check(dirty[0x30] == 0x03 && dirty[0xFF] == 0x80 && dirty[0x00] == 0x01 && mem[0x0000] == 0x44, "Lines marked dirty");
+    memory_map.write_dirty = NULL;
+}
+
+
+static void test_step(void) {
+
+    test_setup();
+    command("s");
+    check(replied("T05") && reg.pc == 0x1003 && reg.x == 0x2000, "Step");
+    command("s1000");
+    check(replied("T05") && reg.pc == 0x1003, "Step from address");
+
+    // A step from a breakpoint passes it
+    command("Z0,1003,1");
+    command("s");
+    check(replied("T05") && reg.pc == 0x1005 && reg.a == 0x01, "Step past breakpoint");
+}
+
+
+static void test_breakpoints(void) {
+
+    test_setup();
+    command("Z0,1005,1");
+    check(replied("OK") && breakpoint_is_armed(), "Set breakpoint");
+    command("Z0,1005,1");
+    check(replied("OK") && breakpoints.count == 1, "Set twice");
+
+    command("c");
+    check(gdb.is_running && output_length == 1, "Running");
+    output_length = 0;
+    while (gdb_poll(&gdb)) {}
+    check(replied("T05") && reg.pc == 0x1005, "Stopped at breakpoint");
+
+    // Continue stops at it again, one loop on
+    output_length = 0;
+    command("c");
+    while (gdb_poll(&gdb)) {}
+    check(replied("T05") && reg.pc == 0x1005 && reg.a == 0x02, "Stopped again");
+
+    command("z0,1005,1");
+    check(replied("OK") && !breakpoint_is_armed(), "Remove breakpoint");
+    command("Z5,1005,1");
+    check(replied(""), "Unsupported type");
+
+    for (uint8_t i = 0 ; i < BREAKPOINT_MAX ; ++i) {
+        char text[16];
+        snprintf(text, sizeof(text), "Z1,%x,1", 0x4000 + i);
+        command(text);
+    }
+
+    command("Z1,5000,1");
+    check(replied("E0E"), "Breakpoints full");
+}
+
+
+static void test_watchpoints(void) {
+
+    test_setup();
+    command("Z2,2100,1");
+    check(replied("OK"), "Set watchpoint");
+    command("c");
+    output_length = 0;
+    while (gdb_poll(&gdb)) {}
+    check(replied("T05watch:2100;"), "Write reported");
+    check(mem[0x2100] == 0x01, "Write done");
+
+    command("z2,2100,1");
+    command("Z3,2002,2");
+    command("c");
+    output_length = 0;
+    while (gdb_poll(&gdb)) {}
+    check(replied("T05rwatch:2002;") && reg.a == 0x03, "Read reported");
+
+    command("z3,2002,2");
+    command("Z4,2100,1");
+    command("c");
+    output_length = 0;
+    while (gdb_poll(&gdb)) {}
+    check(replied("T05awatch:2100;"), "Access reported");
+}
+
+
+static void test_interrupt(void) {
+
+    test_setup();
+    command("c");
+    check(gdb_poll(&gdb), "Still running");
+
+    output_length = 0;
+    const uint8_t interrupt = GDB_INTERRUPT;
+    gdb_feed(&gdb, &interrupt, 1);
+    check(!gdb.is_running && replied("S02"), "Interrupted");
+    check(!gdb_poll(&gdb), "Not running");
+    command("?");
+    check(replied("S02"), "Stop reason kept");
+}
+
+
+static void test_core_run(void) {
+
+    // Continues go to the core: stand in for it by taking its commands
+    // and posting its events
+    test_setup();
+    CORE core;
+    core_init(&core, mem, NULL, NULL);
+    gdb.core = &core;
+    command("c");
+    MAILBOX_MSG msg;
+    check(gdb.is_running && mailbox_get(&core.commands, &msg) && msg.type == CORE_CMD_RUN, "Continue sent to core");
+    check(gdb_poll(&gdb) && reg.pc == 0x1000, "Not run here");
+
+    command("g");
+    check(replied("E01"), "Packets refused while running");
+
+    output_length = 0;
+    breakpoints.hit_kind = BREAKPOINT_EXECUTE;
+    MAILBOX_MSG event = {CORE_EVENT_STOPPED, CORE_STOP_BREAKPOINT, 0x1005, 20};
+    mailbox_put(&core.events, &event);
+    check(!gdb_poll(&gdb) && replied("T05"), "Breakpoint stop reported");
+
+    // An interrupt pauses the core, and is reported once it has
+    command("c");
+    mailbox_get(&core.commands, &msg);
+    output_length = 0;
+    const uint8_t interrupt = GDB_INTERRUPT;
+    gdb_feed(&gdb, &interrupt, 1);
+    check(mailbox_get(&core.commands, &msg) && msg.type == CORE_CMD_PAUSE && gdb_poll(&gdb) && output_length == 0, "Interrupt pauses the core");
+
+    event.arg = CORE_STOP_PAUSED;
+    mailbox_put(&core.events, &event);
+    check(!gdb_poll(&gdb) && replied("S02"), "Interrupted");
+}
+
+
+static void test_queries(void) {
+
+    test_setup();
+    command("qSupported:multiprocess+;xmlRegisters=i386");
+    check(replied("PacketSize=400;qXfer:features:read+;QStartNoAckMode+"), "Supported");
+    command("qAttached");
+    check(replied("1"), "Attached");
+    command("qfThreadInfo");
+    check(replied("m1"), "Threads");
+
+    // The description in two parts
+    command("qXfer:features:read:target.xml:0,20");
+    check(replied("m<?xml version=\"1.0\"?><!DOCTYPE t"), "Description start");
+    command("qXfer:features:read:target.xml:20,400");
+    check(strstr(output, "<reg name=\"pc\" bitsize=\"16\" type=\"code_ptr\"/>") != NULL, "Description registers");
+    check(strstr(output, "$l") != NULL, "Description end");
+
+    // 'monitor dis 1000 2'
+    command("qRcmd,64697320313030302032");
+    check(strstr(output, "$O") != NULL && replied("OK"), "Monitor output");
+    check(gdb.bad_packets == 0, "Good packets");
+
+    command("QStartNoAckMode");
+    check(output[0] == '+' && replied("OK"), "No acks acked");
+    command("?");
+    check(output[0] == '$', "No acks");
+}
+
+
+static void test_detach(void) {
+
+    test_setup();
+    command("Z0,1005,1");
+    command("D");
+    check(replied("OK") && !gdb.is_attached, "Detached");
+    check(!breakpoint_is_armed(), "Breakpoints gone");
+    check(!gdb_owns_cpu(&gdb), "CPU released");
+
+    // The keypad may not run code while the debugger holds the CPU
+    command("Z0,1005,1");
+    check(gdb_owns_cpu(&gdb), "CPU owned while attached");
+    command("c");
+    check(gdb_owns_cpu(&gdb), "CPU owned while running");
+    command("k");
+    check(!gdb.is_running && !gdb.is_attached && !breakpoint_is_armed(), "Killed");
+    check(!gdb_owns_cpu(&gdb), "CPU released on kill");
+}
+
+
+/**
+ * @brief Send the stub a packet, clearing the output first.
+ */
+static void command(const char* data) {
+
+    uint8_t sum = 0;
+    for (const char* c = data ; *c != '\0' ; ++c) sum += (uint8_t)*c;
+
+    char packet[256];
+    uint32_t length = (uint32_t)snprintf(packet, sizeof(packet), "$%s#%02x", data, sum);
+    output_length = 0;
+    output[0] = '\0';
+    gdb_feed(&gdb, (const uint8_t*)packet, length);
+}
+
+
+/**
+ * @brief Check the stub's last packet.
+ */
+static bool replied(const char* data) {
+
+    uint8_t sum = 0;
+    for (const char* c = data ; *c != '\0' ; ++c) sum += (uint8_t)*c;
+
+    char packet[256];
+    uint32_t length = (uint32_t)snprintf(packet, sizeof(packet), "$%s#%02x", data, sum);
+    return output_length >= length && memcmp(&output[output_length - length], packet, length) == 0;
+}
+
+
+static void capture(const uint8_t* data, uint32_t length) {
+
+    if (output_length + length >= sizeof(output)) return;
+    memcpy(&output[output_length], data, length);
+    output_length += length;
+    output[output_length] = '\0';
+}
+
+
+static void test_setup(void) {
+
+    tests++;
+    memset(mem, 0, KB64);
+    memcpy(&mem[0x1000], PROGRAM, sizeof(PROGRAM));
+    for (uint32_t i = 0 ; i < 0x100 ; ++i) mem[0x2000 + i] = i + 1;
+    memset(&reg, 0, sizeof(reg));
+    init_cpu();
+    reg.pc = 0x1000;
+    reg.s = 0x8000;
+
+    breakpoint_clear_all();
+    breakpoints.is_resuming = false;
+    gdb_init(&gdb, mem, capture);
+    output_length = 0;
+    output[0] = '\0';
+}
+
+
+static void check(bool is_good, const char* name) {
+
+    if (is_good) {
+        passes++;
+    } else {
+        errors++;
+        printf("  %02d. %s failed\n", tests, name);
+    }
+}
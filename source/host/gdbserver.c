@@ -0,0 +1,254 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Host GDB server: serves the GDB stub over TCP or stdio
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+// App
+#include "main.h"
+#include "cpu.h"
+#include "gdb.h"
+#include "loader.h"
+#include "file_loader.h"
+
+
+/*
+ * STATICS
+ */
+static bool     load_binary(const char* path, uint32_t base);
+static bool     load_program(const char* path);
+static int      listen_on(uint16_t port);
+static void     serve(int in_fd);
+static void     send_bytes(const uint8_t* data, uint32_t length);
+static void     show_help(void);
+
+
+/*
+ * GLOBALS
+ */
+extern REG_6809     reg;
+extern uint8_t      mem[KB64];
+
+static GDB          gdb;
+static int          out_fd = STDOUT_FILENO;
+
+
+/**
+ * @brief Load a program and serve it to GDB, over a local TCP port or,
+ *        by default, stdin and stdout, eg. `target remote | e6809_gdb prog.s19`.
+ *
+ *        Usage: e6809_gdb [-p port] [-b base] [<file>]
+ *
+ * @retval 0 when the debugger has gone, otherwise 1.
+ */
+int main(int argc, char* argv[]) {
+
+    const char* path = NULL;
+    uint32_t base = 0;
+    uint32_t port = 0;
+    bool is_binary = false;
+
+    for (int i = 1 ; i < argc ; ++i) {
+        if (strcmp(argv[i], "-p") == 0 && i < argc - 1) {
+            port = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-b") == 0 && i < argc - 1) {
+            base = (uint32_t)strtoul(argv[++i], NULL, 0);
+            is_binary = true;
+        } else if (strcmp(argv[i], "-h") == 0) {
+            show_help();
+            return 0;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    if (base >= KB64 || port > 0xFFFF) {
+        show_help();
+        return 1;
+    }
+
+    init_cpu();
+    if (path != NULL && !(is_binary ? load_binary(path, base) : load_program(path))) return 1;
+    gdb_init(&gdb, mem, send_bytes);
+
+    if (port == 0) {
+        serve(STDIN_FILENO);
+        return 0;
+    }
+
+    int server = listen_on((uint16_t)port);
+    if (server < 0) return 1;
+    fprintf(stderr, "Waiting for GDB on port %u\n", port);
+
+    // One debugger at a time; the CPU and memory carry over to the next
+    while (true) {
+        int client = accept(server, NULL, NULL);
+        if (client < 0) break;
+        int flag = 1;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+        out_fd = client;
+        gdb_init(&gdb, mem, send_bytes);
+        serve(client);
+        close(client);
+        fprintf(stderr, "GDB disconnected\n");
+    }
+
+    close(server);
+    return 0;
+}
+
+
+/**
+ * @brief Read a binary image into memory, and set the PC to its start.
+ *
+ * @param path: The file's path.
+ * @param base: The address of its first byte.
+ *
+ * @retval Whether the image was read.
+ */
+static bool load_binary(const char* path, uint32_t base) {
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "[ERROR] Cannot open %s\n", path);
+        return false;
+    }
+
+    size_t count = fread(&mem[base], 1, KB64 - base, file);
+    fclose(file);
+
+    if (count == 0) {
+        fprintf(stderr, "[ERROR] %s is empty\n", path);
+        return false;
+    }
+
+    reg.pc = (uint16_t)base;
+    return true;
+}
+
+
+/**
+ * @brief Load an S-record, Intel HEX or DECB program into memory, and
+ *        set the PC to its entry point or its lowest address.
+ *
+ * @param path: The file's path.
+ *
+ * @retval Whether the program was loaded.
+ */
+static bool load_program(const char* path) {
+
+    static LOADER loader;
+    loader_init(&loader, mem);
+
+    uint8_t result = load_file(&loader, path);
+    if (result != LOADER_OK) {
+        fprintf(stderr, "[ERROR] %s: %s (line %u)\n", path, loader_error_message(result), loader.line);
+        return false;
+    }
+
+    reg.pc = loader.has_entry ? loader.entry : (uint16_t)loader.low_address;
+    return true;
+}
+
+
+/**
+ * @brief Open a TCP port on the loopback interface.
+ *
+ * @param port: The port number.
+ *
+ * @retval The listening socket, or -1 on failure.
+ */
+static int listen_on(uint16_t port) {
+
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    if (server < 0) {
+        perror("[ERROR] socket");
+        return -1;
+    }
+
+    int flag = 1;
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(flag));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+
+    if (bind(server, (struct sockaddr*)&address, sizeof(address)) < 0 || listen(server, 1) < 0) {
+        perror("[ERROR] bind");
+        close(server);
+        return -1;
+    }
+
+    return server;
+}
+
+
+/**
+ * @brief Pass the debugger's bytes to the stub until it detaches or
+ *        goes. While the CPU runs, input is checked between slices
+ *        without waiting; otherwise the loop sleeps until input comes.
+ *
+ * @param in_fd: The file descriptor to read.
+ */
+static void serve(int in_fd) {
+
+    uint8_t chunk[4096];
+    struct pollfd source = {in_fd, POLLIN, 0};
+
+    while (true) {
+        int ready = poll(&source, 1, gdb.is_running ? 0 : -1);
+        if (ready > 0) {
+            ssize_t count = read(in_fd, chunk, sizeof(chunk));
+            if (count <= 0) return;
+            gdb_feed(&gdb, chunk, (uint32_t)count);
+            if (!gdb.is_attached) return;
+        }
+
+        gdb_poll(&gdb);
+    }
+}
+
+
+/**
+ * @brief Write the stub's output to the debugger.
+ */
+static void send_bytes(const uint8_t* data, uint32_t length) {
+
+    while (length > 0) {
+        ssize_t count = write(out_fd, data, length);
+        if (count <= 0) return;
+        data += count;
+        length -= (uint32_t)count;
+    }
+}
+
+
+/**
+ * @brief Show usage information.
+ */
+static void show_help(void) {
+
+    fprintf(stderr, "Usage: e6809_gdb [-p port] [-b base] [<file>]\n");
+    fprintf(stderr, "  -p  Wait for GDB on this TCP port, on the loopback interface. Default: use stdin and stdout\n");
+    fprintf(stderr, "  -b  Read the file as a binary image loaded at this address, eg. 0x8000.\n");
+    fprintf(stderr, "      Otherwise, it is loaded as an S-record, Intel HEX or DECB program.\n");
+    fprintf(stderr, "      The PC is set to the program's entry point, or its first address\n");
+}
@@ -0,0 +1,244 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Hardware abstraction layer: Linux. GPIO pins are modelled, with
+ * pulls, so device code can be driven from tests; there is nothing on
+ * the I2C bus, SPI writes go nowhere, flash is held in RAM and stdio
+ * is the process's own. There is no LED
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <poll.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+// App
+#include "main.h"
+#include "hal.h"
+#include "hal_linux.h"
+
+
+/*
+ * STRUCTS
+ */
+typedef struct {
+    bool        is_output;
+    bool        is_pulled_up;
+    bool        is_driven;      // By hal_linux_drive(), as external hardware would
+    bool        level;
+} HAL_PIN;
+
+
+/*
+ * GLOBALS
+ */
+static HAL_PIN  pins[HAL_GPIO_COUNT];
+static void     (*falling_callbacks[HAL_GPIO_COUNT])(uint8_t pin);
+static uint8_t  flash[HAL_FLASH_SIZE];
+static bool     is_flash_erased = false;
+
+
+/*
+ *      GPIO
+ */
+void hal_gpio_init(uint8_t pin, bool is_output) {
+
+    if (pin >= HAL_GPIO_COUNT) return;
+    memset(&pins[pin], 0, sizeof(HAL_PIN));
+    pins[pin].is_output = is_output;
+}
+
+
+void hal_gpio_set_dir(uint8_t pin, bool is_output) {
+
+    if (pin < HAL_GPIO_COUNT) pins[pin].is_output = is_output;
+}
+
+
+void hal_gpio_pull(uint8_t pin, bool is_up) {
+
+    if (pin < HAL_GPIO_COUNT) pins[pin].is_pulled_up = is_up;
+}
+
+
+void hal_gpio_put(uint8_t pin, bool is_high) {
+
+    if (pin < HAL_GPIO_COUNT) pins[pin].level = is_high;
+}
+
+
+/**
+ * @brief Read a pin: an output reads back its level, an input the
+ *        level it is driven to or, failing that, its pull.
+ */
+bool hal_gpio_get(uint8_t pin) {
+
+    if (pin >= HAL_GPIO_COUNT) return false;
+    HAL_PIN* p = &pins[pin];
+    if (p->is_output || p->is_driven) return p->level;
+    return p->is_pulled_up;
+}
+
+
+void hal_gpio_irq_falling(uint8_t pin, void (*callback)(uint8_t pin)) {
+
+    if (pin < HAL_GPIO_COUNT) falling_callbacks[pin] = callback;
+}
+
+
+/**
+ * @brief Drive an input pin from outside, as attached hardware would.
+ *        A fall calls the pin's callback, as its interrupt would.
+ *
+ * @param pin:     The GPIO number.
+ * @param is_high: The level.
+ */
+void hal_linux_drive(uint8_t pin, bool is_high) {
+
+    if (pin >= HAL_GPIO_COUNT) return;
+    bool was_high = hal_gpio_get(pin);
+    pins[pin].is_driven = true;
+    pins[pin].level = is_high;
+    if (was_high && !is_high && falling_callbacks[pin] != NULL) falling_callbacks[pin](pin);
+}
+
+
+/**
+ * @brief Stop driving a pin, leaving it to its pull.
+ *
+ * @param pin: The GPIO number.
+ */
+void hal_linux_release(uint8_t pin) {
+
+    if (pin < HAL_GPIO_COUNT) pins[pin].is_driven = false;
+}
+
+
+/*
+ *      BUSES
+ */
+void hal_i2c_init(uint8_t sda_pin, uint8_t scl_pin, uint32_t baud_rate) {
+
+    (void)sda_pin;
+    (void)scl_pin;
+    (void)baud_rate;
+}
+
+
+void hal_i2c_deinit(void) {
+
+}
+
+
+int hal_i2c_write(uint8_t address, const uint8_t* data, uint32_t count, bool no_stop) {
+
+    // No devices are attached
+    (void)address;
+    (void)data;
+    (void)count;
+    (void)no_stop;
+    return HAL_BUS_ERROR;
+}
+
+
+int hal_i2c_read(uint8_t address, uint8_t* data, uint32_t count, bool no_stop) {
+
+    (void)address;
+    (void)data;
+    (void)count;
+    (void)no_stop;
+    return HAL_BUS_ERROR;
+}
+
+
+void hal_spi_init(uint8_t sck_pin, uint8_t tx_pin, uint32_t baud_rate) {
+
+    (void)sck_pin;
+    (void)tx_pin;
+    (void)baud_rate;
+}
+
+
+int hal_spi_write(const uint8_t* data, uint32_t count) {
+
+    (void)data;
+    return (int)count;
+}
+
+
+/*
+ *      TIMING
+ */
+uint32_t hal_time_us(void) {
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000);
+}
+
+
+void hal_sleep_ms(uint32_t ms) {
+
+    struct timespec wait = {ms / 1000, (long)(ms % 1000) * 1000000};
+    nanosleep(&wait, NULL);
+}
+
+
+/*
+ *      FLASH
+ */
+static void erase_flash(void) {
+
+    if (!is_flash_erased) {
+        memset(flash, 0xFF, sizeof(flash));
+        is_flash_erased = true;
+    }
+}
+
+
+void hal_flash_read(uint32_t offset, uint8_t* data, uint32_t count) {
+
+    erase_flash();
+    if (offset >= HAL_FLASH_SIZE) return;
+    if (count > HAL_FLASH_SIZE - offset) count = HAL_FLASH_SIZE - offset;
+    memcpy(data, &flash[offset], count);
+}
+
+
+void hal_flash_write(uint32_t offset, const uint8_t* data, uint32_t count) {
+
+    erase_flash();
+    if (offset >= HAL_FLASH_SIZE) return;
+    if (count > HAL_FLASH_SIZE - offset) count = HAL_FLASH_SIZE - offset;
+    memcpy(&flash[offset], data, count);
+}
+
+
+/*
+ *      LED
+ */
+/**
+ * @brief Stand-in for the board's LED signal, which cpu.c uses to
+ *        flag interrupts. There is no LED on the host.
+ */
+void flash_led(uint8_t count) {
+
+    (void)count;
+}
+
+
+/*
+ *      STDIO
+ */
+int hal_stdio_get(uint32_t timeout_us) {
+
+    struct pollfd input = {STDIN_FILENO, POLLIN, 0};
+    if (poll(&input, 1, (int)((timeout_us + 999) / 1000)) <= 0) return HAL_NO_CHAR;
+
+    uint8_t c;
+    return read(STDIN_FILENO, &c, 1) == 1 ? c : HAL_NO_CHAR;
+}
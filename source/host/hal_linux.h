@@ -0,0 +1,26 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Hardware abstraction layer: Linux -- see hal_linux.c
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _HAL_LINUX_HEADER_
+#define _HAL_LINUX_HEADER_
+
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*
+ *      PROTOTYPES
+ */
+void        hal_linux_drive(uint8_t pin, bool is_high);
+void        hal_linux_release(uint8_t pin);
+
+
+#endif  // _HAL_LINUX_HEADER_
@@ -0,0 +1,217 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Memory access heatmap tests
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "main.h"
+#include "cpu.h"
+#include "heatmap.h"
+
+
+/*
+ * STATICS
+ */
+static void test_off(void);
+static void test_addresses(void);
+static void test_pages(void);
+static void test_read(void);
+static void test_csv(void);
+static void test_ppm(void);
+static void run_program(void);
+static void out(const char* text, uint32_t length);
+static void test_setup(void);
+static void check(bool is_good, const char* name);
+
+
+/*
+ * GLOBALS
+ */
+uint32_t errors = 0;
+uint32_t passes = 0;
+uint32_t tests = 0;
+
+extern REG_6809     reg;
+extern uint8_t      mem[KB64];
+extern HEATMAP      heatmap;
+
+// 0x1000: LDA $2000, STA $2101, BRA *
+const uint8_t PROGRAM[] = {0xB6, 0x20, 0x00, 0xB7, 0x21, 0x01, 0x20, 0xFE};
+#define PROGRAM_OPS     3
+
+static uint32_t cells[HEATMAP_KINDS][HEATMAP_ADDRESSES];
+static char output[HEATMAP_IMAGE_SIZE * HEATMAP_IMAGE_SIZE * 3 + 32];
+static uint32_t output_length = 0;
+
+
+int main(void) {
+
+    test_off();
+    test_addresses();
+    test_pages();
+    test_read();
+    test_csv();
+    test_ppm();
+
+    printf("Tests: %i\n", tests);
+    printf("Passes: %i\n", passes);
+    printf("Fails: %i\n", errors);
+    return errors == 0 ? 0 : 1;
+}
+
+
+static void test_off(void) {
+
+    // Nothing is counted until the heatmap is started
+    test_setup();
+    run_program();
+    check(!heatmap_is_on() && heatmap.pages[HEATMAP_FETCH][0x10] == 0 && cells[HEATMAP_FETCH][0x1000] == 0, "Off counts nothing");
+
+    heatmap_start(cells);
+    check(heatmap_is_on(), "Started");
+    heatmap_stop();
+    run_program();
+    check(!heatmap_is_on() && cells[HEATMAP_FETCH][0x1000] == 0, "Stopped counts nothing");
+}
+
+
+static void test_addresses(void) {
+
+    test_setup();
+    heatmap_start(cells);
+    run_program();
+    heatmap_stop();
+
+    bool is_fetched = true;
+    for (uint16_t i = 0x1000 ; i < 0x1000 + sizeof(PROGRAM) ; ++i) is_fetched = is_fetched && cells[HEATMAP_FETCH][i] == 1;
+    check(is_fetched && cells[HEATMAP_FETCH][0x1000 + sizeof(PROGRAM)] == 0, "Op and operand bytes fetched");
+    check(cells[HEATMAP_READ][0x2000] == 1 && cells[HEATMAP_WRITE][0x2000] == 0, "Read counted");
+    check(cells[HEATMAP_WRITE][0x2101] == 1 && cells[HEATMAP_READ][0x2101] == 0, "Write counted");
+    check(heatmap.pages[HEATMAP_FETCH][0x10] == sizeof(PROGRAM) && heatmap.pages[HEATMAP_READ][0x20] == 1 && heatmap.pages[HEATMAP_WRITE][0x21] == 1, "Pages counted");
+
+    heatmap_reset();
+    check(cells[HEATMAP_FETCH][0x1000] == 0 && heatmap.pages[HEATMAP_FETCH][0x10] == 0, "Reset");
+}
+
+
+static void test_pages(void) {
+
+    // Without per-address storage, pages are still counted
+    test_setup();
+    heatmap_start(NULL);
+    run_program();
+    run_program();
+    heatmap_stop();
+    check(heatmap.pages[HEATMAP_FETCH][0x10] == 2 * sizeof(PROGRAM) && heatmap.pages[HEATMAP_WRITE][0x21] == 2, "Pages only");
+    check(cells[HEATMAP_FETCH][0x1000] == 0, "No address counts");
+}
+
+
+static void test_read(void) {
+
+    test_setup();
+    heatmap_start(NULL);
+    run_program();
+    heatmap_stop();
+
+    // Page counters are big-endian words, by kind then page
+    uint8_t data[8];
+    uint32_t offset = (HEATMAP_READ * HEATMAP_PAGES + 0x20) * 4;
+    check(heatmap_read(offset, data, 4) == 4 && data[0] == 0 && data[1] == 0 && data[2] == 0 && data[3] == 1, "Serialised count");
+    check(heatmap_read(HEATMAP_SIZE - 2, data, 8) == 2 && heatmap_read(HEATMAP_SIZE, data, 8) == 0, "Read stops at the end");
+}
+
+
+static void test_csv(void) {
+
+    test_setup();
+    heatmap_start(cells);
+    run_program();
+    heatmap_stop();
+
+    heatmap_csv(out);
+    output[output_length] = 0;
+    check(strncmp(output, "address,fetches,reads,writes\n0x1000,1,0,0\n", 42) == 0, "Address CSV");
+    check(strstr(output, "0x2000,0,1,0\n") != NULL && strstr(output, "0x2101,0,0,1\n") != NULL && strstr(output, "0x2001") == NULL, "Untouched addresses skipped");
+
+    output_length = 0;
+    heatmap_start(NULL);
+    heatmap_csv(out);
+    heatmap_stop();
+    output[output_length] = 0;
+    check(strcmp(output, "page,fetches,reads,writes\n0x10,8,0,0\n0x20,0,1,0\n0x21,0,0,1\n") == 0, "Page CSV");
+}
+
+
+static void test_ppm(void) {
+
+    test_setup();
+    heatmap_start(cells);
+    run_program();
+    heatmap_stop();
+
+    heatmap_ppm(out);
+    uint32_t header = strlen("P6\n256 256\n255\n");
+    check(output_length == header + HEATMAP_IMAGE_SIZE * HEATMAP_IMAGE_SIZE * 3 && strncmp(output, "P6\n256 256\n255\n", header) == 0, "Image size");
+
+    // Writes red, reads green, fetches blue
+    const uint8_t* written = (const uint8_t*)&output[header + 0x2101 * 3];
+    const uint8_t* read = (const uint8_t*)&output[header + 0x2000 * 3];
+    const uint8_t* fetched = (const uint8_t*)&output[header + 0x1000 * 3];
+    const uint8_t* untouched = (const uint8_t*)&output[header + 0x3000 * 3];
+    check(written[0] == 255 && written[1] == 0 && written[2] == 0, "Write pixel");
+    check(read[0] == 0 && read[1] == 255 && read[2] == 0, "Read pixel");
+    check(fetched[0] == 0 && fetched[1] == 0 && fetched[2] == 255, "Fetch pixel");
+    check(untouched[0] == 0 && untouched[1] == 0 && untouched[2] == 0, "Untouched pixel");
+}
+
+
+static void run_program(void) {
+
+    reg.pc = 0x1000;
+    for (uint8_t i = 0 ; i < PROGRAM_OPS ; ++i) process_next_instruction();
+}
+
+
+static void out(const char* text, uint32_t length) {
+
+    if (output_length + length > sizeof(output) - 1) return;
+    memcpy(&output[output_length], text, length);
+    output_length += length;
+}
+
+
+static void test_setup(void) {
+
+    tests++;
+    memset(mem, 0, KB64);
+    memcpy(&mem[0x1000], PROGRAM, sizeof(PROGRAM));
+    init_cpu();
+    reg.s = 0x8000;
+    output_length = 0;
+
+    // Zero any counts a previous test left
+    heatmap_start(cells);
+    heatmap_reset();
+    heatmap_stop();
+}
+
+
+static void check(bool is_good, const char* name) {
+
+    if (is_good) {
+        passes++;
+    } else {
+        errors++;
+        printf("  %02d. %s failed\n", tests, name);
+    }
+}
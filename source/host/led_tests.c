@@ -0,0 +1,160 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * LED pattern engine tests
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "led.h"
+
+
+/*
+ * STATICS
+ */
+static void test_pattern(void);
+static void test_sources(void);
+static void test_base(void);
+static void test_overflow(void);
+static void test_setup(void);
+static void check(bool is_good, const char* name);
+static void put(bool is_on);
+static void run_ticks(uint32_t count);
+static bool levels_are(const char* expected);
+
+
+/*
+ * GLOBALS
+ */
+uint32_t errors = 0;
+uint32_t passes = 0;
+uint32_t tests = 0;
+
+LED      led;
+// The LED's level after each tick, as '1' or '0'
+char     levels[256];
+uint32_t level_count = 0;
+
+
+int main(void) {
+
+    test_pattern();
+    test_sources();
+    test_base();
+    test_overflow();
+
+    printf("Tests: %i\n", tests);
+    printf("Passes: %i\n", passes);
+    printf("Fails: %i\n", errors);
+    return errors == 0 ? 0 : 1;
+}
+
+
+static void test_pattern(void) {
+
+    // Queueing returns at once; the ticks play the blinks, then a gap
+    test_setup();
+    check(led_queue(&led, 0, 3) && level_count == 0, "Queue returns at once");
+
+    run_ticks(10);
+    check(levels_are("1010100000"), "Three blinks then the gap");
+    check(!led_is_busy(&led), "Idle after the pattern");
+    check(!led_queue(&led, 0, 0), "Empty pattern refused");
+}
+
+
+static void test_sources(void) {
+
+    // Both sources' patterns play, taking turns, each in full
+    test_setup();
+    led_queue(&led, 0, 1);
+    led_queue(&led, 0, 2);
+    led_queue(&led, 1, 3);
+
+    run_ticks(18);
+    check(levels_are("1000" "10101000" "101000"), "Sources take turns");
+}
+
+
+static void test_base(void) {
+
+    // The base level shows between patterns, and patterns override it
+    test_setup();
+    led_set(&led, true);
+    check(level_count == 1 && levels[0] == '1', "Base shown at once");
+
+    led_queue(&led, 0, 1);
+    run_ticks(6);
+    check(levels_are("100111"), "Pattern over the base level");
+
+    led_set(&led, false);
+    run_ticks(1);
+    check(levels_are("0"), "Base cleared");
+}
+
+
+static void test_overflow(void) {
+
+    // A flood of patterns is dropped, not waited on
+    test_setup();
+    uint32_t queued = 0;
+    for (uint32_t i = 0 ; i < 100 ; ++i) {
+        if (led_queue(&led, 1, 2)) queued++;
+    }
+
+    check(queued == MAILBOX_SIZE && led.dropped == 100 - MAILBOX_SIZE, "Overflow dropped");
+}
+
+
+static void test_setup(void) {
+
+    tests++;
+    led_init(&led, put);
+    level_count = 0;
+}
+
+
+static void check(bool is_good, const char* name) {
+
+    if (is_good) {
+        passes++;
+    } else {
+        errors++;
+        printf("  %02d. %s failed\n", tests, name);
+    }
+}
+
+
+static void put(bool is_on) {
+
+    if (level_count < sizeof(levels) - 1) levels[level_count++] = is_on ? '1' : '0';
+}
+
+
+static void run_ticks(uint32_t count) {
+
+    level_count = 0;
+    for (uint32_t i = 0 ; i < count ; ++i) {
+        uint32_t before = level_count;
+        led_tick(&led);
+
+        // An idle tick leaves the LED as it was
+        if (level_count == before) put(level_count > 0 ? levels[level_count - 1] == '1' : led.base);
+    }
+}
+
+
+static bool levels_are(const char* expected) {
+
+    levels[level_count] = 0;
+    if (strcmp(levels, expected) == 0) return true;
+    printf("  Got %s, expected %s\n", levels, expected);
+    return false;
+}
@@ -0,0 +1,271 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Program loader tests
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "loader.h"
+#include "file_loader.h"
+
+
+/*
+ * STATICS
+ */
+static void test_srec(void);
+static void test_ihex(void);
+static void test_decb(void);
+static void test_errors(void);
+static void test_file(void);
+static void test_long_file(void);
+static void test_setup(void);
+static void check(bool is_good, const char* name);
+static bool program_loaded(uint16_t address);
+static uint8_t feed_in_chunks(const uint8_t* data, uint32_t length, uint32_t chunk);
+static uint32_t make_long_srec(char* file);
+
+// Records in the long S-record file, each of LONG_RECORD_BYTES from 0x4000
+#define LONG_RECORDS        24
+#define LONG_RECORD_BYTES   16
+
+// LDA #$41 ; STA $0400 ; RTS
+static const uint8_t PROGRAM[6] = {0x86, 0x41, 0xB7, 0x04, 0x00, 0x39};
+
+static const char* SREC_FILE =
+    "S007000054455354B8\r\n"
+    "S10930008641B70400390B\r\n"
+    "S9033000CC\r\n";
+
+static const char* IHEX_FILE =
+    ":063000008641B70400390F\n"
+    ":0400000500003000C7\n"
+    ":00000001FF\n";
+
+static const uint8_t DECB_FILE[] = {
+    0x00, 0x00, 0x06, 0x30, 0x00, 0x86, 0x41, 0xB7, 0x04, 0x00, 0x39,
+    0xFF, 0x00, 0x00, 0x30, 0x00
+};
+
+
+/*
+ * GLOBALS
+ */
+uint32_t errors = 0;
+uint32_t passes = 0;
+uint32_t tests = 0;
+
+uint8_t  mem[65536];
+LOADER   loader;
+
+
+int main(void) {
+
+    test_srec();
+    test_ihex();
+    test_decb();
+    test_errors();
+    test_file();
+    test_long_file();
+
+    printf("Tests: %i\n", tests);
+    printf("Passes: %i\n", passes);
+    printf("Fails: %i\n", errors);
+    return errors == 0 ? 0 : 1;
+}
+
+
+static void test_srec(void) {
+
+    // Whole file
+    test_setup();
+    uint8_t result = feed_in_chunks((const uint8_t*)SREC_FILE, strlen(SREC_FILE), 4096);
+    check(result == LOADER_OK && program_loaded(0x3000), "S-record load");
+    check(loader.format == LOADER_FORMAT_SREC && loader.records == 3, "S-record records");
+    check(loader.has_entry && loader.entry == 0x3000, "S-record entry point");
+    check(loader.low_address == 0x3000 && loader.high_address == 0x3005, "S-record span");
+
+    // Byte at a time: records split across feeds
+    test_setup();
+    result = feed_in_chunks((const uint8_t*)SREC_FILE, strlen(SREC_FILE), 1);
+    check(result == LOADER_OK && program_loaded(0x3000), "S-record streamed load");
+}
+
+
+static void test_ihex(void) {
+
+    test_setup();
+    uint8_t result = feed_in_chunks((const uint8_t*)IHEX_FILE, strlen(IHEX_FILE), 4096);
+    check(result == LOADER_OK && program_loaded(0x3000), "Intel HEX load");
+    check(loader.has_entry && loader.entry == 0x3000, "Intel HEX entry point");
+
+    test_setup();
+    result = feed_in_chunks((const uint8_t*)IHEX_FILE, strlen(IHEX_FILE), 3);
+    check(result == LOADER_OK && program_loaded(0x3000), "Intel HEX streamed load");
+
+    // Extended linear address beyond 64KB
+    test_setup();
+    const char* high = ":020000040001F9\n:063000008641B70400390F\n";
+    result = feed_in_chunks((const uint8_t*)high, strlen(high), 4096);
+    check(result == LOADER_ERR_RANGE, "Intel HEX range check");
+}
+
+
+static void test_decb(void) {
+
+    test_setup();
+    uint8_t result = feed_in_chunks(DECB_FILE, sizeof(DECB_FILE), 4096);
+    check(result == LOADER_OK && program_loaded(0x3000), "DECB load");
+    check(loader.has_entry && loader.entry == 0x3000, "DECB entry point");
+
+    test_setup();
+    result = feed_in_chunks(DECB_FILE, sizeof(DECB_FILE), 1);
+    check(result == LOADER_OK && program_loaded(0x3000), "DECB streamed load");
+
+    // No postamble
+    test_setup();
+    result = feed_in_chunks(DECB_FILE, sizeof(DECB_FILE) - 5, 4096);
+    check(result == LOADER_ERR_TRUNCATED, "DECB truncation");
+}
+
+
+static void test_errors(void) {
+
+    // Corrupt the last data byte of the S1 record
+    test_setup();
+    char bad[128];
+    strcpy(bad, SREC_FILE);
+    bad[38] = '8';
+    uint8_t result = feed_in_chunks((const uint8_t*)bad, strlen(bad), 4096);
+    check(result == LOADER_ERR_CHECKSUM, "S-record checksum");
+
+    test_setup();
+    const char* bad_hex = ":063000008641B70400390E\n";
+    result = feed_in_chunks((const uint8_t*)bad_hex, strlen(bad_hex), 4096);
+    check(result == LOADER_ERR_CHECKSUM, "Intel HEX checksum");
+
+    test_setup();
+    const char* short_hex = ":063000008641B7\n";
+    result = feed_in_chunks((const uint8_t*)short_hex, strlen(short_hex), 4096);
+    check(result == LOADER_ERR_TRUNCATED, "Intel HEX short record");
+
+    test_setup();
+    result = feed_in_chunks((const uint8_t*)"HELLO", 5, 4096);
+    check(result == LOADER_ERR_FORMAT, "Unknown format");
+}
+
+
+static void test_file(void) {
+
+    char path[] = "/tmp/e6809_loader_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        check(false, "Temporary file");
+        return;
+    }
+
+    write(fd, SREC_FILE, strlen(SREC_FILE));
+    close(fd);
+
+    test_setup();
+    uint8_t result = load_file(&loader, path);
+    check(result == LOADER_OK && program_loaded(0x3000), "Mapped file load");
+    unlink(path);
+
+    test_setup();
+    check(load_file(&loader, path) == LOADER_ERR_FILE, "Missing file");
+}
+
+
+static void test_long_file(void) {
+
+    // Well over the monitor's 262-byte block buffer, so a byte lost
+    // between blocks would corrupt a record
+    char file[LONG_RECORDS * 48];
+    uint32_t length = make_long_srec(file);
+
+    // As the monitor streams it: the first byte on its own, then the rest
+    // a byte at a time
+    test_setup();
+    uint8_t result = loader_feed(&loader, (const uint8_t*)file, 1);
+    for (uint32_t i = 1 ; i < length && result == LOADER_OK ; ++i) result = loader_feed(&loader, (const uint8_t*)&file[i], 1);
+    result = loader_finish(&loader);
+
+    bool is_loaded = true;
+    for (uint32_t i = 0 ; i < LONG_RECORDS * LONG_RECORD_BYTES ; ++i) is_loaded = is_loaded && mem[0x4000 + i] == (uint8_t)i;
+    check(length > 262 && result == LOADER_OK && is_loaded, "Long S-record streamed load");
+    check(loader.records == LONG_RECORDS + 1 && loader.high_address == 0x4000 + LONG_RECORDS * LONG_RECORD_BYTES - 1, "Long S-record records");
+
+    // In 262-byte blocks
+    test_setup();
+    result = feed_in_chunks((const uint8_t*)file, length, 262);
+    check(result == LOADER_OK && loader.records == LONG_RECORDS + 1, "Long S-record block load");
+}
+
+
+static void test_setup(void) {
+
+    tests++;
+    memset(mem, 0, sizeof(mem));
+    loader_init(&loader, mem);
+}
+
+
+static void check(bool is_good, const char* name) {
+
+    if (is_good) {
+        passes++;
+    } else {
+        errors++;
+        printf("  %02d. %s failed (error: %s)\n", tests, name, loader_error_message(loader.error));
+    }
+}
+
+
+static bool program_loaded(uint16_t address) {
+
+    return memcmp(&mem[address], PROGRAM, sizeof(PROGRAM)) == 0;
+}
+
+
+static uint8_t feed_in_chunks(const uint8_t* data, uint32_t length, uint32_t chunk) {
+
+    for (uint32_t i = 0 ; i < length ; i += chunk) {
+        uint32_t size = length - i < chunk ? length - i : chunk;
+        if (loader_feed(&loader, data + i, size) != LOADER_OK) break;
+    }
+
+    return loader_finish(&loader);
+}
+
+
+static uint32_t make_long_srec(char* file) {
+
+    // S1 records of LONG_RECORD_BYTES bytes, each byte its offset from 0x4000
+    uint32_t length = 0;
+    for (uint32_t r = 0 ; r < LONG_RECORDS ; ++r) {
+        uint16_t address = 0x4000 + r * LONG_RECORD_BYTES;
+        uint8_t count = LONG_RECORD_BYTES + 3;
+        uint32_t sum = count + (address >> 8) + (address & 0xFF);
+        length += sprintf(&file[length], "S1%02X%04X", count, address);
+        for (uint32_t i = 0 ; i < LONG_RECORD_BYTES ; ++i) {
+            uint8_t byte = (uint8_t)(r * LONG_RECORD_BYTES + i);
+            sum += byte;
+            length += sprintf(&file[length], "%02X", byte);
+        }
+
+        length += sprintf(&file[length], "%02X\r\n", (~sum) & 0xFF);
+    }
+
+    length += sprintf(&file[length], "S9034000BC\r\n");
+    return length;
+}
@@ -0,0 +1,211 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Diagnostic logging tests. Built with LOG_LEVEL at LOG_LEVEL_INFO,
+ * so debug records must compile away. Built again, expected to fail,
+ * with LOG_TESTS_TOO_MANY_ARGS set
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "log.h"
+
+
+/*
+ * STATICS
+ */
+static void test_levels(void);
+static void test_format(void);
+static void test_max_args(void);
+static void test_sources(void);
+static void test_overflow(void);
+static void test_backpressure(void);
+static void test_setup(void);
+static void check(bool is_good, const char* name);
+static uint32_t clock(void);
+static uint8_t source(void);
+static bool out(const char* text, uint32_t length);
+static uint32_t side_effect(void);
+
+
+/*
+ * GLOBALS
+ */
+uint32_t errors = 0;
+uint32_t passes = 0;
+uint32_t tests = 0;
+
+uint32_t now = 0;
+uint8_t  current_source = 0;
+uint32_t side_effects = 0;
+// What out() received, and how many more lines it will take
+char     output[8192];
+uint32_t output_length = 0;
+uint32_t lines = 0;
+uint32_t room = 0;
+
+
+int main(void) {
+
+    test_levels();
+    test_format();
+    test_max_args();
+    test_sources();
+    test_overflow();
+    test_backpressure();
+
+    printf("Tests: %i\n", tests);
+    printf("Passes: %i\n", passes);
+    printf("Fails: %i\n", errors);
+    return errors == 0 ? 0 : 1;
+}
+
+
+static void test_levels(void) {
+
+    // Below the build's level, nothing is stored or even evaluated
+    test_setup();
+    LOG_DEBUG("Not stored %u", side_effect());
+    check(side_effects == 0 && log_drain(10, out) == 0, "Debug compiled out");
+
+    LOG_INFO("Stored %u", side_effect());
+    LOG_WARN("Warned");
+    LOG_ERROR("Failed");
+    check(side_effects == 1 && log_drain(10, out) == 3, "Info and above stored");
+}
+
+
+static void test_format(void) {
+
+    // Records are formatted at drain time, one line each
+    test_setup();
+    now = 1234567;
+    LOG_INFO("PC %04X, A %02X, depth %i", 0x4000, 0x42, 3);
+    now = 2000;
+    LOG_ERROR("No arguments");
+    log_drain(10, out);
+    check(strcmp(output, "[   1234.567] I PC 4000, A 42, depth 3\n[      2.000] E No arguments\n") == 0, "Lines formatted");
+}
+
+
+static void test_max_args(void) {
+
+    // Every argument up to the limit is kept
+    test_setup();
+    LOG_INFO("%u %u %u", 1, 2, 3);
+    log_drain(10, out);
+    check(LOG_MAX_ARGS == 3 && strcmp(output, "[      0.000] I 1 2 3\n") == 0, "Most arguments kept");
+
+    // Any number is counted correctly, so more fail the build
+    check(LOG_COUNT_ARGS() == 0 && LOG_COUNT_ARGS(side_effect()) == 1 && LOG_COUNT_ARGS(1, 2, 3, 4, 5) == 5, "Arguments counted");
+    check(side_effects == 0, "Counted arguments not evaluated");
+
+#ifdef LOG_TESTS_TOO_MANY_ARGS
+    LOG_INFO("%u %u %u %u", 1, 2, 3, 4);
+#endif
+}
+
+
+static void test_sources(void) {
+
+    // Each source keeps its own order
+    test_setup();
+    current_source = 1;
+    LOG_INFO("B1");
+    current_source = 0;
+    LOG_INFO("A1");
+    current_source = 1;
+    LOG_INFO("B2");
+    log_drain(10, out);
+    check(strstr(output, "A1") != NULL && strstr(output, "B1") < strstr(output, "B2"), "Per-source order");
+}
+
+
+static void test_overflow(void) {
+
+    // A full ring drops records rather than waiting, and says so
+    test_setup();
+    for (uint32_t i = 0 ; i < LOG_RING_SIZE + 10 ; ++i) LOG_INFO("Record %u", i);
+    check(log_dropped() == 10, "Overflow dropped");
+
+    log_drain(LOG_RING_SIZE + 10, out);
+    check(strstr(output, "10 record(s) dropped on source 0") != NULL && lines == LOG_RING_SIZE + 1, "Drop reported");
+    check(strstr(output, "Record 63\n") != NULL && strstr(output, "Record 64\n") == NULL, "Oldest records kept");
+}
+
+
+static void test_backpressure(void) {
+
+    // Records the output cannot take stay for the next drain
+    test_setup();
+    for (uint32_t i = 0 ; i < 5 ; ++i) LOG_INFO("Line %u", i);
+    room = 2;
+    check(log_drain(10, out) == 2 && lines == 2, "Drain stops when output full");
+
+    room = 100;
+    check(log_drain(10, out) == 3 && strstr(output, "Line 2\n") != NULL && lines == 5, "Rest sent later");
+    check(log_drain(2, out) == 0, "Nothing left");
+}
+
+
+static void test_setup(void) {
+
+    tests++;
+    log_init(clock, source);
+    now = 0;
+    current_source = 0;
+    side_effects = 0;
+    output[0] = 0;
+    output_length = 0;
+    lines = 0;
+    room = 1000;
+}
+
+
+static void check(bool is_good, const char* name) {
+
+    if (is_good) {
+        passes++;
+    } else {
+        errors++;
+        printf("  %02d. %s failed\n", tests, name);
+    }
+}
+
+
+static uint32_t clock(void) {
+
+    return now;
+}
+
+
+static uint8_t source(void) {
+
+    return current_source;
+}
+
+
+static bool out(const char* text, uint32_t length) {
+
+    if (room == 0 || output_length + length >= sizeof(output)) return false;
+    memcpy(&output[output_length], text, length);
+    output_length += length;
+    output[output_length] = 0;
+    lines++;
+    room--;
+    return true;
+}
+
+
+static uint32_t side_effect(void) {
+
+    side_effects++;
+    return 42;
+}
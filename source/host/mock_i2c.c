@@ -0,0 +1,63 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Host mock I2C bus: counts transactions and models the display RAM
+ * of HT16K33s, so driver changes can be checked and measured off the
+ * board
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <string.h>
+// App
+#include "hal.h"
+#include "mock_i2c.h"
+
+
+/*
+ * GLOBALS
+ */
+MOCK_I2C_BUS    mock_i2c_bus;
+
+
+/**
+ * @brief Clear the bus counters and every device's RAM.
+ */
+void mock_i2c_reset(void) {
+
+    memset(&mock_i2c_bus, 0, sizeof(mock_i2c_bus));
+}
+
+
+/**
+ * @brief Record a write. A single byte is a command; longer writes put
+ *        bytes into RAM from the address in the first byte, which
+ *        auto-increments, as the HT16K33 does.
+ *
+ * @param address: The 7-bit device address.
+ * @param data:    The bytes to write.
+ * @param count:   The number of bytes.
+ * @param no_stop: Unused.
+ *
+ * @retval The number of bytes written.
+ */
+int hal_i2c_write(uint8_t address, const uint8_t* data, uint32_t count, bool no_stop) {
+
+    (void)no_stop;
+
+    mock_i2c_bus.transactions++;
+    mock_i2c_bus.bytes += count;
+    address &= MOCK_I2C_DEVICES - 1;
+
+    if (count == 1) {
+        mock_i2c_bus.last_command[address] = data[0];
+    } else {
+        for (uint32_t i = 1 ; i < count ; ++i) {
+            mock_i2c_bus.ram[address][(data[0] + i - 1) & (MOCK_I2C_RAM_SIZE - 1)] = data[i];
+        }
+    }
+
+    return (int)count;
+}
@@ -0,0 +1,49 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Host mock I2C bus
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _MOCK_I2C_HEADER_
+#define _MOCK_I2C_HEADER_
+
+
+#include <stdint.h>
+
+
+/*
+ *      CONSTANTS
+ */
+#define MOCK_I2C_DEVICES            128
+#define MOCK_I2C_RAM_SIZE           16
+
+
+/*
+ * STRUCTS
+ */
+// Bus traffic, and each device's RAM as an HT16K33 would hold it
+typedef struct {
+    uint32_t    transactions;
+    uint32_t    bytes;
+    uint8_t     ram[MOCK_I2C_DEVICES][MOCK_I2C_RAM_SIZE];
+    uint8_t     last_command[MOCK_I2C_DEVICES];
+} MOCK_I2C_BUS;
+
+
+/*
+ * GLOBALS
+ */
+extern MOCK_I2C_BUS mock_i2c_bus;
+
+
+/*
+ *      PROTOTYPES
+ */
+void        mock_i2c_reset(void);
+
+
+#endif  // _MOCK_I2C_HEADER_
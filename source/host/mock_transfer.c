@@ -0,0 +1,89 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Host stand-in for the DMA transfer port: logs the jobs the queue
+ * starts and completes them when a test says, so the queue's ordering
+ * can be checked off the board
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <string.h>
+// App
+#include "mock_transfer.h"
+
+
+/*
+ * STATICS
+ */
+static void     mock_start(uint8_t bus, TRANSFER_JOB* job);
+static uint8_t  mock_check(uint8_t bus, TRANSFER_JOB* job);
+
+
+/*
+ * GLOBALS
+ */
+MOCK_TRANSFER       mock_transfer;
+const TRANSFER_PORT mock_transfer_port = {mock_start, mock_check};
+
+
+/**
+ * @brief Clear the log and idle every bus.
+ */
+void mock_transfer_reset(void) {
+
+    memset(&mock_transfer, 0, sizeof(mock_transfer));
+}
+
+
+/**
+ * @brief Set what the port reports, at the next poll, for a bus's job
+ *        in flight.
+ *
+ * @param bus:         The bus.
+ * @param result:      TRANSFER_OK or TRANSFER_FAILED.
+ * @param read_data:   Bytes the job reads back, or NULL.
+ * @param read_length: The number of bytes at `read_data`.
+ */
+void mock_transfer_finish(uint8_t bus, uint8_t result, const uint8_t* read_data, uint16_t read_length) {
+
+    mock_transfer.result[bus] = result;
+    if (read_data != NULL) memcpy(mock_transfer.read_data[bus], read_data, read_length);
+}
+
+
+/**
+ * @brief Port start(): log the job and mark its bus busy.
+ */
+static void mock_start(uint8_t bus, TRANSFER_JOB* job) {
+
+    if (mock_transfer.started < MOCK_TRANSFER_LOG_SIZE) {
+        mock_transfer.log[mock_transfer.started] = *job;
+        mock_transfer.log_bus[mock_transfer.started] = bus;
+    }
+
+    mock_transfer.started++;
+    mock_transfer.is_active[bus] = true;
+    mock_transfer.result[bus] = TRANSFER_BUSY;
+}
+
+
+/**
+ * @brief Port check(): report the result set for the bus, supplying any
+ *        bytes read once it is done.
+ */
+static uint8_t mock_check(uint8_t bus, TRANSFER_JOB* job) {
+
+    uint8_t result = mock_transfer.result[bus];
+    if (result == TRANSFER_BUSY) return result;
+
+    if (result == TRANSFER_OK && job->read_length > 0) {
+        memcpy(job->data, mock_transfer.read_data[bus], job->read_length);
+    }
+
+    mock_transfer.is_active[bus] = false;
+    mock_transfer.result[bus] = TRANSFER_BUSY;
+    return result;
+}
@@ -0,0 +1,55 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Host stand-in for the DMA transfer port
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _MOCK_TRANSFER_HEADER_
+#define _MOCK_TRANSFER_HEADER_
+
+
+#include <stdint.h>
+#include "transfer.h"
+
+
+/*
+ *      CONSTANTS
+ */
+#define MOCK_TRANSFER_LOG_SIZE      64
+
+
+/*
+ * STRUCTS
+ */
+// Jobs as the port saw them when they started, and what the port will
+// report for each bus's job in flight: TRANSFER_BUSY until a test
+// finishes it with mock_transfer_finish()
+typedef struct {
+    TRANSFER_JOB    log[MOCK_TRANSFER_LOG_SIZE];
+    uint8_t         log_bus[MOCK_TRANSFER_LOG_SIZE];
+    uint32_t        started;
+    bool            is_active[TRANSFER_BUS_COUNT];
+    uint8_t         result[TRANSFER_BUS_COUNT];
+    uint8_t         read_data[TRANSFER_BUS_COUNT][TRANSFER_MAX_DATA];
+} MOCK_TRANSFER;
+
+
+/*
+ * GLOBALS
+ */
+extern MOCK_TRANSFER        mock_transfer;
+extern const TRANSFER_PORT  mock_transfer_port;
+
+
+/*
+ *      PROTOTYPES
+ */
+void        mock_transfer_reset(void);
+void        mock_transfer_finish(uint8_t bus, uint8_t result, const uint8_t* read_data, uint16_t read_length);
+
+
+#endif  // _MOCK_TRANSFER_HEADER_
@@ -0,0 +1,112 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * MC6821 PIA tests, on the Linux HAL's modelled GPIO pins
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "main.h"
+#include "cpu.h"
+#include "hal.h"
+#include "hal_linux.h"
+#include "pia.h"
+
+
+/*
+ * STATICS
+ */
+static void test_inputs(void);
+static void test_outputs(void);
+static void test_setup(void);
+static void check(bool is_good, const char* name);
+
+
+/*
+ * GLOBALS
+ */
+uint32_t errors = 0;
+uint32_t passes = 0;
+uint32_t tests = 0;
+
+MC6821  pia;
+uint8_t pia_gpio[RP2040_PIA_GPIO_COUNT] = {PIN_6821_PA0, PIN_6821_PA1, PIN_6821_PA2, PIN_6821_PA3,
+                                           PIN_6821_PA4, PIN_6821_PA5, PIN_6821_PA6, PIN_6821_PA7,
+                                           PIN_6821_CA1, PIN_6821_CA2};
+
+extern uint8_t  mem[KB64];
+
+
+int main(void) {
+
+    test_inputs();
+    test_outputs();
+
+    printf("Tests: %i\n", tests);
+    printf("Passes: %i\n", passes);
+    printf("Fails: %i\n", errors);
+    return errors == 0 ? 0 : 1;
+}
+
+
+static void test_inputs(void) {
+
+    // On reset every PA pin is an input, pulled up
+    test_setup();
+    for (uint8_t i = 0 ; i < 8 ; ++i) pia_get_gpio_input_state(&pia, i);
+    check(pia.reg_output_a == 0xFF, "Inputs pulled up");
+
+    // A pin driven low clears only its own bit
+    test_setup();
+    pia.reg_output_a = 0xFF;
+    hal_linux_drive(PIN_6821_PA3, false);
+    pia_get_gpio_input_state(&pia, 3);
+    check(pia.reg_output_a == 0xF7, "Input follows pin");
+    hal_linux_release(PIN_6821_PA3);
+}
+
+
+static void test_outputs(void) {
+
+    // A DDR bit makes the pin an output, at the output register's level
+    test_setup();
+    mem[0xFF01] = 0xFE;
+    pia.reg_output_a = 0x01;
+    pia_set_gpio_direction(&pia, 0);
+    check(pia_get_gpio_direction(&pia, 0) == OUTPUT && hal_gpio_get(PIN_6821_PA0), "Output set high");
+
+    pia.reg_output_a = 0x00;
+    pia_set_gpio_output_state(&pia, 0);
+    check(!hal_gpio_get(PIN_6821_PA0) && hal_gpio_get(PIN_6821_PA1), "Output set low");
+}
+
+
+static void test_setup(void) {
+
+    tests++;
+    for (uint8_t i = 0 ; i < RP2040_PIA_GPIO_COUNT ; ++i) hal_gpio_init(pia_gpio[i], false);
+    pia.pa_pins = &pia_gpio[0];
+    pia.ca_pins = &pia_gpio[8];
+    pia.reg_control_a = &mem[0xFF00];
+    pia.reg_data_a = &mem[0xFF01];
+    mem[0xFF00] = 0;
+    mem[0xFF01] = 0;
+    pia_init(&pia);
+}
+
+
+static void check(bool is_good, const char* name) {
+
+    if (is_good) {
+        passes++;
+    } else {
+        errors++;
+        printf("  %02d. %s failed\n", tests, name);
+    }
+}
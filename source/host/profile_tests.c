@@ -0,0 +1,211 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Opcode profiler tests
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "main.h"
+#include "cpu.h"
+#include "profile.h"
+
+
+/*
+ * STATICS
+ */
+static void test_counts(void);
+static void test_forms(void);
+static void test_interrupts(void);
+static void test_modes(void);
+static void test_read(void);
+static void test_report(void);
+static void run_program(void);
+static void save_report(const char* text, uint32_t length);
+static uint32_t read_word(uint32_t index);
+static void test_setup(void);
+static void check(bool is_good, const char* name);
+
+
+/*
+ * GLOBALS
+ */
+uint32_t errors = 0;
+uint32_t passes = 0;
+uint32_t tests = 0;
+
+char     report[8192];
+uint32_t report_length = 0;
+
+extern REG_6809     reg;
+extern uint8_t      mem[KB64];
+extern STATE_6809   state;
+extern PROFILE      profile;
+
+// LDA #5, LDY #$2000, LDA 1,X, LDB ,X+, CMPU #0, BRA *
+#define PROGRAM_OPS     6
+const uint8_t PROGRAM[] = {
+    0x86, 0x05,
+    0x10, 0x8E, 0x20, 0x00,
+    0xA6, 0x01,
+    0xE6, 0x80,
+    0x11, 0x83, 0x00, 0x00,
+    0x20, 0xFE
+};
+
+
+int main(void) {
+
+    test_counts();
+    test_forms();
+    test_interrupts();
+    test_modes();
+    test_read();
+    test_report();
+
+    printf("Tests: %i\n", tests);
+    printf("Passes: %i\n", passes);
+    printf("Fails: %i\n", errors);
+    return errors == 0 ? 0 : 1;
+}
+
+
+static void test_counts(void) {
+
+    // Each page's ops are counted apart, with their cycles
+    test_setup();
+    run_program();
+    check(profile.instructions[0][0x86] == 1 && profile.cycles[0][0x86] == 2, "Page 0 op counted");
+    check(profile.instructions[1][0x8E] == 1 && profile.cycles[1][0x8E] == 4, "Page 1 op counted");
+    check(profile.instructions[2][0x83] == 1 && profile.cycles[2][0x83] == 5, "Page 2 op counted");
+    check(profile.instructions[0][0x8E] == 0 && profile.instructions[0][0x10] == 0, "Prefix not counted as an op");
+    check(profile.histogram[2] == 1 && profile.histogram[3] == 1 && profile.histogram[4] == 1
+          && profile.histogram[5] == 2 && profile.histogram[6] == 1, "Cycle histogram");
+}
+
+
+static void test_forms(void) {
+
+    // Indexed ops are counted by postbyte form, with their total cycles
+    test_setup();
+    run_program();
+    check(profile.form_instructions[PROFILE_FORM_OFFSET_5] == 1 && profile.form_cycles[PROFILE_FORM_OFFSET_5] == 5, "5-bit offset form");
+    check(profile.form_instructions[0] == 1 && profile.form_cycles[0] == 6, "Auto-increment form");
+    check(profile.form_instructions[4] == 0, "Unused form not counted");
+}
+
+
+static void test_interrupts(void) {
+
+    // Taking an interrupt runs no op, so counts nothing
+    test_setup();
+    mem[IRQ_VECTOR] = 0x10;
+    mem[IRQ_VECTOR + 1] = 0x00;
+    reg.cc = 0x00;
+    state.interrupts = 1 << IRQ_BIT;
+    process_next_instruction();
+    uint32_t total = 0;
+    for (uint32_t i = 0 ; i < PROFILE_OPCODES ; ++i) total += profile.instructions[0][i];
+    check(total == 0 && reg.pc == 0x1000, "Interrupt entry not counted");
+
+    process_next_instruction();
+    check(profile.instructions[0][0x86] == 1, "Handler op counted");
+}
+
+
+static void test_modes(void) {
+
+    test_setup();
+    check(profile_mode(0x16) == PROFILE_MODE_RELATIVE && profile_mode(0x8D) == PROFILE_MODE_RELATIVE, "Branch modes");
+    check(profile_mode(0x30) == MODE_INDEXED && profile_mode(0xA6) == MODE_INDEXED, "Indexed modes");
+    check(profile_mode(0x34) == MODE_IMMEDIATE && profile_mode(0x1F) == MODE_IMMEDIATE && profile_mode(0xCC) == MODE_IMMEDIATE, "Immediate modes");
+    check(profile_mode(0x0C) == MODE_DIRECT && profile_mode(0xB7) == MODE_EXTENDED, "Memory modes");
+    check(profile_mode(0x3A) == MODE_INHERENT && profile_mode(0x4F) == MODE_INHERENT, "Inherent modes");
+}
+
+
+static void test_read(void) {
+
+    // The serialised profile is big-endian words, mode totals last
+    test_setup();
+    run_program();
+    uint8_t data[8];
+    check(profile_read(0x86 * 4, data, 4) == 4 && data[0] == 0 && data[3] == 1, "Counter is big-endian");
+
+    uint32_t modes = PROFILE_WORDS - 2 * PROFILE_MODES;
+    check(read_word(modes + MODE_IMMEDIATE) == 3 && read_word(modes + MODE_INDEXED) == 2
+          && read_word(modes + PROFILE_MODE_RELATIVE) == 1, "Mode instruction totals");
+    check(read_word(modes + PROFILE_MODES + MODE_INDEXED) == 11, "Mode cycle totals");
+    check(profile_read(PROFILE_SIZE - 2, data, 8) == 2 && profile_read(PROFILE_SIZE, data, 8) == 0, "Read stops at the end");
+}
+
+
+static void test_report(void) {
+
+    test_setup();
+    run_program();
+    report_length = 0;
+    profile_report(save_report);
+    report[report_length] = 0;
+    check(strstr(report, "6 instructions, 25 cycles") != NULL, "Report totals");
+    check(strstr(report, "10 8E   immediate") != NULL && strstr(report, "11 83   immediate") != NULL, "Report prefixed ops");
+    check(strstr(report, ",R+") != NULL && strstr(report, "n5,R") != NULL, "Report indexed forms");
+
+    // Ops are listed busiest first: LDB ,X+ took the most cycles
+    char* first = strstr(report, "Cycles%\n");
+    check(first != NULL && strncmp(first + 8, "   E6", 5) == 0, "Report ordered by cycles");
+}
+
+
+static void run_program(void) {
+
+    for (uint32_t i = 0 ; i < PROGRAM_OPS ; ++i) process_next_instruction();
+}
+
+
+static void save_report(const char* text, uint32_t length) {
+
+    if (report_length + length < sizeof(report)) {
+        memcpy(&report[report_length], text, length);
+        report_length += length;
+    }
+}
+
+
+static uint32_t read_word(uint32_t index) {
+
+    uint8_t data[4];
+    profile_read(index * 4, data, 4);
+    return (data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+}
+
+
+static void test_setup(void) {
+
+    tests++;
+    memset(mem, 0, KB64);
+    memcpy(&mem[0x1000], PROGRAM, sizeof(PROGRAM));
+    init_cpu();
+    reg.pc = 0x1000;
+    reg.s = 0x8000;
+    reg.x = 0x2000;
+    profile_reset();
+}
+
+
+static void check(bool is_good, const char* name) {
+
+    if (is_good) {
+        passes++;
+    } else {
+        errors++;
+        printf("  %02d. %s failed\n", tests, name);
+    }
+}
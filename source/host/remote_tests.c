@@ -0,0 +1,408 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Remote-control protocol tests
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "main.h"
+#include "breakpoint.h"
+#include "cpu.h"
+#include "core.h"
+#include "crc.h"
+#include "mailbox.h"
+#include "remote.h"
+
+
+/*
+ * STATICS
+ */
+static void test_memory(void);
+static void test_registers(void);
+static void test_run(void);
+static void test_breakpoints(void);
+static void test_watchpoints(void);
+static void test_core_run(void);
+static void test_errors(void);
+static void test_setup(void);
+static void check(bool is_good, const char* name);
+static void send_reply(const uint8_t* data, uint32_t length);
+static void command(uint8_t cmd, uint8_t tag, const uint8_t* payload, uint16_t length);
+static uint8_t* find_response(uint8_t code, uint8_t tag, uint16_t* length);
+static uint8_t get_status(uint8_t cmd, uint8_t tag);
+
+
+/*
+ * GLOBALS
+ */
+uint32_t errors = 0;
+uint32_t passes = 0;
+uint32_t tests = 0;
+
+uint8_t  replies[4096];
+uint32_t reply_count = 0;
+REMOTE   remote;
+
+extern REG_6809     reg;
+extern uint8_t      mem[KB64];
+extern STATE_6809   state;
+extern BREAKPOINTS  breakpoints;
+extern MEMORY_MAP_6809 memory_map;
+
+// LDA #$42 ; loop: INCA ; BRA loop
+const uint8_t program[] = {0x86, 0x42, 0x4C, 0x20, 0xFD};
+
+
+int main(void) {
+
+    test_memory();
+    test_registers();
+    test_run();
+    test_breakpoints();
+    test_watchpoints();
+    test_core_run();
+    test_errors();
+
+    printf("Tests: %i\n", tests);
+    printf("Passes: %i\n", passes);
+    printf("Fails: %i\n", errors);
+    return errors == 0 ? 0 : 1;
+}
+
+
+static void test_memory(void) {
+
+    test_setup();
+    command(REMOTE_CMD_PING, 1, NULL, 0);
+    uint16_t length = 0;
+    uint8_t* data = find_response(REMOTE_CMD_PING | REMOTE_RESPONSE_BIT, 1, &length);
+    check(data != NULL && length == 2 && data[0] == REMOTE_STATUS_OK && data[1] == REMOTE_VERSION, "PING");
+
+    // Poke a range, fed a byte at a time, then peek it back
+    uint8_t poke[2 + 300];
+    poke[0] = 0x12;
+    poke[1] = 0x34;
+    for (uint32_t i = 0 ; i < 300 ; ++i) poke[2 + i] = i * 7;
+    uint8_t frame[REMOTE_HEADER_SIZE + sizeof(poke) + REMOTE_CRC_SIZE];
+    uint8_t header[REMOTE_HEADER_SIZE] = {REMOTE_SYNC_HEAD, REMOTE_SYNC_REMOTE, REMOTE_CMD_POKE, 2, sizeof(poke) >> 8, sizeof(poke) & 0xFF};
+    memcpy(frame, header, REMOTE_HEADER_SIZE);
+    memcpy(&frame[REMOTE_HEADER_SIZE], poke, sizeof(poke));
+    uint32_t crc = crc32(&frame[2], REMOTE_HEADER_SIZE - 2 + sizeof(poke));
+    uint8_t* tail = &frame[REMOTE_HEADER_SIZE + sizeof(poke)];
+    tail[0] = crc >> 24;
+    tail[1] = (crc >> 16) & 0xFF;
+    tail[2] = (crc >> 8) & 0xFF;
+    tail[3] = crc & 0xFF;
+    uint8_t dirty[DIRTY_MAP_SIZE] = {0};
+    memory_map.write_dirty = dirty;
+    for (uint32_t i = 0 ; i < sizeof(frame) ; ++i) remote_feed(&remote, &frame[i], 1);
+    check(get_status(REMOTE_CMD_POKE, 2) == REMOTE_STATUS_OK && memcmp(&mem[0x1234], &poke[2], 300) == 0, "POKE");
+
+    // Lines 0x91 to 0x9A
+    check(dirty[0x11] == 0x00 && dirty[0x12] == 0xFE && dirty[0x13] == 0x07 && dirty[0x14] == 0x00, "POKE marked dirty");
+    memory_map.write_dirty = NULL;
+
+    uint8_t peek[4] = {0x12, 0x34, 0x01, 0x2C};
+    command(REMOTE_CMD_PEEK, 3, peek, 4);
+    data = find_response(REMOTE_CMD_PEEK | REMOTE_RESPONSE_BIT, 3, &length);
+    check(data != NULL && length == 301 && memcmp(&data[1], &poke[2], 300) == 0, "PEEK");
+
+    // Ranges past the top of memory are refused
+    uint8_t past[4] = {0xFF, 0xF0, 0x00, 0x20};
+    command(REMOTE_CMD_PEEK, 4, past, 4);
+    check(get_status(REMOTE_CMD_PEEK, 4) == REMOTE_STATUS_BAD_LENGTH, "PEEK past end refused");
+}
+
+
+static void test_registers(void) {
+
+    test_setup();
+    uint8_t regs[REMOTE_REGS_SIZE] = {0x01, 0x02, 0x10, 0x11, 0x20, 0x21, 0x30, 0x31, 0x7F, 0x00, 0x40, 0x00, 0x50, 0x04};
+    command(REMOTE_CMD_SET_REGS, 1, regs, sizeof(regs));
+    check(get_status(REMOTE_CMD_SET_REGS, 1) == REMOTE_STATUS_OK, "SET_REGS");
+    check(reg.a == 0x01 && reg.b == 0x02 && reg.x == 0x1011 && reg.y == 0x2021 && reg.u == 0x3031
+          && reg.s == 0x7F00 && reg.pc == 0x4000 && reg.cc == 0x50 && reg.dp == 0x04, "Registers set");
+
+    command(REMOTE_CMD_GET_REGS, 2, NULL, 0);
+    uint16_t length = 0;
+    uint8_t* data = find_response(REMOTE_CMD_GET_REGS | REMOTE_RESPONSE_BIT, 2, &length);
+    check(data != NULL && length == REMOTE_REGS_SIZE + 1 && memcmp(&data[1], regs, REMOTE_REGS_SIZE) == 0, "GET_REGS");
+
+    // Step LDA #$42
+    command(REMOTE_CMD_STEP, 3, NULL, 0);
+    data = find_response(REMOTE_CMD_STEP | REMOTE_RESPONSE_BIT, 3, &length);
+    check(data != NULL && data[1] == 0x42 && data[11] == 0x40 && data[12] == 0x02, "STEP");
+}
+
+
+static void test_run(void) {
+
+    // 2 + 10 * (2 + 3): stops after the tenth BRA
+    test_setup();
+    uint8_t cycles[4] = {0x00, 0x00, 0x00, 52};
+    command(REMOTE_CMD_RUN, 1, cycles, 4);
+    check(get_status(REMOTE_CMD_RUN, 1) == REMOTE_STATUS_OK && remote.is_running, "RUN accepted");
+    check(get_status(REMOTE_CMD_STEP, 0xFF) == 0xFF, "Run waits for poll");
+
+    // Commands still work while running; some are refused
+    command(REMOTE_CMD_STEP, 2, NULL, 0);
+    check(get_status(REMOTE_CMD_STEP, 2) == REMOTE_STATUS_BUSY, "STEP refused while running");
+
+    while (remote_poll(&remote));
+    uint16_t length = 0;
+    uint8_t* data = find_response(REMOTE_EVENT_STOPPED, 0, &length);
+    check(data != NULL && data[1] == REMOTE_STOP_CYCLES && reg.a == 0x4C && remote.cycles_run == 52, "Ran requested cycles");
+
+    // An unlimited run continues across slices until stopped
+    test_setup();
+    uint8_t forever[4] = {0};
+    command(REMOTE_CMD_RUN, 1, forever, 4);
+    check(remote_poll(&remote) && remote_poll(&remote) && remote.cycles_run >= 2 * REMOTE_SLICE_CYCLES, "Unlimited run sliced");
+
+    command(REMOTE_CMD_STATUS, 2, NULL, 0);
+    data = find_response(REMOTE_CMD_STATUS | REMOTE_RESPONSE_BIT, 2, &length);
+    check(data != NULL && data[1] == 1, "STATUS while running");
+
+    command(REMOTE_CMD_STOP, 3, NULL, 0);
+    data = find_response(REMOTE_EVENT_STOPPED, 0, &length);
+    check(!remote_poll(&remote) && data != NULL && data[1] == REMOTE_STOP_HALTED, "STOP");
+
+    // RTI at the top level returns to the monitor
+    test_setup();
+    mem[0x4000] = 0x3B;
+    command(REMOTE_CMD_RUN, 1, forever, 4);
+    remote_poll(&remote);
+    data = find_response(REMOTE_EVENT_STOPPED, 0, &length);
+    check(data != NULL && data[1] == REMOTE_STOP_RETURN, "Return to monitor");
+}
+
+
+static void test_breakpoints(void) {
+
+    test_setup();
+    uint8_t address[2] = {0x40, 0x03};
+    command(REMOTE_CMD_BREAK_SET, 1, address, 2);
+    check(get_status(REMOTE_CMD_BREAK_SET, 1) == REMOTE_STATUS_OK && breakpoints.count == 1, "BREAK_SET");
+
+    uint8_t forever[4] = {0};
+    command(REMOTE_CMD_RUN, 2, forever, 4);
+    remote_poll(&remote);
+    uint16_t length = 0;
+    uint8_t* data = find_response(REMOTE_EVENT_STOPPED, 0, &length);
+    check(data != NULL && data[1] == REMOTE_STOP_BREAKPOINT && reg.pc == 0x4003 && reg.a == 0x43, "Breakpoint hit");
+
+    // Continuing runs past the breakpoint to hit it again
+    reply_count = 0;
+    command(REMOTE_CMD_RUN, 3, forever, 4);
+    remote_poll(&remote);
+    data = find_response(REMOTE_EVENT_STOPPED, 0, &length);
+    check(data != NULL && reg.pc == 0x4003 && reg.a == 0x44 && remote.cycles_run == 5, "Continue from breakpoint");
+
+    command(REMOTE_CMD_BREAK_CLEAR, 4, address, 2);
+    check(get_status(REMOTE_CMD_BREAK_CLEAR, 4) == REMOTE_STATUS_OK && breakpoints.count == 0, "BREAK_CLEAR");
+
+    // The table fills
+    for (uint16_t i = 0 ; i <= BREAKPOINT_MAX ; ++i) {
+        uint8_t other[2] = {0x50, i};
+        command(REMOTE_CMD_BREAK_SET, 10 + i, other, 2);
+    }
+
+    check(get_status(REMOTE_CMD_BREAK_SET, 10 + BREAKPOINT_MAX) == REMOTE_STATUS_FULL, "Breakpoint table full");
+    command(REMOTE_CMD_BREAK_CLEAR_ALL, 5, NULL, 0);
+    check(breakpoints.count == 0, "BREAK_CLEAR_ALL");
+}
+
+
+static void test_watchpoints(void) {
+
+    // Write watchpoint on 0x5000, set by BREAK_ADD: STA $5000 after INCA
+    test_setup();
+    mem[0x4003] = 0xB7;
+    mem[0x4004] = 0x50;
+    mem[0x4005] = 0x00;
+    uint8_t watch[14] = {BREAKPOINT_WRITE, 0x50, 0x00, 0x50, 0x00, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_ALWAYS, 0, 0, 0, 0, 0, 0, 0};
+    command(REMOTE_CMD_BREAK_ADD, 1, watch, sizeof(watch));
+    uint16_t length = 0;
+    uint8_t* data = find_response(REMOTE_CMD_BREAK_ADD | REMOTE_RESPONSE_BIT, 1, &length);
+    check(data != NULL && length == 2 && data[0] == REMOTE_STATUS_OK && data[1] == 0, "BREAK_ADD");
+
+    uint8_t forever[4] = {0};
+    command(REMOTE_CMD_RUN, 2, forever, 4);
+    remote_poll(&remote);
+    data = find_response(REMOTE_EVENT_STOPPED, 0, &length);
+    check(data != NULL && length == 11 && data[1] == REMOTE_STOP_WATCHPOINT && data[8] == 0 && data[9] == 0x50 && data[10] == 0x00
+          && reg.pc == 0x4006 && mem[0x5000] == 0x43 && remote.cycles_run == 9, "Watchpoint hit");
+
+    // A snapshot, taken by a read watchpoint on the op after the store
+    reply_count = 0;
+    uint8_t remove = 0;
+    command(REMOTE_CMD_BREAK_REMOVE, 3, &remove, 1);
+    mem[0x4006] = 0xB6;
+    mem[0x4007] = 0x50;
+    mem[0x4008] = 0x00;
+    mem[0x4009] = 0x3B;
+    watch[0] = BREAKPOINT_READ;
+    watch[5] = BREAKPOINT_ACTION_SNAPSHOT;
+    command(REMOTE_CMD_BREAK_ADD, 4, watch, sizeof(watch));
+    command(REMOTE_CMD_RUN, 5, forever, 4);
+    remote_poll(&remote);
+    command(REMOTE_CMD_SNAPSHOTS, 6, NULL, 0);
+    data = find_response(REMOTE_CMD_SNAPSHOTS | REMOTE_RESPONSE_BIT, 6, &length);
+    check(data != NULL && length == 1 + REMOTE_SNAPSHOT_SIZE && data[2] == BREAKPOINT_READ && data[3] == 0x50 && data[8] == 1
+          && data[9] == 0x43 && data[19] == 0x40 && data[20] == 0x09, "SNAPSHOTS");
+}
+
+
+static void test_core_run(void) {
+
+    // Runs go to the core: stand in for it by taking its commands and
+    // posting its events
+    test_setup();
+    CORE core;
+    core_init(&core, mem, NULL, NULL);
+    remote.core = &core;
+    uint8_t cycles[4] = {0x00, 0x00, 0x03, 0xE8};
+    command(REMOTE_CMD_RUN, 1, cycles, 4);
+    MAILBOX_MSG msg;
+    check(get_status(REMOTE_CMD_RUN, 1) == REMOTE_STATUS_OK && mailbox_get(&core.commands, &msg)
+          && msg.type == CORE_CMD_RUN && msg.value == 1000, "RUN sent to core");
+    check(remote_poll(&remote) && reg.pc == 0x4000, "Not run here");
+
+    // The run owns memory and the breakpoints
+    uint8_t poke[3] = {0x50, 0x00, 0xAA};
+    command(REMOTE_CMD_POKE, 2, poke, 3);
+    command(REMOTE_CMD_BREAK_SET, 3, poke, 2);
+    check(get_status(REMOTE_CMD_POKE, 2) == REMOTE_STATUS_BUSY && get_status(REMOTE_CMD_BREAK_SET, 3) == REMOTE_STATUS_BUSY
+          && mem[0x5000] == 0x00 && breakpoints.count == 0, "Changes refused while running");
+
+    MAILBOX_MSG event = {CORE_EVENT_STOPPED, CORE_STOP_CYCLES, 0x4003, 1001};
+    mailbox_put(&core.events, &event);
+    uint16_t length = 0;
+    uint8_t* data = NULL;
+    check(!remote_poll(&remote) && (data = find_response(REMOTE_EVENT_STOPPED, 0, &length)) != NULL
+          && data[1] == REMOTE_STOP_CYCLES && remote.cycles_run == 1001, "Core stop reported");
+
+    // STOP pauses the core. If the run ends on its own first, that is
+    // the reason given, once the pause is answered
+    reply_count = 0;
+    command(REMOTE_CMD_RUN, 4, cycles, 4);
+    mailbox_get(&core.commands, &msg);
+    command(REMOTE_CMD_STOP, 5, NULL, 0);
+    check(mailbox_get(&core.commands, &msg) && msg.type == CORE_CMD_PAUSE && remote_poll(&remote), "STOP pauses the core");
+
+    breakpoints.hit_kind = BREAKPOINT_EXECUTE;
+    event.arg = CORE_STOP_BREAKPOINT;
+    mailbox_put(&core.events, &event);
+    check(remote_poll(&remote) && find_response(REMOTE_EVENT_STOPPED, 0, &length) == NULL, "Waits for the pause");
+
+    event.arg = CORE_STOP_PAUSED;
+    mailbox_put(&core.events, &event);
+    check(!remote_poll(&remote) && (data = find_response(REMOTE_EVENT_STOPPED, 0, &length)) != NULL
+          && data[1] == REMOTE_STOP_BREAKPOINT, "Breakpoint stop kept");
+}
+
+
+static void test_errors(void) {
+
+    test_setup();
+    command(0x7E, 1, NULL, 0);
+    check(get_status(0x7E, 1) == REMOTE_STATUS_BAD_COMMAND, "Unknown command");
+
+    command(REMOTE_CMD_SET_REGS, 2, NULL, 0);
+    check(get_status(REMOTE_CMD_SET_REGS, 2) == REMOTE_STATUS_BAD_LENGTH, "Bad length");
+
+    // Noise, then a frame with a bad CRC, then a good one
+    uint8_t noise[] = {0x00, 0x55, 0x55, 0x12, 0x55, 0x3E, REMOTE_CMD_PING, 3, 0x00, 0x00, 0xDE, 0xAD, 0xBE, 0xEF};
+    remote_feed(&remote, noise, sizeof(noise));
+    command(REMOTE_CMD_PING, 4, NULL, 0);
+    check(get_status(REMOTE_CMD_PING, 3) == REMOTE_STATUS_BAD_CRC && remote.bad_frames == 1, "Bad CRC");
+    check(get_status(REMOTE_CMD_PING, 4) == REMOTE_STATUS_OK, "Resync after bad frame");
+}
+
+
+static void test_setup(void) {
+
+    tests++;
+    memset(mem, 0, KB64);
+    memcpy(&mem[0x4000], program, sizeof(program));
+    memset(&reg, 0, sizeof(reg));
+    memset(&state, 0, sizeof(state));
+    reg.pc = 0x4000;
+    reg.s = 0x7F00;
+    reply_count = 0;
+    remote_init(&remote, mem, send_reply);
+}
+
+
+static void check(bool is_good, const char* name) {
+
+    if (is_good) {
+        passes++;
+    } else {
+        errors++;
+        printf("  %02d. %s failed\n", tests, name);
+    }
+}
+
+
+static void send_reply(const uint8_t* data, uint32_t length) {
+
+    if (reply_count + length > sizeof(replies)) return;
+    memcpy(&replies[reply_count], data, length);
+    reply_count += length;
+}
+
+
+static void command(uint8_t cmd, uint8_t tag, const uint8_t* payload, uint16_t length) {
+
+    uint8_t frame[REMOTE_HEADER_SIZE + 64 + REMOTE_CRC_SIZE];
+    uint8_t header[REMOTE_HEADER_SIZE] = {REMOTE_SYNC_HEAD, REMOTE_SYNC_REMOTE, cmd, tag, length >> 8, length & 0xFF};
+
+    memcpy(frame, header, REMOTE_HEADER_SIZE);
+    if (length > 0) memcpy(&frame[REMOTE_HEADER_SIZE], payload, length);
+
+    uint32_t crc = crc32(&frame[2], REMOTE_HEADER_SIZE - 2 + length);
+    uint8_t* tail = &frame[REMOTE_HEADER_SIZE + length];
+    tail[0] = crc >> 24;
+    tail[1] = (crc >> 16) & 0xFF;
+    tail[2] = (crc >> 8) & 0xFF;
+    tail[3] = crc & 0xFF;
+    remote_feed(&remote, frame, REMOTE_HEADER_SIZE + length + REMOTE_CRC_SIZE);
+}
+
+
+static uint8_t* find_response(uint8_t code, uint8_t tag, uint16_t* length) {
+
+    // Walk the responses, checking each one's CRC
+    for (uint32_t i = 0 ; i + REMOTE_HEADER_SIZE <= reply_count ; ) {
+        uint16_t size = (replies[i + 4] << 8) | replies[i + 5];
+        uint8_t* tail = &replies[i + REMOTE_HEADER_SIZE + size];
+        uint32_t crc = (tail[0] << 24) | (tail[1] << 16) | (tail[2] << 8) | tail[3];
+        if (crc != crc32(&replies[i + 2], REMOTE_HEADER_SIZE - 2 + size)) return NULL;
+
+        if (replies[i + 2] == code && replies[i + 3] == tag) {
+            *length = size;
+            return &replies[i + REMOTE_HEADER_SIZE];
+        }
+
+        i += REMOTE_HEADER_SIZE + size + REMOTE_CRC_SIZE;
+    }
+
+    return NULL;
+}
+
+
+static uint8_t get_status(uint8_t cmd, uint8_t tag) {
+
+    uint16_t length = 0;
+    uint8_t* data = find_response(cmd | REMOTE_RESPONSE_BIT, tag, &length);
+    return data == NULL ? 0xFF : data[0];
+}
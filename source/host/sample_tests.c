@@ -0,0 +1,184 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * PC sampler tests
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "main.h"
+#include "cpu.h"
+#include "sample.h"
+
+
+/*
+ * STATICS
+ */
+static void test_calls(void);
+static void test_interrupts(void);
+static void test_unwinding(void);
+static void test_truncation(void);
+static void test_ring(void);
+static bool next_sample(uint16_t pc, uint8_t depth, uint16_t outer, uint16_t inner);
+static void test_setup(void);
+static void check(bool is_good, const char* name);
+
+
+/*
+ * GLOBALS
+ */
+uint32_t errors = 0;
+uint32_t passes = 0;
+uint32_t tests = 0;
+
+extern REG_6809     reg;
+extern uint8_t      mem[KB64];
+extern STATE_6809   state;
+
+// 0x1000: JSR $1020, BRA *
+// 0x1020: BSR $1030, RTS
+// 0x1030: NOP, PULS PC
+// 0x1040: RTI
+const uint8_t MAIN[] = {0xBD, 0x10, 0x20, 0x20, 0xFE};
+const uint8_t OUTER[] = {0x8D, 0x0E, 0x39};
+const uint8_t INNER[] = {0x12, 0x35, 0x80};
+const uint8_t HANDLER[] = {0x3B};
+
+
+int main(void) {
+
+    test_calls();
+    test_interrupts();
+    test_unwinding();
+    test_truncation();
+    test_ring();
+
+    printf("Tests: %i\n", tests);
+    printf("Passes: %i\n", passes);
+    printf("Fails: %i\n", errors);
+    return errors == 0 ? 0 : 1;
+}
+
+
+static void test_calls(void) {
+
+    // Sampling every instruction shows the stack growing and shrinking
+    test_setup();
+    for (uint8_t i = 0 ; i < 6 ; ++i) process_next_instruction();
+    check(next_sample(0x1020, 1, 0x1003, 0x1003), "JSR stacks a frame");
+    check(next_sample(0x1030, 2, 0x1003, 0x1022), "BSR stacks a frame");
+    check(next_sample(0x1031, 2, 0x1003, 0x1022), "Frames held");
+    check(next_sample(0x1022, 1, 0x1003, 0x1003), "PULS PC returns");
+    check(next_sample(0x1003, 0, 0, 0), "RTS returns");
+}
+
+
+static void test_interrupts(void) {
+
+    // An interrupt's frame holds the interrupted PC
+    test_setup();
+    reg.pc = 0x1003;
+    reg.cc = 0x00;
+    state.interrupts = 1 << IRQ_BIT;
+    process_next_instruction();
+    process_next_instruction();
+    check(next_sample(0x1040, 1, 0x1003, 0x1003), "IRQ stacks a frame");
+    check(next_sample(0x1003, 0, 0, 0), "RTI returns");
+}
+
+
+static void test_unwinding(void) {
+
+    // Frames S has moved above are gone, even without a return
+    test_setup();
+    sample_call(0x1234, 0x7FFE);
+    sample_take(0x2000, 0x8000);
+    check(next_sample(0x2000, 0, 0, 0), "Stack adjustment unwinds");
+
+    // A call at a stale frame's level replaces it
+    sample_call(0x1111, 0x7FFE);
+    sample_return(0x7FFC);
+    sample_call(0x2222, 0x7FFE);
+    sample_take(0x2000, 0x7FFE);
+    check(next_sample(0x2000, 1, 0x2222, 0x2222), "Stale frame replaced");
+}
+
+
+static void test_truncation(void) {
+
+    // Deep stacks keep their innermost frames
+    test_setup();
+    for (uint16_t i = 0 ; i < 20 ; ++i) sample_call(0x1000 + i, 0x7FFE - 2 * i);
+    sample_take(0x3000, 0x7FFE - 38);
+    check(next_sample(0x3000, SAMPLE_MAX_DEPTH | SAMPLE_TRUNCATED, 0x1004, 0x1013), "Deep stack truncated");
+}
+
+
+static void test_ring(void) {
+
+    // A full ring drops samples rather than waiting
+    test_setup();
+    uint32_t dropped = sample_dropped();
+    for (uint32_t i = 0 ; i < SAMPLE_RING_SIZE + 2 ; ++i) sample_take(0x4000 + i, 0x8000);
+    check(sample_dropped() == dropped + 2, "Full ring drops samples");
+
+    // Reads take whole samples only: depth byte, frames, then PC
+    sample_call(0x1234, 0x7FFE);
+    SAMPLE sample;
+    for (uint32_t i = 0 ; i < SAMPLE_RING_SIZE - 1 ; ++i) sample_get(&sample);
+    sample_take(0x5678, 0x7FFE);
+    uint8_t data[8];
+    check(sample_read(data, 4) == 3 && data[0] == 0 && data[1] == 0x40 && data[2] == 0x7F, "Read is whole samples");
+    check(sample_read(data, 4) == 0, "No room for the next");
+    check(sample_read(data, 8) == 5 && data[0] == 1 && data[1] == 0x12 && data[2] == 0x34 && data[3] == 0x56, "Frames read outermost first");
+}
+
+
+static bool next_sample(uint16_t pc, uint8_t depth, uint16_t outer, uint16_t inner) {
+
+    SAMPLE sample;
+    if (!sample_get(&sample) || sample.pc != pc || sample.depth != depth) return false;
+
+    uint8_t count = depth & ~SAMPLE_TRUNCATED;
+    return count == 0 || (sample.stack[0] == outer && sample.stack[count - 1] == inner);
+}
+
+
+static void test_setup(void) {
+
+    tests++;
+    memset(mem, 0, KB64);
+    memcpy(&mem[0x1000], MAIN, sizeof(MAIN));
+    memcpy(&mem[0x1020], OUTER, sizeof(OUTER));
+    memcpy(&mem[0x1030], INNER, sizeof(INNER));
+    memcpy(&mem[0x1040], HANDLER, sizeof(HANDLER));
+    mem[IRQ_VECTOR] = 0x10;
+    mem[IRQ_VECTOR + 1] = 0x40;
+    init_cpu();
+    reg.pc = 0x1000;
+    reg.s = 0x8000;
+
+    // Clear the call stack and the ring, then sample every instruction
+    SAMPLE sample;
+    sample_return(0xFFFF);
+    while (sample_get(&sample));
+    sample_start(1);
+}
+
+
+static void check(bool is_good, const char* name) {
+
+    if (is_good) {
+        passes++;
+    } else {
+        errors++;
+        printf("  %02d. %s failed\n", tests, name);
+    }
+}
@@ -0,0 +1,210 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Instruction tracer tests
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "main.h"
+#include "cpu.h"
+#include "trace.h"
+
+
+/*
+ * STATICS
+ */
+static void test_records(void);
+static void test_interrupts(void);
+static void test_off(void);
+static void test_encoding(void);
+static void test_gaps(void);
+static void run(uint32_t count);
+static void drain(void);
+static void test_setup(void);
+static void check(bool is_good, const char* name);
+
+
+/*
+ * GLOBALS
+ */
+uint32_t errors = 0;
+uint32_t passes = 0;
+uint32_t tests = 0;
+
+extern REG_6809     reg;
+extern uint8_t      mem[KB64];
+extern STATE_6809   state;
+
+// 0x1000: LDX #$2000, LDA 3,X, STA $2100, LDY #$1234, BRA *
+// 0x1040: RTI
+const uint8_t PROGRAM[] = {0x8E, 0x20, 0x00, 0xA6, 0x03, 0xB7, 0x21, 0x00, 0x10, 0x8E, 0x12, 0x34, 0x20, 0xFE};
+const uint8_t HANDLER[] = {0x3B};
+
+
+int main(void) {
+
+    test_records();
+    test_interrupts();
+    test_off();
+    test_encoding();
+    test_gaps();
+
+    printf("Tests: %i\n", tests);
+    printf("Passes: %i\n", passes);
+    printf("Fails: %i\n", errors);
+    return errors == 0 ? 0 : 1;
+}
+
+
+static void test_records(void) {
+
+    test_setup();
+    mem[0x2003] = 0x42;
+    run(5);
+
+    TRACE_RECORD record;
+    check(trace_get(&record) && record.pc == 0x1000 && record.regs.pc == 0x1003 && record.length == 3
+          && record.bytes[0] == 0x8E && record.regs.x == 0x2000 && record.cycles == 3, "Immediate op");
+    check((record.flags & TRACE_GAP) && (record.flags & TRACE_NO_ADDRESS), "First record follows a gap");
+    check(trace_get(&record) && record.length == 2 && record.address == 0x2003 && record.regs.a == 0x42
+          && !(record.flags & (TRACE_GAP | TRACE_NO_ADDRESS)), "Indexed op");
+    check(trace_get(&record) && record.length == 3 && record.address == 0x2100, "Extended op");
+    check(trace_get(&record) && record.pc == 0x1008 && record.length == 4 && record.regs.y == 0x1234 && record.cycles == 4, "Prefixed op");
+    check(trace_get(&record) && record.pc == 0x100C && record.regs.pc == 0x100C && record.length == 2, "Branch");
+    check(!trace_get(&record), "Ring empty");
+}
+
+
+static void test_interrupts(void) {
+
+    // An interrupt entry is recorded without op bytes
+    test_setup();
+    run(4);
+    drain();
+    reg.cc = 0x00;
+    state.interrupts = 1 << IRQ_BIT;
+    run(2);
+
+    TRACE_RECORD record;
+    check(trace_get(&record) && record.pc == 0x100C && record.regs.pc == 0x1040 && record.length == 0
+          && (record.flags & TRACE_NO_ADDRESS) && record.regs.s == 0x8000 - 12, "Interrupt entry");
+    check(trace_get(&record) && record.pc == 0x1040 && record.regs.pc == 0x100C && record.length == 1, "RTI");
+
+    // CWAI waits are not recorded
+    mem[0x100C] = 0x3C;
+    mem[0x100D] = 0xFF;
+    run(4);
+    check(trace_get(&record) && record.bytes[0] == 0x3C && !trace_get(&record), "CWAI wait");
+}
+
+
+static void test_off(void) {
+
+    test_setup();
+    trace_stop();
+    run(3);
+
+    TRACE_RECORD record;
+    check(!trace_get(&record), "Stopped");
+}
+
+
+static void test_encoding(void) {
+
+    test_setup();
+    run(1);
+
+    // Gap marker, then LDX # whole: PC, bytes, every register and no next PC
+    uint8_t data[64];
+    uint8_t first[] = {TRACE_HEADER_CYCLES, 0x00,
+                       0x03 | TRACE_HEADER_PC | TRACE_HEADER_BYTES | TRACE_HEADER_REGS, 0x10, 0x00, 0x03, 0x8E, 0x20, 0x00,
+                       0xFF, reg.cc, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00};
+    check(trace_read(data, 8) == 0, "Only whole records read");
+    check(trace_read(data, sizeof(data)) == sizeof(first) && memcmp(data, first, sizeof(first)) == 0, "Whole record");
+
+    // Then only what changed: LDA 3,X, with its address and CC
+    run(1);
+    uint8_t second[] = {0x05 | TRACE_HEADER_BYTES | TRACE_HEADER_ADDRESS | TRACE_HEADER_REGS, 0x02, 0xA6, 0x03, 0x20, 0x03, TRACE_REG_CC, reg.cc};
+    check(trace_read(data, sizeof(data)) == sizeof(second) && memcmp(data, second, sizeof(second)) == 0, "Delta record");
+
+    // A loop's ops come from the byte cache
+    run(2);
+    trace_read(data, sizeof(data));
+    run(2);
+    trace_read(data, sizeof(data));
+    run(1);
+    uint8_t branch[] = {0x03 | TRACE_HEADER_NEXT_PC, 0x10, 0x0C};
+    check(trace_read(data, sizeof(data)) == sizeof(branch) && memcmp(data, branch, sizeof(branch)) == 0, "Cached op bytes");
+}
+
+
+static void test_gaps(void) {
+
+    // A full ring drops records and marks the next one stored
+    test_setup();
+    uint32_t dropped = trace_dropped();
+    run(TRACE_RING_SIZE + 3);
+    check(trace_dropped() == dropped + 3, "Full ring drops records");
+
+    TRACE_RECORD record;
+    for (uint32_t i = 0 ; i < TRACE_RING_SIZE ; ++i) trace_get(&record);
+    run(1);
+    check(trace_get(&record) && (record.flags & TRACE_GAP), "Gap marked");
+
+    // The encoded stream restarts after a gap
+    run(TRACE_RING_SIZE + 1);
+    uint8_t data[64];
+    for (uint32_t i = 0 ; i < TRACE_RING_SIZE ; ++i) trace_get(&record);
+    run(1);
+    check(trace_read(data, sizeof(data)) > 2 && data[0] == TRACE_HEADER_CYCLES && data[1] == 0, "Gap marker sent");
+}
+
+
+static void run(uint32_t count) {
+
+    for (uint32_t i = 0 ; i < count ; ++i) process_next_instruction();
+}
+
+
+static void drain(void) {
+
+    TRACE_RECORD record;
+    while (trace_get(&record));
+}
+
+
+static void test_setup(void) {
+
+    tests++;
+    memset(mem, 0, KB64);
+    memcpy(&mem[0x1000], PROGRAM, sizeof(PROGRAM));
+    memcpy(&mem[0x1040], HANDLER, sizeof(HANDLER));
+    mem[IRQ_VECTOR] = 0x10;
+    mem[IRQ_VECTOR + 1] = 0x40;
+    memset(&reg, 0, sizeof(reg));
+    init_cpu();
+    reg.pc = 0x1000;
+    reg.s = 0x8000;
+
+    drain();
+    trace_start();
+}
+
+
+static void check(bool is_good, const char* name) {
+
+    if (is_good) {
+        passes++;
+    } else {
+        errors++;
+        printf("  %02d. %s failed\n", tests, name);
+    }
+}
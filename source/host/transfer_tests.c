@@ -0,0 +1,251 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Transfer queue tests, on the host stand-in port
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "transfer.h"
+#include "mock_transfer.h"
+
+
+/*
+ * STATICS
+ */
+static void test_no_port(void);
+static void test_order(void);
+static void test_buses(void);
+static void test_copy(void);
+static void test_full(void);
+static void test_read(void);
+static void test_failure(void);
+static void test_chained(void);
+static void test_setup(void);
+static void check(bool is_good, const char* name);
+static void job_done(TRANSFER_JOB* job, bool is_ok);
+static void chain_done(TRANSFER_JOB* job, bool is_ok);
+static bool queue_byte(uint8_t bus, uint8_t target, uint8_t byte);
+static void finish(uint8_t bus, uint8_t result);
+
+
+/*
+ * GLOBALS
+ */
+uint32_t errors = 0;
+uint32_t passes = 0;
+uint32_t tests = 0;
+
+// What the completion callbacks saw, in order
+uint8_t  done_targets[32];
+bool     done_ok[32];
+uint8_t  done_data[32][4];
+uint32_t done_count = 0;
+
+extern TRANSFER_STATS transfer_stats;
+
+
+int main(void) {
+
+    test_no_port();
+    test_order();
+    test_buses();
+    test_copy();
+    test_full();
+    test_read();
+    test_failure();
+    test_chained();
+
+    printf("Tests: %i\n", tests);
+    printf("Passes: %i\n", passes);
+    printf("Fails: %i\n", errors);
+    return errors == 0 ? 0 : 1;
+}
+
+
+static void test_no_port(void) {
+
+    // Without a port, drivers write directly
+    test_setup();
+    transfer_init(NULL);
+    check(!transfer_is_running(), "Not running without a port");
+    check(!queue_byte(TRANSFER_BUS_I2C, 0x70, 1), "Queue refused without a port");
+}
+
+
+static void test_order(void) {
+
+    // Jobs start one at a time, in the order queued
+    test_setup();
+    for (uint8_t i = 0 ; i < 3 ; ++i) queue_byte(TRANSFER_BUS_I2C, 0x70 + i, i);
+    check(mock_transfer.started == 1 && mock_transfer.log[0].target == 0x70, "First job started at once");
+
+    transfer_poll();
+    check(mock_transfer.started == 1 && done_count == 0, "Busy job holds the queue");
+
+    finish(TRANSFER_BUS_I2C, TRANSFER_OK);
+    finish(TRANSFER_BUS_I2C, TRANSFER_OK);
+    finish(TRANSFER_BUS_I2C, TRANSFER_OK);
+    bool is_good = mock_transfer.started == 3 && done_count == 3;
+    for (uint8_t i = 0 ; i < 3 && is_good ; ++i) {
+        is_good = mock_transfer.log[i].target == 0x70 + i && done_targets[i] == 0x70 + i && done_ok[i];
+    }
+
+    check(is_good, "Jobs run and complete in order");
+    check(transfer_is_idle() && transfer_stats.completed == 3, "Queue drained");
+}
+
+
+static void test_buses(void) {
+
+    // A busy I2C bus does not hold up SPI
+    test_setup();
+    queue_byte(TRANSFER_BUS_I2C, 0x70, 1);
+    queue_byte(TRANSFER_BUS_I2C, 0x71, 2);
+    queue_byte(TRANSFER_BUS_SPI, 17, 3);
+    check(mock_transfer.is_active[TRANSFER_BUS_I2C] && mock_transfer.is_active[TRANSFER_BUS_SPI], "Both buses busy");
+
+    finish(TRANSFER_BUS_SPI, TRANSFER_OK);
+    check(done_count == 1 && done_targets[0] == 17 && mock_transfer.is_active[TRANSFER_BUS_I2C], "SPI finishes first");
+    check(mock_transfer.started == 2 && mock_transfer.log_bus[1] == TRANSFER_BUS_SPI, "Second I2C job still waiting");
+}
+
+
+static void test_copy(void) {
+
+    // The caller's buffer is free once the job is queued
+    test_setup();
+    uint8_t frame[72];
+    memset(frame, 0xAA, sizeof(frame));
+    queue_byte(TRANSFER_BUS_SPI, 17, 0);
+    transfer_queue(TRANSFER_BUS_SPI, 17, frame, sizeof(frame), 0, job_done, NULL);
+    memset(frame, 0x55, sizeof(frame));
+
+    finish(TRANSFER_BUS_SPI, TRANSFER_OK);
+    TRANSFER_JOB* job = &mock_transfer.log[1];
+    check(mock_transfer.started == 2 && job->length == 72 && job->data[0] == 0xAA && job->data[71] == 0xAA, "Data copied when queued");
+
+    uint8_t big[TRANSFER_MAX_DATA + 1];
+    check(!transfer_queue(TRANSFER_BUS_SPI, 17, big, sizeof(big), 0, NULL, NULL), "Oversized job refused");
+}
+
+
+static void test_full(void) {
+
+    test_setup();
+    bool is_good = true;
+    for (uint8_t i = 0 ; i < TRANSFER_QUEUE_SIZE ; ++i) is_good &= queue_byte(TRANSFER_BUS_I2C, 0x70, i);
+    check(is_good, "Queue fills");
+    check(!queue_byte(TRANSFER_BUS_I2C, 0x70, 9) && transfer_stats.full == 1, "Full queue refuses a job");
+
+    // Queueing retires finished jobs first
+    mock_transfer_finish(TRANSFER_BUS_I2C, TRANSFER_OK, NULL, 0);
+    check(queue_byte(TRANSFER_BUS_I2C, 0x70, 9) && done_count == 1, "Room made by a finished job");
+}
+
+
+static void test_read(void) {
+
+    // The bytes read come back to the callback in the job's data
+    test_setup();
+    uint8_t reg = 0;
+    uint8_t keys[2] = {0xFE, 0x7F};
+    transfer_queue(TRANSFER_BUS_I2C, 0x20, &reg, 1, 2, job_done, NULL);
+    check(mock_transfer.log[0].read_length == 2, "Read length passed to port");
+
+    mock_transfer_finish(TRANSFER_BUS_I2C, TRANSFER_OK, keys, 2);
+    transfer_poll();
+    check(done_count == 1 && done_data[0][0] == 0xFE && done_data[0][1] == 0x7F, "Read data delivered");
+}
+
+
+static void test_failure(void) {
+
+    // A failed job is reported and the next one still runs
+    test_setup();
+    queue_byte(TRANSFER_BUS_I2C, 0x70, 1);
+    queue_byte(TRANSFER_BUS_I2C, 0x71, 2);
+    finish(TRANSFER_BUS_I2C, TRANSFER_FAILED);
+    check(done_count == 1 && !done_ok[0] && transfer_stats.failed == 1, "Failure reported");
+    check(mock_transfer.started == 2 && mock_transfer.log[1].target == 0x71, "Next job started after failure");
+}
+
+
+static void test_chained(void) {
+
+    // A callback that queues more keeps the order, even from a full queue
+    test_setup();
+    transfer_queue(TRANSFER_BUS_I2C, 0x70, (uint8_t*)"\x01", 1, 0, chain_done, NULL);
+    for (uint8_t i = 1 ; i < TRANSFER_QUEUE_SIZE ; ++i) queue_byte(TRANSFER_BUS_I2C, 0x71 + i, i);
+
+    finish(TRANSFER_BUS_I2C, TRANSFER_OK);
+    bool is_good = true;
+    for (uint8_t i = 1 ; i < TRANSFER_QUEUE_SIZE + 1 ; ++i) {
+        finish(TRANSFER_BUS_I2C, TRANSFER_OK);
+    }
+
+    // Started: 0x70, 0x72..., then the chained 0x7F last
+    for (uint8_t i = 1 ; i < TRANSFER_QUEUE_SIZE ; ++i) is_good &= mock_transfer.log[i].target == 0x71 + i;
+    is_good &= mock_transfer.log[TRANSFER_QUEUE_SIZE].target == 0x7F;
+    check(is_good && mock_transfer.started == TRANSFER_QUEUE_SIZE + 1, "Chained job queued behind the rest");
+    check(transfer_is_idle(), "Queue drained");
+}
+
+
+static void test_setup(void) {
+
+    tests++;
+    mock_transfer_reset();
+    transfer_init(&mock_transfer_port);
+    done_count = 0;
+}
+
+
+static void check(bool is_good, const char* name) {
+
+    if (is_good) {
+        passes++;
+    } else {
+        errors++;
+        printf("  %02d. %s failed\n", tests, name);
+    }
+}
+
+
+static void job_done(TRANSFER_JOB* job, bool is_ok) {
+
+    if (done_count < 32) {
+        done_targets[done_count] = job->target;
+        done_ok[done_count] = is_ok;
+        memcpy(done_data[done_count], job->data, 4);
+    }
+
+    done_count++;
+}
+
+
+static void chain_done(TRANSFER_JOB* job, bool is_ok) {
+
+    job_done(job, is_ok);
+    queue_byte(TRANSFER_BUS_I2C, 0x7F, 0xFF);
+}
+
+
+static bool queue_byte(uint8_t bus, uint8_t target, uint8_t byte) {
+
+    return transfer_queue(bus, target, &byte, 1, 0, job_done, NULL);
+}
+
+
+static void finish(uint8_t bus, uint8_t result) {
+
+    mock_transfer_finish(bus, result, NULL, 0);
+    transfer_poll();
+}
@@ -0,0 +1,398 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Windowed upload protocol tests
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "crc.h"
+#include "upload.h"
+
+
+/*
+ * STATICS
+ */
+static void test_in_order(void);
+static void test_out_of_order(void);
+static void test_corruption(void);
+static void test_missing(void);
+static void test_bad_start(void);
+static void test_compressed(void);
+static void test_delta(void);
+static void test_dump(void);
+static void test_setup(void);
+static void check(bool is_good, const char* name);
+static void send_reply(const uint8_t* data, uint32_t length);
+static uint32_t make_frame(uint8_t* out, uint8_t type, uint8_t flags, uint16_t seq, uint16_t address, const uint8_t* payload, uint16_t length);
+static void feed_frame(uint8_t type, uint16_t seq, uint16_t address, const uint8_t* payload, uint16_t length, uint32_t chunk);
+static void feed_lz4_frame(uint16_t seq, uint16_t address, const uint8_t* payload, uint16_t length, uint32_t chunk);
+static void start(uint16_t address, uint32_t length);
+static void send_data(uint16_t address, uint16_t seq, uint32_t chunk);
+static bool got_reply(uint8_t code, uint16_t seq);
+
+
+/*
+ * GLOBALS
+ */
+uint32_t errors = 0;
+uint32_t passes = 0;
+uint32_t tests = 0;
+
+uint8_t  mem[65536];
+uint8_t  image[65536];
+uint8_t  frame[UPLOAD_HEADER_SIZE + UPLOAD_FRAME_SIZE + UPLOAD_CRC_SIZE];
+uint8_t  replies[2 * UPLOAD_FRAME_SIZE + 64];
+uint32_t reply_count = 0;
+uint32_t image_length = 0;
+UPLOAD   upload;
+
+
+int main(void) {
+
+    srand(6809);
+    for (uint32_t i = 0 ; i < sizeof(image) ; ++i) image[i] = rand() & 0xFF;
+
+    test_in_order();
+    test_out_of_order();
+    test_corruption();
+    test_missing();
+    test_bad_start();
+    test_compressed();
+    test_delta();
+    test_dump();
+
+    printf("Tests: %i\n", tests);
+    printf("Passes: %i\n", passes);
+    printf("Fails: %i\n", errors);
+    return errors == 0 ? 0 : 1;
+}
+
+
+static void test_in_order(void) {
+
+    // Full 64KB image, whole frames
+    test_setup();
+    start(0x0000, 65536);
+    check(got_reply(UPLOAD_REPLY_ACK, 0), "START acknowledged");
+
+    for (uint16_t i = 0 ; i < 16 ; ++i) send_data(0x0000, i, 65536);
+    feed_frame(UPLOAD_FRAME_END, 0, 0, NULL, 0, 65536);
+    check(upload.is_done && memcmp(mem, image, 65536) == 0, "Full image");
+    check(got_reply(UPLOAD_REPLY_DONE, 0), "DONE reply");
+
+    uint8_t* done = &replies[reply_count - 8];
+    uint32_t crc = (done[4] << 24) | (done[5] << 16) | (done[6] << 8) | done[7];
+    check(crc == crc32(image, 65536), "DONE CRC32");
+
+    // Partial final frame, fed a byte at a time
+    test_setup();
+    start(0x1234, 5000);
+    send_data(0x1234, 0, 1);
+    send_data(0x1234, 1, 1);
+    feed_frame(UPLOAD_FRAME_END, 0, 0, NULL, 0, 1);
+    check(upload.is_done && memcmp(&mem[0x1234], image, 5000) == 0, "Streamed partial image");
+}
+
+
+static void test_out_of_order(void) {
+
+    test_setup();
+    start(0x2000, 3 * UPLOAD_FRAME_SIZE);
+    send_data(0x2000, 2, 65536);
+    send_data(0x2000, 0, 65536);
+    send_data(0x2000, 1, 65536);
+    feed_frame(UPLOAD_FRAME_END, 0, 0, NULL, 0, 65536);
+    check(upload.is_done && memcmp(&mem[0x2000], image, 3 * UPLOAD_FRAME_SIZE) == 0, "Out-of-order frames");
+}
+
+
+static void test_corruption(void) {
+
+    test_setup();
+    start(0x0000, 2 * UPLOAD_FRAME_SIZE);
+    send_data(0x0000, 0, 65536);
+
+    // Corrupt a payload byte in frame 1
+    uint32_t size = make_frame(frame, UPLOAD_FRAME_DATA, 0, 1, UPLOAD_FRAME_SIZE, &image[UPLOAD_FRAME_SIZE], UPLOAD_FRAME_SIZE);
+    frame[100] ^= 0x01;
+    reply_count = 0;
+    upload_feed(&upload, frame, size);
+    check(got_reply(UPLOAD_REPLY_NAK, 1) && upload.bad_frames == 1, "Bad CRC NAK'd");
+
+    // Only the bad frame is resent
+    send_data(0x0000, 1, 65536);
+    feed_frame(UPLOAD_FRAME_END, 0, 0, NULL, 0, 65536);
+    check(upload.is_done && memcmp(mem, image, 2 * UPLOAD_FRAME_SIZE) == 0, "Selective retransmit");
+
+    // Garbage between frames is skipped
+    test_setup();
+    uint8_t noise[5] = {0x00, 0x55, 0x12, 0xFF, 0x55};
+    upload_feed(&upload, noise, sizeof(noise));
+    start(0x0000, 100);
+    check(got_reply(UPLOAD_REPLY_ACK, 0), "Resync after noise");
+}
+
+
+static void test_missing(void) {
+
+    test_setup();
+    start(0x0000, 3 * UPLOAD_FRAME_SIZE);
+    send_data(0x0000, 1, 65536);
+    reply_count = 0;
+    feed_frame(UPLOAD_FRAME_END, 0, 0, NULL, 0, 65536);
+    check(!upload.is_done && got_reply(UPLOAD_REPLY_NAK, 0) && got_reply(UPLOAD_REPLY_NAK, 2), "Missing frames NAK'd");
+}
+
+
+static void test_bad_start(void) {
+
+    test_setup();
+    start(0xF000, 0x2000);
+    check(got_reply(UPLOAD_REPLY_ERROR, 0) && !upload.is_active, "Oversized image rejected");
+
+    // A frame whose address doesn't match its sequence number is refused
+    test_setup();
+    start(0x0000, 2 * UPLOAD_FRAME_SIZE);
+    reply_count = 0;
+    feed_frame(UPLOAD_FRAME_DATA, 1, 0x0000, image, UPLOAD_FRAME_SIZE, 65536);
+    check(got_reply(UPLOAD_REPLY_ERROR, 1) && mem[0] == 0, "Mismatched address refused");
+}
+
+
+static void test_compressed(void) {
+
+    // 4096 zeros: one literal, then a 4095-byte run at offset 1
+    uint8_t zeros[] = {0x1F, 0x00, 0x01, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                       0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFB, 0x00};
+
+    // 'ABCD' x 3 then 'XYZ': four literals, an 8-byte match, three literals
+    uint8_t mixed[] = {0x44, 'A', 'B', 'C', 'D', 0x04, 0x00, 0x30, 'X', 'Y', 'Z'};
+
+    test_setup();
+    memset(mem, 0xAA, sizeof(mem));
+    start(0x0000, UPLOAD_FRAME_SIZE + 15);
+    feed_lz4_frame(0, 0x0000, zeros, sizeof(zeros), 1);
+    feed_lz4_frame(1, UPLOAD_FRAME_SIZE, mixed, sizeof(mixed), 65536);
+    check(got_reply(UPLOAD_REPLY_ACK, 0) && got_reply(UPLOAD_REPLY_ACK, 1), "Compressed frames ACK'd");
+
+    bool is_zero = true;
+    for (uint32_t i = 0 ; i < UPLOAD_FRAME_SIZE ; ++i) is_zero &= (mem[i] == 0);
+    check(is_zero && memcmp(&mem[UPLOAD_FRAME_SIZE], "ABCDABCDABCDXYZ", 15) == 0, "Decompressed into memory");
+    check(mem[UPLOAD_FRAME_SIZE + 15] == 0xAA, "No overrun");
+
+    feed_frame(UPLOAD_FRAME_END, 0, 0, NULL, 0, 65536);
+    check(upload.is_done && upload.bytes_received == UPLOAD_FRAME_SIZE + 15, "Compressed upload complete");
+
+    // An offset reaching back before the frame is refused
+    test_setup();
+    start(0x0000, 15);
+    mixed[5] = 0x10;
+    reply_count = 0;
+    feed_lz4_frame(0, 0x0000, mixed, sizeof(mixed), 65536);
+    check(got_reply(UPLOAD_REPLY_NAK, 0), "Bad offset NAK'd");
+
+    // As is a block that decompresses short
+    test_setup();
+    start(0x0000, 16);
+    mixed[5] = 0x04;
+    reply_count = 0;
+    feed_lz4_frame(0, 0x0000, mixed, sizeof(mixed), 65536);
+    check(got_reply(UPLOAD_REPLY_NAK, 0), "Short block NAK'd");
+}
+
+
+static void test_delta(void) {
+
+    // Hash the whole of memory: 256 pages
+    test_setup();
+    memcpy(mem, image, sizeof(mem));
+    uint8_t payload[4] = {0x00, 0x01, 0x00, 0x00};
+    feed_frame(UPLOAD_FRAME_HASH, 0, 0x0000, payload, 4, 65536);
+    check(reply_count == 4 + 256 * 4 && got_reply(UPLOAD_REPLY_HASHES, 256), "Page hashes sent");
+
+    bool is_match = true;
+    for (uint32_t i = 0 ; i < 256 ; ++i) {
+        uint8_t* h = &replies[4 + i * 4];
+        uint32_t hash = (h[0] << 24) | (h[1] << 16) | (h[2] << 8) | h[3];
+        is_match &= hash == page_hash(&image[i * UPLOAD_PAGE_SIZE], UPLOAD_PAGE_SIZE);
+    }
+
+    check(is_match && !upload.is_active, "Page hashes match");
+
+    // Unaligned range: partial pages are hashed over the covered bytes
+    reply_count = 0;
+    payload[1] = 0x00;
+    payload[2] = 0x01;
+    payload[3] = 0x02;
+    feed_frame(UPLOAD_FRAME_HASH, 0, 0x10F0, payload, 4, 65536);
+    uint32_t last = (replies[8] << 24) | (replies[9] << 16) | (replies[10] << 8) | replies[11];
+    check(got_reply(UPLOAD_REPLY_HASHES, 2) && last == page_hash(&image[0x1100], 0xF2), "Partial page hashes");
+
+    // Patch two runs into a delta transfer and check the image
+    test_setup();
+    memcpy(mem, image, sizeof(mem));
+    mem[0x2001] ^= 0xFF;
+    mem[0x5FFF] ^= 0xFF;
+    uint8_t start_payload[4] = {0x00, 0x00, 0x80, 0x00};
+    make_frame(frame, UPLOAD_FRAME_START, UPLOAD_FLAG_DELTA, 0, 0x0000, start_payload, 4);
+    upload_feed(&upload, frame, UPLOAD_HEADER_SIZE + 4 + UPLOAD_CRC_SIZE);
+    feed_frame(UPLOAD_FRAME_PATCH, 1, 0x2000, &image[0x2000], UPLOAD_PAGE_SIZE, 65536);
+    feed_frame(UPLOAD_FRAME_PATCH, 2, 0x5F00, &image[0x5F00], UPLOAD_PAGE_SIZE, 7);
+    check(got_reply(UPLOAD_REPLY_ACK, 1) && got_reply(UPLOAD_REPLY_ACK, 2), "Patches ACK'd");
+
+    feed_frame(UPLOAD_FRAME_END, 3, 0, NULL, 0, 65536);
+    check(upload.is_done && memcmp(mem, image, 0x8000) == 0, "Delta image");
+    check(upload.bytes_received == 2 * UPLOAD_PAGE_SIZE, "Only patches counted");
+
+    // Patches outside the image, or outside a delta transfer, are refused
+    test_setup();
+    make_frame(frame, UPLOAD_FRAME_START, UPLOAD_FLAG_DELTA, 0, 0x1000, start_payload, 4);
+    upload_feed(&upload, frame, UPLOAD_HEADER_SIZE + 4 + UPLOAD_CRC_SIZE);
+    feed_frame(UPLOAD_FRAME_PATCH, 1, 0x8F80, image, UPLOAD_PAGE_SIZE, 65536);
+    check(got_reply(UPLOAD_REPLY_ERROR, 1) && mem[0x8F80] == 0, "Out-of-range patch refused");
+
+    test_setup();
+    start(0x0000, 0x1000);
+    feed_frame(UPLOAD_FRAME_PATCH, 1, 0x0000, image, UPLOAD_PAGE_SIZE, 65536);
+    check(got_reply(UPLOAD_REPLY_ERROR, 1) && mem[0] == 0, "Patch needs a delta transfer");
+}
+
+
+static void test_dump(void) {
+
+    // 5000 bytes: a full frame, a partial frame, then DONE
+    test_setup();
+    memcpy(mem, image, sizeof(mem));
+    uint8_t payload[4] = {0x00, 0x00, 0x13, 0x88};
+    feed_frame(UPLOAD_FRAME_DUMP, 0, 0x1001, payload, 4, 65536);
+    uint32_t first = UPLOAD_HEADER_SIZE + UPLOAD_FRAME_SIZE + UPLOAD_CRC_SIZE;
+    uint32_t second = UPLOAD_HEADER_SIZE + 904 + UPLOAD_CRC_SIZE;
+    check(reply_count == first + second + 8 && upload.bytes_sent == 5000, "Dump size");
+
+    // Each frame is laid out as the host's are, so check it the same way
+    uint8_t expected[UPLOAD_HEADER_SIZE + UPLOAD_FRAME_SIZE + UPLOAD_CRC_SIZE];
+    make_frame(expected, UPLOAD_FRAME_DATA, 0, 0, 0x1001, &image[0x1001], UPLOAD_FRAME_SIZE);
+    bool is_good = memcmp(replies, expected, first) == 0;
+    make_frame(expected, UPLOAD_FRAME_DATA, 0, 1, 0x2001, &image[0x2001], 904);
+    is_good &= memcmp(&replies[first], expected, second) == 0;
+    check(is_good, "Dump frames");
+
+    uint8_t* done = &replies[first + second];
+    uint32_t crc = (done[4] << 24) | (done[5] << 16) | (done[6] << 8) | done[7];
+    check(done[1] == UPLOAD_REPLY_DONE && done[3] == 2 && crc == crc32(&image[0x1001], 5000), "Dump DONE reply");
+    check(memcmp(mem, image, sizeof(mem)) == 0 && !upload.is_active, "Memory untouched");
+
+    // A range past the top of memory is refused
+    test_setup();
+    payload[2] = 0x01;
+    payload[3] = 0x01;
+    feed_frame(UPLOAD_FRAME_DUMP, 0, 0xFF00, payload, 4, 65536);
+    check(got_reply(UPLOAD_REPLY_ERROR, 0) && upload.bytes_sent == 0, "Bad dump range refused");
+}
+
+
+static void test_setup(void) {
+
+    tests++;
+    memset(mem, 0, sizeof(mem));
+    reply_count = 0;
+    upload_init(&upload, mem, send_reply);
+}
+
+
+static void check(bool is_good, const char* name) {
+
+    if (is_good) {
+        passes++;
+    } else {
+        errors++;
+        printf("  %02d. %s failed\n", tests, name);
+    }
+}
+
+
+static void send_reply(const uint8_t* data, uint32_t length) {
+
+    if (reply_count + length > sizeof(replies)) return;
+    memcpy(&replies[reply_count], data, length);
+    reply_count += length;
+}
+
+
+static uint32_t make_frame(uint8_t* out, uint8_t type, uint8_t flags, uint16_t seq, uint16_t address, const uint8_t* payload, uint16_t length) {
+
+    uint8_t header[UPLOAD_HEADER_SIZE] = {
+        UPLOAD_SYNC_HEAD, UPLOAD_SYNC_WINDOWED, type, flags,
+        seq >> 8, seq & 0xFF, address >> 8, address & 0xFF, length >> 8, length & 0xFF
+    };
+
+    memcpy(out, header, UPLOAD_HEADER_SIZE);
+    if (length > 0) memcpy(&out[UPLOAD_HEADER_SIZE], payload, length);
+
+    uint32_t crc = crc32(&out[2], UPLOAD_HEADER_SIZE - 2 + length);
+    uint8_t* tail = &out[UPLOAD_HEADER_SIZE + length];
+    tail[0] = crc >> 24;
+    tail[1] = (crc >> 16) & 0xFF;
+    tail[2] = (crc >> 8) & 0xFF;
+    tail[3] = crc & 0xFF;
+    return UPLOAD_HEADER_SIZE + length + UPLOAD_CRC_SIZE;
+}
+
+
+static void feed_frame(uint8_t type, uint16_t seq, uint16_t address, const uint8_t* payload, uint16_t length, uint32_t chunk) {
+
+    uint32_t size = make_frame(frame, type, 0, seq, address, payload, length);
+    for (uint32_t i = 0 ; i < size ; i += chunk) {
+        upload_feed(&upload, &frame[i], size - i < chunk ? size - i : chunk);
+    }
+}
+
+
+static void feed_lz4_frame(uint16_t seq, uint16_t address, const uint8_t* payload, uint16_t length, uint32_t chunk) {
+
+    uint32_t size = make_frame(frame, UPLOAD_FRAME_DATA, UPLOAD_FLAG_LZ4, seq, address, payload, length);
+    for (uint32_t i = 0 ; i < size ; i += chunk) {
+        upload_feed(&upload, &frame[i], size - i < chunk ? size - i : chunk);
+    }
+}
+
+
+static void start(uint16_t address, uint32_t length) {
+
+    uint8_t payload[4] = {length >> 24, (length >> 16) & 0xFF, (length >> 8) & 0xFF, length & 0xFF};
+    image_length = length;
+    feed_frame(UPLOAD_FRAME_START, 0, address, payload, 4, 65536);
+}
+
+
+static void send_data(uint16_t address, uint16_t seq, uint32_t chunk) {
+
+    uint32_t offset = seq * UPLOAD_FRAME_SIZE;
+    uint32_t length = image_length - offset;
+    if (length > UPLOAD_FRAME_SIZE) length = UPLOAD_FRAME_SIZE;
+    feed_frame(UPLOAD_FRAME_DATA, seq, address + offset, &image[offset], length, chunk);
+}
+
+
+static bool got_reply(uint8_t code, uint16_t seq) {
+
+    for (uint32_t i = 0 ; i + 3 < reply_count ; ) {
+        if (replies[i + 1] == code && ((replies[i + 2] << 8) | replies[i + 3]) == seq) return true;
+        if (replies[i + 1] == UPLOAD_REPLY_HASHES) {
+            i += 4 + 4 * ((replies[i + 2] << 8) | replies[i + 3]);
+        } else {
+            i += replies[i + 1] == UPLOAD_REPLY_DONE ? 8 : 4;
+        }
+    }
+
+    return false;
+}
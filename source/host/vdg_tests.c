@@ -0,0 +1,140 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * MC6847 incremental rendering tests
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "main.h"
+#include "cpu.h"
+#include "vdg.h"
+
+
+/*
+ * STATICS
+ */
+static void test_unchanged(void);
+static void test_text_write(void);
+static void test_full_redraw(void);
+static uint32_t render(void);
+static void test_setup(void);
+static void check(bool is_good, const char* name);
+
+
+/*
+ * GLOBALS
+ */
+uint32_t errors = 0;
+uint32_t passes = 0;
+uint32_t tests = 0;
+
+#define TEXT_BASE       0x0400
+
+MC6847  vdg;
+uint8_t dirty[DIRTY_MAP_SIZE];
+uint8_t mode = 0;
+uint16_t base = TEXT_BASE;
+
+extern REG_6809         reg;
+extern uint8_t          mem[KB64];
+extern MEMORY_MAP_6809  memory_map;
+
+// 0x1000: LDA #$41 ; STA $04A7 (row 5, column 7) ; STA $3000
+const uint8_t PROGRAM[] = {0x86, 0x41, 0xB7, 0x04, 0xA7, 0xB7, 0x30, 0x00};
+
+
+int main(void) {
+
+    test_unchanged();
+    test_text_write();
+    test_full_redraw();
+
+    printf("Tests: %i\n", tests);
+    printf("Passes: %i\n", passes);
+    printf("Fails: %i\n", errors);
+    return errors == 0 ? 0 : 1;
+}
+
+
+static void test_unchanged(void) {
+
+    // The first render draws everything, an unchanged frame nothing
+    test_setup();
+    check(render() == VDG_HEIGHT, "First frame drawn");
+    check(render() == 0 && render() == 0, "Unchanged frame");
+}
+
+
+static void test_text_write(void) {
+
+    // A CPU write to text RAM redraws only its character row
+    test_setup();
+    render();
+    process_next_instruction();
+    process_next_instruction();
+    check(render() == VDG_CELL_HEIGHT, "One row redrawn");
+    check(memcmp(vdg.pixels[5 * VDG_CELL_HEIGHT], vdg.pixels[4 * VDG_CELL_HEIGHT], VDG_WIDTH * VDG_CELL_HEIGHT) != 0, "Character drawn");
+    check(render() == 0, "Row redrawn once");
+
+    // Writes outside video RAM redraw nothing
+    process_next_instruction();
+    check(render() == 0, "Other RAM ignored");
+}
+
+
+static void test_full_redraw(void) {
+
+    test_setup();
+    render();
+    mode = VDG_MODE_CSS;
+    check(render() == VDG_HEIGHT, "Mode change");
+
+    base = TEXT_BASE + 0x200;
+    check(render() == VDG_HEIGHT, "Base change");
+
+    vdg.is_valid = false;
+    check(render() == VDG_HEIGHT, "Invalidated");
+}
+
+
+static uint32_t render(void) {
+
+    return vdg_render(&vdg, mem, base, mode, dirty);
+}
+
+
+static void test_setup(void) {
+
+    tests++;
+    memset(mem, 0, KB64);
+    memset(&mem[TEXT_BASE], 0x60, VDG_TEXT_COLS * VDG_TEXT_ROWS);
+    memcpy(&mem[0x1000], PROGRAM, sizeof(PROGRAM));
+    memset(dirty, 0, sizeof(dirty));
+    init_cpu();
+    reg.pc = 0x1000;
+    reg.s = 0x8000;
+    memory_map.write_dirty = dirty;
+
+    vdg_init(&vdg);
+    mode = 0;
+    base = TEXT_BASE;
+}
+
+
+static void check(bool is_good, const char* name) {
+
+    if (is_good) {
+        passes++;
+    } else {
+        errors++;
+        printf("  %02d. %s failed\n", tests, name);
+    }
+}
@@ -9,16 +9,21 @@
  *
  */
 
-// Pico
-#include "hardware/i2c.h"
+// C
+#include <stddef.h>
 // App
+#include "hal.h"
 #include "ht16k33.h"
+#include "transfer.h"
 
 
 /*
  * STATICS
  */
 static void ht16k33_power(uint8_t address, uint8_t on);
+static HT16K33_SHADOW* ht16k33_get_shadow(uint8_t address);
+static bool i2c_send(uint8_t address, uint8_t *data, uint8_t count);
+static void i2c_send_done(TRANSFER_JOB* job, bool is_ok);
 
 
 /*
@@ -29,6 +34,10 @@ const uint8_t CHARSET[18] = {0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7
 const uint8_t POS[4] = {0, 2, 6, 8};
 // 0x5F, 0x7C, 0x58, 0x5E, 0x7B, 0x71
 
+HT16K33_SHADOW  shadows[HT16K33_MAX_DISPLAYS];
+uint8_t         shadow_count = 0;
+HT16K33_STATS   ht16k33_stats = {0, 0, 0};
+
 
 /*
  * I2C FUNCTIONS
@@ -36,18 +45,58 @@ const uint8_t POS[4] = {0, 2, 6, 8};
 
 /**
  * @brief Convenience function to write a single byte to the matrix.
+ *
+ * @retval `true` if the byte was sent or queued, `false` if the
+ *         transfer queue was full.
  */
-void i2c_write_byte(uint8_t address, uint8_t byte) {
+bool i2c_write_byte(uint8_t address, uint8_t byte) {
 
-    i2c_write_blocking(I2C_PORT, address, &byte, 1, false);
+    if (!i2c_send(address, &byte, 1)) return false;
+    ht16k33_stats.transactions++;
+    ht16k33_stats.bytes++;
+    return true;
 }
 
 /**
  * @brief Convenience function to write a 'count' bytes to the matrix
+ *
+ * @retval `true` if the bytes were sent or queued, `false` if the
+ *         transfer queue was full.
  */
-void i2c_write_block(uint8_t address, uint8_t *data, uint8_t count) {
+bool i2c_write_block(uint8_t address, uint8_t *data, uint8_t count) {
 
-    i2c_write_blocking(I2C_PORT, address, data, count, false);
+    if (!i2c_send(address, data, count)) return false;
+    ht16k33_stats.transactions++;
+    ht16k33_stats.bytes += count;
+    return true;
+}
+
+/**
+ * @brief Queue a write if the transfer queue is running, so the caller
+ *        need not wait for the bus, otherwise write directly. A full
+ *        queue is not waited on: the write is refused.
+ *        NOTE Commands go out at init, before the queue runs, so only
+ *             draws can be refused, and they are retried.
+ *
+ * @retval `true` if the write was made or queued, otherwise `false`.
+ */
+static bool i2c_send(uint8_t address, uint8_t *data, uint8_t count) {
+
+    if (transfer_is_running()) {
+        return transfer_queue(TRANSFER_BUS_I2C, address, data, count, 0, i2c_send_done, NULL);
+    }
+
+    hal_i2c_write(address, data, count, false);
+    return true;
+}
+
+/**
+ * @brief Transfer queue callback for a write: if it failed, the shadow
+ *        no longer matches the chip, so the next draw sends everything.
+ */
+static void i2c_send_done(TRANSFER_JOB* job, bool is_ok) {
+
+    if (!is_ok) ht16k33_invalidate(job->target);
 }
 
 
@@ -63,6 +112,8 @@ void i2c_write_block(uint8_t address, uint8_t *data, uint8_t count) {
  */
 void ht16k33_init(uint8_t address, uint8_t *buffer) {
 
+    // The chip's RAM is unknown at power-up, so the first draw sends it all
+    ht16k33_invalidate(address);
     ht16k33_power(address, 1);
     ht16k33_brightness(address, 6);
     ht16k33_clear(address, buffer);
@@ -108,26 +159,111 @@ void ht16k33_clear(uint8_t address, uint8_t *buffer) {
 }
 
 /**
- * @brief Writes the buffer to the device.
+ * @brief Writes the buffer to the device. Only the bytes that differ
+ *        from what the device last received are sent, as one run from
+ *        the first changed byte to the last; if none differ, nothing
+ *        is sent. If the transfer queue is full, the draw is left
+ *        pending for the next `ht16k33_flush()`.
  *
  * @param address: The display's I2C address.
  * @param buffer:  Pointer to the display code's data buffer.
  */
 void ht16k33_draw(uint8_t address, uint8_t *buffer) {
 
-    // Set up the buffer holding the data to be
-    // transmitted to the LED
-    uint8_t tx_buffer[17];
-    for (uint8_t i = 0 ; i < 17 ; ++i) tx_buffer[i] = 0;
+    HT16K33_SHADOW* shadow = ht16k33_get_shadow(address);
+    uint8_t first = 0;
+    uint8_t last = HT16K33_RAM_SIZE - 1;
+
+    if (shadow != NULL) {
+        shadow->pending = buffer;
+        if (shadow->is_valid) {
+            while (first < HT16K33_RAM_SIZE && buffer[first] == shadow->sent[first]) first++;
+            if (first == HT16K33_RAM_SIZE) {
+                shadow->pending = NULL;
+                ht16k33_stats.skipped++;
+                return;
+            }
+
+            while (buffer[last] == shadow->sent[last]) last--;
+        }
+    }
+
+    // The display RAM address auto-increments, so a run of bytes
+    // follows its start address
+    uint8_t tx_buffer[HT16K33_RAM_SIZE + 1];
+    uint8_t count = last - first + 1;
+    tx_buffer[0] = HT16K33_GENERIC_DISPLAY_ADDRESS + first;
+    for (uint8_t i = 0 ; i < count ; ++i) tx_buffer[i + 1] = buffer[first + i];
+
+    // Write out the transmit buffer, or leave it to the next flush
+    if (!i2c_write_block(address, tx_buffer, count + 1)) return;
+
+    if (shadow != NULL) {
+        shadow->pending = NULL;
+        for (uint8_t i = 0 ; i < HT16K33_RAM_SIZE ; ++i) shadow->sent[i] = buffer[i];
+        shadow->is_valid = true;
+    }
+}
+
+/**
+ * @brief Mark a display to be drawn at the next `ht16k33_flush()`, so
+ *        several changes to one or more displays cost one write each.
+ *
+ * @param address: The display's I2C address.
+ * @param buffer:  Pointer to the display code's data buffer.
+ */
+void ht16k33_queue(uint8_t address, uint8_t *buffer) {
+
+    HT16K33_SHADOW* shadow = ht16k33_get_shadow(address);
+    if (shadow != NULL) {
+        shadow->pending = buffer;
+    } else {
+        ht16k33_draw(address, buffer);
+    }
+}
+
+/**
+ * @brief Draw every display queued since the last flush, or left
+ *        waiting for room in the transfer queue.
+ */
+void ht16k33_flush(void) {
+
+    for (uint8_t i = 0 ; i < shadow_count ; ++i) {
+        if (shadows[i].pending != NULL) ht16k33_draw(shadows[i].address, shadows[i].pending);
+    }
+}
+
+/**
+ * @brief Forget what a display last received, so the next draw sends
+ *        the whole buffer -- eg. after a reset or bus error.
+ *
+ * @param address: The display's I2C address.
+ */
+void ht16k33_invalidate(uint8_t address) {
+
+    HT16K33_SHADOW* shadow = ht16k33_get_shadow(address);
+    if (shadow != NULL) shadow->is_valid = false;
+}
+
+/**
+ * @brief Find, or add, a display's shadow record.
+ *
+ * @param address: The display's I2C address.
+ *
+ * @retval Pointer to the record, or NULL if the table is full.
+ */
+static HT16K33_SHADOW* ht16k33_get_shadow(uint8_t address) {
 
-    // Span the 8 bytes of the graphics buffer
-    // across the 16 bytes of the LED's buffer
-    for (uint8_t i = 0 ; i < 16 ; ++i) {
-        tx_buffer[i + 1] = buffer[i];
+    for (uint8_t i = 0 ; i < shadow_count ; ++i) {
+        if (shadows[i].address == address) return &shadows[i];
     }
 
-    // Write out the transmit buffer
-    i2c_write_block(address, tx_buffer, sizeof(tx_buffer));
+    if (shadow_count == HT16K33_MAX_DISPLAYS) return NULL;
+    HT16K33_SHADOW* shadow = &shadows[shadow_count++];
+    shadow->address = address;
+    shadow->pending = NULL;
+    shadow->is_valid = false;
+    return shadow;
 }
 
 /**
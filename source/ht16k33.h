@@ -39,19 +39,43 @@
 #define HT16K33_SEGMENT_SPACE_CHAR              0x00
 #define HT16K33_SEGMENT_COLON_ROW               0x04
 
+#define HT16K33_RAM_SIZE                        16
+#define HT16K33_MAX_DISPLAYS                    8
+
+
+/*
+ *      STRUCTURES
+ */
+// What a display's RAM last received, so draws can send only changes
+typedef struct {
+    uint8_t     address;
+    uint8_t     sent[HT16K33_RAM_SIZE];
+    uint8_t*    pending;        // Buffer to send at the next flush, or NULL
+    bool        is_valid;       // `sent` matches the chip
+} HT16K33_SHADOW;
+
+typedef struct {
+    uint32_t    transactions;   // I2C writes made
+    uint32_t    bytes;          // Bytes written, including register addresses
+    uint32_t    skipped;        // Draws that needed no write
+} HT16K33_STATS;
+
 
 /*
  *      PROTOTYPES
  */
 // I2C Functions
-void        i2c_write_byte(uint8_t address, uint8_t byte);
-void        i2c_write_block(uint8_t address, uint8_t *data, uint8_t count);
+bool        i2c_write_byte(uint8_t address, uint8_t byte);
+bool        i2c_write_block(uint8_t address, uint8_t *data, uint8_t count);
 
 // Display Functions
 void        ht16k33_init(uint8_t address, uint8_t *buffer);
 void        ht16k33_brightness(uint8_t address, uint8_t brightness);
 void        ht16k33_clear(uint8_t address, uint8_t *buffer);
 void        ht16k33_draw(uint8_t address, uint8_t *buffer);
+void        ht16k33_queue(uint8_t address, uint8_t *buffer);
+void        ht16k33_flush(void);
+void        ht16k33_invalidate(uint8_t address);
 void        ht16k33_set_number(uint8_t address, uint8_t *buffer, uint16_t number, uint8_t digit, bool has_dot);
 void        ht16k33_set_alpha(uint8_t address, uint8_t *buffer, char chr, uint8_t digit, bool has_dot);
 void        ht16k33_set_glyph(uint8_t address, uint8_t *buffer, uint8_t glyph, uint8_t digit, bool has_dot);
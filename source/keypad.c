@@ -10,14 +10,12 @@
  */
 
 #include <stdbool.h>
-// Pico
-#include "pico/stdlib.h"
-#include "hardware/gpio.h"
-#include "hardware/i2c.h"
-#include "hardware/spi.h"
+#include <stddef.h>
 // App
+#include "hal.h"
 #include "ht16k33.h"
 #include "keypad.h"
+#include "transfer.h"
 
 
 /*
@@ -26,6 +24,9 @@
 static bool check_board_presence(void);
 static void keypad_set_led_at(uint8_t x, uint8_t y, uint8_t r, uint8_t g, uint8_t b);
 static void keypad_set_led_data(uint16_t o, uint8_t r, uint8_t g, uint8_t b);
+static void keypad_int_callback(uint8_t pin);
+static void keypad_read_done(TRANSFER_JOB* job, bool is_ok);
+static void keypad_take_reading(uint16_t keys, uint32_t changed_at);
 
 
 /*
@@ -34,6 +35,19 @@ static void keypad_set_led_data(uint16_t o, uint8_t r, uint8_t g, uint8_t b);
 uint8_t led_buffer[72]; // Dimension = H x W x 4 + 8
 uint8_t *led_data = led_buffer + 4;
 
+// Set by the INT edge callback; true at the start to get a first reading
+volatile bool     keys_changed = true;
+volatile uint32_t keys_changed_at = 0;
+// The last reading, and the last one that stayed steady for KEYPAD_DEBOUNCE_US
+uint16_t          raw_keys = 0;
+uint32_t          raw_keys_at = 0;
+uint16_t          stable_keys = 0;
+// A queued read's INT timestamp, while it is in flight
+bool              is_reading = false;
+uint32_t          reading_at = 0;
+// The LED frame could not be queued, so the next flush sends it
+bool              is_leds_pending = false;
+
 
 /**
  * @brief Initialise the keypad, setting the default brightness and
@@ -52,25 +66,24 @@ bool keypad_init(void) {
     keypad_set_brightness(DEFAULT_BRIGHTNESS);
 
     // Set up I2C to read buttons
-    i2c_init(i2c0, 400000);
-    gpio_set_function(KEYPAD_PIN_KEYS_SDA, GPIO_FUNC_I2C);
-    gpio_set_function(KEYPAD_PIN_KEYS_SCL, GPIO_FUNC_I2C);
-    gpio_pull_up(KEYPAD_PIN_KEYS_SDA);
-    gpio_pull_up(KEYPAD_PIN_KEYS_SCL);
+    hal_i2c_init(KEYPAD_PIN_KEYS_SDA, KEYPAD_PIN_KEYS_SCL, 400000);
 
     // Check a board is connected
     if (!check_board_presence()) {
-        i2c_deinit(i2c0);
+        hal_i2c_deinit();
         return false;
     }
 
+    // The TCA9555 pulls INT low when any input changes, until its
+    // inputs are read, so the keys need only be read after an edge
+    hal_gpio_init(KEYPAD_PIN_KEYS_INT, false);
+    hal_gpio_pull(KEYPAD_PIN_KEYS_INT, true);
+    hal_gpio_irq_falling(KEYPAD_PIN_KEYS_INT, keypad_int_callback);
+
     // Set up SPI to set LEDs
-    spi_init(spi0, 4194304);
-    gpio_set_function(KEYPAD_PIN_LEDS_CS, GPIO_FUNC_SIO);
-    gpio_set_dir(KEYPAD_PIN_LEDS_CS, GPIO_OUT);
-    gpio_put(KEYPAD_PIN_LEDS_CS, 1);
-    gpio_set_function(KEYPAD_PIN_LEDS_SCK, GPIO_FUNC_SPI);
-    gpio_set_function(KEYPAD_PIN_LEDS_TX, GPIO_FUNC_SPI);
+    hal_spi_init(KEYPAD_PIN_LEDS_SCK, KEYPAD_PIN_LEDS_TX, 4194304);
+    hal_gpio_init(KEYPAD_PIN_LEDS_CS, true);
+    hal_gpio_put(KEYPAD_PIN_LEDS_CS, true);
 
     // Set the LEDs
     keypad_set_all(0x20, 0x20, 0x20);
@@ -80,13 +93,31 @@ bool keypad_init(void) {
 
 
 /**
- * @brief Write the pixel colour data out to SPI.
+ * @brief Write the pixel colour data out to SPI. If the transfer queue
+ *        is running, the data is queued and this returns at once; if
+ *        the queue is full, the frame waits for `keypad_flush()`.
  */
 void keypad_update_leds(void) {
 
-    gpio_put(KEYPAD_PIN_LEDS_CS, 0);
-    spi_write_blocking(spi0, led_buffer, sizeof(led_buffer));
-    gpio_put(KEYPAD_PIN_LEDS_CS, 1);
+    if (transfer_is_running()) {
+        is_leds_pending = !transfer_queue(TRANSFER_BUS_SPI, KEYPAD_PIN_LEDS_CS, led_buffer, sizeof(led_buffer), 0, NULL, NULL);
+        return;
+    }
+
+    hal_gpio_put(KEYPAD_PIN_LEDS_CS, false);
+    hal_spi_write(led_buffer, sizeof(led_buffer));
+    hal_gpio_put(KEYPAD_PIN_LEDS_CS, true);
+}
+
+
+/**
+ * @brief Send the LED frame if an update found the transfer queue full.
+ *        The buffer always holds the latest colours, so only the last
+ *        of several refused updates goes out.
+ */
+void keypad_flush(void) {
+
+    if (is_leds_pending) keypad_update_leds();
 }
 
 
@@ -157,14 +188,90 @@ uint16_t keypad_get_button_states(void) {
 
     uint8_t input_buffer[2];
     uint8_t tca9555_reg = 0;
-    i2c_write_blocking(i2c0, KEYPAD_I2C_ADDRESS, &tca9555_reg, 1, true);
-    i2c_read_blocking(i2c0, KEYPAD_I2C_ADDRESS, input_buffer, 2, false);
+    hal_i2c_write(KEYPAD_I2C_ADDRESS, &tca9555_reg, 1, true);
+    hal_i2c_read(KEYPAD_I2C_ADDRESS, input_buffer, 2, false);
 
     // Read value is 0 = pressed, 1 = not pressed, so invert the return value
     return ~((input_buffer[0]) | (input_buffer[1] << 8));
 }
 
 
+/**
+ * @brief Get the key states, debounced. The TCA9555 is read only if its
+ *        INT line has fallen since the last read, so this is cheap to
+ *        call on every pass of a loop.
+ *
+ * @param now:  The current time in microseconds.
+ * @param keys: Set to the debounced key states if they have changed.
+ *
+ * @retval `true` if the debounced key states changed, otherwise `false`.
+ */
+bool keypad_get_stable_states(uint32_t now, uint16_t* keys) {
+
+    if (keys_changed && !is_reading) {
+        // Clear the flag first: an edge during the read sets it again
+        keys_changed = false;
+        uint32_t changed_at = keys_changed_at;
+        if (changed_at == 0) changed_at = now;
+
+        if (transfer_is_running()) {
+            // Queue the read behind any display writes; the result
+            // arrives via keypad_read_done()
+            uint8_t tca9555_reg = 0;
+            reading_at = changed_at;
+            is_reading = transfer_queue(TRANSFER_BUS_I2C, KEYPAD_I2C_ADDRESS, &tca9555_reg, 1, 2, keypad_read_done, NULL);
+            if (!is_reading) keys_changed = true;
+        } else {
+            keypad_take_reading(keypad_get_button_states(), changed_at);
+        }
+    }
+
+    // Bounces restart the clock via the callback's timestamp
+    if (raw_keys != stable_keys && now - raw_keys_at >= KEYPAD_DEBOUNCE_US) {
+        stable_keys = raw_keys;
+        *keys = stable_keys;
+        return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief Transfer queue callback for a key read.
+ *
+ * @param job:   The finished read, its data holding the TCA9555's inputs.
+ * @param is_ok: Whether the read succeeded.
+ */
+static void keypad_read_done(TRANSFER_JOB* job, bool is_ok) {
+
+    is_reading = false;
+    if (is_ok) {
+        // Read value is 0 = pressed, 1 = not pressed, so invert it
+        keypad_take_reading(~(job->data[0] | (job->data[1] << 8)), reading_at);
+    } else {
+        keys_changed = true;
+    }
+}
+
+
+/**
+ * @brief Record a reading of the keys, for keypad_get_stable_states().
+ *
+ * @param keys:       The key states read.
+ * @param changed_at: When the INT edge that prompted the read came.
+ */
+static void keypad_take_reading(uint16_t keys, uint32_t changed_at) {
+
+    raw_keys = keys;
+    raw_keys_at = changed_at;
+
+    // Reading clears INT unless the keys changed again meanwhile,
+    // in which case there is no new edge to wait for
+    if (!hal_gpio_get(KEYPAD_PIN_KEYS_INT)) keys_changed = true;
+}
+
+
 /**
  * @brief Set the data for a single key's pixel, using the specified colour,
  *        and its co-ordinates on the key grid.
@@ -200,6 +307,21 @@ static void keypad_set_led_data(uint16_t o, uint8_t r, uint8_t g, uint8_t b) {
 }
 
 
+/**
+ * @brief GPIO callback for the TCA9555's INT line: note when the keys
+ *        changed, for keypad_get_stable_states() to read them.
+ *
+ * @param pin: The pin that triggered the interrupt.
+ */
+static void keypad_int_callback(uint8_t pin) {
+
+    if (pin == KEYPAD_PIN_KEYS_INT) {
+        keys_changed_at = hal_time_us();
+        keys_changed = true;
+    }
+}
+
+
 /**
  * @brief Check for the presence of the TCA9555 IO expander at 0x20.
  *  Will detect *any thing* at 0x20, however.
@@ -209,6 +331,5 @@ static void keypad_set_led_data(uint16_t o, uint8_t r, uint8_t g, uint8_t b) {
 static bool check_board_presence(void) {
 
     uint8_t rxdata;
-    int ret = i2c_read_blocking(i2c0, KEYPAD_I2C_ADDRESS, &rxdata, 1, false);
-    return !(rxdata < 0);
+    return hal_i2c_read(KEYPAD_I2C_ADDRESS, &rxdata, 1, false) != HAL_BUS_ERROR;
 }
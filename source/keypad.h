@@ -16,6 +16,7 @@
  * INCLUDES
  */
 #include <stdint.h>
+#include <stdbool.h>
 
 
 /*
@@ -29,21 +30,27 @@
 #define KEYPAD_I2C_ADDRESS                  0x20
 #define KEYPAD_PIN_KEYS_SDA                 4
 #define KEYPAD_PIN_KEYS_SCL                 5
+#define KEYPAD_PIN_KEYS_INT                 3       // TCA9555 INT, active low
 #define KEYPAD_PIN_LEDS_CS                  17
 #define KEYPAD_PIN_LEDS_SCK                 18
 #define KEYPAD_PIN_LEDS_TX                  19
 
+// Keys must be steady this long after the last INT edge to count
+#define KEYPAD_DEBOUNCE_US                  5000        // 5ms
+
 
 /*
  * PROTOTYPES
  */
 bool        keypad_init(void);
 void        keypad_update_leds(void);
+void        keypad_flush(void);
 void        keypad_set_brightness(float brightness);
 void        keypad_set_led(uint8_t i, uint8_t r, uint8_t g, uint8_t b);
 void        keypad_set_all(uint8_t r, uint8_t g, uint8_t b);
 void        keypad_clear(void);
 uint16_t    keypad_get_button_states(void);
+bool        keypad_get_stable_states(uint32_t now, uint16_t* keys);
 
 
 #endif  // _KEYPAD_HEADER_
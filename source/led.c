@@ -0,0 +1,114 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Background LED pattern engine: blink patterns are queued and played
+ * out by led_tick(), which a timer calls, so nothing waits on the LED
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stddef.h>
+// App
+#include "led.h"
+
+
+/**
+ * @brief Set up an LED engine.
+ *
+ * @param led: Pointer to an LED struct.
+ * @param put: Sets the LED on or off.
+ */
+void led_init(LED* led, void (*put)(bool is_on)) {
+
+    for (uint8_t i = 0 ; i < LED_SOURCES ; ++i) mailbox_init(&led->patterns[i]);
+    led->put = put;
+    led->base = false;
+    led->next_source = 0;
+    led->ticks_left = 0;
+    led->dropped = 0;
+    put(false);
+}
+
+
+/**
+ * @brief Queue a blink pattern. Returns at once.
+ *
+ * @param led:    Pointer to an LED struct.
+ * @param source: The caller's source number, eg. its core, 0 to LED_SOURCES - 1.
+ *                Each source must be only one thread of execution.
+ * @param count:  The number of blinks.
+ *
+ * @retval `true` if the pattern was queued, `false` if it was dropped.
+ */
+bool led_queue(LED* led, uint8_t source, uint8_t count) {
+
+    if (count == 0 || source >= LED_SOURCES) return false;
+
+    MAILBOX_MSG msg = {0, count, 0, 0};
+    if (!mailbox_put(&led->patterns[source], &msg)) {
+        led->dropped++;
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Set the level the LED shows between patterns. If no pattern
+ *        is playing, it is shown at once.
+ *
+ * @param led:   Pointer to an LED struct.
+ * @param is_on: The level.
+ */
+void led_set(LED* led, bool is_on) {
+
+    led->base = is_on;
+    if (led->ticks_left == 0) led->put(is_on);
+}
+
+
+/**
+ * @brief Advance the pattern being shown by one tick, starting the next
+ *        queued pattern when it ends. Call every LED_TICK_MS.
+ *
+ * @param led: Pointer to an LED struct.
+ */
+void led_tick(LED* led) {
+
+    if (led->ticks_left == 0) {
+        // Take the next pattern, trying each source in turn
+        MAILBOX_MSG msg;
+        for (uint8_t i = 0 ; i < LED_SOURCES ; ++i) {
+            uint8_t source = (led->next_source + i) % LED_SOURCES;
+            if (mailbox_get(&led->patterns[source], &msg)) {
+                led->ticks_left = msg.arg * 2 + LED_GAP_TICKS;
+                led->next_source = (source + 1) % LED_SOURCES;
+                break;
+            }
+        }
+
+        if (led->ticks_left == 0) return;
+    }
+
+    // Odd ticks from the end of the blinks are on, even are off
+    led->ticks_left--;
+    uint16_t blink_ticks = led->ticks_left >= LED_GAP_TICKS ? led->ticks_left - LED_GAP_TICKS : 0;
+    bool is_on = led->ticks_left >= LED_GAP_TICKS && (blink_ticks & 1) == 1;
+    led->put(led->ticks_left == 0 ? led->base : is_on);
+}
+
+
+/**
+ * @brief Whether a pattern is playing.
+ *
+ * @param led: Pointer to an LED struct.
+ *
+ * @retval `true` if a pattern is playing, otherwise `false`.
+ */
+bool led_is_busy(LED* led) {
+
+    return led->ticks_left > 0;
+}
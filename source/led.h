@@ -0,0 +1,59 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Background LED pattern engine
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _LED_HEADER_
+#define _LED_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "mailbox.h"
+
+
+/*
+ *      CONSTANTS
+ */
+// Each blink is one tick on, one tick off; patterns are separated by
+// LED_GAP_TICKS more off
+#define LED_TICK_MS                 250
+#define LED_GAP_TICKS               2
+
+// One mailbox per source -- each RP2040 core -- keeps every mailbox
+// single-producer. Patterns that arrive while a mailbox is full are dropped
+#define LED_SOURCES                 2
+
+
+/*
+ * STRUCTS
+ */
+typedef struct {
+    MAILBOX     patterns[LED_SOURCES];
+    void        (*put)(bool is_on);
+    volatile bool base;         // Shown when no pattern is
+    uint8_t     next_source;    // Sources take turns
+    volatile uint16_t ticks_left;   // Of the pattern being shown, including the gap
+    uint32_t    dropped;
+} LED;
+
+
+/*
+ *      PROTOTYPES
+ */
+void        led_init(LED* led, void (*put)(bool is_on));
+bool        led_queue(LED* led, uint8_t source, uint8_t count);
+void        led_set(LED* led, bool is_on);
+void        led_tick(LED* led);
+bool        led_is_busy(LED* led);
+
+
+#endif  // _LED_HEADER_
@@ -0,0 +1,437 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Streaming program loader: S-record, Intel HEX and DECB
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+// App
+#include "loader.h"
+
+
+/*
+ * STATICS
+ */
+static uint8_t  feed_text(LOADER* loader, uint8_t byte);
+static uint8_t  feed_decb(LOADER* loader, uint8_t byte);
+static uint8_t  srec_record_byte(LOADER* loader, uint8_t byte);
+static uint8_t  ihex_record_byte(LOADER* loader, uint8_t byte);
+static uint8_t  store_byte(LOADER* loader, uint32_t address, uint8_t value);
+static int      hex_value(uint8_t chr);
+static bool     is_space(uint8_t chr);
+
+// Parser states
+#define STATE_START                 0
+#define STATE_SREC_TYPE             1
+#define STATE_HEX                   2
+#define STATE_DECB_HEADER           3
+#define STATE_DECB_DATA             4
+#define STATE_DONE                  5
+
+// Address field sizes of S0-S9 records
+// See Motorola M68000 Programmer's Reference Manual, Appendix C
+static const uint8_t SREC_ADDRESS_BYTES[10] = {2, 2, 3, 4, 0, 2, 3, 4, 3, 2};
+
+static const char* ERROR_MESSAGES[] = {
+    "OK",
+    "unknown file format",
+    "malformed record",
+    "bad checksum",
+    "address out of range",
+    "file truncated",
+    "cannot read file"
+};
+
+
+/**
+ * @brief Prepare a loader to receive a new file.
+ *
+ * @param loader: Pointer to a LOADER struct.
+ * @param memory: Pointer to the 64KB memory space to load into.
+ */
+void loader_init(LOADER* loader, uint8_t* memory) {
+
+    memset(loader, 0, sizeof(LOADER));
+    loader->memory = memory;
+    loader->low_address = 0xFFFFFFFF;
+    loader->line = 1;
+}
+
+
+/**
+ * @brief Parse the next chunk of a file, writing data into memory as
+ *        it arrives. Chunks may split records at any point. Checksums
+ *        are verified as each record completes.
+ *
+ * @param loader: Pointer to a LOADER struct.
+ * @param data:   Pointer to the chunk.
+ * @param length: The chunk size in bytes.
+ *
+ * @retval LOADER_OK, or the first error encountered.
+ */
+uint8_t loader_feed(LOADER* loader, const uint8_t* data, uint32_t length) {
+
+    if (loader->error != LOADER_OK) return loader->error;
+
+    for (uint32_t i = 0 ; i < length ; ++i) {
+        uint8_t byte = data[i];
+
+        // Anything after the end record is ignored
+        if (loader->state == STATE_DONE) break;
+
+        if (loader->format == LOADER_FORMAT_UNKNOWN) {
+            if (byte == 'S') {
+                loader->format = LOADER_FORMAT_SREC;
+            } else if (byte == ':') {
+                loader->format = LOADER_FORMAT_IHEX;
+            } else if (byte == DECB_PREAMBLE) {
+                loader->format = LOADER_FORMAT_DECB;
+                loader->state = STATE_DECB_HEADER;
+            } else if (!is_space(byte)) {
+                loader->error = LOADER_ERR_FORMAT;
+            }
+        }
+
+        if (loader->format == LOADER_FORMAT_DECB) {
+            loader->error = feed_decb(loader, byte);
+        } else if (loader->format != LOADER_FORMAT_UNKNOWN) {
+            loader->error = feed_text(loader, byte);
+        }
+
+        if (loader->error != LOADER_OK) break;
+    }
+
+    return loader->error;
+}
+
+
+/**
+ * @brief Call at the end of the input to check the file was complete.
+ *        Text files may omit their end record; a DECB file must have
+ *        its postamble.
+ *
+ * @param loader: Pointer to a LOADER struct.
+ *
+ * @retval LOADER_OK, or the error encountered.
+ */
+uint8_t loader_finish(LOADER* loader) {
+
+    if (loader->error != LOADER_OK) return loader->error;
+    if (loader->format == LOADER_FORMAT_UNKNOWN) {
+        loader->error = LOADER_ERR_FORMAT;
+    } else if (loader->state != STATE_DONE && loader->state != STATE_START) {
+        loader->error = LOADER_ERR_TRUNCATED;
+    }
+
+    return loader->error;
+}
+
+
+/**
+ * @brief Get a readable description of a loader error.
+ *
+ * @param error: A LOADER_ERR_* value.
+ *
+ * @retval The message.
+ */
+const char* loader_error_message(uint8_t error) {
+
+    if (error > LOADER_ERR_FILE) return "unknown error";
+    return ERROR_MESSAGES[error];
+}
+
+
+/**
+ * @brief Process one character of an S-record or Intel HEX file.
+ *
+ * @param loader: Pointer to a LOADER struct.
+ * @param byte:   The character.
+ *
+ * @retval LOADER_OK or an error.
+ */
+static uint8_t feed_text(LOADER* loader, uint8_t byte) {
+
+    switch (loader->state) {
+        case STATE_START:
+            if (byte == '\n') loader->line++;
+            if (is_space(byte)) return LOADER_OK;
+
+            loader->index = 0;
+            loader->length = 0;
+            loader->address = 0;
+            loader->value = 0;
+            loader->sum = 0;
+            loader->has_digit = false;
+
+            if (loader->format == LOADER_FORMAT_SREC && byte == 'S') {
+                loader->state = STATE_SREC_TYPE;
+                return LOADER_OK;
+            }
+
+            if (loader->format == LOADER_FORMAT_IHEX && byte == ':') {
+                loader->state = STATE_HEX;
+                return LOADER_OK;
+            }
+
+            return LOADER_ERR_SYNTAX;
+
+        case STATE_SREC_TYPE:
+            if (byte < '0' || byte > '9' || byte == '4') return LOADER_ERR_SYNTAX;
+            loader->type = byte - '0';
+            loader->state = STATE_HEX;
+            return LOADER_OK;
+
+        case STATE_HEX:
+        {
+            int nibble = hex_value(byte);
+            if (nibble < 0) {
+                return (byte == '\r' || byte == '\n') ? LOADER_ERR_TRUNCATED : LOADER_ERR_SYNTAX;
+            }
+
+            // Process each complete pair of digits
+            if (!loader->has_digit) {
+                loader->digit = (uint8_t)nibble;
+                loader->has_digit = true;
+                return LOADER_OK;
+            }
+
+            loader->has_digit = false;
+            byte = (loader->digit << 4) | (uint8_t)nibble;
+            uint8_t result = loader->format == LOADER_FORMAT_SREC
+                ? srec_record_byte(loader, byte)
+                : ihex_record_byte(loader, byte);
+            loader->index++;
+            return result;
+        }
+    }
+
+    return LOADER_ERR_SYNTAX;
+}
+
+
+/**
+ * @brief Process the next byte of an S-record: count, address, data
+ *        and checksum, which is the ones' complement of the sum of
+ *        the rest.
+ *
+ * @param loader: Pointer to a LOADER struct.
+ * @param byte:   The record byte.
+ *
+ * @retval LOADER_OK or an error.
+ */
+static uint8_t srec_record_byte(LOADER* loader, uint8_t byte) {
+
+    uint32_t index = loader->index;
+    uint32_t address_bytes = SREC_ADDRESS_BYTES[loader->type];
+
+    if (index == 0) {
+        if (byte < address_bytes + 1) return LOADER_ERR_SYNTAX;
+        loader->length = byte;
+        loader->sum = byte;
+        return LOADER_OK;
+    }
+
+    if (index < loader->length) {
+        loader->sum += byte;
+
+        if (index <= address_bytes) {
+            loader->address = (loader->address << 8) | byte;
+            return LOADER_OK;
+        }
+
+        // S1-S3 carry data; S0's header text is skipped
+        if (loader->type >= 1 && loader->type <= 3) {
+            return store_byte(loader, loader->address + index - address_bytes - 1, byte);
+        }
+
+        return LOADER_OK;
+    }
+
+    // Checksum
+    if (((loader->sum + byte) & 0xFF) != 0xFF) return LOADER_ERR_CHECKSUM;
+
+    loader->records++;
+    loader->state = STATE_START;
+
+    if (loader->type >= 7) {
+        // S7-S9 carry the entry point
+        if (loader->address > 0xFFFF) return LOADER_ERR_RANGE;
+        loader->entry = (uint16_t)loader->address;
+        loader->has_entry = true;
+        loader->is_done = true;
+        loader->state = STATE_DONE;
+    }
+
+    return LOADER_OK;
+}
+
+
+/**
+ * @brief Process the next byte of an Intel HEX record: count, address,
+ *        type, data and checksum, which is the two's complement of
+ *        the sum of the rest.
+ *
+ * @param loader: Pointer to a LOADER struct.
+ * @param byte:   The record byte.
+ *
+ * @retval LOADER_OK or an error.
+ */
+static uint8_t ihex_record_byte(LOADER* loader, uint8_t byte) {
+
+    uint32_t index = loader->index;
+    loader->sum += byte;
+
+    if (index == 0) {
+        loader->length = byte;
+        return LOADER_OK;
+    }
+
+    if (index < 3) {
+        loader->address = (loader->address << 8) | byte;
+        return LOADER_OK;
+    }
+
+    if (index == 3) {
+        if (byte > 0x05) return LOADER_ERR_SYNTAX;
+        loader->type = byte;
+        return LOADER_OK;
+    }
+
+    if (index < 4 + loader->length) {
+        if (loader->type == 0x00) {
+            return store_byte(loader, loader->base + loader->address + index - 4, byte);
+        }
+
+        loader->value = (loader->value << 8) | byte;
+        return LOADER_OK;
+    }
+
+    // Checksum, already added into the sum
+    if (loader->sum != 0) return LOADER_ERR_CHECKSUM;
+
+    loader->records++;
+    loader->state = STATE_START;
+
+    switch (loader->type) {
+        case 0x01:
+            loader->is_done = true;
+            loader->state = STATE_DONE;
+            break;
+        case 0x02:
+            loader->base = (loader->value & 0xFFFF) << 4;
+            break;
+        case 0x03:
+            // CS:IP
+            loader->value = ((loader->value >> 16) << 4) + (loader->value & 0xFFFF);
+            // Fall through
+        case 0x05:
+            if (loader->value > 0xFFFF) return LOADER_ERR_RANGE;
+            loader->entry = (uint16_t)loader->value;
+            loader->has_entry = true;
+            break;
+        case 0x04:
+            loader->base = (loader->value & 0xFFFF) << 16;
+    }
+
+    return LOADER_OK;
+}
+
+
+/**
+ * @brief Process one byte of a DECB binary: a series of segments, each
+ *        a five-byte header (0x00, length, load address) and data,
+ *        ended by a postamble (0xFF, 0x0000, entry point).
+ *
+ * @param loader: Pointer to a LOADER struct.
+ * @param byte:   The byte.
+ *
+ * @retval LOADER_OK or an error.
+ */
+static uint8_t feed_decb(LOADER* loader, uint8_t byte) {
+
+    if (loader->state == STATE_DECB_DATA) {
+        uint8_t result = store_byte(loader, loader->address++, byte);
+        if (--loader->length == 0) {
+            loader->records++;
+            loader->state = STATE_DECB_HEADER;
+            loader->index = 0;
+        }
+
+        return result;
+    }
+
+    loader->header[loader->index++] = byte;
+    if (loader->index == 1 && byte != DECB_PREAMBLE && byte != DECB_POSTAMBLE) return LOADER_ERR_SYNTAX;
+    if (loader->index < DECB_HEADER_SIZE) return LOADER_OK;
+
+    loader->index = 0;
+    loader->length = (loader->header[1] << 8) | loader->header[2];
+    loader->address = (loader->header[3] << 8) | loader->header[4];
+
+    if (loader->header[0] == DECB_POSTAMBLE) {
+        loader->entry = (uint16_t)loader->address;
+        loader->has_entry = true;
+        loader->is_done = true;
+        loader->state = STATE_DONE;
+    } else if (loader->length > 0) {
+        loader->state = STATE_DECB_DATA;
+    }
+
+    return LOADER_OK;
+}
+
+
+/**
+ * @brief Write a data byte to memory and record the span loaded.
+ *
+ * @param loader:  Pointer to a LOADER struct.
+ * @param address: The target address.
+ * @param value:   The byte.
+ *
+ * @retval LOADER_OK, or LOADER_ERR_RANGE if the address is beyond 64KB.
+ */
+static uint8_t store_byte(LOADER* loader, uint32_t address, uint8_t value) {
+
+    if (address > 0xFFFF) return LOADER_ERR_RANGE;
+
+    loader->memory[address] = value;
+    loader->bytes_loaded++;
+    if (address < loader->low_address) loader->low_address = address;
+    if (address > loader->high_address) loader->high_address = address;
+    return LOADER_OK;
+}
+
+
+/**
+ * @brief Convert an ASCII hex digit.
+ *
+ * @param chr: The character.
+ *
+ * @retval The value, 0-15, or -1 if the character isn't a hex digit.
+ */
+static int hex_value(uint8_t chr) {
+
+    if (chr >= '0' && chr <= '9') return chr - '0';
+    if (chr >= 'A' && chr <= 'F') return chr - 'A' + 10;
+    if (chr >= 'a' && chr <= 'f') return chr - 'a' + 10;
+    return -1;
+}
+
+
+/**
+ * @brief Check for whitespace between text records.
+ *
+ * @param chr: The character.
+ *
+ * @retval Whether it is whitespace.
+ */
+static bool is_space(uint8_t chr) {
+
+    return chr == ' ' || chr == '\t' || chr == '\r' || chr == '\n';
+}
@@ -0,0 +1,84 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Streaming program loader: S-record, Intel HEX and DECB
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _LOADER_HEADER_
+#define _LOADER_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*
+ *      CONSTANTS
+ */
+#define LOADER_FORMAT_UNKNOWN       0
+#define LOADER_FORMAT_SREC          1
+#define LOADER_FORMAT_IHEX          2
+#define LOADER_FORMAT_DECB          3
+
+#define LOADER_OK                   0
+#define LOADER_ERR_FORMAT           1
+#define LOADER_ERR_SYNTAX           2
+#define LOADER_ERR_CHECKSUM         3
+#define LOADER_ERR_RANGE            4
+#define LOADER_ERR_TRUNCATED        5
+#define LOADER_ERR_FILE             6
+
+// DECB segment markers
+// See Disk BASIC Unravelled, 'LOADM'
+#define DECB_PREAMBLE               0x00
+#define DECB_POSTAMBLE              0xFF
+#define DECB_HEADER_SIZE            5
+
+
+/*
+ * STRUCTS
+ */
+typedef struct {
+    uint8_t*    memory;         // The 64KB space records are written into
+    uint8_t     format;
+    uint8_t     error;
+    bool        is_done;        // End record or postamble seen
+    bool        has_entry;
+    uint16_t    entry;
+    uint32_t    records;
+    uint32_t    bytes_loaded;
+    uint32_t    low_address;
+    uint32_t    high_address;
+    uint32_t    line;           // Text formats: the current line, for errors
+    // Record parser state
+    uint8_t     state;
+    uint8_t     type;
+    uint8_t     digit;
+    bool        has_digit;      // The high nibble of a hex pair has arrived
+    uint8_t     sum;
+    uint32_t    index;
+    uint32_t    length;
+    uint32_t    address;
+    uint32_t    value;
+    uint32_t    base;           // Intel HEX segment/linear base
+    uint8_t     header[DECB_HEADER_SIZE];
+} LOADER;
+
+
+/*
+ *      PROTOTYPES
+ */
+void        loader_init(LOADER* loader, uint8_t* memory);
+uint8_t     loader_feed(LOADER* loader, const uint8_t* data, uint32_t length);
+uint8_t     loader_finish(LOADER* loader);
+const char* loader_error_message(uint8_t error);
+
+
+#endif  // _LOADER_HEADER_
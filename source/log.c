@@ -0,0 +1,178 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Levelled, ring-buffered diagnostic logging: writers store a binary
+ * record and return; a background task formats and sends the records
+ * when the output has room
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+// App
+#include "log.h"
+
+
+/*
+ * STATICS
+ */
+static uint32_t format_record(const LOG_RECORD* record, char* line);
+
+
+/*
+ * GLOBALS
+ */
+LOG_RING    log_rings[LOG_SOURCES];
+uint32_t    (*log_clock)(void) = NULL;
+uint8_t     (*log_source)(void) = NULL;
+
+const char  LOG_LEVEL_CHARS[] = "-EWID";
+
+
+/**
+ * @brief Empty the rings and set where records' times and sources
+ *        come from. Call before any other core starts.
+ *
+ * @param clock:  Returns the time in microseconds, or NULL.
+ * @param source: Returns the writer's source number, eg. its core, or
+ *                NULL if there is only one.
+ */
+void log_init(uint32_t (*clock)(void), uint8_t (*source)(void)) {
+
+    for (uint8_t i = 0 ; i < LOG_SOURCES ; ++i) {
+        atomic_store_explicit(&log_rings[i].head, 0, memory_order_relaxed);
+        atomic_store_explicit(&log_rings[i].tail, 0, memory_order_relaxed);
+        atomic_store_explicit(&log_rings[i].dropped, 0, memory_order_relaxed);
+        log_rings[i].reported = 0;
+    }
+
+    log_clock = clock;
+    log_source = source;
+}
+
+
+/**
+ * @brief Store a record. Never waits: if the writer's ring is full,
+ *        the record is dropped. Use the LOG_* macros rather than this.
+ *
+ * @param level:  The record's LOG_LEVEL_*.
+ * @param format: A printf format, kept until the record is drained.
+ * @param count:  The number of integer arguments that follow.
+ */
+void log_write(uint8_t level, const char* format, uint8_t count, ...) {
+
+    uint8_t source = log_source != NULL ? log_source() : 0;
+    if (source >= LOG_SOURCES) return;
+    LOG_RING* ring = &log_rings[source];
+
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail == LOG_RING_SIZE) {
+        uint32_t dropped = atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+        atomic_store_explicit(&ring->dropped, dropped + 1, memory_order_relaxed);
+        return;
+    }
+
+    LOG_RECORD* record = &ring->records[head & (LOG_RING_SIZE - 1)];
+    record->format = format;
+    record->time = log_clock != NULL ? log_clock() : 0;
+    record->level = level;
+
+    va_list args;
+    va_start(args, count);
+    for (uint8_t i = 0 ; i < LOG_MAX_ARGS ; ++i) {
+        record->args[i] = i < count ? va_arg(args, uint32_t) : 0;
+    }
+
+    va_end(args);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+
+/**
+ * @brief Format and send stored records, oldest first within each
+ *        ring. A record stays stored if `out` has no room for it, so
+ *        this never waits on the output.
+ *
+ * @param max: The most records to send.
+ * @param out: Sends a line, returning `false` if it cannot take it now.
+ *
+ * @retval The number of records sent.
+ */
+uint32_t log_drain(uint32_t max, bool (*out)(const char* text, uint32_t length)) {
+
+    char line[LOG_LINE_SIZE];
+    uint32_t sent = 0;
+
+    for (uint8_t i = 0 ; i < LOG_SOURCES ; ++i) {
+        LOG_RING* ring = &log_rings[i];
+
+        // Say if records were lost since the last report
+        uint32_t dropped = atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+        if (dropped != ring->reported && sent < max) {
+            uint32_t length = snprintf(line, sizeof(line), "[log] %u record(s) dropped on source %u\n",
+                                       (unsigned)(dropped - ring->reported), (unsigned)i);
+            if (!out(line, length)) return sent;
+            ring->reported = dropped;
+        }
+
+        while (sent < max) {
+            uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+            uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+            if (head == tail) break;
+
+            uint32_t length = format_record(&ring->records[tail & (LOG_RING_SIZE - 1)], line);
+            if (!out(line, length)) return sent;
+
+            atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+            sent++;
+        }
+    }
+
+    return sent;
+}
+
+
+/**
+ * @brief The number of records dropped so far, across all sources.
+ */
+uint32_t log_dropped(void) {
+
+    uint32_t dropped = 0;
+    for (uint8_t i = 0 ; i < LOG_SOURCES ; ++i) {
+        dropped += atomic_load_explicit(&log_rings[i].dropped, memory_order_relaxed);
+    }
+
+    return dropped;
+}
+
+
+/**
+ * @brief Render a record as a line of text: time in ms, level, message.
+ *
+ * @param record: The record.
+ * @param line:   LOG_LINE_SIZE bytes to receive the line.
+ *
+ * @retval The length of the line.
+ */
+static uint32_t format_record(const LOG_RECORD* record, char* line) {
+
+    uint8_t level = record->level < sizeof(LOG_LEVEL_CHARS) - 1 ? record->level : 0;
+    int length = snprintf(line, LOG_LINE_SIZE, "[%7u.%03u] %c ",
+                          (unsigned)(record->time / 1000), (unsigned)(record->time % 1000), LOG_LEVEL_CHARS[level]);
+    length += snprintf(line + length, LOG_LINE_SIZE - length, record->format, record->args[0], record->args[1], record->args[2]);
+    if (length >= LOG_LINE_SIZE - 1) length = LOG_LINE_SIZE - 2;
+
+    // One record, one line
+    if (line[length - 1] != '\n') {
+        line[length++] = '\n';
+        line[length] = 0;
+    }
+
+    return length;
+}
@@ -0,0 +1,115 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Levelled, ring-buffered diagnostic logging
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _LOG_HEADER_
+#define _LOG_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+
+/*
+ *      CONSTANTS
+ */
+#define LOG_LEVEL_NONE              0
+#define LOG_LEVEL_ERROR             1
+#define LOG_LEVEL_WARN              2
+#define LOG_LEVEL_INFO              3
+#define LOG_LEVEL_DEBUG             4
+
+// Messages above LOG_LEVEL compile to nothing, arguments included
+#ifndef LOG_LEVEL
+#ifdef DEBUG
+#define LOG_LEVEL                   LOG_LEVEL_DEBUG
+#else
+#define LOG_LEVEL                   LOG_LEVEL_NONE
+#endif
+#endif
+
+// One ring per source -- each RP2040 core -- so each has one producer.
+// Records that arrive while a ring is full are dropped and counted
+#define LOG_SOURCES                 2
+#define LOG_RING_SIZE               64          // Must be a power of two
+#define LOG_MAX_ARGS                3
+#define LOG_LINE_SIZE               128
+
+
+/*
+ *      MACROS
+ */
+// Formats take up to LOG_MAX_ARGS 32-bit integer arguments, and are not
+// applied until the record is drained, so must be string literals.
+// The arguments are counted as the size of an array of them, so any
+// number is counted, and a call with too many fails to compile
+#define LOG_COUNT_ARGS(...)         (sizeof((uint32_t[]){0, ##__VA_ARGS__}) / sizeof(uint32_t) - 1)
+#define LOG_CHECK_ARGS(count) \
+    ((uint8_t)((count) + 0 * sizeof(struct { _Static_assert((count) <= LOG_MAX_ARGS, "Too many log arguments"); char c; })))
+#define LOG_WRITE(level, format, ...) \
+    log_write(level, format, LOG_CHECK_ARGS(LOG_COUNT_ARGS(__VA_ARGS__)), ##__VA_ARGS__)
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(format, ...)      LOG_WRITE(LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(format, ...)      ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(format, ...)       LOG_WRITE(LOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#else
+#define LOG_WARN(format, ...)       ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(format, ...)       LOG_WRITE(LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#else
+#define LOG_INFO(format, ...)       ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(format, ...)      LOG_WRITE(LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(format, ...)      ((void)0)
+#endif
+
+
+/*
+ * STRUCTS
+ */
+typedef struct {
+    const char* format;
+    uint32_t    time;
+    uint32_t    args[LOG_MAX_ARGS];
+    uint8_t     level;
+} LOG_RECORD;
+
+typedef struct {
+    LOG_RECORD          records[LOG_RING_SIZE];
+    _Atomic uint32_t    head;       // Written by the producer
+    _Atomic uint32_t    tail;       // Written by the drain
+    _Atomic uint32_t    dropped;    // Written by the producer
+    uint32_t            reported;   // Drops the drain has reported
+} LOG_RING;
+
+
+/*
+ *      PROTOTYPES
+ */
+void        log_init(uint32_t (*clock)(void), uint8_t (*source)(void));
+void        log_write(uint8_t level, const char* format, uint8_t count, ...);
+uint32_t    log_drain(uint32_t max, bool (*out)(const char* text, uint32_t length));
+uint32_t    log_dropped(void);
+
+
+#endif  // _LOG_HEADER_
@@ -0,0 +1,171 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Streaming LZ4 block decompression
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+// App
+#include "lz4.h"
+
+
+/*
+ * STATICS
+ */
+static uint8_t  copy_match(LZ4_STREAM* stream);
+
+// Decoder states
+// See https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+#define STATE_TOKEN                 0
+#define STATE_LITERAL_LENGTH        1
+#define STATE_LITERALS              2
+#define STATE_OFFSET_LOW            3
+#define STATE_OFFSET_HIGH           4
+#define STATE_MATCH_LENGTH          5
+
+#define LENGTH_EXTENDED             15
+#define LENGTH_CONTINUES            255
+
+
+/**
+ * @brief Prepare to decompress one LZ4 block.
+ *
+ * @param stream:   Pointer to an LZ4_STREAM struct.
+ * @param out:      Where to write the decompressed data.
+ * @param out_size: The expected decompressed size.
+ */
+void lz4_init(LZ4_STREAM* stream, uint8_t* out, uint32_t out_size) {
+
+    memset(stream, 0, sizeof(LZ4_STREAM));
+    stream->out = out;
+    stream->out_size = out_size;
+}
+
+
+/**
+ * @brief Decompress the next chunk of an LZ4 block. Chunks may split
+ *        sequences at any point.
+ *
+ * @param stream: Pointer to an LZ4_STREAM struct.
+ * @param data:   Pointer to the compressed bytes.
+ * @param length: The number of bytes.
+ *
+ * @retval LZ4_OK, or the first error encountered.
+ */
+uint8_t lz4_feed(LZ4_STREAM* stream, const uint8_t* data, uint32_t length) {
+
+    uint32_t i = 0;
+
+    while (i < length && stream->error == LZ4_OK) {
+        uint8_t byte;
+
+        switch (stream->state) {
+            case STATE_TOKEN:
+                byte = data[i++];
+                stream->literals = byte >> 4;
+                stream->match = byte & 0x0F;
+                if (stream->literals == LENGTH_EXTENDED) {
+                    stream->state = STATE_LITERAL_LENGTH;
+                } else {
+                    stream->state = stream->literals > 0 ? STATE_LITERALS : STATE_OFFSET_LOW;
+                }
+
+                break;
+
+            case STATE_LITERAL_LENGTH:
+                byte = data[i++];
+                stream->literals += byte;
+                if (byte != LENGTH_CONTINUES) stream->state = STATE_LITERALS;
+                break;
+
+            case STATE_LITERALS:
+            {
+                // Copy as many literals as are available in one go
+                uint32_t count = stream->literals;
+                if (count > length - i) count = length - i;
+                if (stream->out_pos + count > stream->out_size) {
+                    stream->error = LZ4_ERR_OVERRUN;
+                    break;
+                }
+
+                memcpy(&stream->out[stream->out_pos], &data[i], count);
+                stream->out_pos += count;
+                stream->literals -= count;
+                i += count;
+                if (stream->literals == 0) stream->state = STATE_OFFSET_LOW;
+                break;
+            }
+
+            case STATE_OFFSET_LOW:
+                stream->offset = data[i++];
+                stream->state = STATE_OFFSET_HIGH;
+                break;
+
+            case STATE_OFFSET_HIGH:
+                stream->offset |= data[i++] << 8;
+                if (stream->offset == 0 || stream->offset > stream->out_pos) {
+                    stream->error = LZ4_ERR_OFFSET;
+                } else if (stream->match == LENGTH_EXTENDED) {
+                    stream->state = STATE_MATCH_LENGTH;
+                } else {
+                    stream->error = copy_match(stream);
+                }
+
+                break;
+
+            case STATE_MATCH_LENGTH:
+                byte = data[i++];
+                stream->match += byte;
+                if (byte != LENGTH_CONTINUES) stream->error = copy_match(stream);
+        }
+    }
+
+    return stream->error;
+}
+
+
+/**
+ * @brief Check that a block ended cleanly: after a sequence's literals,
+ *        with exactly the expected output.
+ *
+ * @param stream: Pointer to an LZ4_STREAM struct.
+ *
+ * @retval LZ4_OK, or the error encountered.
+ */
+uint8_t lz4_finish(LZ4_STREAM* stream) {
+
+    if (stream->error != LZ4_OK) return stream->error;
+
+    bool is_at_end = stream->state == STATE_OFFSET_LOW || (stream->state == STATE_TOKEN && stream->out_pos == 0);
+    if (!is_at_end || stream->out_pos != stream->out_size) stream->error = LZ4_ERR_TRUNCATED;
+    return stream->error;
+}
+
+
+/**
+ * @brief Copy a match from earlier output. The source and destination
+ *        may overlap, which is how LZ4 encodes runs, so copy bytewise.
+ *
+ * @param stream: Pointer to an LZ4_STREAM struct.
+ *
+ * @retval LZ4_OK, or LZ4_ERR_OVERRUN if the match overflows the block.
+ */
+static uint8_t copy_match(LZ4_STREAM* stream) {
+
+    uint32_t count = stream->match + LZ4_MIN_MATCH;
+    if (stream->out_pos + count > stream->out_size) return LZ4_ERR_OVERRUN;
+
+    uint8_t* dest = &stream->out[stream->out_pos];
+    const uint8_t* src = dest - stream->offset;
+    for (uint32_t i = 0 ; i < count ; ++i) dest[i] = src[i];
+
+    stream->out_pos += count;
+    stream->state = STATE_TOKEN;
+    return LZ4_OK;
+}
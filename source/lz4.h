@@ -0,0 +1,58 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Streaming LZ4 block decompression
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _LZ4_HEADER_
+#define _LZ4_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*
+ *      CONSTANTS
+ */
+#define LZ4_MIN_MATCH               4
+
+#define LZ4_OK                      0
+#define LZ4_ERR_OFFSET              1
+#define LZ4_ERR_OVERRUN             2
+#define LZ4_ERR_TRUNCATED           3
+
+
+/*
+ * STRUCTS
+ */
+// Matches are copied from the output already written, so the history
+// window is the output block itself and no other buffer is needed
+typedef struct {
+    uint8_t*    out;
+    uint32_t    out_size;
+    uint32_t    out_pos;
+    uint32_t    literals;
+    uint32_t    match;
+    uint16_t    offset;
+    uint8_t     state;
+    uint8_t     error;
+} LZ4_STREAM;
+
+
+/*
+ *      PROTOTYPES
+ */
+void        lz4_init(LZ4_STREAM* stream, uint8_t* out, uint32_t out_size);
+uint8_t     lz4_feed(LZ4_STREAM* stream, const uint8_t* data, uint32_t length);
+uint8_t     lz4_finish(LZ4_STREAM* stream);
+
+
+#endif  // _LZ4_HEADER_
@@ -0,0 +1,65 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Lock-free single-producer, single-consumer mailbox
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include "mailbox.h"
+
+
+/**
+ * @brief Empty a mailbox. Call before either side uses it.
+ *
+ * @param box: Pointer to a MAILBOX struct.
+ */
+void mailbox_init(MAILBOX* box) {
+
+    atomic_store_explicit(&box->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&box->tail, 0, memory_order_relaxed);
+}
+
+
+/**
+ * @brief Post a message. Producer side only.
+ *
+ * @param box: Pointer to a MAILBOX struct.
+ * @param msg: The message, which is copied.
+ *
+ * @retval `true` if the message was posted, `false` if the mailbox is full.
+ */
+bool mailbox_put(MAILBOX* box, const MAILBOX_MSG* msg) {
+
+    uint32_t head = atomic_load_explicit(&box->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&box->tail, memory_order_acquire);
+    if (head - tail == MAILBOX_SIZE) return false;
+
+    // Fill the slot before the consumer can see it
+    box->slots[head & (MAILBOX_SIZE - 1)] = *msg;
+    atomic_store_explicit(&box->head, head + 1, memory_order_release);
+    return true;
+}
+
+
+/**
+ * @brief Take the oldest message. Consumer side only.
+ *
+ * @param box: Pointer to a MAILBOX struct.
+ * @param msg: Receives the message.
+ *
+ * @retval `true` if there was a message, `false` if the mailbox is empty.
+ */
+bool mailbox_get(MAILBOX* box, MAILBOX_MSG* msg) {
+
+    uint32_t tail = atomic_load_explicit(&box->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&box->head, memory_order_acquire);
+    if (head == tail) return false;
+
+    // Copy the slot out before the producer can reuse it
+    *msg = box->slots[tail & (MAILBOX_SIZE - 1)];
+    atomic_store_explicit(&box->tail, tail + 1, memory_order_release);
+    return true;
+}
@@ -0,0 +1,57 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Lock-free single-producer, single-consumer mailbox
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _MAILBOX_HEADER_
+#define _MAILBOX_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+
+/*
+ *      CONSTANTS
+ */
+// Must be a power of two
+#define MAILBOX_SIZE                16
+
+
+/*
+ * STRUCTS
+ */
+typedef struct {
+    uint8_t     type;
+    uint8_t     arg;
+    uint16_t    address;
+    uint32_t    value;
+} MAILBOX_MSG;
+
+// One side only ever puts and the other only ever gets, so the two
+// indexes need no lock: each is written by one side and read by the other
+typedef struct {
+    MAILBOX_MSG         slots[MAILBOX_SIZE];
+    _Atomic uint32_t    head;       // Next slot to fill; written by the producer
+    _Atomic uint32_t    tail;       // Next slot to empty; written by the consumer
+} MAILBOX;
+
+
+/*
+ *      PROTOTYPES
+ */
+void        mailbox_init(MAILBOX* box);
+bool        mailbox_put(MAILBOX* box, const MAILBOX_MSG* msg);
+bool        mailbox_get(MAILBOX* box, MAILBOX_MSG* msg);
+
+
+#endif  // _MAILBOX_HEADER_
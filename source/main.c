@@ -15,12 +15,13 @@
 #include <time.h>
 // Pico
 #include "pico/stdlib.h"
-#include "hardware/flash.h"
-#include "hardware/sync.h"
 // App
 #include "ops.h"
 #include "cpu.h"
 #include "cpu_tests.h"
+#include "hal.h"
+#include "led.h"
+#include "log.h"
 #include "monitor.h"
 #include "pia.h"
 #include "main.h"
@@ -32,6 +33,9 @@
 static void boot_cpu(void);
 static void init_rp2040_gpio(void);
 static void prepare_environment(void);
+static void led_put(bool is_on);
+static uint8_t log_core(void);
+static bool led_timer_callback(struct repeating_timer* timer);
 // EXPERIMENTAL
 static void read_into_ram(void);
 static void save_ram(void);
@@ -41,6 +45,8 @@ static void save_ram(void);
  *  GLOBALS
  */
 STATE_RP2040 pico_state;
+LED          pico_led;
+struct repeating_timer led_timer;
 
 extern REG_6809    reg;
 extern STATE_6809  state;
@@ -57,9 +63,12 @@ int main() {
     stdio_usb_init();
 #ifdef DEBUG
     // Pause to allow the USB path to initialize
-    sleep_ms(2000);
+    hal_sleep_ms(2000);
 #endif
 
+    // Diagnostics are stored per core and sent by the monitor loop
+    log_init(hal_time_us, log_core);
+
     // Basic RP2040 config
     pico_state.has_led = true;
     pico_state.has_mc6821 = false;
@@ -181,9 +190,8 @@ static void init_rp2040_gpio(void) {
 
     // Set up the IRQ pins
     for (uint8_t i = 0 ; i < RP2040_IRQ_GPIO_COUNT ; ++i) {
-        gpio_init(pico_state.irq_gpio[i]);
-        gpio_set_dir(pico_state.irq_gpio[i], GPIO_IN);
-        gpio_pull_down(pico_state.irq_gpio[i]);
+        hal_gpio_init(pico_state.irq_gpio[i], false);
+        hal_gpio_pull(pico_state.irq_gpio[i], false);
     }
 
     // Initialize PIA pins if PIA is present
@@ -192,16 +200,15 @@ static void init_rp2040_gpio(void) {
         for (uint8_t i = 0 ; i < RP2040_PIA_GPIO_COUNT ; ++i) {
             // On RESET, set PA0-7, CA1, CA2 to inputs
             // See MC6821 Data Sheet p6
-            gpio_init(pico_state.pia_gpio[i]);
-            gpio_set_dir(pico_state.pia_gpio[i], GPIO_IN);
-            gpio_pull_down(pico_state.pia_gpio[i]);
+            hal_gpio_init(pico_state.pia_gpio[i], false);
+            hal_gpio_pull(pico_state.pia_gpio[i], false);
         }
     }
 
-    // Set up the Pico LED
-    gpio_init(PIN_PICO_LED);
-    gpio_set_dir(PIN_PICO_LED, GPIO_OUT);
-    gpio_put(PIN_PICO_LED, false);
+    // Set up the Pico LED, and play its blink patterns in the background
+    hal_gpio_init(PIN_PICO_LED, true);
+    led_init(&pico_led, led_put);
+    add_repeating_timer_ms(-LED_TICK_MS, led_timer_callback, NULL, &led_timer);
 }
 
 
@@ -214,28 +221,67 @@ uint8_t sample_interrupts(void) {
 
     uint8_t irqs = 0;
     for (uint8_t i = 0 ; i < 3 ; ++i) {
-        if (gpio_get(pico_state.irq_gpio[i])) irqs |= (1 << i);
+        if (hal_gpio_get(pico_state.irq_gpio[i])) irqs |= (1 << i);
     }
     return irqs;
 }
 
 
 /**
- * @brief Flash the Pico LED.
+ * @brief Flash the Pico LED. The blinks are queued and play out in the
+ *        background, so this returns at once; either core may call it.
  *
  * @param count: The number of blinks in the sequence.
  */
 void flash_led(uint8_t count) {
 
-    if (pico_state.has_led) {
-        while (count > 0) {
-            gpio_put(PIN_PICO_LED, true);
-            sleep_ms(250);
-            gpio_put(PIN_PICO_LED, false);
-            sleep_ms(250);
-            count--;
-        }
-    }
+    if (pico_state.has_led) led_queue(&pico_led, get_core_num(), count);
+}
+
+
+/**
+ * @brief Set the Pico LED on or off, between any blink patterns.
+ *        Core 0 only.
+ *
+ * @param is_on: Whether the LED is lit.
+ */
+void set_led(bool is_on) {
+
+    if (pico_state.has_led) led_set(&pico_led, is_on);
+}
+
+
+/**
+ * @brief The log's source for a record: the core writing it.
+ *
+ * @retval The core number, 0 or 1.
+ */
+static uint8_t log_core(void) {
+
+    return (uint8_t)get_core_num();
+}
+
+
+/**
+ * @brief The LED engine's output.
+ *
+ * @param is_on: Whether the LED is lit.
+ */
+static void led_put(bool is_on) {
+
+    hal_gpio_put(PIN_PICO_LED, is_on);
+}
+
+
+/**
+ * @brief Repeating timer callback: advance the LED's blink pattern.
+ *
+ * @retval `true`, to keep the timer running.
+ */
+static bool led_timer_callback(struct repeating_timer* timer) {
+
+    led_tick(&pico_led);
+    return true;
 }
 
 
@@ -244,28 +290,16 @@ void flash_led(uint8_t count) {
  */
 static void read_into_ram(void) {
 
-    // See https://kevinboone.me/picoflash.html?i=1
     // 2MB Flash = 2,097,152
-    // Allow 1MB for app code, so start at
-    // XIP_BASE + 1,048,576
+    // Allow 1MB for app code, so start at 1,048,576
     // RAM SIZE = 64KB = 65,536
-    char *p = (char *)XIP_BASE;
-    p += 1048576;
-
-    // Read 64KB from Flash into RAM
-    for (uint16_t i = 0 ; i < 65536 ; ++i) {
-        mem[i] = (uint8_t)(*p);
-    }
+    hal_flash_read(RP2040_FLASH_DATA_START, mem, RP2040_FLASH_DATA_SIZE);
 }
 
 
 static void save_ram(void) {
 
-    // See https://kevinboone.me/picoflash.html?i=1
-    uint32_t irqs = save_and_disable_interrupts();
-    flash_range_erase (RP2040_FLASH_DATA_START, RP2040_FLASH_DATA_SIZE);
-    flash_range_program (RP2040_FLASH_DATA_START, mem, RP2040_FLASH_DATA_SIZE);
-    restore_interrupts (irqs);
+    hal_flash_write(RP2040_FLASH_DATA_START, mem, RP2040_FLASH_DATA_SIZE);
 }
 
 
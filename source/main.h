@@ -63,6 +63,7 @@ typedef struct {
  */
 uint8_t     sample_interrupts(void);
 void        flash_led(uint8_t count);
+void        set_led(bool is_on);
 
 
 #endif // _E6809_HEADER_
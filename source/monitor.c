@@ -13,14 +13,25 @@
 #include <stdio.h>
 // Pico
 #include "pico/stdlib.h"
+#include "pico/multicore.h"
 #include "hardware/gpio.h"
+#include "tusb.h"
 // App
 #include "main.h"
 #include "cpu.h"
+#include "core.h"
 #include "cpu_tests.h"
+#include "dma.h"
+#include "gdb.h"
+#include "hal.h"
 #include "ht16k33.h"
 #include "keypad.h"
+#include "loader.h"
+#include "log.h"
 #include "monitor.h"
+#include "remote.h"
+#include "transfer.h"
+#include "upload.h"
 
 
 /*
@@ -30,13 +41,22 @@ static void     process_key(uint16_t);
 static void     set_keys(void);
 static uint8_t  keypress_to_value(uint16_t input);
 static void     update_display(void);
+static void     core1_main(void);
+static uint32_t step_core(void);
+static void     log_next_op(void);
+static void     pause_core(void);
 static void     display_cc(void);
 static void     display_ab_dp(void);
 static void     display_left(uint16_t value);
 static void     display_right(uint16_t value);
 static void     display_value(uint16_t value, uint8_t index, bool is_16_bit, bool show_colon);
 static bool     load_code(void);
-static uint16_t get_block(uint8_t *buff);
+static bool     stream_code(uint8_t* data, uint16_t length, uint32_t start);
+static bool     windowed_code(uint8_t* data, uint16_t length);
+static void     send_upload_reply(const uint8_t* data, uint32_t length);
+static void     service_remote(void);
+static bool     send_log(const char* text, uint32_t length);
+static uint16_t get_block(uint8_t *buff, uint16_t size);
 
 
 /*
@@ -54,10 +74,18 @@ bool        mode_changed = false;
 bool        do_display_pc = true;
 bool        is_running_steps = false;
 bool        is_running_full = false;
+bool        is_core_busy = false;
 bool        led_state = false;
 uint8_t     buffer[32];
 uint8_t    *display_buffer[2] = {buffer, buffer + 16};
 uint8_t     display_address[2] = {0x71, 0x70};
+REMOTE      remote;
+GDB         gdb;
+// The 6809 runs on core 1; this is how the UI talks to it
+CORE        cpu_core;
+// The state the displays show, copied when they are redrawn
+REG_6809    shown_reg;
+uint8_t     shown_byte = 0;
 
 extern      REG_6809    reg;
 extern      uint8_t     mem[KB64];
@@ -89,6 +117,9 @@ bool init_board(void) {
     // Set up the displays
     ht16k33_init(display_address[0], display_buffer[0]);
     ht16k33_init(display_address[1], display_buffer[1]);
+
+    // From here on, display and key LED updates go out by DMA
+    dma_port_init();
     return true;
 }
 
@@ -96,22 +127,16 @@ bool init_board(void) {
 /**
  * @brief Initialise and run the main event loop.
  *
- * This primarily continually reads the keypad, allowing for
- * debounces on press and release actions.
+ * This primarily responds to the keypad, which is read only when it
+ * signals a change and is debounced by keypad_get_stable_states().
  * Buttons are triggered only on release.
  */
 void monitor_event_loop(void) {
 
-#ifdef DEBUG
-    printf("Entering UI at main menu\n");
-#endif
+    LOG_INFO("Entering UI at main menu");
 
-    bool is_key_pressed = false;
-    bool can_key_release = false;
-
-    uint32_t debounce_count_press = 0;
-    uint32_t debounce_count_release = 0;
     uint32_t cpu_cycle_complete = 0;
+    uint32_t display_refreshed = 0;
 
     uint16_t the_key = 0;
 
@@ -124,13 +149,34 @@ void monitor_event_loop(void) {
     set_keys();
     update_display();
 
+    // Accept remote-control commands alongside the keypad
+    remote_init(&remote, mem, send_upload_reply);
+    gdb_init(&gdb, mem, send_upload_reply);
+
+    // Run code on core 1, so UI work never slows it. Remote and GDB
+    // runs go there too
+    core_init(&cpu_core, mem, sample_interrupts, NULL);
+    remote.core = &cpu_core;
+    gdb.core = &cpu_core;
+    multicore_launch_core1(core1_main);
+
     // Run the button press loop
     while (true) {
-        // Read the keypad
+        // Retire finished bus transfers and start queued ones
         uint32_t now = time_us_32();
-        uint16_t any_key = keypad_get_button_states();
-        is_key_pressed = (any_key != 0);
-        state.interrupts = sample_interrupts();
+        transfer_poll();
+
+        // Check the keypad -- this touches I2C only after a key change
+        uint16_t keys = 0;
+        bool keys_changed = keypad_get_stable_states(now, &keys);
+
+        // Core 1 owns the CPU state while it runs code from the keypad;
+        // otherwise the remote may drive the CPU from here, and hand
+        // runs to core 1 in turn
+        if (!is_core_busy) {
+            if (!remote.is_running && !gdb.is_running) state.interrupts = sample_interrupts();
+            service_remote();
+        }
 
         if (now - cpu_cycle_complete > 250000) {
             cpu_cycle_complete = now;
@@ -138,14 +184,24 @@ void monitor_event_loop(void) {
         }
 
         if (is_running_full) {
-            // Execute the next instruction
-            gpio_put(PIN_PICO_LED, led_state);
-            uint32_t result = process_next_instruction();
+            // Core 1 is running the code: look for its return
+            set_led(led_state);
+            bool is_done = false;
+            MAILBOX_MSG event;
+            while (core_get_event(&cpu_core, &event)) {
+                if (event.type == CORE_EVENT_STOPPED) {
+                    is_done = true;
+                    is_core_busy = false;
+                }
+            }
 
-            // Update the display
-            update_display();
+            // Redraw the display at a fixed rate from core 1's snapshot
+            if (now - display_refreshed >= DISPLAY_REFRESH_US || is_done) {
+                update_display();
+                display_refreshed = now;
+            }
 
-            if (result == BREAK_TO_MONITOR) {
+            if (is_done) {
                 // Code hit RTI -- show we're not running
                 // NOTE A key press then will take the
                 //      user to the main menu
@@ -156,34 +212,78 @@ void monitor_event_loop(void) {
             }
         }
 
-        if (is_key_pressed) {
-            // Allow a debounce period, eg. 20ms
-            if (debounce_count_press == 0) {
-                debounce_count_press = now;
-            } else if (now - debounce_count_press > DEBOUNCE_TIME_US) {
-                // Key still pressed -- start to check for its release
-                debounce_count_press == 0;
-                can_key_release = true;
-                if (the_key == 0) the_key = any_key;
-            }
-        } else if (can_key_release) {
-            // Allow a debounce period, eg. 20ms
-            if (debounce_count_press == 0) {
-                debounce_count_press = now;
-            } else if (now - debounce_count_press > DEBOUNCE_TIME_US) {
+        if (keys_changed) {
+            if (keys != 0) {
+                // Key pressed -- hold it until every key is released
+                if (the_key == 0) the_key = keys;
+            } else if (the_key != 0) {
                 // Key released -- check and action it
-                can_key_release = false;
                 process_key(the_key);
                 the_key = 0;
             }
-        } else {
-            // pause to allow room for interrupts
-            // TODO
         }
+
+        // Send this pass's display and key LED changes, if any, in one go
+        ht16k33_flush();
+        keypad_flush();
+
+        // Pass on a few log records, if the host has room for them
+        log_drain(LOG_DRAIN_RECORDS, send_log);
     }
 }
 
 
+/**
+ * @brief Core 1's entry point: run the CPU for the UI.
+ */
+void core1_main(void) {
+
+    core_loop(&cpu_core);
+}
+
+
+/**
+ * @brief Log the address and first bytes of the op the PC now points
+ *        to. Core 1 is idle between steps, so the registers and memory
+ *        are still. Records hold only integers, so the bytes are logged
+ *        rather than their disassembly.
+ */
+void log_next_op(void) {
+
+    LOG_DEBUG("Next: 0x%04X %02X %02X", reg.pc, mem[reg.pc], mem[(uint16_t)(reg.pc + 1)]);
+}
+
+
+/**
+ * @brief Have core 1 run one instruction, and wait for it.
+ *
+ * @retval The instruction's result: cycles used, or BREAK_TO_MONITOR.
+ */
+uint32_t step_core(void) {
+
+    MAILBOX_MSG event;
+    core_send(&cpu_core, CORE_CMD_STEP, 0, 0);
+    while (true) {
+        if (core_get_event(&cpu_core, &event) && event.type == CORE_EVENT_STEPPED) return event.value;
+    }
+}
+
+
+/**
+ * @brief Stop code running on core 1, and wait until it has.
+ */
+void pause_core(void) {
+
+    MAILBOX_MSG event;
+    core_send(&cpu_core, CORE_CMD_PAUSE, 0, 0);
+    while (true) {
+        if (core_get_event(&cpu_core, &event) && event.type == CORE_EVENT_STOPPED && event.arg == CORE_STOP_PAUSED) break;
+    }
+
+    is_core_busy = false;
+}
+
+
 /**
  * @brief Process a key press to determine if it is valid - a lit button was pressed -
  *        and to then trigger the action the key represents.
@@ -227,9 +327,9 @@ void process_key(uint16_t input) {
                 // D -- Toggle the display between address and CC register -- MAGENTA
                 // E -- Track the PC register on the display               -- ORANGE
                 // F -- Exit to main menu                                  -- RED
-                if (input == INPUT_STEP_NEXT && is_running_steps) {
+                if (input == INPUT_STEP_NEXT && is_running_steps && !remote.is_running && !gdb.is_running) {
                     // Run next instruction
-                    uint32_t result = process_next_instruction();
+                    uint32_t result = step_core();
 
                     if (result == BREAK_TO_MONITOR) {
                         // Code hit RTI -- jump back to the main menu
@@ -239,6 +339,7 @@ void process_key(uint16_t input) {
                         current_address = start_address;
                     } else {
                         if (do_display_pc) current_address = reg.pc;
+                        log_next_op();
                     }
 
                     if (result == 99) show_on_completion = true;
@@ -311,6 +412,8 @@ void process_key(uint16_t input) {
                         // Continue running
                         mode = previous_mode;
                         is_running_full = true;
+                        is_core_busy = true;
+                        core_send(&cpu_core, CORE_CMD_RUN, 0, 0);
                     }
                 }
 
@@ -331,7 +434,7 @@ void process_key(uint16_t input) {
 
                 if (input == INPUT_CONF_CANCEL && previous_mode == MENU_MODE_RUN) {
                     led_state = false;
-                    gpio_put(PIN_PICO_LED, false);
+                    set_led(false);
                 }
 
                 // Show the current values
@@ -340,6 +443,7 @@ void process_key(uint16_t input) {
             case MENU_MODE_RUN:
                 // Key press during a run -- treat this as a pause
                 // so show the Confirm Menu to continue or cancel
+                pause_core();
                 previous_mode = mode;
                 mode = MENU_MODE_CONFIRM;
                 mode_changed = true;
@@ -371,7 +475,9 @@ void process_key(uint16_t input) {
                     mode_changed = true;
                 }
 
-                if (input == INPUT_MAIN_RUN_STEP) {
+                // Neither run may start while the remote or the debugger
+                // holds the CPU: each would overwrite its PC
+                if (input == INPUT_MAIN_RUN_STEP && !remote.is_running && !gdb_owns_cpu(&gdb)) {
                     mode = MENU_MODE_STEP;
                     mode_changed = true;
                     is_running_steps = true;
@@ -380,12 +486,15 @@ void process_key(uint16_t input) {
                     do_display_pc = true;
                 }
 
-                if (input == INPUT_MAIN_RUN) {
+                if (input == INPUT_MAIN_RUN && !remote.is_running && !gdb_owns_cpu(&gdb)) {
+                    // Core 1 is idle, so the registers can be set here
                     mode = MENU_MODE_RUN;
                     mode_changed = true;
                     is_running_full = true;
                     start_address = current_address;
                     reg.pc = current_address;
+                    is_core_busy = true;
+                    core_send(&cpu_core, CORE_CMD_RUN, 0, 0);
                 }
 
                 if (input == INPUT_MAIN_MEM_UP || input == INPUT_MAIN_MEM_DOWN) {
@@ -518,21 +627,31 @@ uint8_t keypress_to_value(uint16_t input) {
 
 
 /**
- * @brief Update the display by mode.
+ * @brief Update the display by mode, from a snapshot of the registers.
  */
 void update_display(void) {
 
     uint16_t left = 0;
     uint16_t right = 0;
-    uint16_t address = 0;
-    uint16_t val = 0;
+
+    // Snapshot the state so the display shows a single moment: while
+    // core 1 runs, it publishes one; otherwise the registers are still
+    if (is_core_busy || remote.is_running || gdb.is_running) {
+        CORE_SNAPSHOT snapshot;
+        core_read_snapshot(&cpu_core, &snapshot);
+        shown_reg = snapshot.reg;
+    } else {
+        shown_reg = reg;
+    }
+
+    uint16_t address = is_running_full ? shown_reg.pc : current_address;
+    shown_byte = mem[address];
+
     switch(display_mode) {
         case 0:
-            address = is_running_full ? reg.pc : current_address;
-            val = is_running_full ? (uint16_t)mem[reg.pc] : (uint16_t)mem[current_address];
             display_left(address);
-            display_right(val);
-            printf("0x%04X -> 0x%02X\n", address, val);
+            display_right(shown_byte);
+            LOG_DEBUG("0x%04X -> 0x%02X", address, shown_byte);
             return;
         case 1:
             display_cc();
@@ -541,12 +660,12 @@ void update_display(void) {
             display_ab_dp();
             return;
         case 3:
-            left = reg.x;
-            right = reg.y;
+            left = shown_reg.x;
+            right = shown_reg.y;
             break;
         default:
-            left = reg.s;
-            right = reg.u;
+            left = shown_reg.s;
+            right = shown_reg.u;
     }
 
     display_value(left,  DISPLAY_LEFT,  true, false);
@@ -562,15 +681,15 @@ void display_cc(void) {
     ht16k33_clear(display_address[DISPLAY_RIGHT], display_buffer[DISPLAY_RIGHT]);
 
     for (uint8_t i = 0 ; i < 4 ; ++i) {
-        ht16k33_set_number(display_address[DISPLAY_RIGHT], display_buffer[DISPLAY_RIGHT], ((reg.cc >> i) & 0x01), 3 - i, false);
+        ht16k33_set_number(display_address[DISPLAY_RIGHT], display_buffer[DISPLAY_RIGHT], ((shown_reg.cc >> i) & 0x01), 3 - i, false);
     }
 
     for (uint8_t i = 4 ; i < 8 ; ++i) {
-        ht16k33_set_number(display_address[DISPLAY_LEFT], display_buffer[DISPLAY_LEFT], ((reg.cc >> i) & 0x01), 7 - i, false);
+        ht16k33_set_number(display_address[DISPLAY_LEFT], display_buffer[DISPLAY_LEFT], ((shown_reg.cc >> i) & 0x01), 7 - i, false);
     }
 
-    ht16k33_draw(display_address[DISPLAY_LEFT],  display_buffer[DISPLAY_LEFT]);
-    ht16k33_draw(display_address[DISPLAY_RIGHT], display_buffer[DISPLAY_RIGHT]);
+    ht16k33_queue(display_address[DISPLAY_LEFT],  display_buffer[DISPLAY_LEFT]);
+    ht16k33_queue(display_address[DISPLAY_RIGHT], display_buffer[DISPLAY_RIGHT]);
 }
 
 /**
@@ -582,19 +701,19 @@ void display_ab_dp(void) {
     ht16k33_clear(display_address[DISPLAY_RIGHT], display_buffer[DISPLAY_RIGHT]);
 
     // A register
-    ht16k33_set_number(display_address[DISPLAY_LEFT], display_buffer[DISPLAY_LEFT], ((reg.a >> 4) & 0x0F), 0, false);
-    ht16k33_set_number(display_address[DISPLAY_LEFT], display_buffer[DISPLAY_LEFT], (reg.a & 0x0F), 1, false);
+    ht16k33_set_number(display_address[DISPLAY_LEFT], display_buffer[DISPLAY_LEFT], ((shown_reg.a >> 4) & 0x0F), 0, false);
+    ht16k33_set_number(display_address[DISPLAY_LEFT], display_buffer[DISPLAY_LEFT], (shown_reg.a & 0x0F), 1, false);
 
     // B register
-    ht16k33_set_number(display_address[DISPLAY_LEFT], display_buffer[DISPLAY_LEFT], ((reg.b >> 4) & 0x0F), 3, false);
-    ht16k33_set_number(display_address[DISPLAY_RIGHT], display_buffer[DISPLAY_RIGHT], (reg.b & 0x0F), 0, false);
+    ht16k33_set_number(display_address[DISPLAY_LEFT], display_buffer[DISPLAY_LEFT], ((shown_reg.b >> 4) & 0x0F), 3, false);
+    ht16k33_set_number(display_address[DISPLAY_RIGHT], display_buffer[DISPLAY_RIGHT], (shown_reg.b & 0x0F), 0, false);
 
     // DP register
-    ht16k33_set_number(display_address[DISPLAY_RIGHT], display_buffer[DISPLAY_RIGHT], ((reg.dp >> 4) & 0x0F), 2, false);
-    ht16k33_set_number(display_address[DISPLAY_RIGHT], display_buffer[DISPLAY_RIGHT], (reg.dp & 0x0F), 3, false);
+    ht16k33_set_number(display_address[DISPLAY_RIGHT], display_buffer[DISPLAY_RIGHT], ((shown_reg.dp >> 4) & 0x0F), 2, false);
+    ht16k33_set_number(display_address[DISPLAY_RIGHT], display_buffer[DISPLAY_RIGHT], (shown_reg.dp & 0x0F), 3, false);
 
-    ht16k33_draw(display_address[DISPLAY_LEFT],  display_buffer[DISPLAY_LEFT]);
-    ht16k33_draw(display_address[DISPLAY_RIGHT], display_buffer[DISPLAY_RIGHT]);
+    ht16k33_queue(display_address[DISPLAY_LEFT],  display_buffer[DISPLAY_LEFT]);
+    ht16k33_queue(display_address[DISPLAY_RIGHT], display_buffer[DISPLAY_RIGHT]);
 }
 
 
@@ -643,7 +762,7 @@ void display_value(uint16_t value, uint8_t index, bool is_16_bit, bool show_colo
     ht16k33_set_number(display_address[index], display_buffer[index], value & 0x0F, 3, false);
 
     if (show_colon) ht16k33_show_colon(display_address[index], display_buffer[index], true);
-    ht16k33_draw(display_address[index], display_buffer[index]);
+    ht16k33_queue(display_address[index], display_buffer[index]);
 }
 
 
@@ -664,12 +783,31 @@ bool load_code(void) {
 
 
     // Light the LED to show we're clear to receive
-    gpio_put(PIN_PICO_LED, true);
+    set_led(true);
 
     while(true) {
-        bytes_read = get_block(load_buffer);
+        if (block_count == 0) {
+            // Files in a standard format are parsed as they stream in,
+            // from their first byte: they are not sent in blocks, so
+            // must not be read in 262-byte pieces with a pause between
+            int c = hal_stdio_get(100);
+            if (c != HAL_NO_CHAR) {
+                load_buffer[0] = (uint8_t)c;
+                if (load_buffer[0] != 0x55) return stream_code(load_buffer, 1, start);
+                bytes_read = 1 + get_block(&load_buffer[1], sizeof(load_buffer) - 1);
+            }
+        } else {
+            bytes_read = get_block(load_buffer, sizeof(load_buffer));
+        }
+
         if (bytes_read > 0) {
             block_count++;
+
+            // As are frames of the windowed protocol
+            if (block_count == 1 && load_buffer[1] == UPLOAD_SYNC_WINDOWED) {
+                return windowed_code(load_buffer, bytes_read);
+            }
+
             if (load_buffer[0] == 0x55 && load_buffer[1] == 0x3C) {
                 // Got a valid block header
                 uint8_t block_type = load_buffer[2];
@@ -679,7 +817,7 @@ bool load_code(void) {
                     // Done -- signal the sender back and
                     // turn off the LED
                     printf("OK END\n");
-                    gpio_put(PIN_PICO_LED, false);
+                    set_led(false);
                     current_address = start_addr;
                     return true;
                 }
@@ -723,31 +861,233 @@ bool load_code(void) {
 
     // Signal an error and turn off the LED
     flash_led(5);
-    gpio_put(PIN_PICO_LED, false);
+    set_led(false);
+    return false;
+}
+
+
+/**
+ * @brief Load an S-record, Intel HEX or DECB file sent as-is, writing
+ *        each record into memory as it arrives. The current address is
+ *        set to the file's entry point, or its lowest loaded address.
+ *
+ * @param data:   The first bytes received.
+ * @param length: The number of bytes received.
+ * @param start:  The upload start time, for the timeout.
+ *
+ * @retval Whether the file was loaded.
+ */
+bool stream_code(uint8_t* data, uint16_t length, uint32_t start) {
+
+    LOADER loader;
+    uint32_t shown = 0;
+    loader_init(&loader, mem);
+    uint8_t result = loader_feed(&loader, data, length);
+
+    while (result == LOADER_OK && !loader.is_done) {
+        int c = hal_stdio_get(UPLOAD_IDLE_US);
+        if (c == HAL_NO_CHAR) {
+            // Text files may end without an end record
+            if (loader.records > 0 || time_us_32() - start > UPLOAD_TIMEOUT_US) break;
+            continue;
+        }
+
+        uint8_t byte = (uint8_t)c;
+        result = loader_feed(&loader, &byte, 1);
+        if (loader.records != shown) {
+            shown = loader.records;
+            display_left(shown);
+            ht16k33_flush();
+        }
+    }
+
+    result = loader_finish(&loader);
+    if (result == LOADER_OK) {
+        printf("OK END %i\n", loader.bytes_loaded);
+        current_address = loader.has_entry ? loader.entry : (uint16_t)loader.low_address;
+        set_led(false);
+        return true;
+    }
+
+    LOG_ERROR("Load failed: error %i, line %i", result, loader.line);
+
+    flash_led(5);
+    set_led(false);
     return false;
 }
 
 
 /**
- * @brief Read in a single transmitted block (up to 262 bytes).
+ * @brief Receive an upload using the windowed protocol (see upload.h).
+ *        USB data is read in bulk rather than a character at a time,
+ *        and the display is updated no more than every 100ms. The host
+ *        may instead dump memory, in which case the session ends once
+ *        the host has been idle for a second.
+ *
+ * @param data:   The first bytes received.
+ * @param length: The number of bytes received.
+ *
+ * @retval Whether the upload, or a dump, completed.
+ */
+bool windowed_code(uint8_t* data, uint16_t length) {
+
+    static UPLOAD upload;
+    uint8_t chunk[UPLOAD_READ_SIZE];
+    uint32_t last_rx = time_us_32();
+    uint32_t last_display = last_rx;
+
+    upload_init(&upload, mem, send_upload_reply);
+    upload_feed(&upload, data, length);
+
+    while (!upload.is_done) {
+        uint32_t now = time_us_32();
+        uint32_t count = tud_cdc_available() > 0 ? tud_cdc_read(chunk, sizeof(chunk)) : 0;
+
+        if (count > 0) {
+            upload_feed(&upload, chunk, count);
+            last_rx = now;
+        } else if (now - last_rx > UPLOAD_TIMEOUT_US) {
+            break;
+        } else if (upload.bytes_sent > 0 && !upload.is_active && now - last_rx > UPLOAD_IDLE_US) {
+            break;
+        }
+
+        // Show progress in 256-byte pages
+        if (now - last_display >= UPLOAD_DISPLAY_US) {
+            display_left((upload.bytes_received + upload.bytes_sent) >> 8);
+            ht16k33_flush();
+            last_display = now;
+        }
+    }
+
+    set_led(false);
+    if (upload.is_done) {
+        current_address = upload.start_address;
+        display_left(upload.bytes_received >> 8);
+        return true;
+    }
+
+    if (upload.bytes_sent > 0 && !upload.is_active) {
+        display_left(upload.bytes_sent >> 8);
+        return true;
+    }
+
+    flash_led(5);
+    return false;
+}
+
+
+/**
+ * @brief Send an upload reply, or dumped memory, to the host. Data is
+ *        binary, so it bypasses stdio's CR/LF translation. Anything
+ *        larger than the CDC FIFO is written as space frees up.
+ *
+ * @param data:   Pointer to the reply bytes.
+ * @param length: The number of bytes.
+ */
+void send_upload_reply(const uint8_t* data, uint32_t length) {
+
+    uint32_t last_write = time_us_32();
+
+    while (length > 0) {
+        uint32_t count = tud_cdc_write(data, length);
+        data += count;
+        length -= count;
+
+        if (count > 0) {
+            last_write = time_us_32();
+        } else {
+            // FIFO full: push it out and give up if the host stops reading
+            tud_cdc_write_flush();
+            if (time_us_32() - last_write > UPLOAD_WRITE_TIMEOUT_US) return;
+        }
+    }
+
+    tud_cdc_write_flush();
+}
+
+
+/**
+ * @brief Process any remote-control commands or GDB packets waiting
+ *        on USB, and look for the end of a remote RUN or GDB continue,
+ *        which core 1 runs. Neither blocks, so the keypad stays live.
+ */
+void service_remote(void) {
+
+    uint8_t chunk[UPLOAD_READ_SIZE];
+    uint32_t count = tud_cdc_available() > 0 ? tud_cdc_read(chunk, sizeof(chunk)) : 0;
+    if (count > 0) {
+        // No remote frame starts with '$' or '+', so a GDB packet or
+        // ack arriving between frames hands the link to the GDB stub,
+        // which keeps it until the debugger detaches
+        if (gdb.is_attached || (remote_is_idle(&remote) && (chunk[0] == '$' || chunk[0] == '+'))) {
+            gdb_feed(&gdb, chunk, count);
+        } else {
+            remote_feed(&remote, chunk, count);
+        }
+    }
+
+    if (remote.is_running || gdb.is_running) {
+        set_led(true);
+        bool is_running = remote.is_running ? remote_poll(&remote) : gdb_poll(&gdb);
+        if (!is_running) {
+            // Run over: show where it stopped
+            set_led(false);
+            current_address = reg.pc;
+            update_display();
+        }
+    }
+}
+
+
+/**
+ * @brief Log output: write a line over USB only if it fits in the
+ *        CDC buffer now, so logging never waits on the host.
+ *
+ * @param text:   The line.
+ * @param length: Its length in bytes.
+ *
+ * @retval `true` if the line was written, otherwise `false`.
+ */
+bool send_log(const char* text, uint32_t length) {
+
+    if (!tud_cdc_connected() || tud_cdc_write_available() < length) return false;
+    tud_cdc_write(text, length);
+    tud_cdc_write_flush();
+    return true;
+}
+
+
+/**
+ * @brief Read in a single transmitted block (up to 262 bytes). Reading
+ *        stops when the buffer is full, so no byte is taken from the
+ *        host that cannot be kept.
  *
  * @param buff: A pointer to the byte store buffer,
+ * @param size: The buffer's size in bytes.
  *
  * @retval The index of the last read byte in the buffer.
  */
-uint16_t get_block(uint8_t *buff) {
+uint16_t get_block(uint8_t *buff, uint16_t size) {
 
     uint16_t buff_ptr = 0;
-    while (true) {
-        int c = getchar_timeout_us(100);
-        if (c != PICO_ERROR_TIMEOUT && buff_ptr < 262) {
-            buff[buff_ptr++] = (c & 0xFF);
+    uint32_t last_display = time_us_32();
+    while (buff_ptr < size) {
+        int c = hal_stdio_get(100);
+        if (c == HAL_NO_CHAR) break;
+        buff[buff_ptr++] = (c & 0xFF);
+
+        // Each display update is an I2C transaction: limit them
+        if (time_us_32() - last_display >= UPLOAD_DISPLAY_US) {
             display_left(buff_ptr);
-        } else {
-            break;
+            ht16k33_flush();
+            last_display = time_us_32();
         }
     }
 
-    sleep_ms(10);
+    display_left(buff_ptr);
+    ht16k33_flush();
+
+    hal_sleep_ms(10);
     return buff_ptr;
 }
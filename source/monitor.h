@@ -15,8 +15,17 @@
 /*
  *  CONSTANTS
  */
-#define DEBOUNCE_TIME_US            5000        // 5ms
 #define UPLOAD_TIMEOUT_US           20000000    // 20s
+#define UPLOAD_IDLE_US              1000000     // 1s
+#define UPLOAD_WRITE_TIMEOUT_US     500000      // 0.5s
+#define UPLOAD_DISPLAY_US           100000      // 100ms
+#define UPLOAD_READ_SIZE            512
+
+// In run mode, the displays are redrawn at 25Hz from core 1's snapshot
+#define DISPLAY_REFRESH_US          40000       // 40ms
+
+// Log records sent per pass of the event loop
+#define LOG_DRAIN_RECORDS           4
 
 #define DISPLAY_LEFT                0
 #define DISPLAY_RIGHT               1
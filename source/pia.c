@@ -10,12 +10,10 @@
  */
 
 #include <stdbool.h>
-// Pico
-#include "pico/stdlib.h"
-#include "hardware/gpio.h"
 // App
 #include "main.h"
 #include "cpu.h"
+#include "hal.h"
 #include "pia.h"
 
 
@@ -64,13 +62,13 @@ void pia_reset(MC6821* pia) {
     // Update GPIO directions (set all to input with pullup)
     // See MC6821 Datasheet p.8
     for (uint8_t i = 0 ; i < 8 ; i++) {
-        gpio_set_dir(*(pia->pa_pins + i), GPIO_IN);
-        gpio_pull_up(*(pia->pa_pins + i));
+        hal_gpio_set_dir(*(pia->pa_pins + i), false);
+        hal_gpio_pull(*(pia->pa_pins + i), true);
     }
 
     // Set the CA pins (inputs)
-    gpio_set_dir(*(pia->ca_pins), GPIO_IN);
-    gpio_set_dir(*(pia->ca_pins + 1), GPIO_IN);
+    hal_gpio_set_dir(*(pia->ca_pins), false);
+    hal_gpio_set_dir(*(pia->ca_pins + 1), false);
     
     // Update the Control Register
     
@@ -93,7 +91,7 @@ void pia_process_control(MC6821* pia) {
     if (pia->ca_2_can_interrupt) {
         pia->ca_2_is_output = true;
         if (is_bit_set(reg_value, 4)) {
-            gpio_put(*(pia->ca_pins + 1), is_bit_set(reg_value, 3));
+            hal_gpio_put(*(pia->ca_pins + 1), is_bit_set(reg_value, 3));
         } else {
             // See MCP6821 Datasheet p.10
         }
@@ -125,7 +123,7 @@ void pia_set_gpio_direction(MC6821* pia, uint8_t pin) {
 
     // Pico GPIO directions: false is input, true is output
     uint8_t value = ((*pia->reg_data_a & (1 << pin)) >> pin);
-    gpio_set_dir(*(pia->pa_pins + pin), (value == OUTPUT));
+    hal_gpio_set_dir(*(pia->pa_pins + pin), (value == OUTPUT));
 
     // If the pin is an output, set its pin level according
     // to the output register value
@@ -153,7 +151,7 @@ uint8_t pia_get_gpio_direction(MC6821* pia, uint8_t pin) {
 void pia_set_gpio_output_state(MC6821* pia, uint8_t pin) {
 
     uint8_t value = ((pia->reg_output_a & (1 << pin)) >> pin);
-    gpio_put(*(pia->pa_pins + pin), (value == 1));
+    hal_gpio_put(*(pia->pa_pins + pin), (value == 1));
 }
 
 /**
@@ -162,10 +160,10 @@ void pia_set_gpio_output_state(MC6821* pia, uint8_t pin) {
  */
 void pia_get_gpio_input_state(MC6821* pia, uint8_t pin) {
 
-    if (gpio_get(*(pia->pa_pins + pin))) {
+    if (hal_gpio_get(*(pia->pa_pins + pin))) {
         pia->reg_output_a |= (1 << pin);
     } else {
-        pia->reg_output_a &= !(1 << pin);
+        pia->reg_output_a &= ~(1 << pin);
     }
 }
 
@@ -255,6 +253,6 @@ void pia_check_irqs(void) {
 void pia_set_pia_ca(MC6821* pia) {
 
     if (pia->ca_2_is_output & (*pia->reg_control_a & 0x10) > 0) {
-        gpio_put(*(pia->ca_pins + 1), (*pia->reg_control_a & 0x08 > 0));
+        hal_gpio_put(*(pia->ca_pins + 1), (*pia->reg_control_a & 0x08 > 0));
     }
 }
@@ -0,0 +1,278 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Per-opcode execution profiler: process_next_instruction() counts
+ * each op's executions and cycles into the tables here; this code
+ * derives the per-mode totals and reports them
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+// App
+#include "cpu.h"
+#include "profile.h"
+
+
+/*
+ * STATICS
+ */
+static uint32_t get_word(uint32_t index);
+static void     get_mode_totals(uint32_t* instructions, uint32_t* cycles);
+static int      compare_ops(const void* a, const void* b);
+static void     report_line(void (*out)(const char* text, uint32_t length), const char* label, uint32_t instructions, uint32_t cycles, uint32_t total_cycles);
+
+
+/*
+ * GLOBALS
+ */
+PROFILE     profile;
+
+const char* PROFILE_MODE_NAMES[PROFILE_MODES] = {
+    "unknown", "immediate", "direct", "indexed", "extended", "inherent", "relative"
+};
+
+// By postbyte bits 0-4 with bit 7 set; '?' forms are illegal
+const char* PROFILE_FORM_NAMES[PROFILE_FORMS] = {
+    ",R+",     ",R++",     ",-R",     ",--R",     ",R",       "B,R",       "A,R",     "?",
+    "n8,R",    "n16,R",    "?",       "D,R",      "n8,PC",    "n16,PC",    "?",       "?",
+    "?",       "[,R++]",   "?",       "[,--R]",   "[,R]",     "[B,R]",     "[A,R]",   "?",
+    "[n8,R]",  "[n16,R]",  "?",       "[D,R]",    "[n8,PC]",  "[n16,PC]",  "?",       "[n16]",
+    "n5,R"
+};
+
+
+/**
+ * @brief Zero every counter.
+ */
+void profile_reset(void) {
+
+    memset(&profile, 0, sizeof(PROFILE));
+}
+
+
+/**
+ * @brief Get an op's addressing mode. Prefixed ops share the modes
+ *        of their page 0 counterparts.
+ *
+ * @param opcode: The opcode, less any prefix.
+ *
+ * @retval The MODE_* value, or PROFILE_MODE_RELATIVE for branches.
+ */
+uint8_t profile_mode(uint8_t opcode) {
+
+    uint8_t msn = opcode >> 4;
+    if (msn == 0x02 || opcode == 0x8D || opcode == 0x16 || opcode == 0x17) return PROFILE_MODE_RELATIVE;
+    if (opcode >= 0x30 && opcode <= 0x33) return MODE_INDEXED;
+
+    // Ops with a postbyte or an operand byte
+    if ((opcode >= 0x34 && opcode <= 0x37) || opcode == 0x3C) return MODE_IMMEDIATE;
+    if (opcode == 0x1A || opcode == 0x1C || opcode == 0x1E || opcode == 0x1F) return MODE_IMMEDIATE;
+
+    switch (msn) {
+        case 0x08:
+        case 0x0C:
+            return MODE_IMMEDIATE;
+        case 0x00:
+        case 0x09:
+        case 0x0D:
+            return MODE_DIRECT;
+        case 0x06:
+        case 0x0A:
+        case 0x0E:
+            return MODE_INDEXED;
+        case 0x07:
+        case 0x0B:
+        case 0x0F:
+            return MODE_EXTENDED;
+        default:
+            return MODE_INHERENT;
+    }
+}
+
+
+/**
+ * @brief Copy part of the serialised profile, as laid out in profile.h.
+ *
+ * @param offset: The first byte to copy.
+ * @param data:   Pointer to the destination.
+ * @param count:  The number of bytes wanted.
+ *
+ * @retval The number of bytes copied: fewer than `count` at the end.
+ */
+uint32_t profile_read(uint32_t offset, uint8_t* data, uint32_t count) {
+
+    if (offset >= PROFILE_SIZE) return 0;
+    if (count > PROFILE_SIZE - offset) count = PROFILE_SIZE - offset;
+
+    for (uint32_t i = 0 ; i < count ; ++i) {
+        uint32_t word = get_word((offset + i) >> 2);
+        data[i] = (word >> (8 * (3 - ((offset + i) & 3)))) & 0xFF;
+    }
+
+    return count;
+}
+
+
+/**
+ * @brief Write a text report: ops by cycles used, then totals by
+ *        addressing mode and by indexed form, then the histogram
+ *        of cycles per instruction.
+ *
+ * @param out: Function that writes report text.
+ */
+void profile_report(void (*out)(const char* text, uint32_t length)) {
+
+    static uint16_t order[PROFILE_PAGES * PROFILE_OPCODES];
+    char line[96];
+    char label[24];
+
+    uint32_t mode_instructions[PROFILE_MODES];
+    uint32_t mode_cycles[PROFILE_MODES];
+    get_mode_totals(mode_instructions, mode_cycles);
+
+    uint32_t total_instructions = 0;
+    uint32_t total_cycles = 0;
+    for (uint8_t i = 0 ; i < PROFILE_MODES ; ++i) {
+        total_instructions += mode_instructions[i];
+        total_cycles += mode_cycles[i];
+    }
+
+    uint32_t length = snprintf(line, sizeof(line), "%u instructions, %u cycles\n", total_instructions, total_cycles);
+    out(line, length);
+
+    // Ops, busiest first
+    uint32_t count = 0;
+    for (uint32_t i = 0 ; i < PROFILE_PAGES * PROFILE_OPCODES ; ++i) {
+        if (profile.instructions[i >> 8][i & 0xFF] > 0) order[count++] = i;
+    }
+
+    qsort(order, count, sizeof(uint16_t), compare_ops);
+    length = snprintf(line, sizeof(line), "\nOpcode  Mode           Count        Cycles  Cyc/op  Cycles%%\n");
+    out(line, length);
+    for (uint32_t i = 0 ; i < count ; ++i) {
+        uint8_t page = order[i] >> 8;
+        uint8_t opcode = order[i] & 0xFF;
+        if (page == 0) {
+            snprintf(label, sizeof(label), "   %02X   %-9s", opcode, PROFILE_MODE_NAMES[profile_mode(opcode)]);
+        } else {
+            snprintf(label, sizeof(label), "%02X %02X   %-9s", page == 1 ? OPCODE_EXTENDED_1 : OPCODE_EXTENDED_2, opcode, PROFILE_MODE_NAMES[profile_mode(opcode)]);
+        }
+
+        report_line(out, label, profile.instructions[page][opcode], profile.cycles[page][opcode], total_cycles);
+    }
+
+    length = snprintf(line, sizeof(line), "\nMode                   Count        Cycles  Cyc/op  Cycles%%\n");
+    out(line, length);
+    for (uint8_t i = 1 ; i < PROFILE_MODES ; ++i) {
+        if (mode_instructions[i] == 0) continue;
+        snprintf(label, sizeof(label), "%-17s", PROFILE_MODE_NAMES[i]);
+        report_line(out, label, mode_instructions[i], mode_cycles[i], total_cycles);
+    }
+
+    length = snprintf(line, sizeof(line), "\nIndexed form           Count        Cycles  Cyc/op  Cycles%%\n");
+    out(line, length);
+    for (uint8_t i = 0 ; i < PROFILE_FORMS ; ++i) {
+        if (profile.form_instructions[i] == 0) continue;
+        snprintf(label, sizeof(label), "%-17s", PROFILE_FORM_NAMES[i]);
+        report_line(out, label, profile.form_instructions[i], profile.form_cycles[i], total_cycles);
+    }
+
+    length = snprintf(line, sizeof(line), "\nCycles         Count\n");
+    out(line, length);
+    for (uint8_t i = 0 ; i < PROFILE_HISTOGRAM_SIZE ; ++i) {
+        if (profile.histogram[i] == 0) continue;
+        length = snprintf(line, sizeof(line), "%6u%s %12u\n", i, i == PROFILE_HISTOGRAM_SIZE - 1 ? "+" : " ", profile.histogram[i]);
+        out(line, length);
+    }
+}
+
+
+/**
+ * @brief Get a word of the serialised profile.
+ *
+ * @param index: The word's index.
+ *
+ * @retval The word's value.
+ */
+static uint32_t get_word(uint32_t index) {
+
+    if (index < PROFILE_PAGES * PROFILE_OPCODES) return profile.instructions[index >> 8][index & 0xFF];
+    index -= PROFILE_PAGES * PROFILE_OPCODES;
+    if (index < PROFILE_PAGES * PROFILE_OPCODES) return profile.cycles[index >> 8][index & 0xFF];
+    index -= PROFILE_PAGES * PROFILE_OPCODES;
+
+    if (index < PROFILE_FORMS) return profile.form_instructions[index];
+    index -= PROFILE_FORMS;
+    if (index < PROFILE_FORMS) return profile.form_cycles[index];
+    index -= PROFILE_FORMS;
+    if (index < PROFILE_HISTOGRAM_SIZE) return profile.histogram[index];
+    index -= PROFILE_HISTOGRAM_SIZE;
+
+    uint32_t mode_instructions[PROFILE_MODES];
+    uint32_t mode_cycles[PROFILE_MODES];
+    get_mode_totals(mode_instructions, mode_cycles);
+    return index < PROFILE_MODES ? mode_instructions[index] : mode_cycles[index - PROFILE_MODES];
+}
+
+
+/**
+ * @brief Total the op counters by addressing mode.
+ *
+ * @param instructions: Pointer to PROFILE_MODES instruction counts.
+ * @param cycles:       Pointer to PROFILE_MODES cycle counts.
+ */
+static void get_mode_totals(uint32_t* instructions, uint32_t* cycles) {
+
+    memset(instructions, 0, PROFILE_MODES * sizeof(uint32_t));
+    memset(cycles, 0, PROFILE_MODES * sizeof(uint32_t));
+
+    for (uint8_t page = 0 ; page < PROFILE_PAGES ; ++page) {
+        for (uint32_t opcode = 0 ; opcode < PROFILE_OPCODES ; ++opcode) {
+            uint8_t mode = profile_mode(opcode);
+            instructions[mode] += profile.instructions[page][opcode];
+            cycles[mode] += profile.cycles[page][opcode];
+        }
+    }
+}
+
+
+/**
+ * @brief qsort() comparator: order page/opcode indices by cycles used, most first.
+ */
+static int compare_ops(const void* a, const void* b) {
+
+    uint16_t op_a = *(const uint16_t*)a;
+    uint16_t op_b = *(const uint16_t*)b;
+    uint32_t cycles_a = profile.cycles[op_a >> 8][op_a & 0xFF];
+    uint32_t cycles_b = profile.cycles[op_b >> 8][op_b & 0xFF];
+    if (cycles_a != cycles_b) return cycles_a > cycles_b ? -1 : 1;
+    return op_a < op_b ? -1 : 1;
+}
+
+
+/**
+ * @brief Write a report line: a label then counts, cycles per
+ *        instruction and share of all cycles, to two places.
+ *
+ * @param out:          Function that writes report text.
+ * @param label:        The line's label.
+ * @param instructions: The number of instructions.
+ * @param cycles:       The number of cycles they took.
+ * @param total_cycles: All the cycles in the profile.
+ */
+static void report_line(void (*out)(const char* text, uint32_t length), const char* label, uint32_t instructions, uint32_t cycles, uint32_t total_cycles) {
+
+    char line[96];
+    uint32_t per_op = (uint32_t)(((uint64_t)cycles * 100 + instructions / 2) / instructions);
+    uint32_t share = total_cycles > 0 ? (uint32_t)(((uint64_t)cycles * 10000 + total_cycles / 2) / total_cycles) : 0;
+    uint32_t length = snprintf(line, sizeof(line), "%s %10u %13u %4u.%02u %5u.%02u\n",
+                               label, instructions, cycles, per_op / 100, per_op % 100, share / 100, share % 100);
+    out(line, length);
+}
@@ -0,0 +1,75 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Per-opcode execution profiler
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _PROFILE_HEADER_
+#define _PROFILE_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*
+ *      CONSTANTS
+ */
+// The profiler is only built in when E6809_PROFILE is defined;
+// otherwise process_next_instruction() carries no trace of it
+#define PROFILE_PAGES               3           // Page 0, 0x10- and 0x11-prefixed ops
+#define PROFILE_OPCODES             256
+#define PROFILE_NO_OPCODE           0xFFFF
+
+// Addressing modes: the cpu.h MODE_* values, plus relative for branches
+#define PROFILE_MODE_RELATIVE       6
+#define PROFILE_MODES               7
+
+// Indexed forms: postbyte bits 0-4 when bit 7 is set, then the 5-bit offset
+#define PROFILE_FORM_OFFSET_5       32
+#define PROFILE_FORMS               33
+#define PROFILE_NO_FORM             0xFF
+
+// Instructions taking this many cycles or more share the last bucket
+#define PROFILE_HISTOGRAM_SIZE      32
+
+// profile_read() serialises the counters as big-endian 32-bit words,
+// in this order, each array in index order:
+//   instructions[page][opcode], cycles[page][opcode],
+//   form_instructions[form], form_cycles[form], histogram[cycles],
+//   mode_instructions[mode], mode_cycles[mode]
+#define PROFILE_WORDS               (2 * PROFILE_PAGES * PROFILE_OPCODES + 2 * PROFILE_FORMS + PROFILE_HISTOGRAM_SIZE + 2 * PROFILE_MODES)
+#define PROFILE_SIZE                (PROFILE_WORDS * 4)
+
+
+/*
+ * STRUCTS
+ */
+// Counts wrap at 2^32, so reset the profile between runs of more than
+// about twenty minutes of emulated time
+typedef struct {
+    uint32_t    instructions[PROFILE_PAGES][PROFILE_OPCODES];
+    uint32_t    cycles[PROFILE_PAGES][PROFILE_OPCODES];
+    uint32_t    form_instructions[PROFILE_FORMS];
+    uint32_t    form_cycles[PROFILE_FORMS];
+    uint32_t    histogram[PROFILE_HISTOGRAM_SIZE];
+} PROFILE;
+
+
+/*
+ *      PROTOTYPES
+ */
+void        profile_reset(void);
+uint8_t     profile_mode(uint8_t opcode);
+uint32_t    profile_read(uint32_t offset, uint8_t* data, uint32_t count);
+void        profile_report(void (*out)(const char* text, uint32_t length));
+
+
+#endif  // _PROFILE_HEADER_
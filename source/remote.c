@@ -0,0 +1,728 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Binary remote-control protocol
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+// App
+#include "breakpoint.h"
+#include "cpu.h"
+#include "crc.h"
+#include "coverage.h"
+#include "heatmap.h"
+#include "profile.h"
+#include "remote.h"
+#include "sample.h"
+#include "trace.h"
+
+
+/*
+ * STATICS
+ */
+static void     end_frame(REMOTE* remote);
+static void     do_command(REMOTE* remote, uint8_t command, uint8_t tag, uint16_t length);
+static bool     poll_core(REMOTE* remote);
+static bool     is_core_running(const REMOTE* remote);
+static uint8_t  add_breakpoint(const uint8_t* in);
+static uint16_t get_snapshots(uint8_t* out);
+static void     get_registers(const REG_6809* regs, uint8_t* out);
+static void     set_registers(const uint8_t* in);
+static void     respond(REMOTE* remote, uint8_t command, uint8_t tag, uint8_t status, const uint8_t* data, uint16_t length);
+
+// Parser states
+#define STATE_SYNC_HEAD             0
+#define STATE_SYNC_TYPE             1
+#define STATE_HEADER                2
+#define STATE_PAYLOAD               3
+#define STATE_CRC                   4
+
+
+/*
+ * GLOBALS
+ */
+extern REG_6809     reg;
+extern BREAKPOINTS  breakpoints;
+
+
+/**
+ * @brief Prepare to receive remote commands.
+ *
+ * @param remote: Pointer to a REMOTE struct.
+ * @param memory: Pointer to the 64KB memory space.
+ * @param send:   Function that writes response bytes to the host.
+ */
+void remote_init(REMOTE* remote, uint8_t* memory, void (*send)(const uint8_t* data, uint32_t length)) {
+
+    memset(remote, 0, sizeof(REMOTE));
+    remote->memory = memory;
+    remote->send = send;
+    breakpoint_clear_all();
+}
+
+
+/**
+ * @brief Process bytes received from the host. Frames may be split
+ *        across calls at any point. Each command is actioned, and
+ *        responded to, as soon as its frame completes; none blocks.
+ *
+ * @param remote: Pointer to a REMOTE struct.
+ * @param data:   Pointer to the received bytes.
+ * @param length: The number of bytes.
+ */
+void remote_feed(REMOTE* remote, const uint8_t* data, uint32_t length) {
+
+    uint32_t i = 0;
+
+    while (i < length) {
+        switch (remote->state) {
+            case STATE_SYNC_HEAD:
+                if (data[i++] == REMOTE_SYNC_HEAD) remote->state = STATE_SYNC_TYPE;
+                break;
+
+            case STATE_SYNC_TYPE:
+            {
+                uint8_t byte = data[i++];
+                if (byte == REMOTE_SYNC_REMOTE) {
+                    remote->index = 2;
+                    remote->state = STATE_HEADER;
+                } else if (byte != REMOTE_SYNC_HEAD) {
+                    remote->state = STATE_SYNC_HEAD;
+                }
+
+                break;
+            }
+
+            case STATE_HEADER:
+                remote->header[remote->index++] = data[i++];
+                if (remote->index == REMOTE_HEADER_SIZE) {
+                    // A bad length means a corrupt header: hunt for the next frame
+                    uint16_t size = (remote->header[4] << 8) | remote->header[5];
+                    if (size > REMOTE_MAX_PAYLOAD) {
+                        remote->bad_frames++;
+                        remote->state = STATE_SYNC_HEAD;
+                        break;
+                    }
+
+                    remote->crc = crc32_update(CRC32_INITIAL, &remote->header[2], REMOTE_HEADER_SIZE - 2);
+                    remote->index = 0;
+                    remote->state = size > 0 ? STATE_PAYLOAD : STATE_CRC;
+                }
+
+                break;
+
+            case STATE_PAYLOAD:
+            {
+                uint16_t size = (remote->header[4] << 8) | remote->header[5];
+                uint32_t count = size - remote->index;
+                if (count > length - i) count = length - i;
+
+                memcpy(&remote->payload[remote->index], &data[i], count);
+                remote->crc = crc32_update(remote->crc, &data[i], count);
+                remote->index += count;
+                i += count;
+
+                if (remote->index == size) {
+                    remote->index = 0;
+                    remote->state = STATE_CRC;
+                }
+
+                break;
+            }
+
+            case STATE_CRC:
+                remote->crc_bytes[remote->index++] = data[i++];
+                if (remote->index == REMOTE_CRC_SIZE) {
+                    end_frame(remote);
+                    remote->state = STATE_SYNC_HEAD;
+                }
+        }
+    }
+}
+
+
+/**
+ * @brief Run the CPU for up to REMOTE_SLICE_CYCLES if a RUN command is
+ *        in progress. Call this from the main loop: it returns quickly
+ *        so keypad and USB input are still serviced. The run stops at a
+ *        breakpoint or watchpoint, when the requested cycles are done,
+ *        or when the code returns to the monitor. Breakpoints are only
+ *        checked if some are set. If the run is on a core, this only
+ *        checks whether it has stopped.
+ *
+ * @param remote: Pointer to a REMOTE struct.
+ *
+ * @retval Whether a run is still in progress.
+ */
+bool remote_poll(REMOTE* remote) {
+
+    if (!remote->is_running) return false;
+    if (remote->core != NULL) return poll_core(remote);
+
+    uint32_t (*step)(void) = breakpoint_is_armed() ? breakpoint_step : process_next_instruction;
+    uint32_t slice = 0;
+    while (slice < REMOTE_SLICE_CYCLES) {
+        uint32_t cycles = step();
+        if (cycles == BREAK_TO_MONITOR) {
+            remote_stop(remote, REMOTE_STOP_RETURN);
+            return false;
+        }
+
+        if (cycles == BREAKPOINT_HIT) {
+            remote->cycles_run += breakpoints.hit_cycles;
+            remote_stop(remote, breakpoints.hit_kind == BREAKPOINT_EXECUTE ? REMOTE_STOP_BREAKPOINT : REMOTE_STOP_WATCHPOINT);
+            return false;
+        }
+
+        // Count at least one cycle so a slice always ends
+        slice += cycles > 0 ? cycles : 1;
+        remote->cycles_run += cycles;
+
+        if (remote->has_run_limit) {
+            if (cycles >= remote->cycles_left) {
+                remote->cycles_left = 0;
+                remote_stop(remote, REMOTE_STOP_CYCLES);
+                return false;
+            }
+
+            remote->cycles_left -= cycles;
+        }
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Report a run on the core once it has stopped. A STOP's pause
+ *        is always answered, so if the run ends on its own first, its
+ *        reason is kept until the pause's event is in.
+ *
+ * @param remote: Pointer to a REMOTE struct.
+ *
+ * @retval Whether the run is still in progress.
+ */
+static bool poll_core(REMOTE* remote) {
+
+    MAILBOX_MSG event;
+    while (core_get_event(remote->core, &event)) {
+        if (event.type != CORE_EVENT_STOPPED) continue;
+        remote->cycles_run = event.value;
+        if (event.arg == CORE_STOP_RETURN) remote->stop_reason = REMOTE_STOP_RETURN;
+        if (event.arg == CORE_STOP_CYCLES) remote->stop_reason = REMOTE_STOP_CYCLES;
+        if (event.arg == CORE_STOP_BREAKPOINT) {
+            remote->stop_reason = breakpoints.hit_kind == BREAKPOINT_EXECUTE ? REMOTE_STOP_BREAKPOINT : REMOTE_STOP_WATCHPOINT;
+        }
+
+        if (remote->is_stopping && event.arg != CORE_STOP_PAUSED) continue;
+
+        // The core is idle now, so `reg` and `breakpoints` may be read
+        remote->is_stopping = false;
+        remote_stop(remote, remote->stop_reason);
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Whether a run is in progress on the core, which then owns the
+ *        registers and the breakpoints.
+ *
+ * @param remote: Pointer to a REMOTE struct.
+ *
+ * @retval `true` if the core is running, otherwise `false`.
+ */
+static bool is_core_running(const REMOTE* remote) {
+
+    return remote->core != NULL && remote->is_running;
+}
+
+
+/**
+ * @brief Whether the parser is between frames and no run is in
+ *        progress, so the link may be handed to another protocol.
+ *
+ * @param remote: Pointer to a REMOTE struct.
+ *
+ * @retval `true` if the remote is idle, otherwise `false`.
+ */
+bool remote_is_idle(const REMOTE* remote) {
+
+    return remote->state == STATE_SYNC_HEAD && !remote->is_running;
+}
+
+
+/**
+ * @brief End a run and tell the host why.
+ *
+ * @param remote: Pointer to a REMOTE struct.
+ * @param reason: The REMOTE_STOP_* reason.
+ */
+void remote_stop(REMOTE* remote, uint8_t reason) {
+
+    if (!remote->is_running) return;
+    remote->is_running = false;
+
+    uint8_t out[10] = {
+        reason, reg.pc >> 8, reg.pc & 0xFF,
+        remote->cycles_run >> 24, (remote->cycles_run >> 16) & 0xFF,
+        (remote->cycles_run >> 8) & 0xFF, remote->cycles_run & 0xFF,
+        breakpoints.hit_index, breakpoints.hit_address >> 8, breakpoints.hit_address & 0xFF
+    };
+
+    bool is_hit = reason == REMOTE_STOP_BREAKPOINT || reason == REMOTE_STOP_WATCHPOINT;
+    respond(remote, REMOTE_EVENT_STOPPED, 0, REMOTE_STATUS_OK, out, is_hit ? 10 : 7);
+}
+
+
+/**
+ * @brief Verify a completed frame's CRC and action the command.
+ *
+ * @param remote: Pointer to a REMOTE struct.
+ */
+static void end_frame(REMOTE* remote) {
+
+    uint8_t command = remote->header[2];
+    uint8_t tag = remote->header[3];
+    uint16_t length = (remote->header[4] << 8) | remote->header[5];
+    uint32_t crc = (remote->crc_bytes[0] << 24) | (remote->crc_bytes[1] << 16)
+                 | (remote->crc_bytes[2] << 8) | remote->crc_bytes[3];
+
+    if ((remote->crc ^ CRC32_FINAL_XOR) != crc) {
+        remote->bad_frames++;
+        respond(remote, command, tag, REMOTE_STATUS_BAD_CRC, NULL, 0);
+        return;
+    }
+
+    do_command(remote, command, tag, length);
+}
+
+
+/**
+ * @brief Action a command and respond to it.
+ *
+ * @param remote:  Pointer to a REMOTE struct.
+ * @param command: The REMOTE_CMD_* value.
+ * @param tag:     The host's tag, returned in the response.
+ * @param length:  The payload length.
+ */
+static void do_command(REMOTE* remote, uint8_t command, uint8_t tag, uint16_t length) {
+
+    const uint8_t* payload = remote->payload;
+    uint16_t address = (payload[0] << 8) | payload[1];
+    uint8_t out[REMOTE_REGS_SIZE];
+
+    // A run on the core owns memory and the breakpoints: changing them
+    // from here would race it
+    bool is_change = command == REMOTE_CMD_POKE || command == REMOTE_CMD_BREAK_SET || command == REMOTE_CMD_BREAK_CLEAR
+                  || command == REMOTE_CMD_BREAK_CLEAR_ALL || command == REMOTE_CMD_BREAK_ADD || command == REMOTE_CMD_BREAK_REMOVE;
+    if (is_change && is_core_running(remote)) {
+        respond(remote, command, tag, REMOTE_STATUS_BUSY, NULL, 0);
+        return;
+    }
+
+    switch (command) {
+        case REMOTE_CMD_PING:
+            out[0] = REMOTE_VERSION;
+            respond(remote, command, tag, REMOTE_STATUS_OK, out, 1);
+            return;
+
+        case REMOTE_CMD_PEEK:
+        {
+            if (length != 4) break;
+            uint16_t count = (payload[2] << 8) | payload[3];
+            if (count > REMOTE_MAX_PAYLOAD - 1 || address + count > KB64) break;
+            respond(remote, command, tag, REMOTE_STATUS_OK, &remote->memory[address], count);
+            return;
+        }
+
+        case REMOTE_CMD_POKE:
+            if (length < 2 || address + length - 2 > KB64) break;
+            memcpy(&remote->memory[address], &payload[2], length - 2);
+            cpu_mark_dirty(address, length - 2);
+            respond(remote, command, tag, REMOTE_STATUS_OK, NULL, 0);
+            return;
+
+        case REMOTE_CMD_GET_REGS:
+            if (is_core_running(remote)) {
+                CORE_SNAPSHOT snapshot;
+                core_read_snapshot(remote->core, &snapshot);
+                get_registers(&snapshot.reg, out);
+            } else {
+                get_registers(&reg, out);
+            }
+
+            respond(remote, command, tag, REMOTE_STATUS_OK, out, REMOTE_REGS_SIZE);
+            return;
+
+        case REMOTE_CMD_SET_REGS:
+            if (length != REMOTE_REGS_SIZE) break;
+            if (remote->is_running) {
+                respond(remote, command, tag, REMOTE_STATUS_BUSY, NULL, 0);
+                return;
+            }
+
+            set_registers(payload);
+            respond(remote, command, tag, REMOTE_STATUS_OK, NULL, 0);
+            return;
+
+        case REMOTE_CMD_RUN:
+            if (length != 4) break;
+            if (remote->is_running) {
+                respond(remote, command, tag, REMOTE_STATUS_BUSY, NULL, 0);
+                return;
+            }
+
+            // The run itself happens in remote_poll(), or on the core
+            remote->cycles_left = (payload[0] << 24) | (payload[1] << 16) | (payload[2] << 8) | payload[3];
+            remote->has_run_limit = remote->cycles_left > 0;
+            remote->cycles_run = 0;
+            if (remote->core != NULL) {
+                // The core passes the breakpoint the run starts from
+                if (!core_send(remote->core, CORE_CMD_RUN, 0, remote->cycles_left)) {
+                    respond(remote, command, tag, REMOTE_STATUS_BUSY, NULL, 0);
+                    return;
+                }
+
+                remote->stop_reason = REMOTE_STOP_HALTED;
+            } else {
+                // Don't stop at the breakpoint the run starts from
+                breakpoint_resume();
+            }
+
+            remote->is_running = true;
+            respond(remote, command, tag, REMOTE_STATUS_OK, NULL, 0);
+            return;
+
+        case REMOTE_CMD_STEP:
+            if (remote->is_running) {
+                respond(remote, command, tag, REMOTE_STATUS_BUSY, NULL, 0);
+                return;
+            }
+
+            process_next_instruction();
+            get_registers(&reg, out);
+            respond(remote, command, tag, REMOTE_STATUS_OK, out, REMOTE_REGS_SIZE);
+            return;
+
+        case REMOTE_CMD_STOP:
+            respond(remote, command, tag, REMOTE_STATUS_OK, NULL, 0);
+            if (is_core_running(remote)) {
+                // Reported by remote_poll() once the core has paused
+                if (!remote->is_stopping) remote->is_stopping = core_send(remote->core, CORE_CMD_PAUSE, 0, 0);
+            } else {
+                remote_stop(remote, REMOTE_STOP_HALTED);
+            }
+
+            return;
+
+        case REMOTE_CMD_BREAK_SET:
+        {
+            if (length != 2) break;
+            BREAKPOINT breakpoint = {address, address, BREAKPOINT_EXECUTE, BREAKPOINT_ACTION_STOP, BREAKPOINT_IF_ALWAYS, 0, 0, 0, 0, false};
+            bool is_set = breakpoint_find(address, BREAKPOINT_EXECUTE) != BREAKPOINT_NONE || breakpoint_set(&breakpoint) != BREAKPOINT_NONE;
+            respond(remote, command, tag, is_set ? REMOTE_STATUS_OK : REMOTE_STATUS_FULL, NULL, 0);
+            return;
+        }
+
+        case REMOTE_CMD_BREAK_CLEAR:
+            if (length != 2) break;
+            breakpoint_clear(breakpoint_find(address, BREAKPOINT_EXECUTE));
+            respond(remote, command, tag, REMOTE_STATUS_OK, NULL, 0);
+            return;
+
+        case REMOTE_CMD_BREAK_CLEAR_ALL:
+            breakpoint_clear_all();
+            respond(remote, command, tag, REMOTE_STATUS_OK, NULL, 0);
+            return;
+
+        case REMOTE_CMD_BREAK_ADD:
+        {
+            if (length != 14) break;
+            uint8_t index = add_breakpoint(payload);
+            if (index == BREAKPOINT_NONE) {
+                // Bad settings as well as a full table
+                respond(remote, command, tag, REMOTE_STATUS_FULL, NULL, 0);
+                return;
+            }
+
+            respond(remote, command, tag, REMOTE_STATUS_OK, &index, 1);
+            return;
+        }
+
+        case REMOTE_CMD_BREAK_REMOVE:
+            if (length != 1) break;
+            breakpoint_clear(payload[0]);
+            respond(remote, command, tag, REMOTE_STATUS_OK, NULL, 0);
+            return;
+
+        case REMOTE_CMD_SNAPSHOTS:
+        {
+            // The request has no payload, so its buffer can hold the reply
+            uint16_t count = get_snapshots(remote->payload);
+            respond(remote, command, tag, REMOTE_STATUS_OK, remote->payload, count);
+            return;
+        }
+
+        case REMOTE_CMD_STATUS:
+            if (is_core_running(remote)) {
+                CORE_SNAPSHOT snapshot;
+                core_read_snapshot(remote->core, &snapshot);
+                remote->cycles_run = snapshot.cycles;
+            }
+
+            out[0] = remote->is_running ? 1 : 0;
+            out[1] = remote->cycles_run >> 24;
+            out[2] = (remote->cycles_run >> 16) & 0xFF;
+            out[3] = (remote->cycles_run >> 8) & 0xFF;
+            out[4] = remote->cycles_run & 0xFF;
+            respond(remote, command, tag, REMOTE_STATUS_OK, out, 5);
+            return;
+
+        case REMOTE_CMD_HEATMAP:
+            if (length != 1 || payload[0] > REMOTE_HEATMAP_RESET) break;
+            if (payload[0] == REMOTE_HEATMAP_OFF) heatmap_stop();
+            if (payload[0] == REMOTE_HEATMAP_ON) heatmap_start(NULL);
+            if (payload[0] == REMOTE_HEATMAP_RESET) heatmap_reset();
+            respond(remote, command, tag, REMOTE_STATUS_OK, NULL, 0);
+            return;
+
+        case REMOTE_CMD_HEATMAP_READ:
+        {
+            if (length != 6) break;
+            uint32_t offset = (payload[0] << 24) | (payload[1] << 16) | (payload[2] << 8) | payload[3];
+            uint16_t count = (payload[4] << 8) | payload[5];
+            if (count > REMOTE_MAX_PAYLOAD - 1) break;
+
+            // The request has been read, so its buffer can hold the reply
+            count = heatmap_read(offset, remote->payload, count);
+            respond(remote, command, tag, REMOTE_STATUS_OK, remote->payload, count);
+            return;
+        }
+
+        case REMOTE_CMD_COVERAGE:
+            if (length != 1 || payload[0] > REMOTE_COVERAGE_RESET) break;
+            if (payload[0] == REMOTE_COVERAGE_OFF) coverage_stop();
+            if (payload[0] == REMOTE_COVERAGE_ON) coverage_start();
+            if (payload[0] == REMOTE_COVERAGE_RESET) coverage_reset();
+            respond(remote, command, tag, REMOTE_STATUS_OK, NULL, 0);
+            return;
+
+        case REMOTE_CMD_COVERAGE_READ:
+        {
+            if (length != 6) break;
+            uint32_t offset = (payload[0] << 24) | (payload[1] << 16) | (payload[2] << 8) | payload[3];
+            uint16_t count = (payload[4] << 8) | payload[5];
+            if (count > REMOTE_MAX_PAYLOAD - 1) break;
+
+            count = coverage_read(offset, remote->payload, count);
+            respond(remote, command, tag, REMOTE_STATUS_OK, remote->payload, count);
+            return;
+        }
+
+#ifdef E6809_PROFILE
+        case REMOTE_CMD_PROFILE:
+        {
+            if (length != 6) break;
+            uint32_t offset = (payload[0] << 24) | (payload[1] << 16) | (payload[2] << 8) | payload[3];
+            uint16_t count = (payload[4] << 8) | payload[5];
+            if (count > REMOTE_MAX_PAYLOAD - 1) break;
+
+            // The request has been read, so its buffer can hold the reply
+            count = profile_read(offset, remote->payload, count);
+            respond(remote, command, tag, REMOTE_STATUS_OK, remote->payload, count);
+            return;
+        }
+
+        case REMOTE_CMD_PROFILE_RESET:
+            profile_reset();
+            respond(remote, command, tag, REMOTE_STATUS_OK, NULL, 0);
+            return;
+#endif
+
+#ifdef E6809_SAMPLE
+        case REMOTE_CMD_SAMPLE_START:
+            if (length != 4) break;
+            sample_start((payload[0] << 24) | (payload[1] << 16) | (payload[2] << 8) | payload[3]);
+            respond(remote, command, tag, REMOTE_STATUS_OK, NULL, 0);
+            return;
+
+        case REMOTE_CMD_SAMPLE_READ:
+        {
+            // The request has no payload, so its buffer can hold the reply
+            uint32_t dropped = sample_dropped();
+            remote->payload[0] = dropped >> 24;
+            remote->payload[1] = (dropped >> 16) & 0xFF;
+            remote->payload[2] = (dropped >> 8) & 0xFF;
+            remote->payload[3] = dropped & 0xFF;
+            uint32_t count = sample_read(&remote->payload[4], REMOTE_MAX_PAYLOAD - 5);
+            respond(remote, command, tag, REMOTE_STATUS_OK, remote->payload, count + 4);
+            return;
+        }
+#endif
+
+#ifdef E6809_TRACE
+        case REMOTE_CMD_TRACE:
+            if (length != 1) break;
+            if (payload[0] != 0) {
+                trace_start();
+            } else {
+                trace_stop();
+            }
+
+            respond(remote, command, tag, REMOTE_STATUS_OK, NULL, 0);
+            return;
+
+        case REMOTE_CMD_TRACE_READ:
+        {
+            // The request has no payload, so its buffer can hold the reply
+            uint32_t dropped = trace_dropped();
+            remote->payload[0] = dropped >> 24;
+            remote->payload[1] = (dropped >> 16) & 0xFF;
+            remote->payload[2] = (dropped >> 8) & 0xFF;
+            remote->payload[3] = dropped & 0xFF;
+            uint32_t count = trace_read(&remote->payload[4], REMOTE_MAX_PAYLOAD - 5);
+            respond(remote, command, tag, REMOTE_STATUS_OK, remote->payload, count + 4);
+            return;
+        }
+#endif
+
+        default:
+            respond(remote, command, tag, REMOTE_STATUS_BAD_COMMAND, NULL, 0);
+            return;
+    }
+
+    // Commands that break out of the switch have a bad payload
+    respond(remote, command, tag, REMOTE_STATUS_BAD_LENGTH, NULL, 0);
+}
+
+
+/**
+ * @brief Set a breakpoint or watchpoint from a BREAK_ADD payload.
+ *
+ * @param in: Pointer to the 14-byte payload.
+ *
+ * @retval The breakpoint's index, or BREAKPOINT_NONE.
+ */
+static uint8_t add_breakpoint(const uint8_t* in) {
+
+    BREAKPOINT breakpoint;
+    breakpoint.kinds = in[0];
+    breakpoint.start = (in[1] << 8) | in[2];
+    breakpoint.end = (in[3] << 8) | in[4];
+    breakpoint.action = in[5];
+    breakpoint.condition = in[6];
+    breakpoint.reg_index = in[7];
+    breakpoint.value = (in[8] << 8) | in[9];
+    breakpoint.count = (in[10] << 24) | (in[11] << 16) | (in[12] << 8) | in[13];
+    return breakpoint_set(&breakpoint);
+}
+
+
+/**
+ * @brief Pack the breakpoint snapshots, newest first: index, kind,
+ *        address (2), hits (4), then the registers as get_registers()
+ *        lays them out.
+ *
+ * @param out: Pointer to room for BREAKPOINT_SNAPSHOTS snapshots.
+ *
+ * @retval The number of bytes written.
+ */
+static uint16_t get_snapshots(uint8_t* out) {
+
+    BREAKPOINT_SNAPSHOT snapshots[BREAKPOINT_SNAPSHOTS];
+    uint8_t count = breakpoint_snapshots(snapshots, BREAKPOINT_SNAPSHOTS);
+
+    for (uint8_t i = 0 ; i < count ; ++i) {
+        uint8_t* item = &out[i * REMOTE_SNAPSHOT_SIZE];
+        item[0] = snapshots[i].index;
+        item[1] = snapshots[i].kind;
+        item[2] = snapshots[i].address >> 8;
+        item[3] = snapshots[i].address & 0xFF;
+        item[4] = snapshots[i].hits >> 24;
+        item[5] = (snapshots[i].hits >> 16) & 0xFF;
+        item[6] = (snapshots[i].hits >> 8) & 0xFF;
+        item[7] = snapshots[i].hits & 0xFF;
+        get_registers(&snapshots[i].regs, &item[8]);
+    }
+
+    return count * REMOTE_SNAPSHOT_SIZE;
+}
+
+
+/**
+ * @brief Pack registers, big-endian: A, B, X, Y, U, S, PC, CC, DP.
+ *
+ * @param regs: Pointer to the registers.
+ * @param out:  Pointer to REMOTE_REGS_SIZE bytes.
+ */
+static void get_registers(const REG_6809* regs, uint8_t* out) {
+
+    uint16_t words[5] = {regs->x, regs->y, regs->u, regs->s, regs->pc};
+
+    out[0] = regs->a;
+    out[1] = regs->b;
+    for (uint8_t i = 0 ; i < 5 ; ++i) {
+        out[2 + i * 2] = words[i] >> 8;
+        out[3 + i * 2] = words[i] & 0xFF;
+    }
+
+    out[12] = regs->cc;
+    out[13] = regs->dp;
+}
+
+
+/**
+ * @brief Unpack the registers, as laid out by get_registers().
+ *
+ * @param in: Pointer to REMOTE_REGS_SIZE bytes.
+ */
+static void set_registers(const uint8_t* in) {
+
+    reg.a = in[0];
+    reg.b = in[1];
+    reg.x = (in[2] << 8) | in[3];
+    reg.y = (in[4] << 8) | in[5];
+    reg.u = (in[6] << 8) | in[7];
+    reg.s = (in[8] << 8) | in[9];
+    reg.pc = (in[10] << 8) | in[11];
+    reg.cc = in[12];
+    reg.dp = in[13];
+}
+
+
+/**
+ * @brief Send a response frame to the host.
+ *
+ * @param remote:  Pointer to a REMOTE struct.
+ * @param command: The command being answered.
+ * @param tag:     The command's tag.
+ * @param status:  The REMOTE_STATUS_* value.
+ * @param data:    Pointer to any response data, or NULL.
+ * @param length:  The number of data bytes.
+ */
+static void respond(REMOTE* remote, uint8_t command, uint8_t tag, uint8_t status, const uint8_t* data, uint16_t length) {
+
+    uint16_t size = length + 1;
+    uint8_t header[REMOTE_HEADER_SIZE + 1] = {
+        REMOTE_SYNC_HEAD, REMOTE_SYNC_REMOTE, command | REMOTE_RESPONSE_BIT, tag, size >> 8, size & 0xFF, status
+    };
+
+    uint32_t crc = crc32_update(CRC32_INITIAL, &header[2], REMOTE_HEADER_SIZE - 1);
+    if (length > 0) crc = crc32_update(crc, data, length);
+    crc ^= CRC32_FINAL_XOR;
+    uint8_t tail[REMOTE_CRC_SIZE] = {crc >> 24, (crc >> 16) & 0xFF, (crc >> 8) & 0xFF, crc & 0xFF};
+
+    remote->send(header, sizeof(header));
+    if (length > 0) remote->send(data, length);
+    remote->send(tail, REMOTE_CRC_SIZE);
+}
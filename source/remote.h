@@ -0,0 +1,147 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Binary remote-control protocol
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _REMOTE_HEADER_
+#define _REMOTE_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "core.h"
+
+
+/*
+ *      CONSTANTS
+ */
+// Frame layout: sync (2), command, tag, payload length (2), payload,
+// CRC32 (4) of everything after the sync. Responses use the same
+// layout: the command with bit 7 set, the request's tag, and a
+// payload that starts with a status byte
+#define REMOTE_SYNC_HEAD            0x55
+#define REMOTE_SYNC_REMOTE          0x3E
+#define REMOTE_HEADER_SIZE          6
+#define REMOTE_CRC_SIZE             4
+#define REMOTE_MAX_PAYLOAD          1024
+#define REMOTE_RESPONSE_BIT         0x80
+
+#define REMOTE_CMD_PING             0x01        // -> version (1)
+#define REMOTE_CMD_PEEK             0x02        // address (2), count (2) -> bytes
+#define REMOTE_CMD_POKE             0x03        // address (2), bytes
+#define REMOTE_CMD_GET_REGS         0x04        // -> registers (14)
+#define REMOTE_CMD_SET_REGS         0x05        // registers (14)
+#define REMOTE_CMD_RUN              0x06        // cycles (4), 0 to run until stopped
+#define REMOTE_CMD_STEP             0x07        // -> registers (14)
+#define REMOTE_CMD_STOP             0x08
+#define REMOTE_CMD_BREAK_SET        0x09        // address (2)
+#define REMOTE_CMD_BREAK_CLEAR      0x0A        // address (2)
+#define REMOTE_CMD_BREAK_CLEAR_ALL  0x0B        // Watchpoints too
+#define REMOTE_CMD_STATUS           0x0C        // -> running (1), cycles (4)
+#define REMOTE_CMD_PROFILE          0x0D        // offset (4), count (2) -> profile bytes
+#define REMOTE_CMD_PROFILE_RESET    0x0E
+#define REMOTE_CMD_SAMPLE_START     0x0F        // period (4), 0 to stop
+#define REMOTE_CMD_SAMPLE_READ      0x10        // -> samples dropped (4), samples
+#define REMOTE_CMD_HEATMAP          0x11        // mode (1): 0 off, 1 on, 2 zero counters
+#define REMOTE_CMD_HEATMAP_READ     0x12        // offset (4), count (2) -> page counter bytes
+#define REMOTE_CMD_TRACE            0x13        // on (1): 1 to start, 0 to stop
+#define REMOTE_CMD_TRACE_READ       0x14        // -> records dropped (4), encoded records
+#define REMOTE_CMD_BREAK_ADD        0x15        // kinds (1), start (2), end (2), action (1), condition (1),
+                                                // register (1), value (2), count (4) -> index (1)
+#define REMOTE_CMD_BREAK_REMOVE     0x16        // index (1)
+#define REMOTE_CMD_SNAPSHOTS        0x17        // -> snapshots, newest first
+#define REMOTE_CMD_COVERAGE         0x18        // mode (1): 0 off, 1 on, 2 clear maps
+#define REMOTE_CMD_COVERAGE_READ    0x19        // offset (4), count (2) -> map bytes
+
+// BREAK_SET and BREAK_CLEAR handle plain execute breakpoints. BREAK_ADD
+// sets any breakpoint or watchpoint; see breakpoint.h for the values.
+// Each snapshot is index (1), kind (1), address (2), hits (4), registers (14)
+
+// The profile commands are only answered by firmware built with
+// E6809_PROFILE; see profile.h for the data's layout. The sample
+// commands need E6809_SAMPLE; see sample_read() for the samples' format.
+// The trace commands need E6809_TRACE; see trace.h for the encoding.
+// The heatmap counts by page only on the board; see heatmap.h for the
+// data's layout. See coverage.h for the coverage maps' layout
+
+// Sent unprompted, tag 0, when a run ends:
+// status, reason (1), PC (2), cycles run (4). A breakpoint or watchpoint
+// stop adds its index (1) and the address hit (2)
+#define REMOTE_EVENT_STOPPED        0xC0
+
+#define REMOTE_STATUS_OK            0x00
+#define REMOTE_STATUS_BAD_CRC       0x01
+#define REMOTE_STATUS_BAD_COMMAND   0x02
+#define REMOTE_STATUS_BAD_LENGTH    0x03
+#define REMOTE_STATUS_BUSY          0x04        // Not while the CPU is running
+#define REMOTE_STATUS_FULL          0x05        // No free breakpoint
+
+#define REMOTE_HEATMAP_OFF          0x00
+#define REMOTE_HEATMAP_ON           0x01
+#define REMOTE_HEATMAP_RESET        0x02
+
+#define REMOTE_COVERAGE_OFF         0x00
+#define REMOTE_COVERAGE_ON          0x01
+#define REMOTE_COVERAGE_RESET       0x02
+
+#define REMOTE_STOP_CYCLES          0x00        // Ran the requested cycles
+#define REMOTE_STOP_BREAKPOINT      0x01
+#define REMOTE_STOP_RETURN          0x02        // Code returned to the monitor
+#define REMOTE_STOP_HALTED          0x03        // STOP command
+#define REMOTE_STOP_WATCHPOINT      0x04        // After the op that made the access
+
+// Registers, big-endian: A, B, X, Y, U, S, PC, CC, DP
+#define REMOTE_REGS_SIZE            14
+#define REMOTE_SNAPSHOT_SIZE        22
+#define REMOTE_VERSION              1
+
+// Most cycles remote_poll() will run in one call, so the caller's
+// loop keeps servicing the keypad and USB while code runs. Runs given
+// to a core are not sliced: remote_poll() just looks for their end
+#define REMOTE_SLICE_CYCLES         2000
+
+
+/*
+ * STRUCTS
+ */
+typedef struct {
+    uint8_t*    memory;
+    void        (*send)(const uint8_t* data, uint32_t length);
+    // Frame parser state
+    uint8_t     state;
+    uint8_t     header[REMOTE_HEADER_SIZE];
+    uint8_t     payload[REMOTE_MAX_PAYLOAD];
+    uint8_t     crc_bytes[REMOTE_CRC_SIZE];
+    uint32_t    index;
+    uint32_t    crc;
+    uint32_t    bad_frames;
+    // Run state
+    CORE*       core;           // If set, runs go to this core, not remote_poll()
+    bool        is_running;
+    bool        is_stopping;    // The core has been asked to pause
+    uint8_t     stop_reason;    // For a run on the core
+    bool        has_run_limit;
+    uint32_t    cycles_left;
+    uint32_t    cycles_run;
+} REMOTE;
+
+
+/*
+ *      PROTOTYPES
+ */
+void        remote_init(REMOTE* remote, uint8_t* memory, void (*send)(const uint8_t* data, uint32_t length));
+void        remote_feed(REMOTE* remote, const uint8_t* data, uint32_t length);
+bool        remote_poll(REMOTE* remote);
+bool        remote_is_idle(const REMOTE* remote);
+void        remote_stop(REMOTE* remote, uint8_t reason);
+
+
+#endif  // _REMOTE_HEADER_
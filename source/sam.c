@@ -0,0 +1,115 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Synchronous Address Multiplexer (SAM)
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+
+#include <stdbool.h>
+// App
+#include "sam.h"
+
+
+/**
+ * @brief Clear the SAM's control register, as on power-up.
+ *
+ * @param sam: Pointer to an MC6883 struct.
+ */
+void sam_reset(MC6883* sam) {
+
+    sam->reg_control = 0;
+}
+
+
+/**
+ * @brief Process a CPU write into the SAM's address range.
+ *        The SAM ignores the data: each control bit has a pair of
+ *        addresses, the even one clearing the bit, the odd one
+ *        setting it.
+ *
+ *        See MC6883 Data Sheet p.11
+ *
+ * @param sam:     Pointer to an MC6883 struct.
+ * @param address: The 16-bit address written to.
+ */
+void sam_write(MC6883* sam, uint16_t address) {
+
+    if (address < SAM_REG_START || address > SAM_REG_END) return;
+
+    uint8_t bit = (address - SAM_REG_START) >> 1;
+    if (address & 0x01) {
+        sam->reg_control |= (1 << bit);
+    } else {
+        sam->reg_control &= ~(1 << bit);
+    }
+}
+
+
+/**
+ * @brief Get the VDG addressing mode, V0-V2.
+ *
+ * @param sam: Pointer to an MC6883 struct.
+ *
+ * @retval The mode, 0-7.
+ */
+uint8_t sam_get_vdg_mode(MC6883* sam) {
+
+    return (sam->reg_control >> SAM_BIT_V0) & SAM_MASK_V;
+}
+
+
+/**
+ * @brief Get the start address of video memory, set by F0-F6
+ *        in 512-byte units.
+ *
+ * @param sam: Pointer to an MC6883 struct.
+ *
+ * @retval The 16-bit display start address.
+ */
+uint16_t sam_get_display_offset(MC6883* sam) {
+
+    return ((sam->reg_control >> SAM_BIT_F0) & SAM_MASK_F) * SAM_DISPLAY_OFFSET_UNIT;
+}
+
+
+/**
+ * @brief Get the MPU rate, R0-R1.
+ *
+ * @param sam: Pointer to an MC6883 struct.
+ *
+ * @retval The rate: 0 = slow, 1 = address-dependent, 2-3 = fast.
+ */
+uint8_t sam_get_cpu_rate(MC6883* sam) {
+
+    return (sam->reg_control >> SAM_BIT_R0) & SAM_MASK_R;
+}
+
+
+/**
+ * @brief Get the memory size, M0-M1.
+ *
+ * @param sam: Pointer to an MC6883 struct.
+ *
+ * @retval The size: 0 = 4KB, 1 = 16KB, 2-3 = 64KB.
+ */
+uint8_t sam_get_memory_size(MC6883* sam) {
+
+    return (sam->reg_control >> SAM_BIT_M0) & SAM_MASK_M;
+}
+
+
+/**
+ * @brief Is the SAM in map type 1, ie. 64KB of RAM with no ROM?
+ *
+ * @param sam: Pointer to an MC6883 struct.
+ *
+ * @retval `true` if TY is set, otherwise `false`.
+ */
+bool sam_is_all_ram(MC6883* sam) {
+
+    return ((sam->reg_control >> SAM_BIT_TY) & 0x01) == 1;
+}
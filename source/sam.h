@@ -0,0 +1,66 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Synchronous Address Multiplexer (SAM)
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _SAM_HEADER_
+#define _SAM_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*
+ *      CONSTANTS
+ */
+#define SAM_REG_START               0xFFC0
+#define SAM_REG_END                 0xFFDF
+
+// Bit positions of the SAM's control register fields
+// See MC6883 Data Sheet p.11
+#define SAM_BIT_V0                  0
+#define SAM_BIT_F0                  3
+#define SAM_BIT_P1                  10
+#define SAM_BIT_R0                  11
+#define SAM_BIT_M0                  13
+#define SAM_BIT_TY                  15
+
+#define SAM_MASK_V                  0x07
+#define SAM_MASK_F                  0x7F
+#define SAM_MASK_R                  0x03
+#define SAM_MASK_M                  0x03
+
+#define SAM_DISPLAY_OFFSET_UNIT     512
+
+
+/*
+ * STRUCTS
+ */
+typedef struct {
+    uint16_t    reg_control;
+} MC6883;
+
+
+/*
+ *      PROTOTYPES
+ */
+void        sam_reset(MC6883* sam);
+void        sam_write(MC6883* sam, uint16_t address);
+
+uint8_t     sam_get_vdg_mode(MC6883* sam);
+uint16_t    sam_get_display_offset(MC6883* sam);
+uint8_t     sam_get_cpu_rate(MC6883* sam);
+uint8_t     sam_get_memory_size(MC6883* sam);
+bool        sam_is_all_ram(MC6883* sam);
+
+
+#endif  // _SAM_HEADER_
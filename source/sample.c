@@ -0,0 +1,179 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Sampling PC profiler: cpu.c reports calls and returns, which this
+ * code mirrors in a shadow call stack, and every sample period it
+ * stores the PC and the stack's return addresses in a ring. The ring
+ * has one producer, the CPU, and one reader
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <string.h>
+// App
+#include "sample.h"
+
+
+/*
+ * GLOBALS
+ */
+SAMPLE_RING     sample_ring;
+
+// Cycles to the next sample; cpu.c counts it down
+int32_t         sample_countdown = INT32_MAX;
+
+static uint32_t sample_period = 0;
+
+// Each call's return address and the S value after it was stacked.
+// A frame is live while S is at or below that value
+static uint16_t shadow_addresses[SAMPLE_STACK_SIZE];
+static uint16_t shadow_sps[SAMPLE_STACK_SIZE];
+static uint32_t shadow_depth = 0;
+
+
+/**
+ * @brief Start sampling, or stop it. Call tracking continues either way,
+ *        so the stack is known when sampling starts.
+ *
+ * @param period: Emulated cycles between samples, or 0 to stop.
+ */
+void sample_start(uint32_t period) {
+
+    sample_period = period;
+    sample_countdown = period > 0 ? (int32_t)period : INT32_MAX;
+}
+
+
+/**
+ * @brief Record a call: a JSR, BSR, SWI or interrupt has just stacked
+ *        its return address.
+ *
+ * @param return_address: Where the call will return to.
+ * @param sp:             S after the return address was stacked.
+ */
+void sample_call(uint16_t return_address, uint16_t sp) {
+
+    // Frames at or below the new one were abandoned without a return
+    while (shadow_depth > 0 && shadow_sps[shadow_depth - 1] <= sp) shadow_depth--;
+
+    // Calls deeper than the shadow stack are not tracked, but the
+    // frames above them still unwind correctly by S
+    if (shadow_depth < SAMPLE_STACK_SIZE) {
+        shadow_addresses[shadow_depth] = return_address;
+        shadow_sps[shadow_depth] = sp;
+        shadow_depth++;
+    }
+}
+
+
+/**
+ * @brief Record a return: an RTS, RTI or PULS PC has just unstacked
+ *        a return address.
+ *
+ * @param sp: S after the return.
+ */
+void sample_return(uint16_t sp) {
+
+    while (shadow_depth > 0 && shadow_sps[shadow_depth - 1] < sp) shadow_depth--;
+}
+
+
+/**
+ * @brief Store a sample and set the countdown to the next one. If the
+ *        ring is full, the sample is dropped.
+ *
+ * @param pc: The address of the next op.
+ * @param sp: The current S value.
+ */
+void sample_take(uint16_t pc, uint16_t sp) {
+
+    sample_countdown = sample_period > 0 ? sample_countdown + (int32_t)sample_period : INT32_MAX;
+    if (sample_period == 0) return;
+
+    // Catch frames discarded by stack adjustments rather than returns
+    sample_return(sp);
+
+    uint32_t head = atomic_load_explicit(&sample_ring.head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&sample_ring.tail, memory_order_acquire);
+    if (head - tail == SAMPLE_RING_SIZE) {
+        uint32_t dropped = atomic_load_explicit(&sample_ring.dropped, memory_order_relaxed);
+        atomic_store_explicit(&sample_ring.dropped, dropped + 1, memory_order_relaxed);
+        return;
+    }
+
+    SAMPLE* sample = &sample_ring.samples[head & (SAMPLE_RING_SIZE - 1)];
+    uint32_t depth = shadow_depth < SAMPLE_MAX_DEPTH ? shadow_depth : SAMPLE_MAX_DEPTH;
+    memcpy(sample->stack, &shadow_addresses[shadow_depth - depth], depth * sizeof(uint16_t));
+    sample->depth = depth | (shadow_depth > SAMPLE_MAX_DEPTH ? SAMPLE_TRUNCATED : 0);
+    sample->pc = pc;
+    atomic_store_explicit(&sample_ring.head, head + 1, memory_order_release);
+}
+
+
+/**
+ * @brief Take the oldest stored sample.
+ *
+ * @param sample: Where to copy the sample.
+ *
+ * @retval Whether there was a sample.
+ */
+bool sample_get(SAMPLE* sample) {
+
+    uint32_t tail = atomic_load_explicit(&sample_ring.tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&sample_ring.head, memory_order_acquire);
+    if (head == tail) return false;
+
+    *sample = sample_ring.samples[tail & (SAMPLE_RING_SIZE - 1)];
+    atomic_store_explicit(&sample_ring.tail, tail + 1, memory_order_release);
+    return true;
+}
+
+
+/**
+ * @brief Take as many stored samples as fit in a buffer, each as its
+ *        depth byte, its return addresses outermost first, then the
+ *        PC, addresses big-endian.
+ *
+ * @param data:  Pointer to the buffer.
+ * @param count: The buffer's size.
+ *
+ * @retval The number of bytes written.
+ */
+uint32_t sample_read(uint8_t* data, uint32_t count) {
+
+    uint32_t length = 0;
+
+    while (true) {
+        uint32_t tail = atomic_load_explicit(&sample_ring.tail, memory_order_relaxed);
+        uint32_t head = atomic_load_explicit(&sample_ring.head, memory_order_acquire);
+        if (head == tail) break;
+
+        const SAMPLE* sample = &sample_ring.samples[tail & (SAMPLE_RING_SIZE - 1)];
+        uint32_t depth = sample->depth & ~SAMPLE_TRUNCATED;
+        if (length + 3 + 2 * depth > count) break;
+
+        data[length++] = sample->depth;
+        for (uint32_t i = 0 ; i < depth ; ++i) {
+            data[length++] = sample->stack[i] >> 8;
+            data[length++] = sample->stack[i] & 0xFF;
+        }
+
+        data[length++] = sample->pc >> 8;
+        data[length++] = sample->pc & 0xFF;
+        atomic_store_explicit(&sample_ring.tail, tail + 1, memory_order_release);
+    }
+
+    return length;
+}
+
+
+/**
+ * @brief The number of samples dropped so far because the ring was full.
+ */
+uint32_t sample_dropped(void) {
+
+    return atomic_load_explicit(&sample_ring.dropped, memory_order_relaxed);
+}
+
@@ -0,0 +1,68 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Sampling PC profiler
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _SAMPLE_HEADER_
+#define _SAMPLE_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+
+/*
+ *      CONSTANTS
+ */
+// The sampler is only built in when E6809_SAMPLE is defined. It keeps
+// a shadow of the return addresses the guest has stacked -- by JSR,
+// BSR, LBSR, SWIs and interrupts -- and every period it stores the PC
+// and that call stack in a ring for the host to collect
+#define SAMPLE_STACK_SIZE           64          // Deepest call chain tracked
+#define SAMPLE_MAX_DEPTH            16          // Innermost return addresses kept per sample
+#define SAMPLE_RING_SIZE            128         // Must be a power of two
+#define SAMPLE_DEFAULT_PERIOD       997         // Cycles; prime, so as not to beat with guest loops
+
+// Set in a sample's depth when the stack was deeper than SAMPLE_MAX_DEPTH
+#define SAMPLE_TRUNCATED            0x80
+
+
+/*
+ * STRUCTS
+ */
+typedef struct {
+    uint16_t    pc;
+    uint8_t     depth;                          // Return addresses held, plus SAMPLE_TRUNCATED
+    uint16_t    stack[SAMPLE_MAX_DEPTH];        // Outermost first
+} SAMPLE;
+
+typedef struct {
+    SAMPLE              samples[SAMPLE_RING_SIZE];
+    _Atomic uint32_t    head;       // Written by the CPU
+    _Atomic uint32_t    tail;       // Written by the reader
+    _Atomic uint32_t    dropped;    // Written by the CPU
+} SAMPLE_RING;
+
+
+/*
+ *      PROTOTYPES
+ */
+void        sample_start(uint32_t period);
+void        sample_call(uint16_t return_address, uint16_t sp);
+void        sample_return(uint16_t sp);
+void        sample_take(uint16_t pc, uint16_t sp);
+bool        sample_get(SAMPLE* sample);
+uint32_t    sample_read(uint8_t* data, uint32_t count);
+uint32_t    sample_dropped(void);
+
+
+#endif  // _SAMPLE_HEADER_
@@ -0,0 +1,292 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Instruction tracer: while it is on, process_next_instruction() stores
+ * a record of each op in a ring, without locks; this code drains the
+ * ring, delta-encoding the records as laid out in trace.h. The ring
+ * has one producer, the CPU, and one reader
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <string.h>
+// App
+#include "cpu.h"
+#include "disasm.h"
+#include "trace.h"
+
+
+/*
+ * STATICS
+ */
+static uint32_t encode(const TRACE_RECORD* record, uint8_t* data);
+static void     remember(const TRACE_RECORD* record);
+static uint32_t put_word(uint8_t* data, uint16_t value);
+
+
+/*
+ * GLOBALS
+ */
+TRACE_RING      trace_ring;
+
+// Checked by process_next_instruction() before each op
+bool            trace_is_on = false;
+
+// Set when a record is dropped or tracing starts, so the next one stored is marked
+static bool     trace_is_gap = true;
+
+// The reader's encoding state: the last record sent, whether there is
+// one, and the op bytes last sent for each address low byte
+static TRACE_RECORD last_record;
+static bool         is_synced = false;
+static uint16_t     cache_pcs[TRACE_BYTE_CACHE_SIZE];
+static uint8_t      cache_lengths[TRACE_BYTE_CACHE_SIZE];
+static uint8_t      cache_bytes[TRACE_BYTE_CACHE_SIZE][TRACE_MAX_BYTES];
+
+
+/**
+ * @brief Start tracing, or restart it. The next record is marked as
+ *        following a gap.
+ */
+void trace_start(void) {
+
+    trace_is_gap = true;
+    trace_is_on = true;
+}
+
+
+/**
+ * @brief Stop tracing. Records already stored can still be read.
+ */
+void trace_stop(void) {
+
+    trace_is_on = false;
+}
+
+
+/**
+ * @brief Get the ring slot for the next record. If the ring is full,
+ *        the record is dropped and the next one stored is marked.
+ *
+ * @retval Pointer to the slot, or NULL.
+ */
+TRACE_RECORD* trace_next(void) {
+
+    uint32_t head = atomic_load_explicit(&trace_ring.head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&trace_ring.tail, memory_order_acquire);
+    if (head - tail == TRACE_RING_SIZE) {
+        uint32_t dropped = atomic_load_explicit(&trace_ring.dropped, memory_order_relaxed);
+        atomic_store_explicit(&trace_ring.dropped, dropped + 1, memory_order_relaxed);
+        trace_is_gap = true;
+        return NULL;
+    }
+
+    TRACE_RECORD* record = &trace_ring.records[head & (TRACE_RING_SIZE - 1)];
+    record->flags = trace_is_gap ? TRACE_GAP : 0;
+    trace_is_gap = false;
+    return record;
+}
+
+
+/**
+ * @brief Publish the record filled in since trace_next().
+ */
+void trace_commit(void) {
+
+    uint32_t head = atomic_load_explicit(&trace_ring.head, memory_order_relaxed);
+    atomic_store_explicit(&trace_ring.head, head + 1, memory_order_release);
+}
+
+
+/**
+ * @brief Take the oldest stored record.
+ *
+ * @param record: Where to copy the record.
+ *
+ * @retval Whether there was a record.
+ */
+bool trace_get(TRACE_RECORD* record) {
+
+    uint32_t tail = atomic_load_explicit(&trace_ring.tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&trace_ring.head, memory_order_acquire);
+    if (head == tail) return false;
+
+    *record = trace_ring.records[tail & (TRACE_RING_SIZE - 1)];
+    record->length = (record->flags & TRACE_INTERRUPT) ? 0 : disasm_length(record->bytes);
+    atomic_store_explicit(&trace_ring.tail, tail + 1, memory_order_release);
+    return true;
+}
+
+
+/**
+ * @brief Take as many stored records as fit in a buffer, delta-encoded
+ *        as laid out in trace.h.
+ *
+ * @param data:  Pointer to the buffer.
+ * @param count: The buffer's size.
+ *
+ * @retval The number of bytes written.
+ */
+uint32_t trace_read(uint8_t* data, uint32_t count) {
+
+    // Room for a gap marker and a record with every field. Records are
+    // encoded straight into the buffer while it has that much room left
+    static uint8_t encoded[32];
+    uint32_t length = 0;
+    uint32_t tail = atomic_load_explicit(&trace_ring.tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&trace_ring.head, memory_order_acquire);
+
+    while (tail != head) {
+        // The slot is the reader's until the tail moves past it
+        TRACE_RECORD* record = &trace_ring.records[tail & (TRACE_RING_SIZE - 1)];
+        record->length = (record->flags & TRACE_INTERRUPT) ? 0 : disasm_length(record->bytes);
+
+        if (count - length >= sizeof(encoded)) {
+            length += encode(record, &data[length]);
+        } else {
+            uint32_t size = encode(record, encoded);
+            if (length + size > count) break;
+            memcpy(&data[length], encoded, size);
+            length += size;
+        }
+
+        remember(record);
+        tail++;
+    }
+
+    atomic_store_explicit(&trace_ring.tail, tail, memory_order_release);
+    return length;
+}
+
+
+/**
+ * @brief The number of records dropped so far because the ring was full.
+ */
+uint32_t trace_dropped(void) {
+
+    return atomic_load_explicit(&trace_ring.dropped, memory_order_relaxed);
+}
+
+
+/**
+ * @brief Drop every stored record unread, eg. to time the CPU's side
+ *        of tracing alone. The next record read is sent whole.
+ */
+void trace_discard(void) {
+
+    uint32_t head = atomic_load_explicit(&trace_ring.head, memory_order_acquire);
+    atomic_store_explicit(&trace_ring.tail, head, memory_order_release);
+    is_synced = false;
+}
+
+
+/**
+ * @brief Delta-encode a record against the last one sent. The
+ *        encoding state is not changed; see remember().
+ *
+ * @param record: Pointer to the record.
+ * @param data:   Pointer to the output buffer.
+ *
+ * @retval The number of bytes written.
+ */
+static uint32_t encode(const TRACE_RECORD* record, uint8_t* data) {
+
+    uint32_t length = 0;
+
+    // After a gap, send a marker and then the record whole
+    bool is_whole = !is_synced || (record->flags & TRACE_GAP);
+    if (is_whole) {
+        data[length++] = TRACE_HEADER_CYCLES;
+        data[length++] = 0;
+    }
+
+    uint8_t* header = &data[length++];
+    *header = record->cycles < TRACE_HEADER_CYCLES ? record->cycles : TRACE_HEADER_CYCLES;
+    if (record->cycles >= TRACE_HEADER_CYCLES) data[length++] = record->cycles;
+
+    if (is_whole || record->pc != last_record.regs.pc) {
+        *header |= TRACE_HEADER_PC;
+        length += put_word(&data[length], record->pc);
+    }
+
+    uint8_t slot = record->pc & (TRACE_BYTE_CACHE_SIZE - 1);
+    if (is_whole || cache_pcs[slot] != record->pc || cache_lengths[slot] != record->length
+        || memcmp(cache_bytes[slot], record->bytes, record->length) != 0) {
+        *header |= TRACE_HEADER_BYTES;
+        data[length++] = record->length;
+        memcpy(&data[length], record->bytes, record->length);
+        length += record->length;
+    }
+
+    if (!(record->flags & TRACE_NO_ADDRESS)) {
+        *header |= TRACE_HEADER_ADDRESS;
+        length += put_word(&data[length], record->address);
+    }
+
+    uint8_t mask = 0xFF;
+    if (!is_whole) {
+        mask = 0;
+        if (record->regs.cc != last_record.regs.cc) mask |= TRACE_REG_CC;
+        if (record->regs.a != last_record.regs.a) mask |= TRACE_REG_A;
+        if (record->regs.b != last_record.regs.b) mask |= TRACE_REG_B;
+        if (record->regs.dp != last_record.regs.dp) mask |= TRACE_REG_DP;
+        if (record->regs.x != last_record.regs.x) mask |= TRACE_REG_X;
+        if (record->regs.y != last_record.regs.y) mask |= TRACE_REG_Y;
+        if (record->regs.u != last_record.regs.u) mask |= TRACE_REG_U;
+        if (record->regs.s != last_record.regs.s) mask |= TRACE_REG_S;
+    }
+
+    if (mask != 0) {
+        *header |= TRACE_HEADER_REGS;
+        data[length++] = mask;
+        if (mask & TRACE_REG_CC) data[length++] = record->regs.cc;
+        if (mask & TRACE_REG_A) data[length++] = record->regs.a;
+        if (mask & TRACE_REG_B) data[length++] = record->regs.b;
+        if (mask & TRACE_REG_DP) data[length++] = record->regs.dp;
+        if (mask & TRACE_REG_X) length += put_word(&data[length], record->regs.x);
+        if (mask & TRACE_REG_Y) length += put_word(&data[length], record->regs.y);
+        if (mask & TRACE_REG_U) length += put_word(&data[length], record->regs.u);
+        if (mask & TRACE_REG_S) length += put_word(&data[length], record->regs.s);
+    }
+
+    if (record->regs.pc != (uint16_t)(record->pc + record->length)) {
+        *header |= TRACE_HEADER_NEXT_PC;
+        length += put_word(&data[length], record->regs.pc);
+    }
+
+    return length;
+}
+
+
+/**
+ * @brief Make a record sent the one the next is encoded against.
+ *
+ * @param record: Pointer to the record.
+ */
+static void remember(const TRACE_RECORD* record) {
+
+    // A gap marker empties the reader's op byte cache
+    if (!is_synced || (record->flags & TRACE_GAP)) memset(cache_lengths, 0xFF, sizeof(cache_lengths));
+
+    uint8_t slot = record->pc & (TRACE_BYTE_CACHE_SIZE - 1);
+    cache_pcs[slot] = record->pc;
+    cache_lengths[slot] = record->length;
+    memcpy(cache_bytes[slot], record->bytes, record->length);
+    last_record = *record;
+    is_synced = true;
+}
+
+
+/**
+ * @brief Write a 16-bit value, big-endian.
+ *
+ * @retval The number of bytes written.
+ */
+static uint32_t put_word(uint8_t* data, uint16_t value) {
+
+    data[0] = value >> 8;
+    data[1] = value & 0xFF;
+    return 2;
+}
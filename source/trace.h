@@ -0,0 +1,110 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Instruction tracer
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _TRACE_HEADER_
+#define _TRACE_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "cpu.h"
+#include "disasm.h"
+
+
+/*
+ *      CONSTANTS
+ */
+// The tracer is only built in when E6809_TRACE is defined. While it
+// is on, each instruction, and each interrupt entry, is stored as a
+// TRACE_RECORD in a ring that the host drains with trace_read()
+#ifndef TRACE_RING_SIZE
+#define TRACE_RING_SIZE             512         // Must be a power of two
+#endif
+#define TRACE_MAX_BYTES             DISASM_MAX_BYTES
+#define TRACE_NO_ADDRESS            0x01        // Record flag: the op has no effective address
+#define TRACE_GAP                   0x02        // Record flag: records before this one were lost
+#define TRACE_INTERRUPT             0x04        // Record flag: an interrupt entry, not an op
+
+// trace_read() delta-encodes records against the one before. Each
+// starts with a header byte:
+//   bit 7    PC follows (2): the op is not where the last one left the PC
+//   bit 6    Op bytes follow: length (1), then the bytes. Otherwise they
+//            match the last op seen at an address with the same low byte
+//   bit 5    Effective address follows (2)
+//   bit 4    Register mask follows (1), then each register it flags that
+//            changed, in TRACE_REG_* order, 8 or 16 bits
+//   bit 3    Next PC follows (2): the op branched, jumped or returned
+//   bits 0-2 Cycles taken, or 7 if a cycles byte follows
+// A header of 0x07 followed by a cycles byte of 0 marks a gap: records
+// were dropped, or tracing restarted. The next record is sent whole
+#define TRACE_HEADER_PC             0x80
+#define TRACE_HEADER_BYTES          0x40
+#define TRACE_HEADER_ADDRESS        0x20
+#define TRACE_HEADER_REGS           0x10
+#define TRACE_HEADER_NEXT_PC        0x08
+#define TRACE_HEADER_CYCLES         0x07
+#define TRACE_BYTE_CACHE_SIZE       256
+
+#define TRACE_REG_CC                0x01
+#define TRACE_REG_A                 0x02
+#define TRACE_REG_B                 0x04
+#define TRACE_REG_DP                0x08
+#define TRACE_REG_X                 0x10
+#define TRACE_REG_Y                 0x20
+#define TRACE_REG_U                 0x40
+#define TRACE_REG_S                 0x80
+
+// Trace files hold this, then trace_read() output
+#define TRACE_FILE_MAGIC            "e6809tr1"
+#define TRACE_FILE_MAGIC_SIZE       8
+
+
+/*
+ * STRUCTS
+ */
+// The registers are those after the op, so `regs.pc` is the next op's
+// address. The CPU stores the bytes at the op's address; the reader
+// works out how many of them are the op's. An interrupt entry has none
+typedef struct {
+    REG_6809    regs;
+    uint16_t    pc;
+    uint16_t    address;
+    uint8_t     cycles;
+    uint8_t     flags;
+    uint8_t     length;
+    uint8_t     bytes[TRACE_MAX_BYTES];
+} TRACE_RECORD;
+
+typedef struct {
+    TRACE_RECORD        records[TRACE_RING_SIZE];
+    _Atomic uint32_t    head;       // Written by the CPU
+    _Atomic uint32_t    tail;       // Written by the reader
+    _Atomic uint32_t    dropped;    // Written by the CPU
+} TRACE_RING;
+
+
+/*
+ *      PROTOTYPES
+ */
+void            trace_start(void);
+void            trace_stop(void);
+TRACE_RECORD*   trace_next(void);
+void            trace_commit(void);
+bool            trace_get(TRACE_RECORD* record);
+uint32_t        trace_read(uint8_t* data, uint32_t count);
+uint32_t        trace_dropped(void);
+void            trace_discard(void);
+
+
+#endif  // _TRACE_HEADER_
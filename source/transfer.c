@@ -0,0 +1,164 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Asynchronous bus transfer queue
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#include <stddef.h>
+#include <string.h>
+// App
+#include "transfer.h"
+
+
+/*
+ * STATICS
+ */
+static void start_next(uint8_t bus);
+
+
+/*
+ * GLOBALS
+ */
+const TRANSFER_PORT*    transfer_port = NULL;
+TRANSFER_BUS            transfer_buses[TRANSFER_BUS_COUNT];
+TRANSFER_STATS          transfer_stats;
+
+
+/**
+ * @brief Empty the queues and attach the hardware that will run them.
+ *
+ * @param port: The hardware port, or NULL to stop queueing.
+ */
+void transfer_init(const TRANSFER_PORT* port) {
+
+    memset(transfer_buses, 0, sizeof(transfer_buses));
+    memset(&transfer_stats, 0, sizeof(transfer_stats));
+    transfer_port = port;
+}
+
+
+/**
+ * @brief Whether transfers are being queued. If not, drivers should
+ *        write to their buses directly.
+ *
+ * @retval `true` if a port is attached, otherwise `false`.
+ */
+bool transfer_is_running(void) {
+
+    return transfer_port != NULL;
+}
+
+
+/**
+ * @brief Queue a transfer. The data is copied, so the caller can
+ *        reuse its buffer at once. Jobs on a bus run in the order they
+ *        were queued; the buses run independently.
+ *
+ * @param bus:         TRANSFER_BUS_I2C or TRANSFER_BUS_SPI.
+ * @param target:      The I2C address, or the SPI chip-select pin.
+ * @param data:        The bytes to write.
+ * @param length:      The number of bytes to write.
+ * @param read_length: I2C only: the number of bytes to read after the write.
+ * @param done:        Called from transfer_poll() when the job ends, or NULL.
+ * @param context:     Stored in the job for `done`.
+ *
+ * @retval `true` if the job was queued, `false` if there was no room or
+ *         no port, or the job is too large.
+ */
+bool transfer_queue(uint8_t bus, uint8_t target, const uint8_t* data, uint16_t length, uint16_t read_length,
+                    void (*done)(TRANSFER_JOB* job, bool is_ok), void* context) {
+
+    if (transfer_port == NULL || bus >= TRANSFER_BUS_COUNT) return false;
+    if (length > TRANSFER_MAX_DATA || read_length > TRANSFER_MAX_DATA) return false;
+
+    // Retire finished jobs first to make room
+    transfer_poll();
+
+    TRANSFER_BUS* queue = &transfer_buses[bus];
+    if (queue->count == TRANSFER_QUEUE_SIZE) {
+        transfer_stats.full++;
+        return false;
+    }
+
+    TRANSFER_JOB* job = &queue->jobs[(queue->head + queue->count) % TRANSFER_QUEUE_SIZE];
+    job->target = target;
+    job->length = length;
+    job->read_length = read_length;
+    memcpy(job->data, data, length);
+    job->done = done;
+    job->context = context;
+    queue->count++;
+    transfer_stats.queued++;
+
+    if (!queue->is_active) start_next(bus);
+    return true;
+}
+
+
+/**
+ * @brief Retire any finished jobs, calling their `done` functions, and
+ *        start the next job on each idle bus. Never waits on hardware.
+ */
+void transfer_poll(void) {
+
+    if (transfer_port == NULL) return;
+
+    for (uint8_t bus = 0 ; bus < TRANSFER_BUS_COUNT ; ++bus) {
+        TRANSFER_BUS* queue = &transfer_buses[bus];
+        if (!queue->is_active) continue;
+
+        TRANSFER_JOB* job = &queue->jobs[queue->head];
+        uint8_t result = transfer_port->check(bus, job);
+        if (result == TRANSFER_BUSY) continue;
+
+        if (result == TRANSFER_OK) {
+            transfer_stats.completed++;
+        } else {
+            transfer_stats.failed++;
+        }
+
+        // Free the slot before the callback, which may queue more, so
+        // hand the callback a copy
+        TRANSFER_JOB finished = *job;
+        queue->is_active = false;
+        queue->head = (queue->head + 1) % TRANSFER_QUEUE_SIZE;
+        queue->count--;
+        if (finished.done != NULL) finished.done(&finished, result == TRANSFER_OK);
+
+        if (!queue->is_active) start_next(bus);
+    }
+}
+
+
+/**
+ * @brief Whether every queue is empty.
+ *
+ * @retval `true` if no job is waiting or in flight, otherwise `false`.
+ */
+bool transfer_is_idle(void) {
+
+    for (uint8_t bus = 0 ; bus < TRANSFER_BUS_COUNT ; ++bus) {
+        if (transfer_buses[bus].count > 0) return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Hand a bus's oldest job, if any, to the port.
+ *
+ * @param bus: The bus to start.
+ */
+static void start_next(uint8_t bus) {
+
+    TRANSFER_BUS* queue = &transfer_buses[bus];
+    if (queue->count == 0) return;
+
+    queue->is_active = true;
+    transfer_port->start(bus, &queue->jobs[queue->head]);
+}
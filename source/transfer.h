@@ -0,0 +1,85 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Asynchronous bus transfer queue
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _TRANSFER_HEADER_
+#define _TRANSFER_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*
+ *      CONSTANTS
+ */
+#define TRANSFER_BUS_I2C            0
+#define TRANSFER_BUS_SPI            1
+#define TRANSFER_BUS_COUNT          2
+
+// Jobs waiting or in flight per bus, and the most bytes one can carry:
+// a full keypad LED frame is 72 bytes, a full display write 17
+#define TRANSFER_QUEUE_SIZE         4
+#define TRANSFER_MAX_DATA           80
+
+// What a port reports for the job in flight
+#define TRANSFER_BUSY               0
+#define TRANSFER_OK                 1
+#define TRANSFER_FAILED             2
+
+
+/*
+ * STRUCTS
+ */
+typedef struct _TRANSFER_JOB {
+    uint8_t     target;         // I2C address, or SPI chip-select pin
+    uint16_t    length;         // Bytes to write
+    uint16_t    read_length;    // I2C only: bytes to read back into `data` after the write
+    uint8_t     data[TRANSFER_MAX_DATA];
+    void        (*done)(struct _TRANSFER_JOB* job, bool is_ok);
+    void*       context;
+} TRANSFER_JOB;
+
+// The hardware side: start() begins a job and check() reports on it.
+// Neither may block
+typedef struct {
+    void        (*start)(uint8_t bus, TRANSFER_JOB* job);
+    uint8_t     (*check)(uint8_t bus, TRANSFER_JOB* job);
+} TRANSFER_PORT;
+
+typedef struct {
+    TRANSFER_JOB    jobs[TRANSFER_QUEUE_SIZE];
+    uint8_t         head;       // The oldest job, in flight if `is_active`
+    uint8_t         count;
+    bool            is_active;
+} TRANSFER_BUS;
+
+typedef struct {
+    uint32_t    queued;
+    uint32_t    completed;
+    uint32_t    failed;
+    uint32_t    full;           // Times a job was refused for want of space
+} TRANSFER_STATS;
+
+
+/*
+ *      PROTOTYPES
+ */
+void        transfer_init(const TRANSFER_PORT* port);
+bool        transfer_is_running(void);
+bool        transfer_queue(uint8_t bus, uint8_t target, const uint8_t* data, uint16_t length, uint16_t read_length,
+                           void (*done)(TRANSFER_JOB* job, bool is_ok), void* context);
+void        transfer_poll(void);
+bool        transfer_is_idle(void);
+
+
+#endif  // _TRANSFER_HEADER_
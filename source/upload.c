@@ -0,0 +1,460 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Windowed upload protocol
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+// App
+#include "crc.h"
+#include "upload.h"
+
+
+/*
+ * STATICS
+ */
+static void     begin_payload(UPLOAD* upload);
+static void     end_frame(UPLOAD* upload);
+static void     start_transfer(UPLOAD* upload, uint16_t seq);
+static void     accept_data(UPLOAD* upload, uint16_t seq);
+static void     end_transfer(UPLOAD* upload, uint16_t seq);
+static void     send_hashes(UPLOAD* upload, uint16_t seq);
+static void     send_dump(UPLOAD* upload);
+static bool     get_range(UPLOAD* upload, uint32_t* start, uint32_t* total);
+static void     reply(UPLOAD* upload, uint8_t code, uint16_t seq);
+
+// Parser states
+#define STATE_SYNC_HEAD             0
+#define STATE_SYNC_TYPE             1
+#define STATE_HEADER                2
+#define STATE_PAYLOAD               3
+#define STATE_CRC                   4
+
+
+/**
+ * @brief Prepare to receive an upload.
+ *
+ * @param upload: Pointer to an UPLOAD struct.
+ * @param memory: Pointer to the 64KB memory space to load into.
+ * @param send:   Function that writes reply bytes to the host.
+ */
+void upload_init(UPLOAD* upload, uint8_t* memory, void (*send)(const uint8_t* data, uint32_t length)) {
+
+    memset(upload, 0, sizeof(UPLOAD));
+    upload->memory = memory;
+    upload->send = send;
+}
+
+
+/**
+ * @brief Process bytes received from the host. Frames may be split
+ *        across calls at any point; payloads are copied straight into
+ *        memory and their CRCs checked when each frame completes.
+ *        Replies are sent as frames complete.
+ *
+ * @param upload: Pointer to an UPLOAD struct.
+ * @param data:   Pointer to the received bytes.
+ * @param length: The number of bytes.
+ */
+void upload_feed(UPLOAD* upload, const uint8_t* data, uint32_t length) {
+
+    uint32_t i = 0;
+
+    while (i < length) {
+        switch (upload->state) {
+            case STATE_SYNC_HEAD:
+                if (data[i++] == UPLOAD_SYNC_HEAD) upload->state = STATE_SYNC_TYPE;
+                break;
+
+            case STATE_SYNC_TYPE:
+            {
+                uint8_t byte = data[i++];
+                if (byte == UPLOAD_SYNC_WINDOWED) {
+                    upload->header[0] = UPLOAD_SYNC_HEAD;
+                    upload->header[1] = byte;
+                    upload->index = 2;
+                    upload->state = STATE_HEADER;
+                } else if (byte != UPLOAD_SYNC_HEAD) {
+                    upload->state = STATE_SYNC_HEAD;
+                }
+
+                break;
+            }
+
+            case STATE_HEADER:
+                upload->header[upload->index++] = data[i++];
+                if (upload->index == UPLOAD_HEADER_SIZE) begin_payload(upload);
+                break;
+
+            case STATE_PAYLOAD:
+            {
+                // Take as much of the payload as is available in one go
+                uint16_t address = (upload->header[6] << 8) | upload->header[7];
+                uint16_t size = (upload->header[8] << 8) | upload->header[9];
+                uint32_t count = size - upload->index;
+                if (count > length - i) count = length - i;
+
+                if (upload->is_wanted) {
+                    if (upload->is_compressed) {
+                        lz4_feed(&upload->lz4, &data[i], count);
+                    } else {
+                        memcpy(&upload->memory[address + upload->index], &data[i], count);
+                    }
+                } else if (upload->header[2] != UPLOAD_FRAME_DATA && upload->header[2] != UPLOAD_FRAME_PATCH) {
+                    memcpy(&upload->control[upload->index], &data[i], count);
+                }
+
+                upload->crc = crc32_update(upload->crc, &data[i], count);
+                upload->index += count;
+                i += count;
+
+                if (upload->index == size) {
+                    upload->index = 0;
+                    upload->state = STATE_CRC;
+                }
+
+                break;
+            }
+
+            case STATE_CRC:
+                upload->crc_bytes[upload->index++] = data[i++];
+                if (upload->index == UPLOAD_CRC_SIZE) {
+                    end_frame(upload);
+                    upload->state = STATE_SYNC_HEAD;
+                }
+        }
+    }
+}
+
+
+/**
+ * @brief Check a completed frame header and decide where its payload
+ *        goes. A DATA payload is only written to memory if its address
+ *        and length match those its sequence number implies.
+ *
+ * @param upload: Pointer to an UPLOAD struct.
+ */
+static void begin_payload(UPLOAD* upload) {
+
+    uint8_t type = upload->header[2];
+    uint16_t seq = (upload->header[4] << 8) | upload->header[5];
+    uint16_t address = (upload->header[6] << 8) | upload->header[7];
+    uint16_t size = (upload->header[8] << 8) | upload->header[9];
+
+    upload->crc = crc32_update(CRC32_INITIAL, &upload->header[2], UPLOAD_HEADER_SIZE - 2);
+    upload->index = 0;
+    upload->is_wanted = false;
+    upload->is_compressed = (upload->header[3] & UPLOAD_FLAG_LZ4) != 0;
+
+    // A bad length means a corrupt header: hunt for the next frame
+    bool is_data = type == UPLOAD_FRAME_DATA || type == UPLOAD_FRAME_PATCH;
+    uint32_t limit = is_data ? UPLOAD_FRAME_SIZE : UPLOAD_CONTROL_SIZE;
+    if (size > limit) {
+        upload->bad_frames++;
+        upload->state = STATE_SYNC_HEAD;
+        return;
+    }
+
+    if (type == UPLOAD_FRAME_DATA && upload->is_active && seq < upload->frame_count) {
+        uint32_t offset = seq * UPLOAD_FRAME_SIZE;
+        uint32_t expected = upload->total_length - offset;
+        if (expected > UPLOAD_FRAME_SIZE) expected = UPLOAD_FRAME_SIZE;
+        if (upload->is_compressed) {
+            // Decompress straight into memory; the size is checked at the end
+            upload->is_wanted = (address == upload->start_address + offset);
+            if (upload->is_wanted) lz4_init(&upload->lz4, &upload->memory[address], expected);
+        } else {
+            upload->is_wanted = (address == upload->start_address + offset && size == expected);
+        }
+    }
+
+    if (type == UPLOAD_FRAME_PATCH && upload->is_active && upload->is_delta && !upload->is_compressed) {
+        // Patches may go anywhere within the image
+        uint32_t end = upload->start_address + upload->total_length;
+        upload->is_wanted = (address >= upload->start_address && address + size <= end);
+    }
+
+    upload->state = size > 0 ? STATE_PAYLOAD : STATE_CRC;
+}
+
+
+/**
+ * @brief Verify a completed frame's CRC and act on it.
+ *
+ * @param upload: Pointer to an UPLOAD struct.
+ */
+static void end_frame(UPLOAD* upload) {
+
+    uint16_t seq = (upload->header[4] << 8) | upload->header[5];
+    uint32_t crc = (upload->crc_bytes[0] << 24) | (upload->crc_bytes[1] << 16)
+                 | (upload->crc_bytes[2] << 8) | upload->crc_bytes[3];
+
+    upload->index = 0;
+
+    // A compressed payload must also decompress to exactly the frame's size
+    bool is_bad = (upload->crc ^ CRC32_FINAL_XOR) != crc;
+    if (upload->is_wanted && upload->is_compressed) is_bad |= lz4_finish(&upload->lz4) != LZ4_OK;
+
+    if (is_bad) {
+        // The payload may have been written: the frame must be resent
+        upload->bad_frames++;
+        if (upload->is_wanted && upload->header[2] == UPLOAD_FRAME_DATA) upload->received &= ~(1 << seq);
+        reply(upload, UPLOAD_REPLY_NAK, seq);
+        return;
+    }
+
+    switch (upload->header[2]) {
+        case UPLOAD_FRAME_START:
+            start_transfer(upload, seq);
+            break;
+        case UPLOAD_FRAME_DATA:
+        case UPLOAD_FRAME_PATCH:
+            accept_data(upload, seq);
+            break;
+        case UPLOAD_FRAME_HASH:
+            send_hashes(upload, seq);
+            break;
+        case UPLOAD_FRAME_DUMP:
+            send_dump(upload);
+            break;
+        case UPLOAD_FRAME_END:
+            end_transfer(upload, seq);
+            break;
+        default:
+            reply(upload, UPLOAD_REPLY_ERROR, seq);
+    }
+}
+
+
+/**
+ * @brief Begin a transfer. The START payload is the image length. A
+ *        delta transfer treats memory as already holding the image, so
+ *        only PATCH frames need follow before END.
+ *
+ * @param upload: Pointer to an UPLOAD struct.
+ * @param seq:    The frame's sequence number.
+ */
+static void start_transfer(UPLOAD* upload, uint16_t seq) {
+
+    uint32_t start;
+    uint32_t total;
+
+    if (!get_range(upload, &start, &total)) {
+        upload->is_active = false;
+        reply(upload, UPLOAD_REPLY_ERROR, seq);
+        return;
+    }
+
+    upload->is_active = true;
+    upload->is_done = false;
+    upload->is_delta = (upload->header[3] & UPLOAD_FLAG_DELTA) != 0;
+    upload->start_address = (uint16_t)start;
+    upload->total_length = total;
+    upload->frame_count = (total + UPLOAD_FRAME_SIZE - 1) / UPLOAD_FRAME_SIZE;
+    upload->bytes_received = 0;
+
+    // In a delta upload, memory already holds every frame bar the patches
+    upload->received = upload->is_delta ? (1 << upload->frame_count) - 1 : 0;
+    reply(upload, UPLOAD_REPLY_ACK, seq);
+}
+
+
+/**
+ * @brief Acknowledge a good DATA frame. Repeats are acknowledged again
+ *        but only counted once.
+ *
+ * @param upload: Pointer to an UPLOAD struct.
+ * @param seq:    The frame's sequence number.
+ */
+static void accept_data(UPLOAD* upload, uint16_t seq) {
+
+    if (!upload->is_wanted) {
+        reply(upload, UPLOAD_REPLY_ERROR, seq);
+        return;
+    }
+
+    if (upload->header[2] == UPLOAD_FRAME_PATCH) {
+        // Patches are not tracked: the sequence number only tags the reply
+        upload->bytes_received += (upload->header[8] << 8) | upload->header[9];
+    } else if ((upload->received & (1 << seq)) == 0) {
+        upload->received |= (1 << seq);
+        upload->bytes_received += upload->is_compressed
+            ? upload->lz4.out_size
+            : (upload->header[8] << 8) | upload->header[9];
+    }
+
+    reply(upload, UPLOAD_REPLY_ACK, seq);
+}
+
+
+/**
+ * @brief Complete a transfer, or NAK every frame still missing.
+ *
+ * @param upload: Pointer to an UPLOAD struct.
+ * @param seq:    The frame's sequence number.
+ */
+static void end_transfer(UPLOAD* upload, uint16_t seq) {
+
+    if (!upload->is_active) {
+        reply(upload, UPLOAD_REPLY_ERROR, seq);
+        return;
+    }
+
+    uint32_t all = (1 << upload->frame_count) - 1;
+    if ((upload->received & all) != all) {
+        for (uint16_t i = 0 ; i < upload->frame_count ; ++i) {
+            if ((upload->received & (1 << i)) == 0) reply(upload, UPLOAD_REPLY_NAK, i);
+        }
+
+        return;
+    }
+
+    uint32_t crc = crc32(&upload->memory[upload->start_address], upload->total_length);
+    uint8_t done[UPLOAD_REPLY_SIZE + 4] = {
+        UPLOAD_REPLY_HEAD, UPLOAD_REPLY_DONE, (seq >> 8) & 0xFF, seq & 0xFF,
+        (crc >> 24) & 0xFF, (crc >> 16) & 0xFF, (crc >> 8) & 0xFF, crc & 0xFF
+    };
+
+    upload->is_active = false;
+    upload->is_done = true;
+    upload->send(done, sizeof(done));
+}
+
+
+/**
+ * @brief Reply to a HASH frame with the hash of each 256-byte page
+ *        the range covers. Partial pages at either end are hashed over
+ *        the covered bytes only, so the host can match them.
+ *
+ * @param upload: Pointer to an UPLOAD struct.
+ * @param seq:    The frame's sequence number.
+ */
+static void send_hashes(UPLOAD* upload, uint16_t seq) {
+
+    uint32_t start;
+    uint32_t total;
+
+    if (!get_range(upload, &start, &total)) {
+        reply(upload, UPLOAD_REPLY_ERROR, seq);
+        return;
+    }
+
+    uint32_t end = start + total;
+    uint16_t count = ((end - 1) / UPLOAD_PAGE_SIZE) - (start / UPLOAD_PAGE_SIZE) + 1;
+    reply(upload, UPLOAD_REPLY_HASHES, count);
+
+    // Send the hashes in batches, big-endian
+    uint8_t out[UPLOAD_HASHES_PER_REPLY * 4];
+    uint32_t used = 0;
+    uint32_t address = start;
+
+    while (address < end) {
+        uint32_t next = (address / UPLOAD_PAGE_SIZE + 1) * UPLOAD_PAGE_SIZE;
+        if (next > end) next = end;
+
+        uint32_t hash = page_hash(&upload->memory[address], next - address);
+        out[used++] = hash >> 24;
+        out[used++] = (hash >> 16) & 0xFF;
+        out[used++] = (hash >> 8) & 0xFF;
+        out[used++] = hash & 0xFF;
+
+        if (used == sizeof(out) || next == end) {
+            upload->send(out, used);
+            used = 0;
+        }
+
+        address = next;
+    }
+}
+
+
+/**
+ * @brief Reply to a DUMP frame by sending the range as DATA frames of
+ *        up to 4KB, each with its CRC32, then a DONE reply carrying
+ *        the CRC32 of the whole range. Payloads go straight from
+ *        memory to the host.
+ *
+ * @param upload: Pointer to an UPLOAD struct.
+ */
+static void send_dump(UPLOAD* upload) {
+
+    uint32_t start;
+    uint32_t total;
+
+    if (!get_range(upload, &start, &total)) {
+        reply(upload, UPLOAD_REPLY_ERROR, 0);
+        return;
+    }
+
+    uint16_t seq = 0;
+    for (uint32_t offset = 0 ; offset < total ; offset += UPLOAD_FRAME_SIZE) {
+        uint32_t address = start + offset;
+        uint32_t size = total - offset;
+        if (size > UPLOAD_FRAME_SIZE) size = UPLOAD_FRAME_SIZE;
+
+        uint8_t header[UPLOAD_HEADER_SIZE] = {
+            UPLOAD_SYNC_HEAD, UPLOAD_SYNC_WINDOWED, UPLOAD_FRAME_DATA, 0,
+            seq >> 8, seq & 0xFF, address >> 8, address & 0xFF, size >> 8, size & 0xFF
+        };
+
+        uint32_t crc = crc32_update(CRC32_INITIAL, &header[2], UPLOAD_HEADER_SIZE - 2);
+        crc = crc32_update(crc, &upload->memory[address], size) ^ CRC32_FINAL_XOR;
+        uint8_t tail[UPLOAD_CRC_SIZE] = {crc >> 24, (crc >> 16) & 0xFF, (crc >> 8) & 0xFF, crc & 0xFF};
+
+        upload->send(header, UPLOAD_HEADER_SIZE);
+        upload->send(&upload->memory[address], size);
+        upload->send(tail, UPLOAD_CRC_SIZE);
+        upload->bytes_sent += size;
+        seq++;
+    }
+
+    uint32_t crc = crc32(&upload->memory[start], total);
+    uint8_t done[UPLOAD_REPLY_SIZE + 4] = {
+        UPLOAD_REPLY_HEAD, UPLOAD_REPLY_DONE, (seq >> 8) & 0xFF, seq & 0xFF,
+        (crc >> 24) & 0xFF, (crc >> 16) & 0xFF, (crc >> 8) & 0xFF, crc & 0xFF
+    };
+
+    upload->send(done, sizeof(done));
+}
+
+
+/**
+ * @brief Read and check the address range carried by START, HASH and DUMP
+ *        frames: the start address in the header, the length in the
+ *        payload.
+ *
+ * @param upload: Pointer to an UPLOAD struct.
+ * @param start:  Where to store the start address.
+ * @param total:  Where to store the length.
+ *
+ * @retval Whether the range is valid.
+ */
+static bool get_range(UPLOAD* upload, uint32_t* start, uint32_t* total) {
+
+    uint16_t size = (upload->header[8] << 8) | upload->header[9];
+    *start = (upload->header[6] << 8) | upload->header[7];
+    *total = (upload->control[0] << 24) | (upload->control[1] << 16)
+           | (upload->control[2] << 8) | upload->control[3];
+
+    return size == 4 && *total > 0 && *start + *total <= 0x10000;
+}
+
+
+/**
+ * @brief Send a four-byte reply to the host.
+ *
+ * @param upload: Pointer to an UPLOAD struct.
+ * @param code:   The UPLOAD_REPLY_* code.
+ * @param seq:    The sequence number of the frame replied to.
+ */
+static void reply(UPLOAD* upload, uint8_t code, uint16_t seq) {
+
+    uint8_t out[UPLOAD_REPLY_SIZE] = {UPLOAD_REPLY_HEAD, code, (seq >> 8) & 0xFF, seq & 0xFF};
+    upload->send(out, sizeof(out));
+}
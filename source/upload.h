@@ -0,0 +1,104 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Windowed upload protocol
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _UPLOAD_HEADER_
+#define _UPLOAD_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "lz4.h"
+
+
+/*
+ *      CONSTANTS
+ */
+// Frame layout: sync (2), type, flags, sequence (2), address (2),
+// payload length (2), payload, CRC32 (4) of everything after the sync
+#define UPLOAD_SYNC_HEAD            0x55
+#define UPLOAD_SYNC_WINDOWED        0x3D
+#define UPLOAD_HEADER_SIZE          10
+#define UPLOAD_CRC_SIZE             4
+#define UPLOAD_FRAME_SIZE           4096
+#define UPLOAD_MAX_FRAMES           16
+#define UPLOAD_CONTROL_SIZE         8
+
+#define UPLOAD_FRAME_START          0x01
+#define UPLOAD_FRAME_DATA           0x02
+#define UPLOAD_FRAME_END            0x03
+#define UPLOAD_FRAME_HASH           0x04
+#define UPLOAD_FRAME_PATCH          0x05
+#define UPLOAD_FRAME_DUMP           0x06
+
+// DATA frame flags
+#define UPLOAD_FLAG_LZ4             0x01        // Payload is an LZ4 block
+
+// START frame flags
+#define UPLOAD_FLAG_DELTA           0x02        // Memory holds the image; only PATCH frames follow
+
+// Delta uploads compare memory with the host's image in 256-byte pages
+#define UPLOAD_PAGE_SIZE            256
+#define UPLOAD_HASHES_PER_REPLY     64
+
+// Reply layout: head, code, sequence (2); a DONE reply adds the
+// image's CRC32 (4); a HASHES reply's sequence is the page count,
+// and that many page hashes (4 each) follow. A DUMP is answered with
+// DATA frames, sequence numbered from zero, then a DONE reply whose
+// sequence is the frame count
+#define UPLOAD_REPLY_HEAD           0xAA
+#define UPLOAD_REPLY_ACK            'A'
+#define UPLOAD_REPLY_NAK            'N'
+#define UPLOAD_REPLY_DONE           'D'
+#define UPLOAD_REPLY_ERROR          'E'
+#define UPLOAD_REPLY_HASHES         'H'
+#define UPLOAD_REPLY_SIZE           4
+
+
+/*
+ * STRUCTS
+ */
+typedef struct {
+    uint8_t*    memory;         // The 64KB space frames are written into
+    void        (*send)(const uint8_t* data, uint32_t length);
+    // Frame parser state
+    uint8_t     state;
+    uint8_t     header[UPLOAD_HEADER_SIZE];
+    uint8_t     control[UPLOAD_CONTROL_SIZE];
+    uint8_t     crc_bytes[UPLOAD_CRC_SIZE];
+    uint32_t    index;
+    uint32_t    crc;
+    bool        is_wanted;      // The payload is going to memory
+    bool        is_compressed;
+    LZ4_STREAM  lz4;
+    // Transfer state
+    bool        is_active;
+    bool        is_done;
+    bool        is_delta;
+    uint16_t    start_address;
+    uint32_t    total_length;
+    uint16_t    frame_count;
+    uint32_t    received;       // Bitmap of good frames
+    uint32_t    bytes_received;
+    uint32_t    bad_frames;
+    uint32_t    bytes_sent;     // Memory dumped to the host
+} UPLOAD;
+
+
+/*
+ *      PROTOTYPES
+ */
+void        upload_init(UPLOAD* upload, uint8_t* memory, void (*send)(const uint8_t* data, uint32_t length));
+void        upload_feed(UPLOAD* upload, const uint8_t* data, uint32_t length);
+
+
+#endif  // _UPLOAD_HEADER_
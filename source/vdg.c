@@ -0,0 +1,393 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Video Display Generator (VDG)
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+// App
+#include "vdg.h"
+
+
+/*
+ * STATICS
+ */
+static bool     is_row_dirty(const uint8_t* dirty, uint16_t address, uint32_t length);
+static void     clear_dirty(uint8_t* dirty, uint16_t address, uint32_t length);
+static void     render_text_row(MC6847* vdg, const uint8_t* ram, uint16_t address, uint8_t mode, uint32_t row);
+static void     render_graphics_row(MC6847* vdg, const uint8_t* ram, uint16_t address, uint8_t mode, uint32_t row);
+
+// Graphics mode geometry, by GM2-GM0
+// See MC6847 Data Sheet p.13
+typedef struct {
+    uint8_t     row_bytes;
+    uint8_t     rows;
+    bool        is_colour;
+} VDG_GEOMETRY;
+
+static const VDG_GEOMETRY GRAPHICS_MODES[8] = {
+    {16,  64, true},        // CG1   64 x  64, 4 colours
+    {16,  64, false},       // RG1  128 x  64, 2 colours
+    {32,  64, true},        // CG2  128 x  64, 4 colours
+    {16,  96, false},       // RG2  128 x  96, 2 colours
+    {32,  96, true},        // CG3  128 x  96, 4 colours
+    {16, 192, false},       // RG3  128 x 192, 2 colours
+    {32, 192, true},        // CG6  128 x 192, 4 colours
+    {32, 192, false}        // RG6  256 x 192, 2 colours
+};
+
+// Internal character generator: 64 5x7 glyphs, one byte per row, bit 4 leftmost
+// See MC6847 Data Sheet p.15
+static const uint8_t CHARSET[64 * VDG_GLYPH_HEIGHT] = {
+    0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E,   // 0x00 @
+    0x04, 0x0A, 0x11, 0x11, 0x1F, 0x11, 0x11,   // 0x01 A
+    0x1E, 0x09, 0x09, 0x0E, 0x09, 0x09, 0x1E,   // 0x02 B
+    0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E,   // 0x03 C
+    0x1E, 0x09, 0x09, 0x09, 0x09, 0x09, 0x1E,   // 0x04 D
+    0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F,   // 0x05 E
+    0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10,   // 0x06 F
+    0x0F, 0x10, 0x10, 0x13, 0x11, 0x11, 0x0F,   // 0x07 G
+    0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11,   // 0x08 H
+    0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E,   // 0x09 I
+    0x01, 0x01, 0x01, 0x01, 0x11, 0x11, 0x0E,   // 0x0A J
+    0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11,   // 0x0B K
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F,   // 0x0C L
+    0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11,   // 0x0D M
+    0x11, 0x19, 0x15, 0x13, 0x11, 0x11, 0x11,   // 0x0E N
+    0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E,   // 0x0F O
+    0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10,   // 0x10 P
+    0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D,   // 0x11 Q
+    0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11,   // 0x12 R
+    0x0E, 0x11, 0x10, 0x0E, 0x01, 0x11, 0x0E,   // 0x13 S
+    0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,   // 0x14 T
+    0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E,   // 0x15 U
+    0x11, 0x11, 0x11, 0x0A, 0x0A, 0x04, 0x04,   // 0x16 V
+    0x11, 0x11, 0x11, 0x15, 0x15, 0x1B, 0x11,   // 0x17 W
+    0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11,   // 0x18 X
+    0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x04,   // 0x19 Y
+    0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F,   // 0x1A Z
+    0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E,   // 0x1B [
+    0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00,   // 0x1C BACKSLASH
+    0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E,   // 0x1D ]
+    0x04, 0x0E, 0x15, 0x04, 0x04, 0x04, 0x04,   // 0x1E UP ARROW
+    0x00, 0x04, 0x08, 0x1F, 0x08, 0x04, 0x00,   // 0x1F LEFT ARROW
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,   // 0x20 SPACE
+    0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04,   // 0x21 !
+    0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00,   // 0x22 "
+    0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A,   // 0x23 #
+    0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04,   // 0x24 $
+    0x19, 0x19, 0x02, 0x04, 0x08, 0x13, 0x13,   // 0x25 %
+    0x08, 0x14, 0x14, 0x08, 0x15, 0x12, 0x0D,   // 0x26 &
+    0x04, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00,   // 0x27 '
+    0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02,   // 0x28 (
+    0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08,   // 0x29 )
+    0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00,   // 0x2A *
+    0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00,   // 0x2B +
+    0x00, 0x00, 0x00, 0x0C, 0x0C, 0x04, 0x08,   // 0x2C ,
+    0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00,   // 0x2D -
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C,   // 0x2E .
+    0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00,   // 0x2F /
+    0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E,   // 0x30 0
+    0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E,   // 0x31 1
+    0x0E, 0x11, 0x01, 0x0E, 0x10, 0x10, 0x1F,   // 0x32 2
+    0x0E, 0x11, 0x01, 0x06, 0x01, 0x11, 0x0E,   // 0x33 3
+    0x02, 0x06, 0x0A, 0x1F, 0x02, 0x02, 0x02,   // 0x34 4
+    0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E,   // 0x35 5
+    0x0E, 0x10, 0x10, 0x1E, 0x11, 0x11, 0x0E,   // 0x36 6
+    0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x10,   // 0x37 7
+    0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E,   // 0x38 8
+    0x0E, 0x11, 0x11, 0x0F, 0x01, 0x01, 0x0E,   // 0x39 9
+    0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00,   // 0x3A :
+    0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x04, 0x08,   // 0x3B ;
+    0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02,   // 0x3C <
+    0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00,   // 0x3D =
+    0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08,   // 0x3E >
+    0x0E, 0x11, 0x01, 0x06, 0x04, 0x00, 0x04,   // 0x3F ?
+};
+
+// RGB values for the palette indices
+static const uint8_t PALETTE[VDG_PALETTE_SIZE][3] = {
+    {0x00, 0xFF, 0x00},     // Green
+    {0xFF, 0xFF, 0x00},     // Yellow
+    {0x00, 0x00, 0xFF},     // Blue
+    {0xFF, 0x00, 0x00},     // Red
+    {0xFF, 0xFF, 0xFF},     // Buff
+    {0x00, 0xFF, 0xFF},     // Cyan
+    {0xFF, 0x00, 0xFF},     // Magenta
+    {0xFF, 0x80, 0x00},     // Orange
+    {0x00, 0x00, 0x00},     // Black
+    {0x00, 0x40, 0x00},     // Dark green
+    {0x40, 0x10, 0x00}      // Dark orange
+};
+
+
+/**
+ * @brief Clear the framebuffer and force a full redraw on the next render.
+ *
+ * @param vdg: Pointer to an MC6847 struct.
+ */
+void vdg_init(MC6847* vdg) {
+
+    memset(vdg->pixels, VDG_BLACK, sizeof(vdg->pixels));
+    vdg->mode = 0;
+    vdg->base = 0;
+    vdg->is_valid = false;
+}
+
+
+/**
+ * @brief Render video RAM into the framebuffer. Only rows whose 32-byte
+ *        lines are marked in the dirty bitmap are redrawn, unless the
+ *        mode or base address has changed since the last call. The
+ *        bitmap's bits for the display area are cleared afterwards.
+ *
+ * @param vdg:   Pointer to an MC6847 struct.
+ * @param ram:   Pointer to the 64KB memory space.
+ * @param base:  The address of video RAM, as set by the SAM.
+ * @param mode:  The VDG mode pins, VDG_MODE_* bits.
+ * @param dirty: Pointer to the write-dirty bitmap, or NULL to redraw everything.
+ *
+ * @retval The number of scanlines redrawn.
+ */
+uint32_t vdg_render(MC6847* vdg, const uint8_t* ram, uint16_t base, uint8_t mode, uint8_t* dirty) {
+
+    mode &= VDG_MODE_MASK;
+    bool is_full = !vdg->is_valid || dirty == NULL || mode != vdg->mode || base != vdg->base;
+
+    uint32_t row_bytes = VDG_TEXT_COLS;
+    uint32_t rows = VDG_TEXT_ROWS;
+    if (mode & VDG_MODE_AG) {
+        const VDG_GEOMETRY* geometry = &GRAPHICS_MODES[(mode >> VDG_MODE_GM_SHIFT) & VDG_MODE_GM_MASK];
+        row_bytes = geometry->row_bytes;
+        rows = geometry->rows;
+    }
+
+    uint32_t lines = 0;
+    uint32_t row_lines = VDG_HEIGHT / rows;
+    uint16_t address = base;
+
+    for (uint32_t i = 0 ; i < rows ; ++i) {
+        if (is_full || is_row_dirty(dirty, address, row_bytes)) {
+            if (mode & VDG_MODE_AG) {
+                render_graphics_row(vdg, ram, address, mode, i);
+            } else {
+                render_text_row(vdg, ram, address, mode, i);
+            }
+
+            lines += row_lines;
+        }
+
+        address += row_bytes;
+    }
+
+    if (dirty != NULL) clear_dirty(dirty, base, row_bytes * rows);
+
+    vdg->mode = mode;
+    vdg->base = base;
+    vdg->is_valid = true;
+    return lines;
+}
+
+
+/**
+ * @brief Get the amount of video RAM a mode displays.
+ *
+ * @param mode: The VDG mode pins, VDG_MODE_* bits.
+ *
+ * @retval The size in bytes.
+ */
+uint32_t vdg_get_ram_size(uint8_t mode) {
+
+    if ((mode & VDG_MODE_AG) == 0) return VDG_TEXT_COLS * VDG_TEXT_ROWS;
+
+    const VDG_GEOMETRY* geometry = &GRAPHICS_MODES[(mode >> VDG_MODE_GM_SHIFT) & VDG_MODE_GM_MASK];
+    return geometry->row_bytes * geometry->rows;
+}
+
+
+/**
+ * @brief Write the framebuffer to a file as a binary (P6) PPM image.
+ *
+ * @param vdg:  Pointer to an MC6847 struct.
+ * @param file: The open output file.
+ *
+ * @retval Whether the image was written.
+ */
+bool vdg_write_ppm(MC6847* vdg, FILE* file) {
+
+    uint8_t line[VDG_WIDTH * 3];
+
+    if (fprintf(file, "P6\n%i %i\n255\n", VDG_WIDTH, VDG_HEIGHT) < 0) return false;
+
+    for (uint32_t i = 0 ; i < VDG_HEIGHT ; ++i) {
+        uint8_t* rgb = line;
+        for (uint32_t j = 0 ; j < VDG_WIDTH ; ++j) {
+            const uint8_t* colour = PALETTE[vdg->pixels[i][j]];
+            *rgb++ = colour[0];
+            *rgb++ = colour[1];
+            *rgb++ = colour[2];
+        }
+
+        if (fwrite(line, 1, sizeof(line), file) != sizeof(line)) return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Check the dirty bitmap for any write to a row of video RAM.
+ *
+ * @param dirty:   Pointer to the write-dirty bitmap.
+ * @param address: The row's first byte.
+ * @param length:  The row's size in bytes.
+ *
+ * @retval Whether the row has been written to.
+ */
+static bool is_row_dirty(const uint8_t* dirty, uint16_t address, uint32_t length) {
+
+    uint32_t first = address >> 5;
+    uint32_t last = ((address + length - 1) & 0xFFFF) >> 5;
+
+    for (uint32_t line = first ; ; line = (line + 1) & 0x7FF) {
+        if (dirty[line >> 3] & (1 << (line & 0x07))) return true;
+        if (line == last) return false;
+    }
+}
+
+
+/**
+ * @brief Clear the dirty bitmap over an area of memory.
+ *
+ * @param dirty:   Pointer to the write-dirty bitmap.
+ * @param address: The area's first byte.
+ * @param length:  The area's size in bytes.
+ */
+static void clear_dirty(uint8_t* dirty, uint16_t address, uint32_t length) {
+
+    uint32_t first = address >> 5;
+    uint32_t last = ((address + length - 1) & 0xFFFF) >> 5;
+
+    for (uint32_t line = first ; ; line = (line + 1) & 0x7FF) {
+        dirty[line >> 3] &= ~(1 << (line & 0x07));
+        if (line == last) return;
+    }
+}
+
+
+/**
+ * @brief Draw one row of 32 text cells, 12 scanlines. Bit 7 selects
+ *        semigraphics: SG6 if INT/EXT is set, otherwise SG4. For
+ *        characters, bit 6 selects normal (dark on light) video.
+ *
+ * @param vdg:     Pointer to an MC6847 struct.
+ * @param ram:     Pointer to the 64KB memory space.
+ * @param address: The address of the row's first cell.
+ * @param mode:    The VDG mode pins.
+ * @param row:     The text row, 0-15.
+ */
+static void render_text_row(MC6847* vdg, const uint8_t* ram, uint16_t address, uint8_t mode, uint32_t row) {
+
+    bool is_css = (mode & VDG_MODE_CSS) != 0;
+    uint8_t light = is_css ? VDG_ORANGE : VDG_GREEN;
+    uint8_t dark = is_css ? VDG_DARK_ORANGE : VDG_DARK_GREEN;
+
+    for (uint32_t col = 0 ; col < VDG_TEXT_COLS ; ++col) {
+        uint8_t code = ram[(uint16_t)(address + col)];
+        uint32_t x = col * 8;
+
+        for (uint32_t y = 0 ; y < VDG_CELL_HEIGHT ; ++y) {
+            uint8_t* pixel = &vdg->pixels[row * VDG_CELL_HEIGHT + y][x];
+            uint8_t bits = 0;
+            uint8_t ink;
+            uint8_t paper;
+
+            if (code & 0x80) {
+                if (mode & VDG_MODE_INT_EXT) {
+                    // SG6: 2 x 3 blocks, colour from bits 6-7 and CSS
+                    bits = (code >> (4 - (y >> 2) * 2)) & 0x03;
+                    ink = ((code >> 6) & 0x03) + (is_css ? VDG_BUFF : VDG_GREEN);
+                } else {
+                    // SG4: 2 x 2 blocks, colour from bits 4-6
+                    bits = (code >> (y < 6 ? 2 : 0)) & 0x03;
+                    ink = (code >> 4) & 0x07;
+                }
+
+                paper = VDG_BLACK;
+                for (uint32_t i = 0 ; i < 8 ; ++i) {
+                    *pixel++ = (bits & (i < 4 ? 0x02 : 0x01)) ? ink : paper;
+                }
+            } else {
+                if (y >= VDG_GLYPH_TOP && y < VDG_GLYPH_TOP + VDG_GLYPH_HEIGHT) {
+                    // Align the glyph's bit 4 with pixel VDG_GLYPH_LEFT
+                    bits = CHARSET[(code & 0x3F) * VDG_GLYPH_HEIGHT + y - VDG_GLYPH_TOP] << (3 - VDG_GLYPH_LEFT);
+                }
+
+                ink = (code & 0x40) ? dark : light;
+                paper = (code & 0x40) ? light : dark;
+                for (uint32_t i = 0 ; i < 8 ; ++i) {
+                    *pixel++ = (bits & 0x80) ? ink : paper;
+                    bits <<= 1;
+                }
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Draw one row of graphics data, repeating it as many scanlines
+ *        as the mode requires.
+ *
+ * @param vdg:     Pointer to an MC6847 struct.
+ * @param ram:     Pointer to the 64KB memory space.
+ * @param address: The address of the row's first byte.
+ * @param mode:    The VDG mode pins.
+ * @param row:     The graphics row.
+ */
+static void render_graphics_row(MC6847* vdg, const uint8_t* ram, uint16_t address, uint8_t mode, uint32_t row) {
+
+    const VDG_GEOMETRY* geometry = &GRAPHICS_MODES[(mode >> VDG_MODE_GM_SHIFT) & VDG_MODE_GM_MASK];
+    bool is_css = (mode & VDG_MODE_CSS) != 0;
+    uint32_t row_lines = VDG_HEIGHT / geometry->rows;
+    uint8_t* line = vdg->pixels[row * row_lines];
+    uint8_t* pixel = line;
+
+    if (geometry->is_colour) {
+        // Four 2-bit pixels per byte
+        uint32_t width = VDG_WIDTH / (geometry->row_bytes * 4);
+        uint8_t offset = is_css ? VDG_BUFF : VDG_GREEN;
+
+        for (uint32_t i = 0 ; i < geometry->row_bytes ; ++i) {
+            uint8_t byte = ram[(uint16_t)(address + i)];
+            for (uint32_t j = 0 ; j < 4 ; ++j) {
+                uint8_t colour = offset + ((byte >> 6) & 0x03);
+                for (uint32_t k = 0 ; k < width ; ++k) *pixel++ = colour;
+                byte <<= 2;
+            }
+        }
+    } else {
+        // Eight 1-bit pixels per byte
+        uint32_t width = VDG_WIDTH / (geometry->row_bytes * 8);
+        uint8_t colour = is_css ? VDG_BUFF : VDG_GREEN;
+
+        for (uint32_t i = 0 ; i < geometry->row_bytes ; ++i) {
+            uint8_t byte = ram[(uint16_t)(address + i)];
+            for (uint32_t j = 0 ; j < 8 ; ++j) {
+                uint8_t value = (byte & 0x80) ? colour : VDG_BLACK;
+                for (uint32_t k = 0 ; k < width ; ++k) *pixel++ = value;
+                byte <<= 1;
+            }
+        }
+    }
+
+    for (uint32_t i = 1 ; i < row_lines ; ++i) {
+        memcpy(vdg->pixels[row * row_lines + i], line, VDG_WIDTH);
+    }
+}
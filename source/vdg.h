@@ -0,0 +1,81 @@
+/*
+ * e6809 for Raspberry Pi Pico
+ * Video Display Generator (VDG)
+ *
+ * @version     0.0.2
+ * @author      smittytone
+ * @copyright   2025
+ * @licence     MIT
+ *
+ */
+#ifndef _VDG_HEADER_
+#define _VDG_HEADER_
+
+
+/*
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+
+/*
+ *      CONSTANTS
+ */
+#define VDG_WIDTH                   256
+#define VDG_HEIGHT                  192
+
+// Mode bits, laid out as on the Dragon's PIA 1 port B
+// See MC6847 Data Sheet p.7
+#define VDG_MODE_AG                 0x80
+#define VDG_MODE_GM_SHIFT           4
+#define VDG_MODE_GM_MASK            0x07
+#define VDG_MODE_INT_EXT            0x10
+#define VDG_MODE_CSS                0x08
+#define VDG_MODE_MASK               0xF8
+
+// Text mode cell geometry
+#define VDG_TEXT_COLS               32
+#define VDG_TEXT_ROWS               16
+#define VDG_CELL_HEIGHT             12
+#define VDG_GLYPH_HEIGHT            7
+#define VDG_GLYPH_TOP               3
+#define VDG_GLYPH_LEFT              2
+
+// Palette indices
+#define VDG_GREEN                   0
+#define VDG_YELLOW                  1
+#define VDG_BLUE                    2
+#define VDG_RED                     3
+#define VDG_BUFF                    4
+#define VDG_CYAN                    5
+#define VDG_MAGENTA                 6
+#define VDG_ORANGE                  7
+#define VDG_BLACK                   8
+#define VDG_DARK_GREEN              9
+#define VDG_DARK_ORANGE             10
+#define VDG_PALETTE_SIZE            11
+
+
+/*
+ * STRUCTS
+ */
+typedef struct {
+    uint8_t     pixels[VDG_HEIGHT][VDG_WIDTH];  // Palette indices
+    uint8_t     mode;                           // Mode of the last render
+    uint16_t    base;                           // Video RAM address of the last render
+    bool        is_valid;                       // False forces a full redraw
+} MC6847;
+
+
+/*
+ *      PROTOTYPES
+ */
+void        vdg_init(MC6847* vdg);
+uint32_t    vdg_render(MC6847* vdg, const uint8_t* ram, uint16_t base, uint8_t mode, uint8_t* dirty);
+uint32_t    vdg_get_ram_size(uint8_t mode);
+bool        vdg_write_ppm(MC6847* vdg, FILE* file);
+
+
+#endif  // _VDG_HEADER_